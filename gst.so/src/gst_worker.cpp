@@ -0,0 +1,860 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/gst_worker.h"
+
+#include <unistd.h>
+#include <string>
+#include <memory>
+#include <iostream>
+
+#include "include/rvs_blas.h"
+#include "include/rvs_module.h"
+#include "include/rvscpuusage.h"
+#include "include/rvsloglp.h"
+
+#define MODULE_NAME                             "gst"
+
+#define GST_MEM_ALLOC_ERROR                     "memory allocation error!"
+#define GST_BLAS_ERROR                          "memory/blas error!"
+#define GST_BLAS_MEMCPY_ERROR                   "HostToDevice mem copy error!"
+
+#define GST_MAX_GFLOPS_OUTPUT_KEY               "Gflop"
+#define GST_FLOPS_PER_OP_OUTPUT_KEY             "flops_per_op"
+#define GST_BYTES_COPIED_PER_OP_OUTPUT_KEY      "bytes_copied_per_op"
+#define GST_TRY_OPS_PER_SEC_OUTPUT_KEY          "try_ops_per_sec"
+
+#define GST_LOG_GFLOPS_INTERVAL_KEY             "Gflops"
+#define GST_JSON_LOG_GPU_ID_KEY                 "gpu_id"
+#define GST_HOST_PAGE_KEY                       "host page"
+#define GST_HOST_PIN_TIME_KEY                   "pin time"
+#define GST_PIPELINE_KEY                        "pipeline"
+#define GST_PIPELINE_GFLOPS_KEY                 "pipeline Gflops"
+#define GST_PIPELINE_COPY_BW_KEY                "copy GBps"
+#define GST_PIPELINE_GEMM_GFLOPS_KEY            "gemm Gflops"
+#define GST_CPU_UTILIZATION_KEY                 "host cpu utilization"
+#define GST_GEMM_QUEUE_KEY                      "gemm queue"
+
+#define PROC_DEC_INC_SGEMM_FREQ_DELAY           10
+
+#define NMAX_MS_GPU_RUN_PEAK_PERFORMANCE        1000
+#define NMAX_MS_SGEMM_OPS_RAMP_SUB_INTERVAL     1000
+#define USLEEP_MAX_VAL                          (1000000 - 1)
+
+#define GST_COPY_MATRIX_MSG                     "copy matrix"
+#define GST_START_MSG                           "start"
+#define GST_PASS_KEY                            "pass"
+#define GST_RAMP_EXCEEDED_MSG                   "ramp time exceeded"
+#define GST_TARGET_ACHIEVED_MSG                 "target achieved"
+#define GST_STRESS_VIOLATION_MSG                "stress violation"
+
+using std::string;
+
+bool GSTWorker::bjson = false;
+
+GSTWorker::GSTWorker() : copy_pipeline(0), gemm_batch(1), gemm_streams(1),
+                         gemm_queue_depth(1), host_page(0) {}
+GSTWorker::~GSTWorker() {}
+
+/**
+ * @brief performs the rvsBlas setup
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::setup_blas(int *error, string *err_description) {
+    *error = 0;
+    // setup rvsBlas
+    gpu_blas = std::unique_ptr<rvs_blas>(
+        new rvs_blas(gpu_device_index, matrix_size_a, matrix_size_b,
+                        matrix_size_c, gst_trans_a, gst_trans_b,
+                        gst_alpha_val, gst_beta_val, 
+                        gst_lda_offset, gst_ldb_offset, gst_ldc_offset,
+                        gst_ops_type, host_page));
+
+    if (!gpu_blas) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    if (gpu_blas->error()) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    if (host_page) {
+        string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_HOST_PAGE_KEY + " " +
+            rvs::HostAllocator::page_name(gpu_blas->get_host_page_size()) +
+            " requested " + rvs::HostAllocator::page_name(host_page) + " " +
+            GST_HOST_PIN_TIME_KEY + " " +
+            std::to_string(gpu_blas->get_host_pin_time_us()) + " us";
+        rvs::lp::Log(msg, rvs::loginfo);
+        log_to_json(GST_HOST_PAGE_KEY,
+            rvs::HostAllocator::page_name(gpu_blas->get_host_page_size()),
+            rvs::loginfo);
+        log_to_json(GST_HOST_PIN_TIME_KEY,
+            std::to_string(gpu_blas->get_host_pin_time_us()), rvs::loginfo);
+    }
+
+    // generate random matrix & copy it to the GPU
+    gpu_blas->generate_random_matrix_data();
+    if (!copy_matrix) {
+        // copy matrix only once
+        if (!gpu_blas->copy_data_to_gpu(gst_ops_type)) {
+            *error = 1;
+            *err_description = GST_BLAS_MEMCPY_ERROR;
+            return;
+        }
+
+        // matrices stay on the GPU, so GEMMs can be queued back to back
+        if (gemm_streams > 1 || gemm_queue_depth > 1) {
+            if (!gpu_blas->start_gemm_queue(gemm_streams, gemm_queue_depth)) {
+                *error = 1;
+                *err_description = GST_MEM_ALLOC_ERROR;
+                return;
+            }
+            rvs::lp::LogLazy(rvs::loginfo, "[", action_name, "] ",
+                MODULE_NAME, " ", gpu_id, " ", GST_GEMM_QUEUE_KEY,
+                " streams ", gpu_blas->get_gemm_queue()->streams(),
+                " depth ", gpu_blas->get_gemm_queue()->depth());
+        }
+    }
+}
+
+/**
+ * @brief runs gemm_batch GEMMs and waits for them, or launches them through
+ * the GEMM queue
+ *
+ * Queued GEMMs overlap each other and complete in bursts, so no per call
+ * Gflops are available for them; callers compute Gflops from the number of
+ * completed GEMMs over their log interval.
+ *
+ * @param gemms [out] number of GEMMs completed
+ * @param gflops [out] Gflops of the GEMMs (device timed), left unchanged
+ * when queued
+ * @return true if everything went fine, otherwise false
+ */
+bool GSTWorker::run_gemms(uint64_t *gemms, double *gflops) {
+    const rvs::GemmQueue* queue = gpu_blas->get_gemm_queue();
+    double gemm_time_us;
+
+    if (!queue) {
+        if (!gpu_blas->timed_gemm_batch(gemm_batch, &gemm_time_us))
+            return false;
+        *gemms = gemm_batch;
+        *gflops = gpu_blas->gemm_gflop_count() * gemm_batch /
+                    (gemm_time_us/1e6)/1e9;
+        return true;
+    }
+
+    uint64_t completed = queue->completed();
+    if (!gpu_blas->run_queued_gemms(gemm_batch))
+        return false;
+    *gemms = queue->completed() - completed;
+    return true;
+}
+
+/**
+ * @brief attempts to hit the maximum Gflops value
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::hit_max_gflops(int *error, string *err_description) {
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                                    gst_end_time,
+                                                    gst_log_interval_time;
+    double seconds_elapsed = 0, curr_gflops;
+    uint16_t num_sgemm_ops_log_interval = 0;
+    uint64_t millis_sgemm_ops;
+    string msg;
+
+    *error = 0;
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = std::chrono::system_clock::now();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+
+        gst_end_time = std::chrono::system_clock::now();
+        if (time_diff(gst_end_time, gst_start_time) >=
+                            NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            break;
+
+        if (copy_matrix) {
+            // copy matrix before each GEMM
+            if (!gpu_blas->copy_data_to_gpu(gst_ops_type)) {
+                *error = 1;
+                *err_description = GST_BLAS_MEMCPY_ERROR;
+                return;
+            }
+        }
+
+        // run GEMMs & wait for completion (the thread sleeps meanwhile)
+        if (!gpu_blas->run_gemm_batch(gemm_batch) ||
+            !gpu_blas->wait_gemm_batch())
+            continue;  // failed to run the current SGEMM
+
+        num_sgemm_ops_log_interval += gemm_batch;
+
+        gst_end_time = std::chrono::system_clock::now();
+        millis_sgemm_ops = time_diff(gst_end_time, gst_log_interval_time);
+
+        if (millis_sgemm_ops >= log_interval) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double> (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed != 0) {
+                curr_gflops = static_cast<double>(gpu_blas->gemm_gflop_count() *
+                                num_sgemm_ops_log_interval) / seconds_elapsed;
+                log_interval_gflops(curr_gflops);
+            }
+
+            num_sgemm_ops_log_interval = 0;
+            gst_log_interval_time = std::chrono::system_clock::now();
+        }
+    }
+}
+
+/**
+ * @brief performs the ramp-up on the given GPU (attempts to reach the given 
+ * target stress Gflops)
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if target stress is achieved within the ramp_interval,
+ * false otherwise
+ */
+bool GSTWorker::do_gst_ramp(int *error, string *err_description) {
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                                    gst_end_time,
+                                                    gst_log_interval_time,
+                                                    gst_start_gflops_time,
+                                                    gst_last_sgemm_start_time,
+                                                    gst_last_sgemm_end_time;
+    double seconds_elapsed, curr_gflops, dyn_delay_target_stress;
+    uint64_t num_sgemm_ops = 0, num_sgemm_ops_log_interval = 0;
+    uint64_t millis_sgemm_ops, millis_last_sgemm;
+    uint16_t proc_delay = 0;
+    uint64_t gemms_done;
+    double gflops_interval = 0;
+    string msg;
+
+    // make sure that the ramp_interval & duration are not less than
+    // NMAX_MS_GPU_RUN_PEAK_PERFORMANCE (e.g.: 1000)
+    if (run_duration_ms < NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+        run_duration_ms += NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+
+    if (ramp_interval < NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+        ramp_interval += NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+
+    // stage 1. setup rvs blas
+    setup_blas(error, err_description);
+    if (*error)
+        return false;
+
+    // check if stop signal was received
+    if (rvs::lp::Stopping())
+        return false;
+
+    // stage 3. reduce the SGEMM frequency and try to achieve the desired Gflops
+    // the delay which gives the SGEMM frequency will be dynamically computed
+    delay_target_stress = 0;
+
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = std::chrono::system_clock::now();
+    gst_start_gflops_time = std::chrono::system_clock::now();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        gst_end_time = std::chrono::system_clock::now();
+        if (time_diff(gst_end_time,  gst_start_time) >
+                            ramp_interval - NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            return false;
+
+        gst_last_sgemm_start_time = std::chrono::system_clock::now();
+
+        if (copy_matrix) {
+            // Genrate random matrix data
+            gpu_blas->generate_random_matrix_data();
+            // copy matrix before each GEMM
+            if (!gpu_blas->copy_data_to_gpu(gst_ops_type)) {
+                *error = 1;
+                *err_description = GST_BLAS_MEMCPY_ERROR;
+                return false;
+            }
+        }
+
+        // run GEMMs & wait for completion
+        if (!run_gemms(&gemms_done, &gflops_interval)) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+
+        gst_last_sgemm_end_time = std::chrono::system_clock::now();
+        millis_last_sgemm =
+                time_diff(gst_last_sgemm_end_time, gst_last_sgemm_start_time);
+        if (static_cast<double>(
+                (1000 * gpu_blas->gemm_gflop_count() * gemms_done) /
+                    target_stress) <
+                        millis_last_sgemm) {
+            // last SGEMM timed-out (it took more than it should)
+            dyn_delay_target_stress = 1;
+        }
+
+
+        num_sgemm_ops += gemms_done;
+        num_sgemm_ops_log_interval += gemms_done;
+
+        gst_end_time = std::chrono::system_clock::now();
+        millis_sgemm_ops =
+                    time_diff(gst_end_time, gst_start_gflops_time);
+        if (millis_sgemm_ops >= NMAX_MS_SGEMM_OPS_RAMP_SUB_INTERVAL) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double>
+                                (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed > 0) {
+                curr_gflops = static_cast<double>(
+                                    gpu_blas->gemm_gflop_count() *
+                                    num_sgemm_ops) / seconds_elapsed;
+                if (curr_gflops >= target_stress && curr_gflops <
+                        target_stress + target_stress * tolerance/2) {
+                    ramp_actual_time =
+                                time_diff(gst_end_time,  gst_start_time) +
+                                NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+                    delay_target_stress /= num_sgemm_ops;
+                    return true;
+                }
+            }
+            proc_delay +=
+                (delay_target_stress * PROC_DEC_INC_SGEMM_FREQ_DELAY) / 100;
+            num_sgemm_ops = 0;
+            delay_target_stress = 0;
+            gst_start_gflops_time = std::chrono::system_clock::now();
+        }
+
+        millis_sgemm_ops =
+                    time_diff(gst_end_time, gst_log_interval_time);
+        if (millis_sgemm_ops >= log_interval) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double>
+                                (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed > 0) {
+                curr_gflops = static_cast<double>(
+                                gpu_blas->gemm_gflop_count() *
+                                num_sgemm_ops_log_interval) / seconds_elapsed;
+                // queued GEMMs overlap, only the interval average is valid
+                log_interval_gflops(gpu_blas->get_gemm_queue() ?
+                                    curr_gflops / 1e9 : gflops_interval);
+            }
+
+            num_sgemm_ops_log_interval = 0;
+            gst_log_interval_time = std::chrono::system_clock::now();
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief logs the Gflops computed over the last log_interval period 
+ * @param gflops_interval the Gflops that the GPU achieved
+ */
+void GSTWorker::check_target_stress(double gflops_interval) {
+    string msg;
+    bool result;
+
+    if(gflops_interval >= target_stress){
+           result = true;
+    }else{
+           result = false;
+    }
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+              std::to_string(gpu_id) + " " + GST_LOG_GFLOPS_INTERVAL_KEY + " " + std::to_string(gflops_interval) + " " +
+              "Target stress :" + " " + std::to_string(target_stress) + " met :" + (result ? "TRUE" : "FALSE");
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_LOG_GFLOPS_INTERVAL_KEY, std::to_string(gflops_interval),
+                rvs::loginfo);
+}
+
+
+
+/**
+ * @brief logs the Gflops computed over the last log_interval period 
+ * @param gflops_interval the Gflops that the GPU achieved
+ */
+void GSTWorker::log_interval_gflops(double gflops_interval) {
+    rvs::lp::LogLazy(rvs::logresults, "[", action_name, "] ", MODULE_NAME,
+                     " ", gpu_id, " ", GST_LOG_GFLOPS_INTERVAL_KEY, " ",
+                     gflops_interval);
+
+    log_to_json(GST_LOG_GFLOPS_INTERVAL_KEY, std::to_string(gflops_interval),
+                rvs::loginfo);
+}
+
+/**
+ * @brief checks for Gflops violation 
+ * @param gflops_interval the Gflops that the GPU achieved over the last
+ * log_interval period
+ * @return true if this gflops violates the bounds, false otherwise
+ */
+bool GSTWorker::check_gflops_violation(double gflops_interval) {
+    if (!(gflops_interval > target_stress - target_stress * tolerance &&
+            gflops_interval < target_stress + target_stress * tolerance)) {
+//        rvs::lp::LogLazy(rvs::loginfo, "[", action_name, "] ", MODULE_NAME,
+//                         " ", gpu_id, " ", GST_STRESS_VIOLATION_MSG, " ",
+//                         gflops_interval);
+
+        //log_to_json(GST_STRESS_VIOLATION_MSG, std::to_string(gflops_interval),
+         //           rvs::loginfo);
+        return true;
+    }
+
+
+    return false;
+}
+
+/**
+ * @brief performs the stress test on the given GPU
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if stress violations is less than max_violations, false otherwise
+ */
+bool GSTWorker::do_gst_stress_test(int *error, std::string *err_description) {
+    uint64_t num_sgemm_ops = 0;
+    uint16_t num_gflops_violations = 0;
+    uint64_t total_milliseconds, log_interval_milliseconds;
+    uint64_t gemms_done;
+    double seconds_elapsed, gflops_interval;
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                            gst_end_time, gst_log_interval_time;
+
+    if (copy_matrix && copy_pipeline)
+        return do_gst_pipelined_test(error, err_description);
+
+    *error = 0;
+    max_gflops = 0;
+    num_sgemm_ops = 0;
+    gflops_interval = 0;
+
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = std::chrono::system_clock::now();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        if (copy_matrix) {
+            // copy matrix before each GEMM
+            if (!gpu_blas->copy_data_to_gpu(gst_ops_type)) {
+                *error = 1;
+                *err_description = GST_BLAS_MEMCPY_ERROR;
+                return false;
+            }
+        }
+
+        // run GEMMs & wait for completion
+        if (!run_gemms(&gemms_done, &gflops_interval)) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+
+        num_sgemm_ops += gemms_done;
+
+        gst_end_time = std::chrono::system_clock::now();
+        total_milliseconds = time_diff(gst_end_time, gst_start_time);
+        log_interval_milliseconds = time_diff(gst_end_time,
+                                              gst_log_interval_time);
+
+        if (log_interval_milliseconds >= log_interval && num_sgemm_ops > 0) {
+            seconds_elapsed = static_cast<double> (log_interval_milliseconds) /
+                                1000;
+            if (seconds_elapsed != 0) {
+
+                // queued GEMMs overlap, so Gflops are averaged over the
+                // log interval instead of taken from the last batch
+                if (gpu_blas->get_gemm_queue())
+                    gflops_interval = gpu_blas->gemm_gflop_count() *
+                                        num_sgemm_ops / seconds_elapsed / 1e9;
+
+                if (gflops_interval > max_gflops)
+                    max_gflops = gflops_interval;
+
+                log_interval_gflops(max_gflops);
+
+                // reset time & gflops related data
+                num_sgemm_ops = 0;
+                gst_log_interval_time = std::chrono::system_clock::now();
+            }
+        }
+
+
+        if(!gst_hot_calls) {
+               rvs::lp::LogLazy(rvs::logtrace, "[", action_name, "] ",
+                           MODULE_NAME, " ", gpu_id, " ", GST_START_MSG, " ",
+                           " Execution time in milliseconds :",
+                           total_milliseconds,
+                           " run_duration_ms :", run_duration_ms);
+               if (total_milliseconds >= run_duration_ms)
+                      break;
+        }else{
+            rvs::lp::LogLazy(rvs::logtrace, "[", action_name, "] ",
+                   MODULE_NAME, " ", gpu_id, " ", GST_START_MSG, " ",
+                   " Executing hot calls loop :", gst_hot_calls);
+           
+            gst_hot_calls--; 
+        }
+    }
+
+    // wait for the GEMMs still in flight
+    if (gpu_blas->get_gemm_queue() && !gpu_blas->finish_gemm_queue()) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief performs the stress test with copies of the next GEMM's matrices
+ * overlapping the running GEMM
+ *
+ * Gflops are measured over wall clock time, so they include whatever
+ * copy/compute overlap was achieved. Copy bandwidth and GEMM-only Gflops
+ * come from GPU event timing of the individual copies and GEMMs.
+ *
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if the test ran for the whole duration, false otherwise
+ */
+bool GSTWorker::do_gst_pipelined_test(int *error,
+                                      std::string *err_description) {
+    uint64_t num_gemm_ops = 0, total_milliseconds, log_interval_milliseconds;
+    uint64_t last_copies = 0, last_gemms = 0;
+    double last_copy_time = 0, last_gemm_time = 0;
+    double seconds_elapsed, gflops_interval;
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                            gst_end_time, gst_log_interval_time;
+
+    *error = 0;
+    max_gflops = 0;
+
+    if (!gpu_blas->start_pipeline(copy_pipeline)) {
+        *error = 1;
+        *err_description = GST_BLAS_MEMCPY_ERROR;
+        return false;
+    }
+    const rvs::GemmPipeline* pipe = gpu_blas->get_pipeline();
+
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = gst_start_time;
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping()) {
+            gpu_blas->finish_pipeline();
+            return false;
+        }
+
+        // start GEMM, fill and copy matrices of the next one meanwhile
+        if (!gpu_blas->run_pipelined_gemm()) {
+            gpu_blas->finish_pipeline();
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+        num_gemm_ops++;
+
+        gst_end_time = std::chrono::system_clock::now();
+        total_milliseconds = time_diff(gst_end_time, gst_start_time);
+        log_interval_milliseconds = time_diff(gst_end_time,
+                                              gst_log_interval_time);
+
+        if (log_interval_milliseconds >= log_interval && num_gemm_ops > 0) {
+            seconds_elapsed = static_cast<double>(log_interval_milliseconds) /
+                                1000;
+            gflops_interval = gpu_blas->gemm_gflop_count() * num_gemm_ops /
+                                seconds_elapsed / 1e9;
+            if (gflops_interval > max_gflops)
+                max_gflops = gflops_interval;
+
+            log_interval_gflops(max_gflops);
+            log_pipeline_stats(gflops_interval,
+                               pipe->copies() - last_copies,
+                               pipe->copy_time() - last_copy_time,
+                               pipe->gemms() - last_gemms,
+                               pipe->gemm_time() - last_gemm_time);
+
+            last_copies = pipe->copies();
+            last_copy_time = pipe->copy_time();
+            last_gemms = pipe->gemms();
+            last_gemm_time = pipe->gemm_time();
+            num_gemm_ops = 0;
+            gst_log_interval_time = std::chrono::system_clock::now();
+        }
+
+        if (!gst_hot_calls) {
+            if (total_milliseconds >= run_duration_ms)
+                break;
+        } else {
+            gst_hot_calls--;
+        }
+    }
+
+    if (!gpu_blas->finish_pipeline()) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return false;
+    }
+
+    // whole stress test
+    seconds_elapsed = static_cast<double>(time_diff(
+                        std::chrono::system_clock::now(), gst_start_time)) /
+                        1000;
+    log_pipeline_stats(seconds_elapsed > 0 ? gpu_blas->gemm_gflop_count() *
+                            pipe->gemms() / seconds_elapsed / 1e9 : 0,
+                       pipe->copies(), pipe->copy_time(),
+                       pipe->gemms(), pipe->gemm_time());
+    return true;
+}
+
+/**
+ * @brief logs throughput of the copy/compute pipeline
+ * @param gflops Gflops over wall clock time
+ * @param copies number of completed copies
+ * @param copy_time total duration of the copies in seconds
+ * @param gemms number of completed GEMMs
+ * @param gemm_time total duration of the GEMMs in seconds
+ */
+void GSTWorker::log_pipeline_stats(double gflops, uint64_t copies,
+                                   double copy_time, uint64_t gemms,
+                                   double gemm_time) {
+    double copy_gbps = copy_time > 0 ? static_cast<double>(copies) *
+                        gpu_blas->get_bytes_copied_per_op() / copy_time / 1e9
+                        : 0;
+    double gemm_gflops = gemm_time > 0 ? gpu_blas->gemm_gflop_count() *
+                        gemms / gemm_time / 1e9 : 0;
+
+    rvs::lp::LogLazy(rvs::logresults, "[", action_name, "] ", MODULE_NAME,
+                     " ", gpu_id, " ", GST_PIPELINE_KEY, " ",
+                     GST_LOG_GFLOPS_INTERVAL_KEY, " ", gflops, " ",
+                     GST_PIPELINE_COPY_BW_KEY, " ", copy_gbps, " ",
+                     GST_PIPELINE_GEMM_GFLOPS_KEY, " ", gemm_gflops);
+
+    if (GSTWorker::bjson && rvs::lp::Enabled(rvs::loginfo)) {
+        unsigned int sec;
+        unsigned int usec;
+
+        rvs::lp::get_ticks(&sec, &usec);
+        void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::loginfo, sec, usec);
+        if (json_node) {
+            rvs::lp::AddString(json_node, GST_JSON_LOG_GPU_ID_KEY,
+                            std::to_string(gpu_id));
+            rvs::lp::AddString(json_node, GST_PIPELINE_GFLOPS_KEY,
+                            std::to_string(gflops));
+            rvs::lp::AddString(json_node, GST_PIPELINE_COPY_BW_KEY,
+                            std::to_string(copy_gbps));
+            rvs::lp::AddString(json_node, GST_PIPELINE_GEMM_GFLOPS_KEY,
+                            std::to_string(gemm_gflops));
+            rvs::lp::LogRecordFlush(json_node);
+        }
+    }
+}
+
+/**
+ * @brief performs the stress test on the given GPU
+ */
+void GSTWorker::run() {
+    string msg, err_description;
+    int error = 0;
+    bool gst_test_passed = true;
+    rvs::ThreadCpuUsage cpu_usage;
+
+    max_gflops = 0;
+
+    // log GST stress test - start message
+    rvs::lp::LogLazy(rvs::logtrace, "[", action_name, "] ", MODULE_NAME, " ",
+                     gpu_id, " ", GST_START_MSG, " ",
+                     " Starting the GST stress test ");
+
+    log_to_json(GST_START_MSG, std::to_string(target_stress), rvs::loginfo);
+    log_to_json(GST_COPY_MATRIX_MSG, (copy_matrix ? "true":"false"),
+                rvs::loginfo);
+
+    // let the GPU ramp-up and check the result
+    bool ramp_up_success = do_gst_ramp(&error, &err_description);
+
+    // GPU was not able to do the processing (HIP/rocBlas error(s) occurred)
+    if (error) {
+        string msg = "[" + action_name + "] " + MODULE_NAME + " "
+                        + std::to_string(gpu_id) + " " + err_description;
+        rvs::lp::Log(msg, rvs::logerror);
+        log_to_json("err", err_description, rvs::logerror);
+
+        return;
+    }
+
+    // the GPU succeeded to achieve the target_stress GFLOPS
+    // continue with the same workload for the rest of the test duration
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + " GST ramp completed for interval :" + " " +
+                std::to_string(ramp_interval);
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(GST_TARGET_ACHIEVED_MSG, std::to_string(target_stress),
+                    rvs::loginfo);
+    if (run_duration_ms > 0) {
+            gst_test_passed = do_gst_stress_test(&error, &err_description);
+            // check if stop signal was received
+            if (rvs::lp::Stopping())
+                return;
+
+            if (error) {
+                // GPU didn't complete the test (HIP/rocBlas error(s) occurred)
+                string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                                std::to_string(gpu_id) + " " + err_description;
+                rvs::lp::Log(msg, rvs::logerror);
+                log_to_json("err", err_description, rvs::logerror);
+                return;
+            }
+    }
+
+    log_interval_gflops(max_gflops);
+    check_target_stress(max_gflops);
+    log_cpu_utilization(cpu_usage.utilization());
+}
+
+/**
+ * @brief logs how busy the worker thread kept its CPU core
+ * @param utilization share of wall clock time the thread was on CPU (0 - 1)
+ */
+void GSTWorker::log_cpu_utilization(double utilization) {
+    rvs::lp::LogLazy(rvs::loginfo, "[", action_name, "] ", MODULE_NAME,
+                     " ", gpu_id, " ", GST_CPU_UTILIZATION_KEY, " ",
+                     100 * utilization, " %");
+
+    log_to_json(GST_CPU_UTILIZATION_KEY, std::to_string(100 * utilization),
+                rvs::loginfo);
+}
+
+/**
+ * @brief logs the GST test result
+ * @param gst_test_passed true if test succeeded, false otherwise
+ */
+void GSTWorker::log_gst_test_result(bool gst_test_passed) {
+    string msg;
+
+    double flops_per_op = (2 * (static_cast<double>(gpu_blas->get_m())/1000) *
+                                (static_cast<double>(gpu_blas->get_n())/1000) *
+                                (static_cast<double>(gpu_blas->get_k())/1000));
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+        std::to_string(gpu_id) + " " + GST_MAX_GFLOPS_OUTPUT_KEY + ": " +
+        std::to_string(max_gflops) + " " + GST_FLOPS_PER_OP_OUTPUT_KEY + ": " +
+        std::to_string(flops_per_op) + "x1e9" + " " +
+        GST_BYTES_COPIED_PER_OP_OUTPUT_KEY + ": " +
+        std::to_string(gpu_blas->get_bytes_copied_per_op()) +
+        " " + GST_TRY_OPS_PER_SEC_OUTPUT_KEY + ": "+
+        std::to_string(target_stress / gpu_blas->gemm_gflop_count()) +
+        " "  ;
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_MAX_GFLOPS_OUTPUT_KEY, std::to_string(max_gflops),
+                rvs::loginfo);
+    log_to_json(GST_FLOPS_PER_OP_OUTPUT_KEY, std::to_string(flops_per_op) +
+                "x1e9", rvs::loginfo);
+    log_to_json(GST_BYTES_COPIED_PER_OP_OUTPUT_KEY,
+                std::to_string(gpu_blas->get_bytes_copied_per_op()),
+                rvs::loginfo);
+    log_to_json(GST_TRY_OPS_PER_SEC_OUTPUT_KEY,
+                std::to_string(target_stress / gpu_blas->gemm_gflop_count()),
+                rvs::loginfo);
+    log_to_json(GST_PASS_KEY, (gst_test_passed ?
+            GST_RESULT_PASS_MESSAGE : GST_RESULT_FAIL_MESSAGE),
+            rvs::logresults);
+}
+
+/**
+ * @brief computes the difference (in milliseconds) between 2 points in time
+ * @param t_end second point in time
+ * @param t_start first point in time
+ * @return time difference in milliseconds
+ */
+uint64_t GSTWorker::time_diff(
+                std::chrono::time_point<std::chrono::system_clock> t_end,
+                std::chrono::time_point<std::chrono::system_clock> t_start) {
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            t_end - t_start);
+    return milliseconds.count();
+}
+
+/**
+ * @brief logs a message to JSON
+ * @param key info type
+ * @param value message to log
+ * @param log_level the level of log (e.g.: info, results, error)
+ */
+void GSTWorker::log_to_json(const std::string &key, const std::string &value,
+                     int log_level) {
+    if (GSTWorker::bjson && rvs::lp::Enabled(log_level)) {
+        unsigned int sec;
+        unsigned int usec;
+
+        rvs::lp::get_ticks(&sec, &usec);
+        void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), log_level, sec, usec);
+        if (json_node) {
+            rvs::lp::AddString(json_node, GST_JSON_LOG_GPU_ID_KEY,
+                            std::to_string(gpu_id));
+            rvs::lp::AddString(json_node, key, value);
+            rvs::lp::LogRecordFlush(json_node);
+        }
+    }
+}
+
+/**
+ * @brief extends the usleep for more than 1000000us
+ * @param microseconds us to sleep
+ */
+void GSTWorker::usleep_ex(uint64_t microseconds) {
+    uint64_t total_microseconds = microseconds;
+    for (;;) {
+         if (total_microseconds > USLEEP_MAX_VAL) {
+            usleep(USLEEP_MAX_VAL);
+            total_microseconds -= USLEEP_MAX_VAL;
+        } else {
+            usleep(total_microseconds);
+            return;
+        }
+    }
+}
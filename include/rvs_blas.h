@@ -30,7 +30,43 @@
 #include "rocblas.h"
 #include "include/hip/hip_runtime.h"
 #include "include/hip/hip_runtime_api.h"
+#include "include/rvsblasbuf.h"
+#include "include/rvsgemmpipe.h"
+#include "include/rvsgemmqueue.h"
+#include "include/rvshostalloc.h"
+#include "include/rvsmatgen.h"
 #include <sys/time.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class rvs_blas_pinner
+ * @ingroup GST
+ *
+ * @brief pins host matrices with hipHostRegister()
+ *
+ */
+class rvs_blas_pinner : public rvs::HostPinner {
+ public:
+    int Pin(void* Ptr, size_t Size, int Peer, void** pDevPtr) override;
+    void Unpin(void* Ptr) override;
+};
+
+/**
+ * @brief events marking copy and GEMM of a pipeline slot
+ */
+struct rvs_blas_events {
+    //! recorded on copy stream before the copy
+    hipEvent_t copy_start;
+    //! recorded on copy stream after the copy
+    hipEvent_t copy_done;
+    //! recorded on compute stream before the GEMM
+    hipEvent_t gemm_start;
+    //! recorded on compute stream after the GEMM
+    hipEvent_t gemm_done;
+};
 
 /**
  * @class rvs_blas
@@ -38,12 +74,24 @@
  *
  * @brief implements the SGEMM logic
  *
+ * Only matrices of the precision used by ops_type are allocated. Host and
+ * device memory is provided to the matrix buffers through the
+ * rvs::BlasAllocator interface.
+ *
+ * In pipelined mode host data preparation and copies of the next GEMM's
+ * matrices overlap the running GEMM, see rvs::GemmPipeline.
+ *
+ * In queued mode several GEMMs are kept in flight across several streams,
+ * each with its own rocBlas handle and device matrices, see rvs::GemmQueue.
+ *
  */
-class rvs_blas {
+class rvs_blas : public rvs::BlasAllocator, public rvs::GemmRuntime,
+                 public rvs::GemmQueueRuntime {
  public:
     rvs_blas(int _gpu_device_index, int _m, int _n, int _k, 
         int transa, int transb, float aplha, float beta, 
-        int lda, int ldb, int ldc);
+        int lda, int ldb, int ldc, const std::string& _ops_type,
+        size_t _host_page = 0);
     ~rvs_blas();
 
     //! returns the GPU index
@@ -55,17 +103,27 @@ class rvs_blas {
     //! returns k (matrix size)
     rocblas_int get_k(void) { return k; }
 
+    //! returns the GEMM operation matrices are allocated for
+    std::string get_ops_type(void) {
+        return rvs::BlasBuffersBase::ops_name(ops_precision);
+    }
+
     //! computes the number of bytes which are copied to
-    //! the GPU for one SGEMM operation
+    //! the GPU for one GEMM operation
     uint64_t get_bytes_copied_per_op(void) {
-        return sizeof(float) * (size_a + size_b + size_c);
+        return buffers ? buffers->bytes() : 0;
     }
     //! computes the gflop for a SGEMM operation
     double gemm_gflop_count(void) {
         return static_cast<double>(2.0 * m * n * k);
     }
 
-    double get_time_us(void);
+    //! returns smallest page size backing host matrices
+    //! (0 - matrices allocated on heap)
+    size_t get_host_page_size(void) { return host_alloc.min_page(); }
+    //! returns time spent pinning host matrices in microseconds
+    double get_host_pin_time_us(void) { return host_alloc.pin_time() * 1e6; }
+
     //! returns TRUE if an error occured
     bool error(void) { return is_error; }
     void generate_random_matrix_data(void);
@@ -73,6 +131,25 @@ class rvs_blas {
     bool run_blass_gemm(std::string);
     bool is_gemm_op_complete(void);
 
+    bool run_gemm_batch(int Count = 1);
+    bool wait_gemm_batch(void);
+    double get_gemm_batch_time_us(void);
+    bool timed_gemm_batch(int Count, double* pTimeUs);
+
+    bool start_pipeline(int Slots = RVS_GEMMPIPE_SLOTS);
+    bool run_pipelined_gemm(void);
+    bool finish_pipeline(void);
+    //! returns copy and GEMM statistics of the pipeline (nullptr - pipeline
+    //! not started)
+    const rvs::GemmPipeline* get_pipeline(void) { return pipeline.get(); }
+
+    bool start_gemm_queue(int Streams, int Depth);
+    bool run_queued_gemms(int Count);
+    bool finish_gemm_queue(void);
+    //! returns launch and completion counters of the GEMM queue (nullptr -
+    //! queue not started)
+    const rvs::GemmQueue* get_gemm_queue(void) { return gemm_queue.get(); }
+
  protected:
     //! GPU device index
     int gpu_device_index;
@@ -93,33 +170,10 @@ class rvs_blas {
     //! Transpose matrix B
     rocblas_operation transb;
 
-    //SGEMM DECLARAION
-    //! pointer to device (GPU) memory
-    float *da;
-    //! pointer to device (GPU) memory
-    float *db;
-    //! pointer to device (GPU) memory
-    float *dc;
-    //! pointer to host memory
-    float *ha;
-    //! pointer to host memory
-    float *hb;
-    //! pointer to host memory
-    float *hc;
-
-    //DGEMM Declaration
-    //! pointer to device (GPU) memory
-    double *ddbla;
-    //! pointer to device (GPU) memory
-    double *ddblb;
-    //! pointer to device (GPU) memory
-    double *ddblc;
-    //! pointer to host memory
-    double *hdbla;
-    //! pointer to host memory
-    double *hdblb;
-    //! pointer to host memory
-    double *hdblc;
+    //! precision of GEMM (one of RVS_BLAS_*GEMM, -1 if not valid)
+    int ops_precision;
+    //! host and device matrices of the configured precision
+    std::unique_ptr<rvs::BlasBuffersBase> buffers;
 
     //!GST Aplha Val 
     float blas_alpha_val;
@@ -131,40 +185,87 @@ class rvs_blas {
     int blas_ldb_offset;
     int blas_ldc_offset;
 
-    //HGEMM Declaration
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfa;
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfb;
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfc;
-    //! pointer to host memory
-    rocblas_half *hhlfa;
-    //! pointer to host memory
-    rocblas_half *hhlfb;
-    //! pointer to host memory
-    rocblas_half *hhlfc;
-
-    rocblas_half  hostarrayA;
-    rocblas_half  hostarrayB;
-    rocblas_half  hostarrayC;
-
     //! HIP API stream - used to query for GEMM completion
     hipStream_t hip_stream;
     //! rocBlas related handle
     rocblas_handle blas_handle;
     //! TRUE is rocBlas handle was successfully initialized
     bool is_handle_init;
+    //! recorded on rocBlas stream before a GEMM batch
+    hipEvent_t batch_start;
+    //! recorded on rocBlas stream after a GEMM batch (blocking sync)
+    hipEvent_t batch_done;
+    //! TRUE if batch events were successfully created
+    bool is_batch_event_init;
     //! rocBlas guard (prevents executing blass_gemm when there are mem errors)
     bool is_error;
 
+    rvs::BlasBuffersBase* create_buffers(void);
+    rvs::BlasBuffersBase* slot_buffers(int Slot);
+    void generate_matrix_data(rvs::BlasBuffersBase* pBuff);
+    bool enqueue_gemm(rvs::BlasBuffersBase* pBuff, rocblas_handle Handle);
+    void release_pipeline(void);
+    void release_gemm_queue(void);
+
     bool init_gpu_device(void);
     bool allocate_gpu_matrix_mem(void);
     void release_gpu_matrix_mem(void);
 
     bool alocate_host_matrix_mem(void);
     void release_host_matrix_mem(void);
-    float fast_pseudo_rand(u_long *nextr);
+
+    void* AllocHost(size_t Size) override;
+    void  FreeHost(void* Ptr) override;
+    void* AllocDevice(size_t Size) override;
+    void  FreeDevice(void* Ptr) override;
+
+    int Fill(int Slot) override;
+    int CopyAsync(int Slot) override;
+    int GemmAsync(int Slot) override;
+    int WaitCopy(int Slot) override;
+    int WaitGemm(int Slot) override;
+    int CopyTime(int Slot, double* pSeconds) override;
+    int GemmTime(int Slot, double* pSeconds) override;
+
+    int QueueGemm(int Stream, int Slot) override;
+    int WaitQueued(int Slot) override;
+
+    //! page size requested for host matrices (0 - allocate on heap)
+    size_t host_page;
+    //! pins host matrices mapped by host_alloc
+    rvs_blas_pinner host_pinner;
+    //! maps host matrices with host_page pages
+    rvs::HostAllocator host_alloc;
+    //! host matrices mapped by host_alloc, by address
+    std::map<void*, rvs::HostBuffer> host_buffers;
+    //! fills host matrices in parallel
+    rvs::MatrixGen matrix_gen;
+
+    //! TRUE if heap matrices are pinned as well (async copies need it)
+    bool pin_host;
+    //! HIP API stream pipelined copies run on
+    hipStream_t copy_stream;
+    //! TRUE if copy_stream was successfully created
+    bool is_copy_stream_init;
+    //! matrices of pipeline slots 1.., slot 0 uses buffers
+    std::vector<std::unique_ptr<rvs::BlasBuffersBase>> slot_extra;
+    //! events of pipeline slots
+    std::vector<rvs_blas_events> slot_events;
+    //! copy/compute overlap state machine (nullptr - not pipelined)
+    std::unique_ptr<rvs::GemmPipeline> pipeline;
+    //! seed of the next pipeline fill
+    uint64_t fill_seed;
+
+    //! HIP API streams of queue streams 1.., stream 0 is hip_stream
+    std::vector<hipStream_t> queue_streams;
+    //! rocBlas handles of queue streams 1.., stream 0 uses blas_handle
+    std::vector<rocblas_handle> queue_handles;
+    //! device matrices of queue streams 1.., stream 0 uses buffers
+    std::vector<std::unique_ptr<rvs::BlasBuffersBase>> queue_buffers;
+    //! events of queue slots (blocking sync)
+    std::vector<hipEvent_t> queue_events;
+    //! GEMMs in flight state (nullptr - not queued)
+    std::unique_ptr<rvs::GemmQueue> gemm_queue;
 };
 
 #endif  // INCLUDE_RVS_BLAS_H_
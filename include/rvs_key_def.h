@@ -40,6 +40,24 @@
 #define RVS_CONF_BLOCK_SIZE_KEY         "block_size"
 #define RVS_CONF_B2B_BLOCK_SIZE_KEY     "b2b_block_size"
 #define RVS_CONF_LINK_TYPE_KEY          "link_type"
+#define RVS_CONF_QUEUE_DEPTH_KEY        "queue_depth"
+#define RVS_CONF_ADAPTIVE_KEY           "adaptive"
+#define RVS_CONF_ADAPTIVE_TOL_KEY       "adaptive_tolerance"
+#define RVS_CONF_LATENCY_KEY            "latency"
+#define RVS_CONF_LATENCY_ROUNDS_KEY     "latency_rounds"
+#define RVS_CONF_ALL_TO_ALL_KEY         "all_to_all"
+#define RVS_CONF_ALL_TO_ALL_CSV_KEY     "all_to_all_csv"
+#define RVS_CONF_COLLECTIVE_KEY         "collective"
+#define RVS_CONF_COLLECTIVE_CHUNKS_KEY  "collective_chunks"
+#define RVS_CONF_LINK_SCHEDULE_KEY      "link_schedule"
+#define RVS_CONF_HOST_PLACEMENT_KEY     "host_placement"
+#define RVS_CONF_CPU_PINNING_KEY        "cpu_pinning"
+#define RVS_CONF_HOST_BASELINE_KEY      "host_baseline"
+#define RVS_CONF_HOST_THREADS_KEY       "host_threads"
+#define RVS_CONF_HOST_PAGE_KEY          "host_page"
+#define RVS_CONF_GEMM_BATCH_KEY         "gemm_batch"
+#define RVS_CONF_GEMM_STREAMS_KEY       "gemm_streams"
+#define RVS_CONF_GEMM_QUEUE_DEPTH_KEY   "gemm_queue_depth"
 #define RVS_CONF_MONITOR_KEY            "monitor"
 
 #define DEFAULT_LOG_INTERVAL (1000u)
@@ -0,0 +1,142 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSBLASBUF_H_
+#define INCLUDE_RVSBLASBUF_H_
+
+#include <stddef.h>
+
+#include <string>
+
+//! single precision GEMM (float)
+#define RVS_BLAS_SGEMM 0
+//! double precision GEMM (double)
+#define RVS_BLAS_DGEMM 1
+//! half precision GEMM (rocblas_half)
+#define RVS_BLAS_HGEMM 2
+
+//! matrix A
+#define RVS_BLAS_MATRIX_A 0
+//! matrix B
+#define RVS_BLAS_MATRIX_B 1
+//! matrix C
+#define RVS_BLAS_MATRIX_C 2
+
+namespace rvs {
+
+/**
+ * @class BlasAllocator
+ * @ingroup RVS
+ *
+ * @brief Interface providing host and device memory to BlasBuffers
+ *
+ * Implemented by rvs_blas on top of HIP. Unit tests implement it with a
+ * fake allocator.
+ *
+ */
+class BlasAllocator {
+ public:
+  virtual ~BlasAllocator() {}
+
+  //! Allocates host memory, returns nullptr on failure
+  virtual void* AllocHost(size_t Size) = 0;
+  //! Releases memory obtained through AllocHost()
+  virtual void  FreeHost(void* Ptr) = 0;
+  //! Allocates device memory, returns nullptr on failure
+  virtual void* AllocDevice(size_t Size) = 0;
+  //! Releases memory obtained through AllocDevice()
+  virtual void  FreeDevice(void* Ptr) = 0;
+};
+
+/**
+ * @class BlasBuffersBase
+ * @ingroup RVS
+ *
+ * @brief Host and device copies of GEMM matrices A, B and C of one precision
+ *
+ * Element type is only known through its size here, typed access is
+ * provided by BlasBuffers.
+ *
+ */
+class BlasBuffersBase {
+ public:
+  BlasBuffersBase(BlasAllocator* pAlloc, size_t ElemSize,
+                  size_t SizeA, size_t SizeB, size_t SizeC);
+  virtual ~BlasBuffersBase();
+
+  bool allocate_host();
+  bool allocate_device();
+  void release_host();
+  void release_device();
+
+  //! Returns host copy of matrix (one of RVS_BLAS_MATRIX_*)
+  void* host_ptr(int Matrix) const { return host[Matrix]; }
+  //! Returns device copy of matrix (one of RVS_BLAS_MATRIX_*)
+  void* device_ptr(int Matrix) const { return device[Matrix]; }
+  //! Returns number of elements of matrix (one of RVS_BLAS_MATRIX_*)
+  size_t count(int Matrix) const { return counts[Matrix]; }
+  //! Returns size of matrix in bytes (one of RVS_BLAS_MATRIX_*)
+  size_t bytes(int Matrix) const { return counts[Matrix] * elem_size; }
+  size_t bytes() const;
+  //! Returns size of one element in bytes
+  size_t element_size() const { return elem_size; }
+
+  static int parse_ops_type(const std::string& Name);
+  static const char* ops_name(int Precision);
+
+ protected:
+  //! provides host and device memory
+  BlasAllocator* allocator;
+  //! size of one element in bytes
+  size_t elem_size;
+  //! number of elements of A, B and C
+  size_t counts[3];
+  //! host copies of A, B and C
+  void* host[3];
+  //! device copies of A, B and C
+  void* device[3];
+};
+
+/**
+ * @class BlasBuffers
+ * @ingroup RVS
+ *
+ * @brief BlasBuffersBase with typed access to matrices
+ *
+ */
+template <typename T>
+class BlasBuffers : public BlasBuffersBase {
+ public:
+  BlasBuffers(BlasAllocator* pAlloc, size_t SizeA, size_t SizeB, size_t SizeC)
+  : BlasBuffersBase(pAlloc, sizeof(T), SizeA, SizeB, SizeC) {}
+
+  //! Returns host copy of matrix (one of RVS_BLAS_MATRIX_*)
+  T* host_data(int Matrix) const { return static_cast<T*>(host[Matrix]); }
+  //! Returns device copy of matrix (one of RVS_BLAS_MATRIX_*)
+  T* device_data(int Matrix) const { return static_cast<T*>(device[Matrix]); }
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSBLASBUF_H_
@@ -0,0 +1,157 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSCOLLECTIVE_H_
+#define INCLUDE_RVSCOLLECTIVE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "include/rvstopology.h"
+
+//! all-gather along a ring
+#define RVS_COLL_ALLGATHER      0
+//! broadcast pipelined along a ring (chain)
+#define RVS_COLL_BROADCAST      1
+//! broadcast along a binary tree
+#define RVS_COLL_BROADCAST_TREE 2
+
+//! default number of chunks every block of data is split into
+#define RVS_COLL_CHUNKS 4
+
+namespace rvs {
+
+/**
+ * @brief One copy of a collective schedule
+ *
+ * Copies Size bytes at Offset from the buffer of rank Src to the same
+ * offset in the buffer of rank Dst, once all copies in Deps completed.
+ *
+ */
+struct CollectiveStep {
+  //! source rank
+  int    src;
+  //! destination rank
+  int    dst;
+  //! offset in source and destination buffer
+  size_t offset;
+  //! number of bytes to copy
+  size_t size;
+  //! indexes of copies which must complete first (all lower than own)
+  std::vector<size_t> deps;
+};
+
+/**
+ * @class CollectiveEngine
+ * @ingroup RVS
+ *
+ * @brief Interface to asynchronous copy engine driven by Collective
+ *
+ * Every rank owns one buffer, copies are identified by their index in the
+ * schedule. Implemented by rvs::HsaCollectiveEngine on top of HSA async
+ * copies, unit tests use a simulated engine.
+ *
+ */
+class CollectiveEngine {
+ public:
+  virtual ~CollectiveEngine() {}
+
+  //! Starts copy Index once its dependencies complete, returns 0 if OK
+  virtual int Submit(size_t Index, const CollectiveStep& Step) = 0;
+  //! Waits for copy Index to complete, returns 0 if successfull
+  virtual int Wait(size_t Index) = 0;
+  //! Fetches start and end time (nsec) of completed copy, 0 if OK
+  virtual int CopyTime(size_t Index, uint64_t* pStart, uint64_t* pEnd) = 0;
+};
+
+/**
+ * @class Collective
+ * @ingroup RVS
+ *
+ * @brief Schedule of chunked copies implementing a collective operation
+ *
+ * Ranks are given in ring order (see ring_order()). Data is split into
+ * chunks and every chunk is forwarded as soon as it arrives, so copies on
+ * different links overlap. Dependencies between copies form a graph
+ * which can be built and checked without GPUs.
+ *
+ * Bandwidth is reported the same way as by nccl-tests: algorithm
+ * bandwidth is data size over time, bus bandwidth scales it by the
+ * fraction of data each rank has to move so that it is comparable to
+ * peak link bandwidth.
+ *
+ */
+class Collective {
+ public:
+  Collective();
+
+  int build(int Kind, const std::vector<uint32_t>& Ranks, size_t Size,
+            int Chunks = RVS_COLL_CHUNKS);
+  int run(CollectiveEngine* pEngine, double* pDuration) const;
+
+  //! Returns collective kind (one of RVS_COLL_*)
+  int kind() const { return coll_kind; }
+  //! Returns NUMA nodes of ranks
+  const std::vector<uint32_t>& ranks() const { return rank_nodes; }
+  //! Returns data size (bytes per rank buffer)
+  size_t size() const { return data_size; }
+  //! Returns number of chunks each block is split into
+  int chunks() const { return chunk_count; }
+  //! Returns all copies in submission order
+  const std::vector<CollectiveStep>& steps() const { return schedule; }
+  double bus_factor() const;
+  double alg_bandwidth(double Duration) const;
+  double bus_bandwidth(double Duration) const;
+
+  static int  parse(const std::string& Name);
+  static const char* name(int Kind);
+  static void ring_order(const Topology& Topo,
+                         const std::vector<uint32_t>& Nodes,
+                         std::vector<uint32_t>* pRing);
+
+ protected:
+  void build_allgather(size_t Pieces);
+  void build_broadcast(size_t Pieces);
+  void build_broadcast_tree(size_t Pieces);
+  void add(int Src, int Dst, size_t Offset, size_t Size, size_t Dep);
+
+ protected:
+  //! collective kind (one of RVS_COLL_*)
+  int coll_kind;
+  //! NUMA nodes of ranks in ring order
+  std::vector<uint32_t> rank_nodes;
+  //! data size
+  size_t data_size;
+  //! requested number of chunks per block
+  int chunk_count;
+  //! copies in submission order
+  std::vector<CollectiveStep> schedule;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSCOLLECTIVE_H_
@@ -0,0 +1,115 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSCONTENTION_H_
+#define INCLUDE_RVSCONTENTION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/rvslinkmap.h"
+#include "include/rvstopology.h"
+
+//! largest number of GPUs for which all bisections are tried
+#define RVS_CONTENTION_MAX_BISECT 16
+
+namespace rvs {
+
+/**
+ * @class Contention
+ * @ingroup RVS
+ *
+ * @brief Bandwidth lost when transfers run concurrently
+ *
+ * Collects, for every transfer of an all-to-all run, bandwidth measured
+ * while the transfer ran alone (isolated) and while all transfers ran at
+ * the same time (concurrent). From these it derives the NxN matrix of
+ * achieved bandwidth, aggregate and bisection bandwidth, and a contention
+ * factor for every link modelled by rvs::LinkMap.
+ *
+ */
+class Contention {
+ public:
+  //! Measurements of one transfer
+  struct Transfer {
+    //! source GPU ID
+    uint16_t src;
+    //! destination GPU ID
+    uint16_t dst;
+    //! bandwidth measured alone (GBps)
+    double   isolated;
+    //! bandwidth measured with all other transfers running (GBps)
+    double   concurrent;
+  };
+
+  //! Load and contention of one link
+  struct Link {
+    //! link name (see rvs::LinkMap)
+    std::string name;
+    //! number of transfers using the link
+    size_t   transfers;
+    //! sum of isolated bandwidth of all transfers using the link (GBps)
+    double   isolated;
+    //! sum of concurrent bandwidth of all transfers using the link (GBps)
+    double   concurrent;
+    //! isolated / concurrent (1 - no contention)
+    double   factor;
+  };
+
+  void add(uint16_t SrcId, uint16_t DstId,
+           uint32_t SrcNode, uint32_t DstNode,
+           const std::vector<linkinfo_t>& Path,
+           double Isolated, double Concurrent);
+  void clear();
+
+  //! Returns all transfers
+  const std::vector<Transfer>& transfers() const { return xfers; }
+  //! Returns GPU IDs in increasing order (matrix row/column order)
+  const std::vector<uint16_t>& ids() const { return gpu_ids; }
+  void   matrix(std::vector<std::vector<double>>* pMatrix) const;
+  double aggregate() const;
+  double bisection(std::vector<uint16_t>* pHalf = nullptr) const;
+  void   links(std::vector<Link>* pLinks) const;
+
+  void write_csv(std::ostream& Out) const;
+
+ protected:
+  double crossing(const std::vector<bool>& Side) const;
+
+ protected:
+  //! measured transfers
+  std::vector<Transfer> xfers;
+  //! links used by transfers (same indexes as xfers)
+  LinkMap link_map;
+  //! GPU IDs in increasing order
+  std::vector<uint16_t> gpu_ids;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSCONTENTION_H_
@@ -0,0 +1,150 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSCOPYPIPE_H_
+#define INCLUDE_RVSCOPYPIPE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <utility>
+#include <vector>
+
+namespace rvs {
+
+/**
+ * @class CopyEngine
+ * @ingroup RVS
+ *
+ * @brief Interface to asynchronous copy engine driven by CopyPipeline
+ *
+ * Copies are identified by direction and slot. Each slot owns its buffers
+ * and completion signal, so copies in different slots may be in flight at
+ * the same time. Implemented by rvs::HsaCopyEngine on top of HSA async
+ * copies, unit tests use a simulated engine.
+ *
+ */
+class CopyEngine {
+ public:
+  virtual ~CopyEngine() {}
+
+  //! Starts copy of Size bytes in the given slot, returns 0 if successfull
+  virtual int Submit(int Dir, int Slot, size_t Size) = 0;
+  //! Waits for copy in the given slot to complete, returns 0 if successfull
+  virtual int Wait(int Dir, int Slot) = 0;
+/**
+ * @brief Fetches start and end time of completed copy
+ *
+ * @param Dir copy direction
+ * @param Slot copy slot
+ * @param pStart [out] start time in nanoseconds
+ * @param pEnd [out] end time in nanoseconds
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+  virtual int CopyTime(int Dir, int Slot, uint64_t* pStart, uint64_t* pEnd) = 0;
+/**
+ * @brief Starts copy once another copy has completed
+ *
+ * Engines able to express dependencies between copies (e.g. HSA signals)
+ * override this so that host does not have to wait in between. Default
+ * implementation waits for the dependency on the host.
+ *
+ * @param Dir copy direction
+ * @param Slot copy slot
+ * @param Size number of bytes to copy
+ * @param DepDir direction of the copy to wait for
+ * @param DepSlot slot of the copy to wait for
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+  virtual int SubmitAfter(int Dir, int Slot, size_t Size,
+                          int DepDir, int DepSlot) {
+    if (Wait(DepDir, DepSlot)) {
+      return -1;
+    }
+    return Submit(Dir, Slot, Size);
+  }
+};
+
+/**
+ * @class CopyPipeline
+ * @ingroup RVS
+ *
+ * @brief Keeps a number of copies in flight in every direction
+ *
+ * Slots of each direction are used as a ring: copies are issued until
+ * Depth of them are outstanding, then the oldest one is waited for and its
+ * slot reused for the next copy. Duration is the time at least one copy was
+ * in progress (union of copy intervals), the same way GetCopyTime() merges
+ * forward and reverse copies, so overlapping copies are not counted twice.
+ * Copies of one direction are expected to start in the order issued.
+ *
+ */
+class CopyPipeline {
+ public:
+  CopyPipeline(CopyEngine* pEngine, int Directions, int Depth);
+
+  int run(size_t Size, uint64_t Count, double* pDuration);
+
+  int start(size_t Size);
+  int next(double* pDuration);
+  int finish(double* pDuration, uint64_t* pCount);
+
+  //! Returns number of copies kept in flight per direction
+  int depth() const { return queue_depth; }
+
+ protected:
+  void reset(size_t Size);
+  int  submit(int Dir);
+  int  complete(int Dir);
+  int  drain();
+  double commit(bool bAll);
+
+ protected:
+  //! copy engine
+  CopyEngine* engine;
+  //! number of directions
+  int directions;
+  //! number of copies kept in flight per direction
+  int queue_depth;
+  //! size of each copy
+  size_t size;
+  //! per direction: slot of the oldest outstanding copy
+  std::vector<int> head;
+  //! per direction: number of outstanding copies
+  std::vector<int> inflight;
+  //! per direction: number of completed copies
+  std::vector<uint64_t> completed;
+  //! per direction: start time of the last completed copy
+  std::vector<uint64_t> last_start;
+  //! completed copy intervals not yet accounted for
+  std::vector<std::pair<uint64_t, uint64_t>> pending;
+  //! end of accounted busy time
+  uint64_t busy_end;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSCOPYPIPE_H_
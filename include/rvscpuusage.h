@@ -0,0 +1,64 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSCPUUSAGE_H_
+#define INCLUDE_RVSCPUUSAGE_H_
+
+#include <chrono>
+
+namespace rvs {
+
+/**
+ * @class ThreadCpuUsage
+ * @ingroup RVS
+ *
+ * @brief CPU utilization of the calling thread
+ *
+ * Compares CPU time consumed by the thread with wall clock time elapsed
+ * since start(). A thread busy waiting for the GPU is close to 1, a thread
+ * sleeping in blocking waits close to 0. All methods must be called from the
+ * thread that called start().
+ *
+ */
+class ThreadCpuUsage {
+ public:
+  ThreadCpuUsage();
+
+  void   start();
+  double cpu_time() const;
+  double wall_time() const;
+  double utilization() const;
+
+  static double thread_cpu_time();
+
+ protected:
+  //! thread CPU time at start() in seconds
+  double cpu_start;
+  //! wall clock time at start()
+  std::chrono::steady_clock::time_point wall_start;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSCPUUSAGE_H_
@@ -0,0 +1,136 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSGEMMPIPE_H_
+#define INCLUDE_RVSGEMMPIPE_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+//! default number of staging slots (double buffering)
+#define RVS_GEMMPIPE_SLOTS 2
+
+namespace rvs {
+
+/**
+ * @class GemmRuntime
+ * @ingroup RVS
+ *
+ * @brief Interface to GPU runtime driven by GemmPipeline
+ *
+ * Each slot owns a set of pinned host (staging) matrices, a set of device
+ * matrices and the events marking its copy and GEMM. Copies run on a copy
+ * stream and GEMMs on a compute stream, a GEMM starts only once the copy of
+ * its slot has completed. Implemented by rvs_blas on top of HIP, unit tests
+ * use a simulated runtime.
+ *
+ */
+class GemmRuntime {
+ public:
+  virtual ~GemmRuntime() {}
+
+  //! Fills staging matrices of the slot on host, returns 0 if successfull
+  virtual int Fill(int Slot) = 0;
+  //! Starts copy of staging to device matrices, returns 0 if successfull
+  virtual int CopyAsync(int Slot) = 0;
+  //! Starts GEMM after the copy of the slot, returns 0 if successfull
+  virtual int GemmAsync(int Slot) = 0;
+  //! Waits for copy of the slot to complete, returns 0 if successfull
+  virtual int WaitCopy(int Slot) = 0;
+  //! Waits for GEMM of the slot to complete, returns 0 if successfull
+  virtual int WaitGemm(int Slot) = 0;
+  //! Fetches duration of completed copy in seconds, returns 0 if successfull
+  virtual int CopyTime(int Slot, double* pSeconds) = 0;
+  //! Fetches duration of completed GEMM in seconds, returns 0 if successfull
+  virtual int GemmTime(int Slot, double* pSeconds) = 0;
+};
+
+/**
+ * @class GemmPipeline
+ * @ingroup RVS
+ *
+ * @brief Overlaps host data preparation and copies with GEMMs
+ *
+ * Slots are used as a ring. Each step() starts the GEMM of the current slot
+ * (its data was copied during the previous step) and then prepares the next
+ * slot: waits for the GEMM that last used it, fills its staging matrices and
+ * starts their copy. The copy and the host fill thus overlap the GEMM just
+ * started, and the compute stream always has a GEMM queued.
+ *
+ * A slot is
+ *  - idle: nothing in flight, may be filled,
+ *  - copying: copy started, GEMM not yet,
+ *  - computing: GEMM started, staging and device matrices in use.
+ *
+ */
+class GemmPipeline {
+ public:
+  GemmPipeline(GemmRuntime* pRuntime, int Slots);
+
+  int start();
+  int step();
+  int finish();
+  void reset_stats();
+
+  //! Returns number of slots
+  int slots() const { return num_slots; }
+  //! Returns number of completed copies
+  uint64_t copies() const { return stat_copies; }
+  //! Returns number of completed GEMMs
+  uint64_t gemms() const { return stat_gemms; }
+  //! Returns total duration of completed copies in seconds
+  double copy_time() const { return stat_copy_time; }
+  //! Returns total duration of completed GEMMs in seconds
+  double gemm_time() const { return stat_gemm_time; }
+
+ protected:
+  int prepare(int Slot);
+  int retire(int Slot);
+
+ protected:
+  //! slot states
+  enum { SLOT_IDLE, SLOT_COPYING, SLOT_COMPUTING };
+
+  //! GPU runtime
+  GemmRuntime* runtime;
+  //! number of slots
+  int num_slots;
+  //! slot holding the data of the next GEMM
+  int current;
+  //! state of each slot
+  std::vector<int> state;
+  //! number of completed copies
+  uint64_t stat_copies;
+  //! number of completed GEMMs
+  uint64_t stat_gemms;
+  //! total duration of completed copies in seconds
+  double stat_copy_time;
+  //! total duration of completed GEMMs in seconds
+  double stat_gemm_time;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSGEMMPIPE_H_
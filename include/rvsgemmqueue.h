@@ -0,0 +1,117 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSGEMMQUEUE_H_
+#define INCLUDE_RVSGEMMQUEUE_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace rvs {
+
+/**
+ * @class GemmQueueRuntime
+ * @ingroup RVS
+ *
+ * @brief Interface to GPU runtime driven by GemmQueue
+ *
+ * Each stream has its own BLAS handle and device matrices, so GEMMs on
+ * different streams may run concurrently. Each queue slot owns an event
+ * recorded behind the GEMM last launched through it. Implemented by
+ * rvs_blas on top of HIP, unit tests use a simulated runtime.
+ *
+ */
+class GemmQueueRuntime {
+ public:
+  virtual ~GemmQueueRuntime() {}
+
+  //! Enqueues GEMM on stream and records event of the slot behind it,
+  //! returns 0 if successfull
+  virtual int QueueGemm(int Stream, int Slot) = 0;
+  //! Waits for the event of the slot, returns 0 if successfull
+  virtual int WaitQueued(int Slot) = 0;
+};
+
+/**
+ * @class GemmQueue
+ * @ingroup RVS
+ *
+ * @brief Keeps a given number of GEMMs in flight across several streams
+ *
+ * Slots are used as a ring, GEMMs are assigned to streams round robin.
+ * submit() launches GEMMs as long as there is a free slot and otherwise
+ * waits for the oldest GEMM in flight, so the GPU always has work queued
+ * and host launch latency is hidden behind the running GEMMs.
+ *
+ * Depth is at least the number of streams, so that every stream has a
+ * GEMM in flight.
+ *
+ */
+class GemmQueue {
+ public:
+  GemmQueue(GemmQueueRuntime* pRuntime, int Streams, int Depth);
+
+  int submit(int Count);
+  int drain();
+  void reset_stats();
+
+  //! Returns number of streams
+  int streams() const { return num_streams; }
+  //! Returns maximum number of GEMMs in flight
+  int depth() const { return num_slots; }
+  //! Returns number of GEMMs currently in flight
+  int in_flight() const { return pending; }
+  //! Returns number of launched GEMMs
+  uint64_t submitted() const { return stat_submitted; }
+  //! Returns number of completed GEMMs
+  uint64_t completed() const { return stat_completed; }
+
+ protected:
+  int retire(int Slot);
+
+ protected:
+  //! GPU runtime
+  GemmQueueRuntime* runtime;
+  //! number of streams
+  int num_streams;
+  //! number of slots (queue depth)
+  int num_slots;
+  //! slot the next GEMM is launched through
+  int next_slot;
+  //! stream the next GEMM is launched on
+  int next_stream;
+  //! number of GEMMs in flight
+  int pending;
+  //! TRUE for each slot with a GEMM in flight
+  std::vector<bool> busy;
+  //! number of launched GEMMs
+  uint64_t stat_submitted;
+  //! number of completed GEMMs
+  uint64_t stat_completed;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSGEMMQUEUE_H_
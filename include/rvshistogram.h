@@ -0,0 +1,130 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSHISTOGRAM_H_
+#define INCLUDE_RVSHISTOGRAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+//! number of bits used to select sub-bucket (precision of recorded values)
+#define RVS_HIST_SUB_BITS 7
+//! number of bits in largest recorded value (larger values are clamped)
+#define RVS_HIST_VALUE_BITS 40
+//! total number of buckets in a histogram
+#define RVS_HIST_BUCKETS \
+  ((1 << RVS_HIST_SUB_BITS) + \
+  (RVS_HIST_VALUE_BITS - RVS_HIST_SUB_BITS) * (1 << (RVS_HIST_SUB_BITS - 1)))
+
+namespace rvs {
+
+/**
+ * @class Histogram
+ * @ingroup RVS
+ *
+ * @brief Log-bucketed (HDR style) histogram of integer values
+ *
+ * Values below 2^RVS_HIST_SUB_BITS are counted exactly. Every power of two
+ * above that is split into 2^(RVS_HIST_SUB_BITS-1) linear sub-buckets, so
+ * reported values are within 1% of recorded ones over the whole range.
+ * Values are meant to be nanoseconds; anything above 2^RVS_HIST_VALUE_BITS
+ * (about 18 minutes) is counted in the last bucket.
+ *
+ * Class is not thread safe. Use AtomicHistogram to record from a thread
+ * which must not block.
+ *
+ */
+class Histogram {
+ public:
+  Histogram();
+
+  void record(uint64_t Value, uint64_t Count = 1);
+  void merge(const Histogram& Other);
+  void reset();
+  //! Returns number of recorded values
+  uint64_t count() const { return total; }
+  //! Returns smallest recorded value (0 if histogram is empty)
+  uint64_t min() const { return total ? vmin : 0; }
+  //! Returns largest recorded value (0 if histogram is empty)
+  uint64_t max() const { return vmax; }
+  uint64_t percentile(double P) const;
+
+  static size_t bucket_index(uint64_t Value);
+  static uint64_t bucket_low(size_t Index);
+  static uint64_t bucket_high(size_t Index);
+
+ protected:
+  //! number of values per bucket
+  std::vector<uint64_t> counts;
+  //! total number of values
+  uint64_t total;
+  //! smallest recorded value
+  uint64_t vmin;
+  //! largest recorded value
+  uint64_t vmax;
+
+  friend class AtomicHistogram;
+};
+
+/**
+ * @class AtomicHistogram
+ * @ingroup RVS
+ *
+ * @brief Lock-free recorder for Histogram
+ *
+ * record() may be called from one or more threads while another thread
+ * periodically moves recorded values into a Histogram by calling drain().
+ * Neither side ever blocks. Values recorded during drain() end up either in
+ * this or in the next drained histogram, but are never lost or counted
+ * twice.
+ *
+ */
+class AtomicHistogram {
+ public:
+  AtomicHistogram();
+
+  void record(uint64_t Value);
+  void drain(Histogram* pHist);
+
+ protected:
+  //! number of values per bucket
+  std::atomic<uint64_t> counts[RVS_HIST_BUCKETS];
+  //! smallest value recorded since last drain()
+  std::atomic<uint64_t> vmin;
+  //! largest value recorded since last drain()
+  std::atomic<uint64_t> vmax;
+};
+
+//! Histograms keyed by transfer size
+typedef std::map<size_t, Histogram> HistogramMap;
+
+void merge(const HistogramMap& Src, HistogramMap* pDst);
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSHISTOGRAM_H_
@@ -0,0 +1,159 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSHOSTALLOC_H_
+#define INCLUDE_RVSHOSTALLOC_H_
+
+#include <stddef.h>
+
+#include <mutex>
+#include <string>
+
+//! 2 MiB huge page
+#define RVS_HOSTALLOC_PAGE_2M (2UL * 1024 * 1024)
+//! 1 GiB huge page
+#define RVS_HOSTALLOC_PAGE_1G (1024UL * 1024 * 1024)
+
+namespace rvs {
+
+/**
+ * @class HostBuffer
+ * @ingroup RVS
+ *
+ * @brief Host buffer mapped by HostAllocator
+ *
+ */
+struct HostBuffer {
+  //! host address (nullptr if not allocated)
+  void* ptr;
+  //! requested size in bytes
+  size_t size;
+  //! size of mapping (size rounded up to page size)
+  size_t map_size;
+  //! page size requested
+  size_t page_req;
+  //! page size backing the buffer
+  size_t page_size;
+  //! 'true' if huge pages were requested but kernel may or may not back
+  //! the buffer with transparent huge pages
+  bool transparent;
+  //! address used by devices (same as ptr if not pinned)
+  void* dev_ptr;
+  //! 'true' if buffer is pinned
+  bool pinned;
+  //! time spent pinning the buffer in seconds
+  double pin_time;
+};
+
+/**
+ * @class HostPinner
+ * @ingroup RVS
+ *
+ * @brief Interface pinning host memory for device access
+ *
+ * Implemented on top of HSA memory locking and HIP host registration, unit
+ * tests use a fake pinner.
+ *
+ */
+class HostPinner {
+ public:
+  virtual ~HostPinner() {}
+
+/**
+ * @brief Pins host memory
+ *
+ * @param Ptr host address
+ * @param Size size in bytes
+ * @param Peer implementation defined device the memory is pinned for
+ * @param pDevPtr [out] address to be used by the device
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+  virtual int  Pin(void* Ptr, size_t Size, int Peer, void** pDevPtr) = 0;
+  //! Unpins memory pinned by Pin()
+  virtual void Unpin(void* Ptr) = 0;
+};
+
+/**
+ * @class HostAllocator
+ * @ingroup RVS
+ *
+ * @brief Allocates host buffers backed by huge pages and pins them
+ *
+ * Explicit huge pages (hugetlbfs) of the requested size are tried first,
+ * then smaller explicit huge pages and finally regular pages with
+ * transparent huge pages requested. Number of buffers, pages obtained and
+ * time spent pinning are accumulated for reporting.
+ *
+ */
+class HostAllocator {
+ public:
+  explicit HostAllocator(HostPinner* pPinner = nullptr);
+  virtual ~HostAllocator() {}
+
+  int  allocate(size_t Size, size_t Page, int Peer, HostBuffer* pBuff);
+  void release(HostBuffer* pBuff);
+
+  //! Returns number of buffers allocated since last reset
+  size_t buffers() const { return stat_buffers; }
+  //! Returns number of bytes allocated since last reset
+  size_t bytes() const { return stat_bytes; }
+  //! Returns smallest page size obtained since last reset (0 - none)
+  size_t min_page() const { return stat_min_page; }
+  //! Returns number of buffers backed by smaller pages than requested
+  size_t fallbacks() const { return stat_fallbacks; }
+  //! Returns total time spent pinning in seconds
+  double pin_time() const { return stat_pin_time; }
+  //! Returns longest time spent pinning one buffer in seconds
+  double pin_time_max() const { return stat_pin_max; }
+  void reset_stats();
+
+  static int  map(size_t Size, size_t Page, HostBuffer* pBuff);
+  static void unmap(HostBuffer* pBuff);
+  static size_t base_page();
+  static int  parse_page(const std::string& Name, size_t* pPage);
+  static std::string page_name(size_t Page);
+
+ protected:
+  //! pins buffers, nullptr - buffers are not pinned
+  HostPinner* pinner;
+  //! protects statistics
+  std::mutex mtx;
+  //! number of buffers allocated
+  size_t stat_buffers;
+  //! number of bytes allocated
+  size_t stat_bytes;
+  //! smallest page size obtained
+  size_t stat_min_page;
+  //! number of buffers backed by smaller pages than requested
+  size_t stat_fallbacks;
+  //! total pinning time in seconds
+  double stat_pin_time;
+  //! longest pinning time in seconds
+  double stat_pin_max;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSHOSTALLOC_H_
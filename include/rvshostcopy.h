@@ -0,0 +1,113 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSHOSTCOPY_H_
+#define INCLUDE_RVSHOSTCOPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "include/rvshostalloc.h"
+
+//! copy with memcpy()
+#define RVS_HOSTCOPY_MEMCPY 0
+//! copy with non-temporal (streaming) stores, bypassing cache
+#define RVS_HOSTCOPY_STREAM 1
+
+//! default buffer size in bytes
+#define RVS_HOSTCOPY_SIZE (64 * 1024 * 1024)
+//! huge page size requested when huge pages are used
+#define RVS_HOSTCOPY_HUGEPAGE RVS_HOSTALLOC_PAGE_2M
+
+namespace rvs {
+
+/**
+ * @class HostCopy
+ * @ingroup RVS
+ *
+ * @brief Host to host memory bandwidth between two NUMA nodes
+ *
+ * Source buffer is first touched by a thread running on source node CPUs and
+ * destination buffer by a thread running on destination node CPUs so that
+ * with default kernel memory policy the pages reside on those nodes. Copies
+ * are then done by threads pinned one per CPU of the copy node, each copying
+ * its own slice of the buffers until time runs out.
+ *
+ * No GPU is involved, so the result is a baseline for host memory side of
+ * GPU transfers.
+ *
+ */
+class HostCopy {
+ public:
+  HostCopy();
+  virtual ~HostCopy();
+
+  int  initialize(const std::vector<int>& SrcCpus,
+                  const std::vector<int>& DstCpus,
+                  const std::vector<int>& CopyCpus,
+                  size_t Size, int Threads, bool HugePage);
+  void release();
+  int  run(int Method, double Seconds, uint64_t* pBytes, double* pDuration);
+
+  //! Returns buffer size in bytes
+  size_t size() const { return buff_size; }
+  //! Returns number of copy threads
+  int threads() const { return num_threads; }
+  //! Returns page size backing the buffers
+  size_t page_size() const { return buff_page; }
+
+  static void copy(int Method, void* pDst, const void* pSrc, size_t Size);
+  static void copy_stream(void* pDst, const void* pSrc, size_t Size);
+  static int  parse_method(const std::string& Name);
+  static const char* method_name(int Method);
+
+ protected:
+  static int   touch(void* pBuff, size_t Size, uint8_t Value,
+                     const std::vector<int>& Cpus);
+
+ protected:
+  //! source buffer
+  uint8_t* src_buff;
+  //! destination buffer
+  uint8_t* dst_buff;
+  //! size of buffers in bytes
+  size_t buff_size;
+  //! source mapping
+  HostBuffer src_host;
+  //! destination mapping
+  HostBuffer dst_host;
+  //! page size backing the buffers
+  size_t buff_page;
+  //! CPUs copy threads run on
+  std::vector<int> copy_cpus;
+  //! number of copy threads
+  int num_threads;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSHOSTCOPY_H_
@@ -33,6 +33,8 @@
 #include <cctype>
 #include <sstream>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <iomanip>
@@ -40,6 +42,13 @@
 #include "hsa/hsa.h"
 #include "hsa/hsa_ext_amd.h"
 
+#include "include/rvscollective.h"
+#include "include/rvscopypipe.h"
+#include "include/rvshostalloc.h"
+#include "include/rvshsapool.h"
+#include "include/rvshistogram.h"
+#include "include/rvstopology.h"
+
 using std::string;
 using std::vector;
 
@@ -52,21 +61,28 @@ using std::vector;
 
 namespace rvs {
 
+class hsa;
+
 /**
- * @class linkinfo_s
+ * @class HsaHostPinner
  * @ingroup RVS
  *
- * @brief Utility class used to store HSA agent information
+ * @brief HostPinner locking host memory for one HSA agent
+ *
+ * Peer passed to Pin() is the agent index in agent_list of rvs::hsa.
  *
  */
-typedef struct linkinfo_s {
-  //! NUMA distance of this hop
-  uint32_t distance;
-  //! link type of this hop (as string)
-  std::string strtype;
-  //! link type of this hop
-  hsa_amd_link_info_type_t etype;
-} linkinfo_t;
+class HsaHostPinner : public HostPinner {
+ public:
+  explicit HsaHostPinner(hsa* pWrapper) : pHsa(pWrapper) {}
+
+  int  Pin(void* Ptr, size_t Size, int Peer, void** pDevPtr) override;
+  void Unpin(void* Ptr) override;
+
+ protected:
+  //! RVS HSA wrapper owning agent list
+  hsa* pHsa;
+};
 
 /**
  * @class hsa
@@ -74,8 +90,12 @@ typedef struct linkinfo_s {
  *
  * @brief Wrapper class for HSA functionality needed for rvs tests
  *
+ * Buffers and signals used by SendTraffic() are cached in a TransferPool
+ * and released on Terminate(). Peer access and link information for all
+ * pairs of agents is fetched once in InitAgents() and kept in a Topology.
+ *
  */
-class hsa {
+class hsa : public TransferAllocator {
  public:
   //! Default constructor
   hsa();
@@ -153,10 +173,19 @@ class hsa {
   int Allocate(int SrcAgent, int DstAgent, size_t Size,
                      hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
                      hsa_amd_memory_pool_t* pDstPool, void** DstBuff);
+  int AllocateShared(int Agent, const std::vector<int>& Peers, size_t Size,
+                     void** pBuff, hsa_amd_memory_pool_t* pPool = nullptr);
+  int SetHostPage(size_t Page);
+  //! Returns page size of host transfer buffers (0 - system memory pool)
+  size_t GetHostPage() const { return host_page; }
+  //! Returns allocator of host transfer buffers, holds pinning statistics
+  HostAllocator& GetHostAllocator() { return host_alloc; }
 
   int SendTraffic(uint32_t SrcNode, uint32_t DstNode,
                   size_t   Size,    bool     bidirectional,
-                  double*  Duration);
+                  double*  Duration, int     QueueDepth = 1);
+  int SendPingPong(uint32_t SrcNode, uint32_t DstNode, size_t Size,
+                   int Rounds, Histogram* pOneWay, Histogram* pRoundTrip);
 
   int GetPeerStatus(uint32_t SrcNode, uint32_t DstNode);
   int GetPeerStatusAgent(const AgentInformation& SrcAgent,
@@ -166,6 +195,12 @@ class hsa {
   double GetCopyTime(bool bidirectional,
                      hsa_signal_t signal_fwd, hsa_signal_t signal_rev);
 
+  int  AllocateBuffers(int SrcAgent, int DstAgent, size_t Size,
+                       void** pSrcBuff, void** pDstBuff) override;
+  void FreeBuffer(void* Buff) override;
+  int  CreateSignal(uint64_t* pSignal) override;
+  void DestroySignal(uint64_t Signal) override;
+
   static void print_hsa_status(const char* message, hsa_status_t st);
   static void print_hsa_status(const char* file, int line,
                                const char* function, hsa_status_t st);
@@ -178,16 +213,123 @@ class hsa {
                               int LinkType);
 
   void PrintTopology();
+  //! Returns all-pairs connection matrix built in InitAgents()
+  const Topology& GetTopology() const { return topology; }
 
  protected:
   void InitAgents();
+  void InitTopology();
+  int  QueryLinkInfo(int SrcIx, int DstIx,
+                     uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr);
 
   static hsa_status_t ProcessAgent(hsa_agent_t agent, void* data);
   static hsa_status_t ProcessMemPool(hsa_amd_memory_pool_t pool, void* data);
 
+  int  AllocateHost(int SrcAgent, int DstAgent, size_t Size,
+                    hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
+                    hsa_amd_memory_pool_t* pDstPool, void** DstBuff);
+
  protected:
   //! pointer to RVS HSA singleton
   static rvs::hsa* pDsc;
+  //! buffers and signals reused by SendTraffic()
+  TransferPool transfer_pool;
+  //! peer access and links between all pairs of agents
+  Topology topology;
+  //! page size of host transfer buffers (0 - system memory pool)
+  size_t host_page;
+  //! locks host transfer buffers for GPU agents
+  HsaHostPinner host_pinner;
+  //! allocates host transfer buffers when host_page is set
+  HostAllocator host_alloc;
+  //! host transfer buffers by address used in copies
+  std::map<void*, HostBuffer> host_buffers;
+  //! protects host_buffers
+  std::mutex host_mtx;
+
+  friend class HsaHostPinner;
+  friend class HsaCopyEngine;
+  friend class HsaCollectiveEngine;
+};
+
+/**
+ * @class HsaCopyEngine
+ * @ingroup RVS
+ *
+ * @brief CopyEngine performing HSA async copies between two agents
+ *
+ * Forward direction copies from source to destination agent, reverse
+ * direction the other way around. Each slot has its own buffers and signal
+ * taken from the transfer pool of rvs::hsa and given back on release().
+ *
+ */
+class HsaCopyEngine : public CopyEngine {
+ public:
+  explicit HsaCopyEngine(hsa* pWrapper);
+  virtual ~HsaCopyEngine();
+
+  int  initialize(int SrcAgent, int DstAgent, bool Fwd, bool Rev,
+                  size_t Size, int Depth);
+  void release();
+  //! Returns number of enabled directions
+  int  directions() const { return static_cast<int>(slots.size()); }
+
+  int Submit(int Dir, int Slot, size_t Size) override;
+  int SubmitAfter(int Dir, int Slot, size_t Size,
+                  int DepDir, int DepSlot) override;
+  int Wait(int Dir, int Slot) override;
+  int CopyTime(int Dir, int Slot, uint64_t* pStart, uint64_t* pEnd) override;
+
+ protected:
+  //! RVS HSA wrapper owning transfer pool
+  hsa* pHsa;
+  //! per direction: source agent index in agent_list
+  std::vector<int> src_agent;
+  //! per direction: destination agent index in agent_list
+  std::vector<int> dst_agent;
+  //! per direction: buffers and signal of every slot
+  std::vector<std::vector<TransferPool::Entry*>> slots;
+};
+
+/**
+ * @class HsaCollectiveEngine
+ * @ingroup RVS
+ *
+ * @brief CollectiveEngine performing HSA async copies between ranks
+ *
+ * Each rank gets one buffer in its own memory, accessible by all other
+ * ranks. Every copy of the schedule has its own signal, so dependencies
+ * are passed to HSA and chunks are forwarded without host involvement.
+ * Buffers and signals are kept until release() and reused as long as
+ * later schedules fit in them.
+ *
+ */
+class HsaCollectiveEngine : public CollectiveEngine {
+ public:
+  explicit HsaCollectiveEngine(hsa* pWrapper);
+  virtual ~HsaCollectiveEngine();
+
+  int  initialize(const std::vector<uint32_t>& Nodes, size_t Size,
+                  size_t Steps);
+  void release();
+
+  int Submit(size_t Index, const CollectiveStep& Step) override;
+  int Wait(size_t Index) override;
+  int CopyTime(size_t Index, uint64_t* pStart, uint64_t* pEnd) override;
+
+ protected:
+  //! RVS HSA wrapper
+  hsa* pHsa;
+  //! NUMA nodes of ranks
+  std::vector<uint32_t> nodes;
+  //! per rank: agent index in agent_list
+  std::vector<int> agents;
+  //! per rank: buffer
+  std::vector<void*> buffers;
+  //! size of every buffer
+  size_t buffer_size;
+  //! per copy: completion signal
+  std::vector<uint64_t> signals;
 };
 
 }  // namespace rvs
@@ -0,0 +1,147 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSHSAPOOL_H_
+#define INCLUDE_RVSHSAPOOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <list>
+#include <mutex>
+
+//! default limit of bytes kept in idle transfer pool entries (1 GB)
+#define RVS_TRANSFER_POOL_MAX (1024ul * 1024 * 1024)
+
+namespace rvs {
+
+/**
+ * @class TransferAllocator
+ * @ingroup RVS
+ *
+ * @brief Interface providing transfer buffers and signals to TransferPool
+ *
+ * Implemented by rvs::hsa on top of HSA memory pools and signals. Unit
+ * tests implement it with a fake allocator.
+ *
+ */
+class TransferAllocator {
+ public:
+  virtual ~TransferAllocator() {}
+
+/**
+ * @brief Allocates buffers for transfer between two agents
+ *
+ * Buffers are accessible by both agents when this method returns.
+ *
+ * @param SrcAgent source agent index
+ * @param DstAgent destination agent index
+ * @param Size size of each buffer in bytes
+ * @param pSrcBuff [out] source buffer
+ * @param pDstBuff [out] destination buffer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+  virtual int  AllocateBuffers(int SrcAgent, int DstAgent, size_t Size,
+                               void** pSrcBuff, void** pDstBuff) = 0;
+  //! Releases buffer obtained through AllocateBuffers()
+  virtual void FreeBuffer(void* Buff) = 0;
+  //! Creates completion signal, returns 0 if successfull
+  virtual int  CreateSignal(uint64_t* pSignal) = 0;
+  //! Destroys signal obtained through CreateSignal()
+  virtual void DestroySignal(uint64_t Signal) = 0;
+};
+
+/**
+ * @class TransferPool
+ * @ingroup RVS
+ *
+ * @brief Cache of transfer buffer pairs and signals
+ *
+ * Entries are keyed by source agent, destination agent and size class
+ * (size rounded up to a power of two) and are reused across transfers, so
+ * allocation and access setup happen only on the first transfer of a given
+ * kind. An entry is used by one transfer at a time. When idle entries hold
+ * more than the given number of bytes, the biggest ones are released first
+ * as allocation cost matters least for big transfers.
+ *
+ */
+class TransferPool {
+ public:
+  //! Cached buffer pair and signal
+  struct Entry {
+    //! source agent index
+    int       src_agent;
+    //! destination agent index
+    int       dst_agent;
+    //! size class this entry belongs to
+    size_t    size_class;
+    //! size of each buffer in bytes
+    size_t    size;
+    //! source buffer
+    void*     src_buff;
+    //! destination buffer
+    void*     dst_buff;
+    //! completion signal handle
+    uint64_t  signal;
+    //! 'true' while entry is acquired by a transfer
+    bool      in_use;
+  };
+
+  explicit TransferPool(TransferAllocator* pAllocator,
+                        size_t MaxBytes = RVS_TRANSFER_POOL_MAX);
+  ~TransferPool();
+
+  Entry* acquire(int SrcAgent, int DstAgent, size_t Size);
+  void release(Entry* pEntry);
+  void clear();
+
+  size_t entries();
+  size_t cached_bytes();
+
+  static size_t size_class(size_t Size);
+
+ protected:
+  void destroy(std::list<Entry>::iterator it);
+  void trim();
+
+  //! provides buffers and signals
+  TransferAllocator* allocator;
+  //! limit of bytes kept in idle entries
+  size_t max_bytes;
+  //! bytes held in all entries (both buffers)
+  size_t total_bytes;
+  //! cached entries (list keeps entry addresses stable)
+  std::list<Entry> pool;
+  //! protects pool
+  std::mutex pool_mutex;
+
+ private:
+  TransferPool(const TransferPool&) = delete;
+  TransferPool& operator=(const TransferPool&) = delete;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSHSAPOOL_H_
@@ -46,6 +46,7 @@ typedef void  (*t_cbAddNode)(void* Parent, void* Child);
 typedef void  (*t_cbStop)(uint16_t flags);
 typedef bool  (*t_cbStopping)(void);
 typedef int   (*t_rvs_module_err)(const char*, const char*, const char*);
+typedef int   (*t_cbLogLevel)(void);
 
 
 /**
@@ -74,6 +75,8 @@ typedef struct tag_module_init {
   t_cbStopping         cbStopping;
   //! pointer to rvs::logger::Err() function
   t_rvs_module_err     cbErr;
+  //! pointer to rvs::logger::log_level() function
+  t_cbLogLevel         cbLogLevel;
 } T_MODULE_INIT;
 
 #ifdef __cplusplus
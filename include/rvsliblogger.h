@@ -25,9 +25,18 @@
 #ifndef INCLUDE_RVSLIBLOGGER_H_
 #define INCLUDE_RVSLIBLOGGER_H_
 
+#include <stdint.h>
+
+#include <chrono>
 #include <string>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <atomic>
 #include "include/rvsliblog.h"
+#include "include/rvslogbinary.h"
 
 
 namespace rvs {
@@ -43,6 +52,7 @@ namespace rvs {
 class logger {
  public:
   static  void  log_level(const int level);
+  static  int   log_level();
 
   static  void  to_json(const bool flag);
   static  bool  to_json();
@@ -50,15 +60,32 @@ class logger {
   static  void  append(const bool flag);
   static  bool  append();
 
+  static  void  buffered(const bool flag);
+  static  bool  buffered();
+
+  static  void  ndjson(const bool flag);
+  static  bool  ndjson();
+
+  static  void  binary(const bool flag);
+  static  bool  binary();
+
+  static  void  rotate_size(const uint64_t bytes);
+  static  void  rotate_time(const uint32_t secs);
+  static  void  rotate_compress(const bool flag);
+
   //! set quiet mode
   static  void  quiet() { b_quiet = true; }
   //! set logging file
   static  void  set_log_file(const std::string& fname);
 
   static  bool   get_ticks(uint32_t* psecs, uint32_t* pusecs);
+  static  void   FormatRow(std::string* pRow, const char* Message,
+                           const int LogLevel, const uint32_t secs,
+                           const uint32_t usecs);
 
   static  int    init_log_file();
   static  int    terminate();
+  static  void   flush();
 
   static  int    log(const std::string& Message, const int level = 1);
   static  int    Log(const char* Message, const int level);
@@ -80,6 +107,21 @@ class logger {
 
  protected:
   static  int    ToFile(const std::string& Row);
+  static  int    ToFileDirect(const std::string& Row);
+  static  int    StartWriter();
+  static  void   StopWriter();
+  static  void   WriterThread();
+  static  int    OutputRow(const char* Message, const int LogLevel,
+                           const uint32_t secs, const uint32_t usecs);
+  static  void   StartMerge();
+  static  void   StopMerge();
+  static  void   MergeThread();
+  static  void   CheckRotate();
+  static  void   Rotate();
+  static  int    Compress(const std::string& File);
+  static  void   StartCompressor();
+  static  void   StopCompressor();
+  static  void   CompressorThread();
 
   //! Current logging level (0..5)
   static  int    loglevel_m;
@@ -103,6 +145,72 @@ class logger {
   static char log_file[1024];
   //! quiet mode
   static bool b_quiet;
+  //! persistent log file stream used by the writer thread
+  static std::ofstream log_stream;
+  //! rows waiting to be written by the writer thread
+  static std::deque<std::string> log_queue;
+  //! Mutex to synchronize access to log_queue
+  static std::mutex queue_mutex;
+  //! signals writer thread that rows are pending or stop is requested
+  static std::condition_variable queue_cv;
+  //! signals waiters in flush() that the queue has been written out
+  static std::condition_variable drained_cv;
+  //! background writer thread
+  static std::thread writer_thread;
+  //! 'true' while writer thread is accepting rows
+  static bool writer_running;
+  //! 'true' when writer thread is requested to drain and exit
+  static bool writer_stop;
+  //! 'true' while writer thread is writing a batch taken from log_queue
+  static bool writer_busy;
+  //! Mutex to serialize writer start/stop
+  static std::mutex writer_mutex;
+  //! output buffer reused for JSON records
+  static std::string json_buf;
+  //! 'true' if per-thread ring buffered logging is requested
+  static bool buffered_m;
+  //! 'true' if JSON records are output one per line (NDJSON)
+  static bool ndjson_m;
+  //! 'true' if log file is written in binary format
+  static bool binary_m;
+  //! binary log encoder (protected by log_mutex)
+  static LogBinaryWriter bin_writer;
+  //! thread merging per-thread log rings
+  static std::thread merge_thread;
+  //! 'true' while merge thread is accepting messages
+  static std::atomic<bool> merge_running;
+  //! number of threads currently handing messages over to merge thread
+  static std::atomic<int> merge_producers;
+  //! 'true' when merge thread is requested to drain and exit
+  static bool merge_stop;
+  //! Mutex to synchronize merge thread start/stop
+  static std::mutex merge_mutex;
+  //! wakes up merge thread
+  static std::condition_variable merge_cv;
+  //! log file segment size triggering rotation (0 - no size limit)
+  static uint64_t rotate_size_m;
+  //! log file segment age in seconds triggering rotation (0 - no limit)
+  static uint32_t rotate_time_m;
+  //! 'true' if rotated segments are compressed
+  static bool rotate_compress_m;
+  //! bytes written to current segment
+  static uint64_t segment_bytes;
+  //! rows and records written to current segment
+  static uint64_t segment_rows;
+  //! time current segment was started
+  static std::chrono::steady_clock::time_point segment_start;
+  //! number of the last rotated segment
+  static int segment_index;
+  //! thread compressing rotated segments
+  static std::thread compress_thread;
+  //! rotated segments waiting for compression
+  static std::deque<std::string> compress_queue;
+  //! Mutex to synchronize access to compress_queue
+  static std::mutex compress_mutex;
+  //! wakes up compression thread
+  static std::condition_variable compress_cv;
+  //! 'true' when compression thread is requested to drain and exit
+  static bool compress_stop;
 };
 
 }  // namespace rvs
@@ -0,0 +1,111 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSLINKMAP_H_
+#define INCLUDE_RVSLINKMAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/rvstopology.h"
+
+//! PCIe link type (same as HSA_AMD_LINK_INFO_TYPE_PCIE)
+#define RVS_LINK_TYPE_PCIE 2
+//! xGMI link type (same as HSA_AMD_LINK_INFO_TYPE_XGMI)
+#define RVS_LINK_TYPE_XGMI 4
+
+namespace rvs {
+
+/**
+ * @class LinkMap
+ * @ingroup RVS
+ *
+ * @brief Physical links used by a set of transfers
+ *
+ * HSA reports only type and distance of each hop, not which link carries
+ * it, so links are modelled from hop types:
+ * - xGMI hop: dedicated link from source to destination GPU (one per
+ *   direction, links are full duplex),
+ * - PCIe hop: upstream PCIe link of the source and downstream PCIe link of
+ *   the destination GPU,
+ * - any other hop (HyperTransport, QPI...): one fabric link of that type
+ *   shared by all transfers crossing it.
+ *
+ * Two transfers contend if they have a link in common.
+ *
+ */
+class LinkMap {
+ public:
+  size_t add(uint32_t SrcNode, uint32_t DstNode,
+             const std::vector<linkinfo_t>& Path);
+  void   add_path(size_t Transfer, uint32_t SrcNode, uint32_t DstNode,
+                  const std::vector<linkinfo_t>& Path);
+  void   clear();
+
+  //! Returns number of transfers
+  size_t size() const { return transfer_links.size(); }
+  //! Returns number of distinct links
+  size_t link_count() const { return link_names.size(); }
+  //! Returns links used by a transfer
+  const std::vector<size_t>& links(size_t Transfer) const {
+    return transfer_links[Transfer];
+  }
+  //! Returns source NUMA node of a transfer
+  uint32_t src(size_t Transfer) const { return transfer_src[Transfer]; }
+  //! Returns destination NUMA node of a transfer
+  uint32_t dst(size_t Transfer) const { return transfer_dst[Transfer]; }
+  //! Returns transfers using a link
+  const std::vector<size_t>& users(size_t Link) const {
+    return link_users[Link];
+  }
+  //! Returns descriptive name of a link
+  const std::string& name(size_t Link) const { return link_names[Link]; }
+  bool disjoint(size_t TransferA, size_t TransferB) const;
+
+  static void path_links(uint32_t SrcNode, uint32_t DstNode,
+                         const std::vector<linkinfo_t>& Path,
+                         std::vector<std::string>* pNames);
+
+ protected:
+  //! link name -> link index
+  std::map<std::string, size_t> link_index;
+  //! link names (by link index)
+  std::vector<std::string> link_names;
+  //! per transfer: sorted indexes of used links
+  std::vector<std::vector<size_t>> transfer_links;
+  //! per transfer: source NUMA node
+  std::vector<uint32_t> transfer_src;
+  //! per transfer: destination NUMA node
+  std::vector<uint32_t> transfer_dst;
+  //! per link: transfers using it
+  std::vector<std::vector<size_t>> link_users;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSLINKMAP_H_
@@ -0,0 +1,70 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSLINKSCHED_H_
+#define INCLUDE_RVSLINKSCHED_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "include/rvslinkmap.h"
+
+//! number of pseudo-random orders tried by LinkScheduler::schedule()
+#define RVS_LINKSCHED_SHUFFLES 16
+
+namespace rvs {
+
+/**
+ * @class LinkScheduler
+ * @ingroup RVS
+ *
+ * @brief Groups transfers into rounds of link-disjoint transfers
+ *
+ * Transfers of one round share no link (see rvs::LinkMap), so running them
+ * at the same time gives the same bandwidth as running each alone. This is
+ * an edge coloring of the graph whose vertices are links and whose edges
+ * are transfers; rounds are colors.
+ *
+ * Coloring is greedy: transfers are placed one by one into the first round
+ * where none of their links is used yet, trying several orders. No
+ * schedule can have fewer rounds than the number of transfers using the
+ * most loaded link (see lower_bound()); search stops once that is reached.
+ * Transfers with no known link are placed into rounds of their own.
+ *
+ */
+class LinkScheduler {
+ public:
+  static size_t schedule(const LinkMap& Map,
+                         std::vector<std::vector<size_t>>* pRounds);
+  static size_t lower_bound(const LinkMap& Map);
+
+ protected:
+  static size_t first_fit(const LinkMap& Map, const std::vector<size_t>& Order,
+                          std::vector<std::vector<size_t>>* pRounds);
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSLINKSCHED_H_
@@ -0,0 +1,144 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSLOGARENA_H_
+#define INCLUDE_RVSLOGARENA_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <new>
+
+namespace rvs {
+
+/**
+ * @class LogArena
+ * @ingroup Launcher
+ *
+ * @brief Bump allocator backing JSON log record trees
+ *
+ * Nodes, their strings and child lists of one log record are carved out of
+ * arena blocks. The whole tree is released at once by reset(). Blocks are
+ * kept across reset() so a recycled arena normally does not allocate.
+ *
+ */
+class LogArena {
+ public:
+  explicit LogArena(size_t BlockSize = 4096);
+  ~LogArena();
+
+  void* allocate(size_t Size, size_t Align = alignof(max_align_t));
+  const char* copy(const char* Str);
+  void reset();
+  size_t blocks() const;
+
+  static LogArena* acquire();
+  static void release(LogArena* pArena);
+  static uint64_t block_allocations();
+
+ protected:
+  //! Arena block header, block data follows the header
+  struct Block {
+    //! next block in chain
+    Block* next;
+    //! size of data area in bytes
+    size_t size;
+  };
+
+  bool next_block(size_t Size, size_t Align);
+
+  //! default size of block data area
+  size_t block_size;
+  //! first block in chain
+  Block* first;
+  //! block currently being carved
+  Block* current;
+  //! next free byte in current block
+  char* ptr;
+  //! end of current block data
+  char* end;
+  //! total number of blocks allocated by all arenas
+  static std::atomic<uint64_t> num_block_alloc;
+
+ private:
+  LogArena(const LogArena&) = delete;
+  LogArena& operator=(const LogArena&) = delete;
+};
+
+/**
+ * @class LogArenaAllocator
+ * @ingroup Launcher
+ *
+ * @brief STL allocator drawing from LogArena
+ *
+ * Falls back to the global heap when no arena is given.
+ *
+ */
+template<class T>
+class LogArenaAllocator {
+ public:
+  //! allocated type
+  typedef T value_type;
+
+  //! Constructor
+  explicit LogArenaAllocator(LogArena* pArena = nullptr) : arena(pArena) {
+  }
+  //! Converting constructor
+  template<class U>
+  LogArenaAllocator(const LogArenaAllocator<U>& rOther)  // NOLINT
+  : arena(rOther.arena) {
+  }
+
+  //! Allocates storage for N objects
+  T* allocate(size_t N) {
+    if (arena) {
+      return static_cast<T*>(arena->allocate(N * sizeof(T), alignof(T)));
+    }
+    return static_cast<T*>(::operator new(N * sizeof(T)));
+  }
+  //! Releases storage (no-op for arena storage)
+  void deallocate(T* p, size_t) {
+    if (!arena) {
+      ::operator delete(p);
+    }
+  }
+
+  //! backing arena, nullptr for global heap
+  LogArena* arena;
+};
+
+template<class T, class U>
+bool operator==(const LogArenaAllocator<T>& a, const LogArenaAllocator<U>& b) {
+  return a.arena == b.arena;
+}
+
+template<class T, class U>
+bool operator!=(const LogArenaAllocator<T>& a, const LogArenaAllocator<U>& b) {
+  return a.arena != b.arena;
+}
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSLOGARENA_H_
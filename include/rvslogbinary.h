@@ -0,0 +1,157 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSLOGBINARY_H_
+#define INCLUDE_RVSLOGBINARY_H_
+
+#include <stdint.h>
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//! Binary log session header
+#define RVSBINMAGIC "RVSB\x01"
+//! Binary log session header length
+#define RVSBINMAGICLEN 5
+
+namespace rvs {
+
+class LogNode;
+
+/**
+ * @brief Binary log element tags
+ */
+typedef enum eLB {
+  BinText      = 1,  //!< text row: level, time, token count, tokens
+  BinRecord    = 2,  //!< JSON record: level, time, children, end
+  BinNode      = 3,  //!< list node: name, children, end
+  BinString    = 4,  //!< string node: key, value
+  BinInt       = 5,  //!< integer node: key, zig-zag value
+  BinEnd       = 6   //!< end of record or list node
+} T_LBTAG;
+
+/**
+ * @brief Kind of string, stored in two low bits of its first varint
+ */
+typedef enum eLBS {
+  BinRef       = 0,  //!< index into string table
+  BinInline    = 1,  //!< length and bytes
+  BinNumber    = 2,  //!< decimal number: digit counts, sign and mantissa
+  BinDefine    = 3   //!< length and bytes, string is added to the table
+} T_LBSTR;
+
+/**
+ * @class LogBinaryWriter
+ * @ingroup Launcher
+ *
+ * @brief Encodes log output into compact binary form
+ *
+ * Integers are stored as LEB128 varints, seconds as delta to the
+ * previous element. Text rows are stored as space separated tokens.
+ * Keys, node names and strings seen more than once are stored once per
+ * session in a string table and then referenced by index, decimal numbers
+ * are stored as integers.
+ *
+ */
+class LogBinaryWriter {
+ public:
+  LogBinaryWriter();
+
+  void reset();
+  void clear() { buf.clear(); }
+  //! Encoded data
+  const std::string& data() const { return buf; }
+
+  void header();
+  void text(const int Level, const uint32_t Sec, const uint32_t uSec,
+            const char* Msg);
+  void record(const int Level, const uint32_t Sec, const uint32_t uSec);
+  void node(const char* Name);
+  void end();
+  void add_string(const char* Key, const char* Val);
+  void add_int(const char* Key, const int Val);
+
+  static void put_varint(std::string* pOut, uint64_t Val);
+
+ protected:
+  void put_time(const uint32_t Sec, const uint32_t uSec);
+  void put_string(const char* Str, size_t Len, bool Intern);
+  bool put_number(const char* Str, size_t Len);
+
+ protected:
+  //! Output buffer
+  std::string buf;
+  //! String table of the current session
+  std::unordered_map<std::string, uint32_t> strings;
+  //! Strings seen once, added to the table when seen again
+  std::unordered_set<std::string> seen;
+  //! Seconds of the last element
+  uint32_t last_sec;
+};
+
+/**
+ * @class LogBinaryReader
+ * @ingroup Launcher
+ *
+ * @brief Converts binary log into text or JSON log
+ *
+ * Output is the same as rvs writes to the log file without (text) or with
+ * "-j" option (JSON). An incomplete element at the end of the input (log
+ * still being written) is ignored.
+ *
+ */
+class LogBinaryReader {
+ public:
+  static int ToText(std::istream& In, std::ostream& Out, int* pCount);
+  static int ToJson(std::istream& In, std::ostream& Out, int* pCount);
+
+ protected:
+  explicit LogBinaryReader(const std::string& Data);
+
+  int  convert(bool Json, std::ostream& Out, int* pCount);
+  bool get_varint(uint64_t* pVal);
+  bool get_string(std::string* pStr);
+  bool get_time(uint32_t* pSec, uint32_t* pUSec);
+  int  get_children(LogNode* pParent);
+
+ protected:
+  //! Input data
+  const std::string& in;
+  //! Read position
+  size_t pos;
+  //! Set when input is malformed
+  bool bad;
+  //! String table of the current session
+  std::vector<std::string> strings;
+  //! Seconds of the last element
+  uint32_t last_sec;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSLOGBINARY_H_
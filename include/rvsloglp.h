@@ -26,24 +26,28 @@
 #define INCLUDE_RVSLOGLP_H_
 
 #include <string>
+#include <type_traits>
 
 #include "include/rvsliblog.h"
 
 #define RVSDEBUG_(ATTR, VAL) \
-{std::string msg = std::string(__FILE__)+"   "+__func__+":" \
+{if (rvs::lp::Enabled(rvs::logdebug)) { \
+std::string msg = std::string(__FILE__)+"   "+__func__+":" \
 +std::to_string(__LINE__) + "\n" + std::string(ATTR) + ": " + \
 std::string(VAL); \
 rvs::lp::Log(msg, rvs::logdebug); \
-}
+}}
 
 #ifdef RVS_DO_TRACE
-  #define RVSTRACE_ rvs::lp::Log(std::string(__FILE__)+"   "+__func__+":"\
-  +std::to_string(__LINE__), rvs::logtrace);
-  #define RVSDEBUG(x, y) rvs::lp::Log(std::string(__FILE__)+"   "\
+  #define RVSTRACE_ {if (rvs::lp::Enabled(rvs::logtrace)) { \
+  rvs::lp::Log(std::string(__FILE__)+"   "+__func__+":"\
+  +std::to_string(__LINE__), rvs::logtrace); }}
+  #define RVSDEBUG(x, y) {if (rvs::lp::Enabled(rvs::logdebug)) { \
+  rvs::lp::Log(std::string(__FILE__)+"   "\
   +__func__+":" + std::to_string(__LINE__)\
   + "   attr: " + std::string(x) \
   + "  val: " + std::string(y) \
-  , rvs::logdebug);
+  , rvs::logdebug); }}
 #else
   #define RVSTRACE_
   #define RVSDEBUG(x, y)
@@ -83,6 +87,82 @@ class lp {
   static int   Err(const std::string &Msg, const std::string &Module);
   static int   Err(const std::string &Msg, const std::string &Module,
                    const std::string &Action);
+  static int   LogLevel();
+
+  //! Returns true if messages of the given level reach the log
+  static bool  Enabled(const int level) { return level <= LogLevel(); }
+
+/**
+ * @brief Output log message formatted only if level is enabled
+ *
+ * Arguments are concatenated into the message (numbers as per
+ * std::to_string()) after the level check, so filtered out messages
+ * cost a single level query.
+ *
+ * @param level Logging level
+ * @param args Message parts
+ * @return 0 - success or filtered out, non-zero otherwise
+ *
+ */
+  template <typename... Args>
+  static int LogLazy(const int level, const Args&... args) {
+    if (!Enabled(level)) {
+      return 0;
+    }
+    std::string msg;
+    Format(&msg, args...);
+    return Log(msg, level);
+  }
+
+/**
+ * @brief Output timestamped log message formatted only if level is enabled
+ *
+ * @param level Logging level
+ * @param Sec seconds from system start
+ * @param uSec microseconds within current second
+ * @param args Message parts
+ * @return 0 - success or filtered out, non-zero otherwise
+ *
+ */
+  template <typename... Args>
+  static int LogLazyExt(const int level, const unsigned int Sec,
+                        const unsigned int uSec, const Args&... args) {
+    if (!Enabled(level)) {
+      return 0;
+    }
+    std::string msg;
+    Format(&msg, args...);
+    return Log(msg, level, Sec, uSec);
+  }
+
+ protected:
+  //! Appends string part of a message
+  static void Append(std::string* pOut, const std::string& Val) {
+    pOut->append(Val);
+  }
+  //! Appends C string part of a message
+  static void Append(std::string* pOut, const char* Val) {
+    pOut->append(Val);
+  }
+  //! Appends single character part of a message
+  static void Append(std::string* pOut, const char Val) {
+    pOut->push_back(Val);
+  }
+  //! Appends numeric part of a message
+  template <typename T, typename std::enable_if<
+            std::is_arithmetic<T>::value, int>::type = 0>
+  static void Append(std::string* pOut, const T Val) {
+    pOut->append(std::to_string(Val));
+  }
+
+  //! Terminates Format() recursion
+  static void Format(std::string*) {}
+  //! Appends message parts one by one
+  template <typename T, typename... Args>
+  static void Format(std::string* pOut, const T& Val, const Args&... args) {
+    Append(pOut, Val);
+    Format(pOut, args...);
+  }
 
  protected:
   //! Module init structure passed through Initialize() method
@@ -0,0 +1,53 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSLOGNDJSON_H_
+#define INCLUDE_RVSLOGNDJSON_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace rvs {
+
+/**
+ * @class LogNdjson
+ * @ingroup Launcher
+ *
+ * @brief Converts NDJSON log files into JSON array log files
+ *
+ * NDJSON logs hold one JSON record per line. Conversion produces the same
+ * content rvs writes when run with "-j" alone.
+ *
+ */
+class LogNdjson {
+ public:
+  static int  ToArray(std::istream& In, std::ostream& Out, int* pCount);
+  static bool Reindent(const std::string& Line, const std::string& Lead,
+                       std::string* pOut);
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSLOGNDJSON_H_
@@ -44,17 +44,20 @@ namespace rvs {
  */
 class LogNode : public LogNodeBase {
  public:
-  explicit LogNode(const char* Name, const LogNodeBase* Parent = nullptr);
+  explicit LogNode(const char* Name, const LogNodeBase* Parent = nullptr,
+                   LogArena* pArena = nullptr);
   virtual ~LogNode();
 
-  virtual std::string ToJson(const std::string& Lead = "");
+  virtual void WriteJson(std::string* pOut, const std::string& Lead,
+                         const int Depth);
+  virtual void WriteBinary(LogBinaryWriter* pOut);
 
  public:
   void Add(LogNodeBase* spChild);
 
  public:
   //! list of child nodes
-  std::vector<LogNodeBase*> Child;
+  std::vector<LogNodeBase*, LogArenaAllocator<LogNodeBase*>> Child;
 };
 
 }  // namespace rvs
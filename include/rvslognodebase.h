@@ -25,13 +25,21 @@
 #ifndef INCLUDE_RVSLOGNODEBASE_H_
 #define INCLUDE_RVSLOGNODEBASE_H_
 
+#include <stddef.h>
+
 #include <string>
 
+#include "include/rvslogarena.h"
+
 #define RVSENDL "\n"
 #define RVSINDENT "  "
+//! Depth requesting single line JSON output (no line breaks, no indentation)
+#define RVSJSONLINE -1
 
 namespace rvs {
 
+class LogBinaryWriter;
+
 typedef enum eLN {
   Unknown = 0,
   List    = 1,
@@ -51,29 +59,80 @@ class LogNodeBase {
  public:
   virtual ~LogNodeBase();
 
+  std::string ToJson(const std::string& Lead = "");
+
 /**
- * @brief Provides JSON representation of Node
+ * @brief Appends JSON representation of Node to output buffer
  *
- * Converts node into proper string representation.
+ * Converts node into proper string representation in a single pass
+ * without building intermediate strings.
  * This method has to be implemented in every derived class.
  *
- * @param Lead String of blanks " " representing current indentation
- * @return Node as JSON string
+ * @param pOut Output buffer JSON is appended to
+ * @param Lead String representing base indentation
+ * @param Depth Nesting level, adds RVSINDENT per level to Lead
+ * (RVSJSONLINE for single line output)
  *
  */
-  virtual std::string ToJson(const std::string& Lead = "") = 0;
+  virtual void WriteJson(std::string* pOut, const std::string& Lead,
+                         const int Depth) = 0;
+
+/**
+ * @brief Appends binary representation of Node to binary log writer
+ *
+ * This method has to be implemented in every derived class.
+ *
+ * @param pOut Binary log writer
+ *
+ */
+  virtual void WriteBinary(LogBinaryWriter* pOut) = 0;
+
+  //! Returns arena node is allocated from (nullptr for heap nodes)
+  LogArena* Arena() const { return arena; }
+
+  static void Destroy(LogNodeBase* pNode);
+
+  //! Allocates node on the heap
+  static void* operator new(size_t Size) { return ::operator new(Size); }
+  //! Allocates node from arena (from the heap if pArena is nullptr)
+  static void* operator new(size_t Size, LogArena* pArena) {
+    return pArena ? pArena->allocate(Size) : ::operator new(Size);
+  }
+  //! Releases heap node
+  static void operator delete(void* p) { ::operator delete(p); }
+  //! Releases node if constructor throws
+  static void operator delete(void* p, LogArena* pArena) {
+    if (!pArena) ::operator delete(p);
+  }
 
  protected:
   explicit LogNodeBase(const char* rName,
-                       const LogNodeBase* pParent = nullptr);
+                       const LogNodeBase* pParent = nullptr,
+                       LogArena* pArena = nullptr);
+
+  const char* CopyString(const char* Str);
+  void FreeString(const char* Str);
+
+  static void NewLine(std::string* pOut, const std::string& Lead,
+                      const int Depth);
+  //! Returns depth of child nodes (RVSJSONLINE is kept for all levels)
+  static int  Nested(const int Depth) {
+    return Depth < 0 ? Depth : Depth + 1;
+  }
 
  protected:
+  //! Arena this node and its strings are allocated from
+  LogArena*      arena;
   //! Node name
-  std::string     Name;
+  const char*    Name;
   //! Parent node
   const LogNodeBase*   Parent;
   //! Node type
   T_LNTYPE       Type;
+
+ private:
+  LogNodeBase(const LogNodeBase&) = delete;
+  LogNodeBase& operator=(const LogNodeBase&) = delete;
 };
 
 
@@ -46,7 +46,9 @@ class LogNodeInt : public LogNodeBase {
 
   virtual ~LogNodeInt();
 
-  virtual std::string ToJson(const std::string& Lead = "");
+  virtual void WriteJson(std::string* pOut, const std::string& Lead,
+                         const int Depth);
+  virtual void WriteBinary(LogBinaryWriter* pOut);
 
  protected:
   //! Node value
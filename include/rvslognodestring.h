@@ -45,11 +45,13 @@ class LogNodeString : public LogNodeBase {
 
   virtual ~LogNodeString();
 
-  virtual std::string ToJson(const std::string& Lead = "");
+  virtual void WriteJson(std::string* pOut, const std::string& Lead,
+                         const int Depth);
+  virtual void WriteBinary(LogBinaryWriter* pOut);
 
  protected:
   //! Node value
-  std::string Value;
+  const char* Value;
 };
 
 }  // namespace rvs
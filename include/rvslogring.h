@@ -0,0 +1,113 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSLOGRING_H_
+#define INCLUDE_RVSLOGRING_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rvs {
+
+/**
+ * @brief Log message with its timestamp and logging level
+ */
+struct LogRingRecord {
+  //! seconds from system start
+  uint32_t sec;
+  //! microseconds in current second
+  uint32_t usec;
+  //! logging level
+  int level;
+  //! message text
+  std::string msg;
+};
+
+/**
+ * @class LogRing
+ * @ingroup Launcher
+ *
+ * @brief Single-producer single-consumer ring buffer of log messages
+ *
+ * Producer (the logging thread) and consumer (logger merge thread)
+ * synchronize only through head and tail indexes, no locks are taken.
+ *
+ */
+class LogRing {
+ public:
+  explicit LogRing(size_t Capacity = 4096);
+
+  bool push(uint32_t Sec, uint32_t uSec, int Level, const char* Msg);
+  bool pop(LogRingRecord* pRec);
+  bool front_ts(uint64_t* pTs) const;
+  size_t size() const;
+  size_t capacity() const;
+
+  void close();
+  bool closed() const;
+
+ protected:
+  //! record slots
+  std::vector<LogRingRecord> slot;
+  //! capacity - 1 (capacity is power of 2)
+  size_t mask;
+  //! next slot to be written by producer
+  std::atomic<size_t> head;
+  //! next slot to be read by consumer
+  std::atomic<size_t> tail;
+  //! 'true' when owning thread has exited
+  std::atomic<bool> bclosed;
+};
+
+/**
+ * @class LogRingSet
+ * @ingroup Launcher
+ *
+ * @brief Registry of per-thread log rings
+ *
+ * Each logging thread gets its own ring on first use. Consumer drains
+ * all rings at once and merges records in timestamp order.
+ *
+ */
+class LogRingSet {
+ public:
+  static LogRing* local();
+  static size_t drain(std::vector<LogRingRecord>* pOut);
+  static size_t count();
+
+ protected:
+  //! registered rings
+  static std::vector<std::shared_ptr<LogRing>> rings;
+  //! Mutex to synchronize ring registration and draining
+  static std::mutex rings_mutex;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSLOGRING_H_
@@ -0,0 +1,107 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSMATGEN_H_
+#define INCLUDE_RVSMATGEN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! plain C++ loop
+#define RVS_MATGEN_SCALAR 0
+//! 8 lanes, AVX2 + F16C
+#define RVS_MATGEN_AVX2 1
+//! 16 lanes, AVX-512F
+#define RVS_MATGEN_AVX512 2
+
+//! minimum number of elements given to one thread
+#define RVS_MATGEN_MIN_CHUNK (1024 * 1024)
+
+namespace rvs {
+
+/**
+ * @class MatrixGen
+ * @ingroup RVS
+ *
+ * @brief Counter based generator of GEMM input matrices
+ *
+ * Element i of stream s is a hash of (seed, s, i), so any part of a matrix
+ * can be produced independently of the others. The matrix is split into
+ * chunks filled in parallel, each chunk with the widest SIMD path the CPU
+ * supports. Output depends only on the seed and stream, never on the number
+ * of threads or the SIMD path taken.
+ *
+ * float and double values are uniform in [0, scale). Half values are
+ * multiples of 2^-11 in [0, 1), which are exact in IEEE binary16.
+ *
+ */
+class MatrixGen {
+ public:
+  explicit MatrixGen(uint64_t Seed = 0, int Threads = 0);
+
+  //! Sets seed of all streams
+  void set_seed(uint64_t Seed) { seed = Seed; }
+  //! Returns seed of all streams
+  uint64_t get_seed() const { return seed; }
+  //! Sets upper bound of float/double values
+  void set_scale(double Scale) { scale = Scale; }
+  //! Returns upper bound of float/double values
+  double get_scale() const { return scale; }
+  void set_threads(int Threads);
+  //! Returns maximum number of threads used
+  int threads() const { return num_threads; }
+  void set_simd(int Level);
+  //! Returns SIMD path in use (one of RVS_MATGEN_*)
+  int simd() const { return simd_level; }
+
+  void generate(float* pData, size_t Count, uint32_t Stream) const;
+  void generate(double* pData, size_t Count, uint32_t Stream) const;
+  void generate_half(uint16_t* pData, size_t Count, uint32_t Stream) const;
+
+  static uint32_t hash(uint32_t Key, uint32_t Index);
+  static uint32_t key(uint64_t Seed, uint32_t Stream, uint32_t Block);
+  static uint16_t half_bits(uint32_t Hash);
+  static int  simd_supported();
+  static const char* simd_name(int Level);
+
+ protected:
+  template <typename T>
+  void run(T* pData, size_t Count, uint32_t Stream, int Type) const;
+  void fill(void* pData, int Type, uint64_t First, size_t Count,
+            uint32_t Stream) const;
+
+ protected:
+  //! seed shared by all streams
+  uint64_t seed;
+  //! upper bound of float/double values
+  double scale;
+  //! maximum number of threads
+  int num_threads;
+  //! SIMD path (one of RVS_MATGEN_*)
+  int simd_level;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSMATGEN_H_
@@ -0,0 +1,122 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSNUMA_H_
+#define INCLUDE_RVSNUMA_H_
+
+#include <sched.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+//! host buffers on every NUMA node (one transfer per CPU agent)
+#define RVS_NUMA_PLACEMENT_ALL    0
+//! host buffers on the NUMA node the GPU is attached to
+#define RVS_NUMA_PLACEMENT_LOCAL  1
+//! host buffers on the nearest NUMA node the GPU is not attached to
+#define RVS_NUMA_PLACEMENT_REMOTE 2
+
+//! default sysfs mount point
+#define RVS_NUMA_SYSFS_ROOT "/sys"
+
+namespace rvs {
+
+/**
+ * @class NumaTopology
+ * @ingroup RVS
+ *
+ * @brief NUMA nodes, their CPUs and NUMA nodes of KFD agents
+ *
+ * Read from sysfs:
+ * - devices/system/node/node<N>/cpulist and distance for NUMA nodes,
+ * - class/kfd/kfd/topology/nodes/<K>/properties for KFD (HSA) agents. CPU
+ *   agents are listed by KFD in NUMA node order; NUMA node of a GPU agent
+ *   is the numa_node of its PCI device (bus/pci/devices/<bdf>/numa_node).
+ *
+ * Root of the tree is a parameter so that tests can use a fake one.
+ *
+ */
+class NumaTopology {
+ public:
+  int  load(const std::string& SysRoot = RVS_NUMA_SYSFS_ROOT);
+  void clear();
+
+  //! Returns NUMA nodes in increasing order
+  const std::vector<int>& nodes() const { return numa_nodes; }
+  const std::vector<int>& cpus(int NumaNode) const;
+  int  distance(int From, int To) const;
+  int  kfd_numa(uint32_t KfdNode) const;
+  int  nearest_remote(int NumaNode) const;
+  int  select(int Placement, uint32_t GpuNode,
+              const std::vector<uint32_t>& CpuNodes,
+              std::vector<uint32_t>* pSelected) const;
+
+  static int  pin(const std::vector<int>& Cpus);
+  static int  parse_cpulist(const std::string& List, std::vector<int>* pCpus);
+  static int  parse_placement(const std::string& Name);
+  static const char* placement_name(int Placement);
+  static const char* relation(int HostNuma, int GpuNuma);
+
+ protected:
+  //! NUMA nodes in increasing order
+  std::vector<int> numa_nodes;
+  //! NUMA node -> CPUs
+  std::map<int, std::vector<int>> node_cpus;
+  //! NUMA node -> distances to all nodes (indexed by NUMA node)
+  std::map<int, std::vector<int>> node_distance;
+  //! KFD node -> NUMA node
+  std::map<uint32_t, int> kfd_node_numa;
+};
+
+/**
+ * @class CpuPinGuard
+ * @ingroup RVS
+ *
+ * @brief Pins calling thread to CPUs for the lifetime of the object
+ *
+ * Previous affinity is restored on destruction, so that code running on a
+ * thread it does not own (e.g. the action thread in serial mode) does not
+ * leave it pinned.
+ *
+ */
+class CpuPinGuard {
+ public:
+  explicit CpuPinGuard(const std::vector<int>& Cpus);
+  ~CpuPinGuard();
+
+  //! Returns 'true' if the thread is pinned to the given CPUs
+  bool pinned() const { return bpinned; }
+
+ protected:
+  //! affinity before pinning
+  cpu_set_t saved;
+  //! 'true' if affinity was changed and has to be restored
+  bool bpinned;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSNUMA_H_
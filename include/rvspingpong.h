@@ -0,0 +1,83 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSPINGPONG_H_
+#define INCLUDE_RVSPINGPONG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
+
+#include "include/rvscopypipe.h"
+#include "include/rvshistogram.h"
+
+//! default number of chained round trips per measurement
+#define RVS_PINGPONG_ROUNDS 16
+//! smallest default ping-pong message size
+#define RVS_PINGPONG_MIN_SIZE 4
+//! largest default ping-pong message size
+#define RVS_PINGPONG_MAX_SIZE (64 * 1024)
+
+namespace rvs {
+
+/**
+ * @class PingPong
+ * @ingroup RVS
+ *
+ * @brief Small message latency between two agents
+ *
+ * Copies alternate between forward (direction 0, source to destination)
+ * and reverse (direction 1) direction. Every copy depends on completion of
+ * the previous one through CopyEngine::SubmitAfter(), so one measurement
+ * is a chain of Rounds round trips the host only waits for at the end.
+ * Engine needs Rounds slots in both directions; slot buffers are reused
+ * by every measurement.
+ *
+ * One-way latency is the duration of each copy, round trip latency the
+ * time from start of a forward copy to the end of the reverse copy which
+ * depends on it. Both are recorded in nanoseconds.
+ *
+ */
+class PingPong {
+ public:
+  PingPong(CopyEngine* pEngine, int Rounds = RVS_PINGPONG_ROUNDS);
+
+  int run(size_t Size, Histogram* pOneWay, Histogram* pRoundTrip);
+
+  //! Returns number of round trips per measurement
+  int rounds() const { return chain; }
+
+  static void default_sizes(std::vector<uint32_t>* pSizes);
+
+ protected:
+  //! copy engine
+  CopyEngine* engine;
+  //! number of round trips per measurement
+  int chain;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSPINGPONG_H_
@@ -0,0 +1,130 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSSIZESWEEP_H_
+#define INCLUDE_RVSSIZESWEEP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
+
+//! default relative half-width of 95% confidence interval to converge to
+#define RVS_SWEEP_TOLERANCE 0.05
+//! default minimum number of samples per size
+#define RVS_SWEEP_MIN_SAMPLES 3
+//! default maximum number of samples per size
+#define RVS_SWEEP_MAX_SAMPLES 50
+//! default maximum number of sizes in one sweep
+#define RVS_SWEEP_MAX_POINTS 48
+//! initial sizes are at least this many times apart
+#define RVS_SWEEP_SEED_RATIO 16
+//! sizes are not refined below this ratio of neighbouring sizes
+#define RVS_SWEEP_MIN_RATIO 1.25
+//! bandwidth step (as fraction of peak) that triggers refinement
+#define RVS_SWEEP_REFINE_STEP 0.1
+//! refined sizes are rounded to this many bytes
+#define RVS_SWEEP_ALIGN 64
+
+namespace rvs {
+
+/**
+ * @class SizeSweep
+ * @ingroup RVS
+ *
+ * @brief Adaptive transfer size sweep
+ *
+ * Starts from a coarse subset of configured sizes and measures every size
+ * until the 95% confidence interval of transfer time gets narrower than
+ * the requested tolerance. Once all sizes have settled, new sizes are
+ * inserted between neighbours whose bandwidth differs by more than
+ * RVS_SWEEP_REFINE_STEP (or twice the tolerance, if larger) of peak
+ * bandwidth, which places them around the knee of the bandwidth curve. Sweep is done when no more refinement is
+ * needed.
+ *
+ * Class does not perform transfers itself: caller asks for pending sizes,
+ * measures them and feeds durations back with add().
+ *
+ */
+class SizeSweep {
+ public:
+  //! Measurements of one transfer size
+  struct Point {
+    //! transfer size in bytes
+    size_t   size;
+    //! number of samples
+    uint32_t samples;
+    //! mean duration (seconds)
+    double   mean;
+    //! sum of squared differences from mean (Welford)
+    double   m2;
+    //! 'true' when no more samples are needed
+    bool     settled;
+    //! 'true' if confidence interval is within tolerance
+    bool     converged;
+
+    double ci() const;
+    //! Returns bandwidth in bytes per second
+    double bandwidth() const { return mean > 0 ? size / mean : 0; }
+  };
+
+  SizeSweep();
+
+  void initialize(const std::vector<uint32_t>& Sizes,
+                  double   Tolerance  = RVS_SWEEP_TOLERANCE,
+                  uint32_t MinSamples = RVS_SWEEP_MIN_SAMPLES,
+                  uint32_t MaxSamples = RVS_SWEEP_MAX_SAMPLES,
+                  uint32_t MaxPoints  = RVS_SWEEP_MAX_POINTS);
+  bool pending(std::vector<size_t>* pSizes);
+  void add(size_t Size, double Duration);
+  //! Returns 'true' when sweep has finished
+  bool done() const { return finished; }
+  //! Returns all measured sizes in increasing order
+  const std::vector<Point>& points() const { return pts; }
+
+  static double t_quantile(uint32_t Df);
+
+ protected:
+  bool refine();
+  void settle(Point* pPoint);
+  static Point make_point(size_t Size);
+
+ protected:
+  //! measured sizes sorted by size
+  std::vector<Point> pts;
+  //! relative confidence interval to converge to
+  double   tolerance;
+  //! minimum number of samples per size
+  uint32_t min_samples;
+  //! maximum number of samples per size
+  uint32_t max_samples;
+  //! maximum number of sizes
+  uint32_t max_points;
+  //! 'true' when sweep has finished
+  bool     finished;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSSIZESWEEP_H_
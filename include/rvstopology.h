@@ -0,0 +1,117 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSTOPOLOGY_H_
+#define INCLUDE_RVSTOPOLOGY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//! first line of serialized topology
+#define RVS_TOPOLOGY_MAGIC "RVSTOPOLOGY 1"
+//! upper bound for NUMA node numbers accepted by Topology::deserialize()
+#define RVS_TOPOLOGY_MAX_NODE 4096
+
+namespace rvs {
+
+/**
+ * @class linkinfo_s
+ * @ingroup RVS
+ *
+ * @brief Utility class used to store HSA agent information
+ *
+ */
+typedef struct linkinfo_s {
+  //! NUMA distance of this hop
+  uint32_t distance;
+  //! link type of this hop (as string)
+  std::string strtype;
+  //! link type of this hop (in line with hsa_amd_link_info_type_t)
+  int etype;
+} linkinfo_t;
+
+/**
+ * @class Topology
+ * @ingroup RVS
+ *
+ * @brief Dense all-pairs matrix of connections between agents
+ *
+ * Filled once by rvs::hsa::InitAgents() so that peer and link queries made
+ * while setting up actions don't go back to HSA. Agents are addressed by
+ * their NUMA node; node to index mapping is a direct lookup table.
+ *
+ */
+class Topology {
+ public:
+  //! Connection from one agent to another
+  struct Pair {
+    //! 0 - no access, 1 - Src can access Dst, 2 - both have access
+    int      peer;
+    //! NUMA distance (sum over all hops)
+    uint32_t distance;
+    //! number of hops
+    uint32_t hops;
+    //! hop by hop link information
+    std::vector<linkinfo_t> path;
+  };
+
+  //! "no connection" distance value (same as rvs::hsa::NO_CONN)
+  static const uint32_t NO_CONN = 0xFFFFFFFF;
+
+  Topology();
+
+  void   reset(const std::vector<uint32_t>& Nodes);
+  void   clear();
+  //! Returns number of agents
+  size_t size() const { return nodes.size(); }
+  //! Returns NUMA nodes of all agents (in agent index order)
+  const std::vector<uint32_t>& agents() const { return nodes; }
+  int    index(uint32_t Node) const;
+
+  Pair*       at(uint32_t SrcNode, uint32_t DstNode);
+  const Pair* at(uint32_t SrcNode, uint32_t DstNode) const;
+  //! Returns connection between agents given by index
+  Pair&       pair(size_t SrcIx, size_t DstIx) {
+    return matrix[SrcIx * nodes.size() + DstIx];
+  }
+
+  void serialize(std::ostream& Out) const;
+  int  deserialize(std::istream& In);
+
+ protected:
+  //! NUMA node of every agent
+  std::vector<uint32_t> nodes;
+  //! NUMA node -> agent index (-1 if not present)
+  std::vector<int>      node_index;
+  //! row-major NxN matrix of connections
+  std::vector<Pair>     matrix;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVSTOPOLOGY_H_
@@ -0,0 +1,1205 @@
+/********************************************************************************
+ * 
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+extern "C" {
+  #include <pci/pci.h>
+  #include <linux/pci.h>
+}
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hsa/hsa.h"
+
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvstimer.h"
+
+#include "include/rvs_key_def.h"
+#include "include/rvs_module.h"
+#include "include/worker_b2b.h"
+
+#define MODULE_NAME "pebb"
+#define MODULE_NAME_CAPS "PEBB"
+#define JSON_CREATE_NODE_ERROR "JSON cannot create node"
+
+using std::string;
+using std::vector;
+
+//! Default constructor
+pebb_action::pebb_action() {
+  bjson = false;
+  b2b_block_size = 0;
+  queue_depth = 1;
+  adaptive = false;
+  adaptive_tolerance = RVS_SWEEP_TOLERANCE;
+  host_placement = RVS_NUMA_PLACEMENT_ALL;
+  cpu_pinning = false;
+  host_baseline = false;
+  host_threads = 0;
+  host_page = 0;
+  link_type = -1;
+}
+
+//! Default destructor
+pebb_action::~pebb_action() {
+  property.clear();
+}
+
+/**
+ * @brief reads all PQT related configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pebb_action::get_all_pebb_config_keys(void) {;
+  string msg;
+  int error;
+  bool bsts = true;
+
+  RVSTRACE_
+
+  if (property_get("host_to_device", &prop_h2d, true)) {
+      msg = "invalid 'host_to_device' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  if (property_get("device_to_host", &prop_d2h, true)) {
+      msg = "invalid 'device_to_host' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_uint_list<uint32_t>(RVS_CONF_BLOCK_SIZE_KEY,
+                                   YAML_DEVICE_PROP_DELIMITER,
+                                   &block_size, &b_block_size_all);
+  if (error == 1) {
+      msg = "invalid '" + std::string(RVS_CONF_BLOCK_SIZE_KEY) + "' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  } else if (error == 2) {
+    b_block_size_all = true;
+    block_size.clear();
+  }
+
+  error = property_get_int<uint32_t>
+  (RVS_CONF_B2B_BLOCK_SIZE_KEY, &b2b_block_size);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_B2B_BLOCK_SIZE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_QUEUE_DEPTH_KEY, &queue_depth, 1);
+  if (error == 1 || queue_depth < 1) {
+    msg = "invalid '" + std::string(RVS_CONF_QUEUE_DEPTH_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  if (property_get(RVS_CONF_ADAPTIVE_KEY, &adaptive, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_ADAPTIVE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get(RVS_CONF_ADAPTIVE_TOL_KEY, &adaptive_tolerance,
+                   static_cast<float>(RVS_SWEEP_TOLERANCE)) ||
+      adaptive_tolerance <= 0 || adaptive_tolerance >= 1) {
+    msg = "invalid '" + std::string(RVS_CONF_ADAPTIVE_TOL_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  std::string placement;
+  if (property_get(RVS_CONF_HOST_PLACEMENT_KEY, &placement,
+                   std::string(rvs::NumaTopology::placement_name(
+                     RVS_NUMA_PLACEMENT_ALL))) ||
+      (host_placement = rvs::NumaTopology::parse_placement(placement)) < 0) {
+    msg = "invalid '" + std::string(RVS_CONF_HOST_PLACEMENT_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get(RVS_CONF_CPU_PINNING_KEY, &cpu_pinning, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_CPU_PINNING_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get(RVS_CONF_HOST_BASELINE_KEY, &host_baseline, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_HOST_BASELINE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_HOST_THREADS_KEY, &host_threads, 0);
+  if (error == 1 || host_threads < 0) {
+    msg = "invalid '" + std::string(RVS_CONF_HOST_THREADS_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  std::string page;
+  if (property_get(RVS_CONF_HOST_PAGE_KEY, &page, std::string("pool")) ||
+      (page != "pool" && rvs::HostAllocator::parse_page(page, &host_page))) {
+    msg = "invalid '" + std::string(RVS_CONF_HOST_PAGE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_LINK_TYPE_KEY, &link_type);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_LINK_TYPE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  return bsts;
+}
+
+/**
+ * @brief reads all common configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pebb_action::get_all_common_config_keys(void) {
+  string msg, sdevid, sdev;
+  int error;
+  int sts;
+  RVSTRACE_
+
+  bool bsts = true;
+  // get the action name
+  if (property_get(RVS_CONF_NAME_KEY, &action_name)) {
+    rvs::lp::Err("Action name missing", MODULE_NAME_CAPS);
+    return false;
+  }
+
+  // get <device> property value (a list of gpu id)
+  if ((sts = property_get_device())) {
+    switch (sts) {
+    case 1:
+      msg = "Invalid 'device' key value.";
+      break;
+    case 2:
+      msg = "Missing 'device' key.";
+      break;
+    }
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  // get the <deviceid> property value if provided
+  if (property_get_int<uint16_t>(RVS_CONF_DEVICEID_KEY,
+                                &property_device_id, 0u)) {
+    msg = "Invalid 'deviceid' key value.";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  // get the other action related properties
+  if (property_get(RVS_CONF_PARALLEL_KEY, &property_parallel, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_PARALLEL_KEY) +
+    "' key value";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  error = property_get_int<uint64_t>
+  (RVS_CONF_COUNT_KEY, &property_count, DEFAULT_COUNT);
+  if (error == 1) {
+    msg ="invalid '" + std::string(RVS_CONF_COUNT_KEY) +"' key value";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  error = property_get_int<uint64_t>
+  (RVS_CONF_WAIT_KEY, &property_wait, DEFAULT_WAIT);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_WAIT_KEY) + "' key value";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_DURATION_KEY,
+    &property_duration, DEFAULT_DURATION)) {
+    msg = "Invalid '" + std::string(RVS_CONF_DURATION_KEY) +
+    "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_LOG_INTERVAL_KEY,
+    &property_log_interval, DEFAULT_LOG_INTERVAL)) {
+    msg = "Invalid '" + std::string(RVS_CONF_LOG_INTERVAL_KEY) +
+    "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  return bsts;
+}
+
+/**
+ * @brief Create thread objects based on action description in configuation
+ * file.
+ *
+ * Threads are created but are not started. Execution, one by one of parallel,
+ * depends on "parallel" key in configuration file. Pointers to created objects
+ * are stored in "test_array" member
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::create_threads() {
+  std::string msg;
+  std::vector<uint16_t> gpu_id;
+  std::vector<uint16_t> gpu_device_id;
+  uint16_t transfer_ix = 0;
+  bool bmatch_found = false;
+
+  RVSTRACE_
+  gpu_get_all_gpu_id(&gpu_id);
+  gpu_get_all_device_id(&gpu_device_id);
+
+  // host buffers from system memory pool or mapped with given page size
+  rvs::hsa::Get()->SetHostPage(host_page);
+
+  // NUMA nodes of agents, for host buffer placement and CPU pinning
+  if (numa.load()) {
+    msg = "[" + action_name + "] pebb NUMA topology not available";
+    rvs::lp::Log(msg, rvs::loginfo);
+  }
+  std::vector<uint32_t> cpu_nodes;
+  for (auto it = rvs::hsa::Get()->cpu_list.begin();
+       it != rvs::hsa::Get()->cpu_list.end(); ++it) {
+    cpu_nodes.push_back(it->node);
+  }
+
+  RVSTRACE_
+  for (size_t i = 0; i < gpu_id.size(); i++) {
+    RVSTRACE_
+    if (property_device_id > 0) {
+      RVSTRACE_
+      if (property_device_id != gpu_device_id[i]) {
+        RVSTRACE_
+        continue;
+      }
+    }
+
+    // filter out by listed sources
+    RVSTRACE_
+    if (!property_device_all) {
+      RVSTRACE_
+      const auto it = std::find(property_device.cbegin(),
+                                property_device.cend(),
+                                gpu_id[i]);
+      if (it == property_device.cend()) {
+        RVSTRACE_
+        continue;
+      }
+    }
+
+    uint16_t dstnode;
+    int srcnode;
+
+    RVSTRACE_
+    if (rvs::gpulist::gpu2node(gpu_id[i], &dstnode)) {
+      RVSTRACE_
+      msg = "no node found for destination GPU ID "
+        + std::to_string(gpu_id[i]);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    // CPU agents whose memory is used for host buffers of this GPU
+    std::vector<uint32_t> selected;
+    if (numa.select(host_placement, dstnode, cpu_nodes, &selected)) {
+      msg = "[" + action_name + "] pebb host_placement '"
+          + rvs::NumaTopology::placement_name(host_placement)
+          + "' not possible for GPU " + std::to_string(gpu_id[i])
+          + ", using all NUMA nodes";
+      rvs::lp::Log(msg, rvs::logerror);
+    }
+
+    for (uint cpu_index = 0;
+         cpu_index < rvs::hsa::Get()->cpu_list.size();
+         cpu_index++) {
+      RVSTRACE_
+      srcnode = rvs::hsa::Get()->cpu_list[cpu_index].node;
+      if (std::find(selected.begin(), selected.end(),
+                    static_cast<uint32_t>(srcnode)) == selected.end()) {
+        continue;
+      }
+
+      // get link info regardless of peer status (just in case...)
+      uint32_t distance = 0;
+      bool b_reverse = false;
+
+      std::vector<rvs::linkinfo_t> arr_linkinfo;
+      rvs::hsa::Get()->GetLinkInfo(srcnode, dstnode,
+                                         &distance, &arr_linkinfo);
+      if (distance == rvs::hsa::NO_CONN) {
+        RVSTRACE_
+        rvs::hsa::Get()->GetLinkInfo(dstnode, srcnode,
+                                    &distance, &arr_linkinfo);
+        if (distance != rvs::hsa::NO_CONN) {
+          RVSTRACE_
+          // there is a path if transfer is initiated by
+          // destination agent:
+          b_reverse = true;
+        }
+      }
+
+      // if link type is specified, check that it matches
+      if (!rvs::hsa::check_link_type(arr_linkinfo, link_type))
+        continue;
+
+      bmatch_found = true;
+      transfer_ix += 1;
+
+      print_link_info(srcnode, dstnode, gpu_id[i],
+                      distance, arr_linkinfo, b_reverse);
+
+      // if GPUs are peers, create transaction for them
+      if (rvs::hsa::Get()->GetPeerStatus(srcnode, dstnode)) {
+        RVSTRACE_
+        pebbworker* p = nullptr;
+        if (property_parallel && b2b_block_size > 0) {
+          RVSTRACE_
+          pebbworker_b2b* pb2b = new pebbworker_b2b;
+          if (pb2b == nullptr) {
+            RVSTRACE_
+            msg = "internal error";
+            rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+            return -1;
+          }
+          pb2b->initialize(srcnode, dstnode,
+                           prop_h2d, prop_d2h, b2b_block_size);
+          p = pb2b;
+        } else {
+          RVSTRACE_
+          p = new pebbworker;
+          if (p == nullptr) {
+            RVSTRACE_
+            msg = "internal error";
+            rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+            return -1;
+          }
+          p->initialize(srcnode, dstnode, prop_h2d, prop_d2h);
+          p->set_adaptive(adaptive, adaptive_tolerance);
+        }
+        RVSTRACE_
+        p->set_name(action_name);
+        p->set_stop_name(action_name);
+        p->set_transfer_ix(transfer_ix);
+        p->set_block_sizes(block_size);
+        p->set_queue_depth(queue_depth);
+        p->set_loglevel(property_log_level);
+        int host_numa = numa.kfd_numa(srcnode);
+        std::vector<int> pin_cpus;
+        if (cpu_pinning) {
+          pin_cpus = numa.cpus(host_numa);
+          if (pin_cpus.empty()) {
+            msg = "[" + action_name + "] pebb no CPUs known for node "
+                + std::to_string(srcnode) + ", worker not pinned";
+            rvs::lp::Log(msg, rvs::logerror);
+          }
+        }
+        p->set_placement(host_numa, numa.kfd_numa(dstnode), pin_cpus);
+        test_array.push_back(p);
+      }
+    }
+  }
+
+  RVSTRACE_
+  if (test_array.size() < 1) {
+    std::string diag;
+    if (bmatch_found) {
+      diag = "No peers found";
+    } else {
+      diag = "No devices match criteria from the test configuation";
+    }
+    msg = "[" + action_name + "] pcie-bandwidth  " + diag;
+    rvs::lp::Log(msg, rvs::logerror);
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate("pcie-bandwidth",
+                              action_name.c_str(), rvs::logerror, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson,
+          "message",
+          diag);
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    return -1;
+  }
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->set_transfer_num(test_array.size());
+  }
+
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Delete test thread objects at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::destroy_threads() {
+  RVSTRACE_
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->set_stop_name(action_name);
+    (*it)->stop();
+    delete *it;
+  }
+  return 0;
+}
+
+/**
+ * @brief Collect running average bandwidth data for all the tests and prints
+ * them out.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_running_average() {
+  for (auto it = test_array.begin(); brun && it != test_array.end(); ++it) {
+    print_running_average(*it);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Collect running average for this particular transfer.
+ *
+ * @param pWorker ptr to a pebbworker class
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_running_average(pebbworker* pWorker) {
+  uint16_t    src_node, dst_node;
+  uint16_t    dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[64];
+  double      bandwidth;
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+
+  rvs::HistogramMap hist;
+
+  RVSTRACE_
+  // get running average
+  pWorker->get_running_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, &hist);
+
+  if (duration > 0) {
+    RVSTRACE_
+    bandwidth = current_size/duration/1000/1000/1000;
+    if (bidir) {
+      RVSTRACE_
+      bandwidth *=2;
+    }
+    snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+  } else {
+    RVSTRACE_
+    // no running average in this iteration, try getting total so far
+    // (do not reset final totals as this is just intermediate query)
+    pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, false);
+      RVSTRACE_
+      bandwidth = current_size/duration/1000/1000/1000;
+      if (bidir) {
+        RVSTRACE_
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps (*)", bandwidth);
+  }
+
+//  dst_id = rvs::gpulist::GetGpuIdFromNodeId(dst_node);
+
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(dst_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  RVSTRACE_
+  transfer_ix = pWorker->get_transfer_ix();
+  transfer_num = pWorker->get_transfer_num();
+
+  msg = "[" + action_name + "] pcie-bandwidth  ["
+      + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+      + "] "
+      + std::to_string(src_node) + " " + std::to_string(dst_id)
+      + "  h2d: " + (prop_h2d ? "true" : "false")
+      + "  d2h: " + (prop_d2h ? "true" : "false") + "  "
+      + buff;
+
+  rvs::lp::Log(msg, rvs::loginfo);
+
+  if (bjson) {
+    RVSTRACE_
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::loginfo, sec, usec);
+    if (pjson != NULL) {
+      RVSTRACE_
+      rvs::lp::AddString(pjson,
+                          "transfer_ix", std::to_string(transfer_ix));
+      rvs::lp::AddString(pjson,
+                          "transfer_num", std::to_string(transfer_num));
+      rvs::lp::AddString(pjson, "src", std::to_string(src_node));
+      rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+      rvs::lp::AddString(pjson, "pcie-bandwidth (GBps)", buff);
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  print_latency(pWorker, src_node, dst_id, hist, rvs::loginfo);
+
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Collect bandwidth totals for all the tests and prints
+ * them on cout at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_final_average() {
+  uint16_t    src_node, dst_node;
+  uint16_t    dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  double      bandwidth;
+  char        buff[128];
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+  rvs::HistogramMap hist;
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, true, &hist);
+
+    if (duration) {
+      RVSTRACE_
+      bandwidth = current_size/duration/1000/1000/1000;
+      if (bidir) {
+        RVSTRACE_
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+    } else {
+      RVSTRACE_
+      snprintf( buff, sizeof(buff), "(not measured)");
+    }
+
+    RVSTRACE_
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    RVSTRACE_
+    transfer_ix = (*it)->get_transfer_ix();
+    transfer_num = (*it)->get_transfer_num();
+    std::string placement = rvs::NumaTopology::relation(
+      (*it)->get_host_numa(), (*it)->get_gpu_numa());
+
+    msg = "[" + action_name + "] pcie-bandwidth  ["
+        + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+        + "] "
+        + std::to_string(src_node) + " " + std::to_string(dst_id)
+        + "  h2d: " + (prop_h2d ? "true" : "false")
+        + "  d2h: " + (prop_d2h ? "true" : "false")
+        + "  " + buff
+        + "  duration: " + std::to_string(duration) + " sec"
+        + "  placement: " + placement
+        + "  host numa: " + std::to_string((*it)->get_host_numa())
+        + "  gpu numa: " + std::to_string((*it)->get_gpu_numa())
+        + "  pinned: " + ((*it)->is_pinned() ? "true" : "false");
+
+    rvs::lp::Log(msg, rvs::logresults);
+    if (bjson) {
+      RVSTRACE_
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        RVSTRACE_
+        rvs::lp::AddString(pjson,
+                            "transfer_ix", std::to_string(transfer_ix));
+        rvs::lp::AddString(pjson,
+                            "transfer_num", std::to_string(transfer_num));
+        rvs::lp::AddString(pjson, "src", std::to_string(src_node));
+        rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        rvs::lp::AddString(pjson, "duration (sec)",
+                           std::to_string(duration));
+        rvs::lp::AddString(pjson, "placement", placement);
+        rvs::lp::AddInt(pjson, "host numa", (*it)->get_host_numa());
+        rvs::lp::AddInt(pjson, "gpu numa", (*it)->get_gpu_numa());
+        rvs::lp::AddString(pjson, "pinned",
+                           (*it)->is_pinned() ? "true" : "false");
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    print_latency(*it, src_node, dst_id, hist, rvs::logresults);
+    if ((*it)->is_adaptive()) {
+      print_sweep(*it, src_node, dst_id);
+    }
+    RVSTRACE_
+  }
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Print page size and pinning time of host transfer buffers
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_host_pages() {
+  rvs::HostAllocator& alloc = rvs::hsa::Get()->GetHostAllocator();
+  char buff[128];
+
+  if (host_page == 0) {
+    return 0;
+  }
+
+  std::string page = alloc.min_page() ?
+    rvs::HostAllocator::page_name(alloc.min_page()) : "(none)";
+  snprintf(buff, sizeof(buff), "%.3f ms  max: %.3f ms",
+           alloc.pin_time() * 1000, alloc.pin_time_max() * 1000);
+
+  std::string msg = "[" + action_name + "] pcie-host-pages"
+      + "  requested: " + rvs::HostAllocator::page_name(host_page)
+      + "  page: " + page
+      + "  buffers: " + std::to_string(alloc.buffers())
+      + "  fallback: " + std::to_string(alloc.fallbacks())
+      + "  pin time: " + buff;
+  rvs::lp::Log(msg, rvs::logresults);
+
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "requested page",
+                         rvs::HostAllocator::page_name(host_page));
+      rvs::lp::AddString(pjson, "page", page);
+      rvs::lp::AddInt(pjson, "buffers", alloc.buffers());
+      rvs::lp::AddInt(pjson, "fallback", alloc.fallbacks());
+      rvs::lp::AddString(pjson, "pin time (ms)",
+                         std::to_string(alloc.pin_time() * 1000));
+      rvs::lp::AddString(pjson, "max pin time (ms)",
+                         std::to_string(alloc.pin_time_max() * 1000));
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Check if all adaptive size sweeps have finished
+ *
+ * @return 'true' if adaptive mode is on and every worker has finished
+ * its sweep, 'false' otherwise
+ *
+ * */
+bool pebb_action::sweep_done() {
+  if (!adaptive) {
+    return false;
+  }
+
+  bool bfound = false;
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    if (!(*it)->is_adaptive()) {
+      continue;
+    }
+    bfound = true;
+    if (!(*it)->sweep_done()) {
+      return false;
+    }
+  }
+
+  return bfound;
+}
+
+/**
+ * @brief Print host to host baseline results for one copy variant: one line
+ * per pair of NUMA nodes followed by one matrix row per source node
+ *
+ * @param Nodes NUMA nodes
+ * @param Method copy method (one of RVS_HOSTCOPY_*)
+ * @param HugePage 'true' if huge pages were requested
+ * @param PageSize page size backing buffers
+ * @param Bandwidth bandwidth in GBps per pair (src major, 0 - not measured)
+ * @param Duration duration in seconds per pair
+ * @param Index number of pairs printed before
+ * @param Count total number of pairs
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_host_baseline(const std::vector<int>& Nodes,
+                                     int Method, bool HugePage,
+                                     size_t PageSize,
+                                     const std::vector<double>& Bandwidth,
+                                     const std::vector<double>& Duration,
+                                     int Index, int Count) {
+  std::string msg;
+  char buff[64];
+  std::string variant = std::string("  method: ")
+      + rvs::HostCopy::method_name(Method)
+      + "  hugepage: " + (HugePage ? "true" : "false")
+      + "  page: " + std::to_string(PageSize);
+
+  for (size_t i = 0; i < Bandwidth.size(); i++) {
+    int src = Nodes[i / Nodes.size()];
+    int dst = Nodes[i % Nodes.size()];
+    if (Bandwidth[i] > 0) {
+      snprintf(buff, sizeof(buff), "%.3f GBps", Bandwidth[i]);
+    } else {
+      snprintf(buff, sizeof(buff), "(not measured)");
+    }
+
+    msg = "[" + action_name + "] host-bandwidth  ["
+        + std::to_string(Index + i + 1) + "/" + std::to_string(Count) + "] "
+        + std::to_string(src) + " " + std::to_string(dst)
+        + variant
+        + "  " + buff
+        + "  duration: " + std::to_string(Duration[i]) + " sec";
+    rvs::lp::Log(msg, rvs::logresults);
+
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "transfer_ix", std::to_string(Index + i + 1));
+        rvs::lp::AddString(pjson, "transfer_num", std::to_string(Count));
+        rvs::lp::AddString(pjson, "src numa", std::to_string(src));
+        rvs::lp::AddString(pjson, "dst numa", std::to_string(dst));
+        rvs::lp::AddString(pjson, "method", rvs::HostCopy::method_name(Method));
+        rvs::lp::AddString(pjson, "hugepage", HugePage ? "true" : "false");
+        rvs::lp::AddString(pjson, "page size", std::to_string(PageSize));
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        rvs::lp::AddString(pjson, "duration (sec)",
+                           std::to_string(Duration[i]));
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  // matrix rows: source node followed by bandwidth to every node
+  for (size_t s = 0; s < Nodes.size(); s++) {
+    msg = "[" + action_name + "] host-bandwidth-matrix" + variant
+        + "  " + std::to_string(Nodes[s]) + ":";
+    for (size_t d = 0; d < Nodes.size(); d++) {
+      snprintf(buff, sizeof(buff), " %.3f", Bandwidth[s * Nodes.size() + d]);
+      msg += buff;
+    }
+    rvs::lp::Log(msg, rvs::logresults);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print results of adaptive size sweep for one transfer
+ *
+ * @param pWorker ptr to a pebbworker class
+ * @param SrcId source ID as printed in results
+ * @param DstId destination GPU ID
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_sweep(pebbworker* pWorker, uint16_t SrcId, uint16_t DstId) {
+  uint16_t    src_node, dst_node;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[128];
+
+  // only direction is needed here, totals are left intact
+  pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+
+  std::vector<rvs::SizeSweep::Point> points = pWorker->get_sweep_points();
+  for (auto it = points.begin(); it != points.end(); ++it) {
+    double bandwidth = it->bandwidth() * pWorker->get_queue_depth()
+                     / 1000 / 1000 / 1000;
+    if (bidir) {
+      bandwidth *= 2;
+    }
+    double ci = it->mean > 0 ? 100 * it->ci() / it->mean : 0;
+    if (it->samples < 2) {
+      snprintf(buff, sizeof(buff), "%.3f GBps", bandwidth);
+    } else {
+      snprintf(buff, sizeof(buff), "%.3f GBps +/- %.1f%%", bandwidth, ci);
+    }
+
+    msg = "[" + action_name + "] pcie-bandwidth-sweep  ["
+        + std::to_string(pWorker->get_transfer_ix()) + "/"
+        + std::to_string(pWorker->get_transfer_num()) + "] "
+        + std::to_string(SrcId) + " " + std::to_string(DstId)
+        + "  size: " + std::to_string(it->size)
+        + "  samples: " + std::to_string(it->samples)
+        + "  " + buff
+        + (it->converged ? "" : "  (not converged)");
+    rvs::lp::Log(msg, rvs::logresults);
+
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "transfer_ix",
+                           std::to_string(pWorker->get_transfer_ix()));
+        rvs::lp::AddString(pjson, "transfer_num",
+                           std::to_string(pWorker->get_transfer_num()));
+        rvs::lp::AddString(pjson, "src", std::to_string(SrcId));
+        rvs::lp::AddString(pjson, "dst", std::to_string(DstId));
+        rvs::lp::AddInt(pjson, "size", static_cast<int>(it->size));
+        rvs::lp::AddInt(pjson, "samples", it->samples);
+        snprintf(buff, sizeof(buff), "%.3f", bandwidth);
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        snprintf(buff, sizeof(buff), "%.2f", ci);
+        rvs::lp::AddString(pjson, "ci (%)", buff);
+        rvs::lp::AddString(pjson, "converged",
+                           it->converged ? "true" : "false");
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print transfer time percentiles for one transfer
+ *
+ * Prints one line (and JSON record) per transfer size.
+ *
+ * @param pWorker ptr to a pebbworker class
+ * @param SrcId source ID as printed in results
+ * @param DstId destination GPU ID
+ * @param Hist per size transfer time (nsec) histograms
+ * @param LogLevel logging level
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_latency(pebbworker* pWorker,
+                               uint16_t SrcId, uint16_t DstId,
+                               const rvs::HistogramMap& Hist, int LogLevel) {
+  const double pct[] = {50, 90, 99, 99.9};
+  const char* pct_name[] = {"p50", "p90", "p99", "p99.9"};
+  const size_t pct_num = sizeof(pct) / sizeof(pct[0]);
+  uint16_t    src_node, dst_node;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[128];
+
+  RVSTRACE_
+  // only direction is needed here, totals are left intact
+  pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+
+  for (auto it = Hist.begin(); it != Hist.end(); ++it) {
+    const rvs::Histogram& h = it->second;
+    if (h.count() == 0) {
+      continue;
+    }
+
+    // bytes moved by one measured transfer
+    double bytes = static_cast<double>(it->first)
+                 * pWorker->get_queue_depth() * (bidir ? 2 : 1);
+    uint64_t p50 = h.percentile(50);
+    uint64_t p99 = h.percentile(99);
+    double bw_p50 = p50 > 0 ? bytes / p50 : 0;
+    double bw_p99 = p99 > 0 ? bytes / p99 : 0;
+
+    msg = "[" + action_name + "] pcie-latency  ["
+        + std::to_string(pWorker->get_transfer_ix()) + "/"
+        + std::to_string(pWorker->get_transfer_num()) + "] "
+        + std::to_string(SrcId) + " " + std::to_string(DstId)
+        + "  h2d: " + (prop_h2d ? "true" : "false")
+        + "  d2h: " + (prop_d2h ? "true" : "false")
+        + "  size: " + std::to_string(it->first)
+        + "  samples: " + std::to_string(h.count());
+    for (size_t i = 0; i < pct_num; i++) {
+      snprintf(buff, sizeof(buff), "  %s: %.3f us", pct_name[i],
+               h.percentile(pct[i]) / 1000.0);
+      msg += buff;
+    }
+    snprintf(buff, sizeof(buff),
+             "  max: %.3f us  p50: %.3f GBps  p99: %.3f GBps",
+             h.max() / 1000.0, bw_p50, bw_p99);
+    msg += buff;
+    rvs::lp::Log(msg, LogLevel);
+
+    if (bjson) {
+      RVSTRACE_
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), LogLevel, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "transfer_ix",
+                           std::to_string(pWorker->get_transfer_ix()));
+        rvs::lp::AddString(pjson, "transfer_num",
+                           std::to_string(pWorker->get_transfer_num()));
+        rvs::lp::AddString(pjson, "src", std::to_string(SrcId));
+        rvs::lp::AddString(pjson, "dst", std::to_string(DstId));
+        rvs::lp::AddInt(pjson, "size", static_cast<int>(it->first));
+        rvs::lp::AddString(pjson, "samples", std::to_string(h.count()));
+        for (size_t i = 0; i < pct_num; i++) {
+          snprintf(buff, sizeof(buff), "%.3f", h.percentile(pct[i]) / 1000.0);
+          rvs::lp::AddString(pjson, std::string(pct_name[i]) + " (us)", buff);
+        }
+        snprintf(buff, sizeof(buff), "%.3f", h.max() / 1000.0);
+        rvs::lp::AddString(pjson, "max (us)", buff);
+        snprintf(buff, sizeof(buff), "%.3f", bw_p50);
+        rvs::lp::AddString(pjson, "p50 bandwidth (GBps)", buff);
+        snprintf(buff, sizeof(buff), "%.3f", bw_p99);
+        rvs::lp::AddString(pjson, "p99 bandwidth (GBps)", buff);
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief timer callback used to signal end of test
+ *
+ * timer callback used to signal end of test and to initiate
+ * calculation of final average
+ *
+ * */
+void pebb_action::do_final_average() {
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  rvs::lp::get_ticks(&sec, &usec);
+
+  std::cout << "\n Final average ";
+
+  msg = "[" + action_name + "] pebb in do_final_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "message", "pebb in do_final_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  // signal main thread to stop
+  brun = false;
+
+  // signal worker threads to stop
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->stop();
+  }
+}
+
+/**
+ * @brief timer callback used to signal end of log interval
+ *
+ * timer callback used to signal end of log interval and to initiate
+ * calculation of moving average
+ *
+ * */
+void pebb_action::do_running_average() {
+  unsigned int sec;
+  unsigned int usec;
+  std::string msg;
+
+  if (!brun) {
+    return;
+  }
+
+  rvs::lp::get_ticks(&sec, &usec);
+  msg = "[" + action_name + "] pebb in do_running_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson,
+                         "message",
+                         "in do_running_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+  print_running_average();
+}
+
+/**
+ * @brief Print link information.
+ *
+ * Print link information as list of "hops" between two NUMA nodes.
+ * Each hop is in format \<link_type\>:\<distance\>
+ *
+ * @param SrcNode starting NUMA node
+ * @param DstNode ending NUMA node
+ * @param DstGpuID destination GPU id
+ * @param Distance NUMA distance between the twonodes
+ * @param arrLinkInfo array of hop infos
+ * @param bReverse 'true' if info is for DST to SRC direction
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_link_info(int SrcNode, int DstNode, int DstGpuID,
+                      uint32_t Distance,
+                      const std::vector<rvs::linkinfo_t>& arrLinkInfo,
+                      bool bReverse) {
+  RVSTRACE_
+  std::string msg;
+
+  msg = "[" + action_name + "] pcie-bandwidth "
+      + std::to_string(SrcNode)
+      + " " + std::to_string(DstNode)
+      + " " + std::to_string(DstGpuID);
+  if (Distance == rvs::hsa::NO_CONN) {
+    msg += "  distance:-1";
+  } else {
+    msg += "  distance:" + std::to_string(Distance);
+  }
+  // iterate through individual hops
+  for (auto it = arrLinkInfo.begin(); it != arrLinkInfo.end(); it++) {
+    msg += " " + it->strtype + ":";
+    if (it->distance == rvs::hsa::NO_CONN) {
+      msg += "-1";
+    } else {
+      msg +=std::to_string(it->distance);
+    }
+  }
+  if (bReverse) {
+    msg += " (R)";
+  }
+
+  rvs::lp::Log(msg, rvs::logresults);
+
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      RVSTRACE_
+      rvs::lp::AddString(pjson, "Src", std::to_string(SrcNode));
+      rvs::lp::AddString(pjson, "Dst", std::to_string(DstNode));
+      rvs::lp::AddString(pjson, "GPU", std::to_string(DstGpuID));
+      if (Distance == rvs::hsa::NO_CONN) {
+          rvs::lp::AddInt(pjson, "distance", -1);
+      } else {
+          rvs::lp::AddInt(pjson, "distance", Distance);
+      }
+      if (bReverse) {
+        rvs::lp::AddInt(pjson, "Reverse", 1);
+      } else {
+        rvs::lp::AddInt(pjson, "Reverse", 0);
+      }
+
+      void* phops = rvs::lp::CreateNode(pjson, "hops");
+      rvs::lp::AddNode(pjson, phops);
+
+      // iterate through individual hops
+      for (uint i = 0; i < arrLinkInfo.size(); i++) {
+        char sbuff[64];
+        snprintf(sbuff, sizeof(sbuff), "hop%d", i);
+        void* phop = rvs::lp::CreateNode(phops, sbuff);
+        rvs::lp::AddString(phop, "type", arrLinkInfo[i].strtype);
+        if (arrLinkInfo[i].distance == rvs::hsa::NO_CONN) {
+          rvs::lp::AddInt(phop, "distance", -1);
+        } else {
+          rvs::lp::AddInt(phop, "distance", arrLinkInfo[i].distance);
+        }
+        rvs::lp::AddNode(phops, phop);
+      }
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  return 0;
+}
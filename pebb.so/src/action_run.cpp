@@ -0,0 +1,345 @@
+/********************************************************************************
+ * 
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+extern "C" {
+  #include <pci/pci.h>
+  #include <linux/pci.h>
+}
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "hsa/hsa.h"
+
+#include "include/rvs_key_def.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvstimer.h"
+#include "include/rvsnuma.h"
+#include "include/rvshostcopy.h"
+
+#include "include/rvs_module.h"
+#include "include/worker.h"
+
+#define MODULE_NAME "pebb"
+#define MODULE_NAME_CAPS "PEBB"
+#define JSON_CREATE_NODE_ERROR "JSON cannot create node"
+
+using std::string;
+using std::vector;
+
+uint64_t test_duration;
+
+/**
+ * @brief computes the difference (in milliseconds) between 2 points in time
+ * @param t_end second point in time
+ * @param t_start first point in time
+ * @return time difference in milliseconds
+ */
+uint64_t time_diff(
+                std::chrono::time_point<std::chrono::system_clock> t_end,
+                std::chrono::time_point<std::chrono::system_clock> t_start) {
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            t_end - t_start);
+    return milliseconds.count();
+}
+
+/**
+ * @brief Main action execution entry point. Implements test logic.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::run() {
+  int sts;
+  string msg;
+  std::chrono::time_point<std::chrono::system_clock> pebb_start_time;
+  std::chrono::time_point<std::chrono::system_clock> pebb_end_time;
+
+  RVSTRACE_
+  if (property.find("cli.-j") != property.end()) {
+    bjson = true;
+  }
+
+  if (!get_all_common_config_keys())
+    return -1;
+  if (!get_all_pebb_config_keys())
+    return -1;
+
+  // log_interval must be less than duration
+  if (property_log_interval > 0 && property_duration > 0) {
+    if (property_log_interval > property_duration) {
+      msg = "log_interval must be less than duration";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+  }
+
+  test_duration = property_duration;
+
+  // host to host baseline does not involve GPUs
+  if (host_baseline) {
+    return run_host_baseline();
+  }
+
+  sts = create_threads();
+
+  if (sts != 0) {
+    return sts;
+  }
+
+  // define timers
+  rvs::timer<pebb_action> timer_running(&pebb_action::do_running_average, this);
+  rvs::timer<pebb_action> timer_final(&pebb_action::do_final_average, this);
+
+  unsigned int iter = property_count > 0 ? property_count : 1;
+  unsigned int step = 1;
+  int count = 0;
+
+  do {
+    // let the test run in this iteration
+    brun = true;
+
+    // every iteration sweeps sizes from the beginning
+    for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+      if ((*it)->is_adaptive()) {
+        (*it)->start_sweep();
+      }
+    }
+    count = 0;
+
+    // start timers
+    if (property_duration) {
+      RVSTRACE_
+      timer_final.start(property_duration, true);  // ticks only once
+    }
+
+    if (property_log_interval) {
+      RVSTRACE_
+      timer_running.start(property_log_interval);        // ticks continuously
+    }
+
+    RVSTRACE_
+    pebb_start_time = std::chrono::system_clock::now();
+
+    do {
+      if (property_parallel) {
+        sts = run_parallel();
+      } else {
+        sts = run_single();
+      }
+
+       pebb_end_time = std::chrono::system_clock::now();
+       uint64_t test_time = time_diff(pebb_end_time, pebb_start_time) ;
+       if(test_time >= property_duration) {
+            pebb_action::do_final_average();
+            break;
+        }
+       // adaptive sweep may finish before duration elapses
+       if (sweep_done()) {
+            pebb_action::do_final_average();
+            break;
+        }
+    } while(brun);
+
+    RVSTRACE_
+    timer_running.stop();
+    timer_final.stop();
+
+    std::cout << "\n Iteration value : " << iter;
+    iter -= step;
+
+    // insert wait between runs if needed
+    if (iter > 0 && property_wait > 0) {
+      RVSTRACE_
+      sleep(property_wait);
+    }
+  } while (iter && !rvs::lp::Stopping());
+
+  RVSTRACE_
+  sts = rvs::lp::Stopping() ? -1 : 0;
+
+  print_final_average();
+  print_host_pages();
+
+  destroy_threads();
+
+  // release host buffers mapped for this action
+  rvs::hsa::Get()->SetHostPage(0);
+
+  return sts;
+}
+
+/**
+ * @brief Execute test transfers one by one, in round robin fashion, for the
+ * duration of the action.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::run_single() {
+  RVSTRACE_
+  int sts = 0;
+
+  // iterate through test array and invoke tests one by one
+  for (auto it = test_array.begin(); brun && it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->do_transfer();
+
+    // if log interval is zero, print current results immediately
+    if (property_log_interval == 0) {
+      print_running_average(*it);
+    }
+
+    if (rvs::lp::Stopping()) {
+      RVSTRACE_
+      brun = false;
+      sts = -1;
+      break;
+    }
+  }
+
+  return sts;
+}
+
+/**
+ * @brief Execute test transfers all at once, for the
+ * duration of the action.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::run_parallel() {
+  RVSTRACE_
+
+  // start all worker threads
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->start();
+  }
+
+  // join all worker threads
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->join();
+  }
+
+  return rvs::lp::Stopping() ? -1 : 0;
+}
+
+/**
+ * @brief Measure host to host copy bandwidth between every pair of NUMA
+ * nodes, with and without huge pages, using memcpy() and non-temporal
+ * stores. Copies run on CPUs of the destination node. No GPU is involved.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::run_host_baseline() {
+  std::string msg;
+
+  RVSTRACE_
+  if (numa.load()) {
+    msg = "NUMA topology not available";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  // memory only nodes can not be first touched and are skipped
+  std::vector<int> nodes;
+  for (auto node : numa.nodes()) {
+    if (!numa.cpus(node).empty()) {
+      nodes.push_back(node);
+    }
+  }
+  if (nodes.empty()) {
+    msg = "no NUMA node with CPUs found";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  size_t size = RVS_HOSTCOPY_SIZE;
+  if (b2b_block_size > 0) {
+    size = b2b_block_size;
+  } else if (!block_size.empty()) {
+    size = *std::max_element(block_size.begin(), block_size.end());
+  }
+
+  const int methods[] = {RVS_HOSTCOPY_MEMCPY, RVS_HOSTCOPY_STREAM};
+  const bool pages[] = {false, true};
+  size_t pairs = nodes.size() * nodes.size();
+  int count = static_cast<int>(pairs * 4);
+
+  // duration is split evenly among all measurements
+  double seconds = property_duration / 1000.0 / count;
+
+  int index = 0;
+  for (bool huge : pages) {
+    for (int method : methods) {
+      std::vector<double> bandwidth(pairs, 0);
+      std::vector<double> duration(pairs, 0);
+      size_t page_size = 0;
+
+      for (size_t i = 0; i < pairs; i++) {
+        int src = nodes[i / nodes.size()];
+        int dst = nodes[i % nodes.size()];
+
+        rvs::HostCopy copy;
+        if (copy.initialize(numa.cpus(src), numa.cpus(dst), numa.cpus(dst),
+                            size, host_threads, huge)) {
+          msg = "[" + action_name + "] pebb host copy " + std::to_string(src)
+              + " " + std::to_string(dst) + " could not be set up";
+          rvs::lp::Log(msg, rvs::logerror);
+          continue;
+        }
+        page_size = copy.page_size();
+
+        uint64_t bytes;
+        if (copy.run(method, seconds, &bytes, &duration[i]) == 0 &&
+            duration[i] > 0) {
+          bandwidth[i] = bytes / duration[i] / 1000 / 1000 / 1000;
+        }
+
+        if (rvs::lp::Stopping()) {
+          return -1;
+        }
+      }
+
+      print_host_baseline(nodes, method, huge, page_size,
+                          bandwidth, duration, index, count);
+      index += pairs;
+    }
+  }
+
+  return rvs::lp::Stopping() ? -1 : 0;
+}
@@ -0,0 +1,415 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/worker.h"
+
+#ifdef __cplusplus
+extern "C" {
+  #endif
+  #include <pci/pci.h>
+  #include <linux/pci.h>
+  #ifdef __cplusplus
+}
+#endif
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+#include "include/rvs_module.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvsnuma.h"
+
+#define MODULE_NAME "PEBB"
+
+using std::string;
+using std::vector;
+using std::map;
+
+extern uint64_t time_diff(
+                std::chrono::time_point<std::chrono::system_clock> t_end,
+                std::chrono::time_point<std::chrono::system_clock> t_start);
+extern uint64_t test_duration;
+ 
+pebbworker::pebbworker() {
+  // set to 'true' so that do_transfer() will also work
+  // when parallel: false
+  brun = true;
+  loglevel = rvs::logerror;
+  queue_depth = 1;
+  adaptive = false;
+  adaptive_tolerance = RVS_SWEEP_TOLERANCE;
+  host_numa = -1;
+  gpu_numa = -1;
+  pinned = false;
+}
+pebbworker::~pebbworker() {}
+
+/**
+ * @brief Thread function
+ *
+ * Loops while brun == TRUE and performs polled monitoring avery 1msec.
+ *
+ * */
+void pebbworker::run() {
+  std::chrono::time_point<std::chrono::system_clock> pqt_start_time;
+  std::chrono::time_point<std::chrono::system_clock> pqt_end_time;
+
+  rvs::lp::LogLazy(rvs::logdebug, "[", action_name, "] pebb thread ",
+                   src_node, " ", dst_node, " has started");
+
+  brun = true;
+
+  pqt_start_time = std::chrono::system_clock::now();
+  do{
+    do_transfer();
+
+    pqt_end_time = std::chrono::system_clock::now();
+
+    uint64_t test_time = time_diff(pqt_end_time, pqt_start_time) ;
+
+    if(test_time >= test_duration) {
+        break;
+    }
+    if (sweep_done()) {
+      break;
+    }
+  } while (brun);
+
+  rvs::lp::LogLazy(rvs::logdebug, "[", action_name, "] pebb thread ",
+                   src_node, " ", dst_node, " has finished");
+}
+
+/**
+ * @brief Stop processing
+ *
+ * Sets brun member to FALSE thus signaling end of processing.
+ * Then it waits for std::thread to exit before returning.
+ *
+ * */
+void pebbworker::stop() {
+  rvs::lp::LogLazy(rvs::logtrace, "[", stop_action_name, "] pebb transfer ",
+                   src_node, " ", dst_node, " in pebbworker::stop()");
+
+  brun = false;
+}
+
+/**
+ * @brief Init worker object and set transfer parameters
+ *
+ * @param Src source NUMA node
+ * @param Dst destination NUMA node
+ * @param h2d 'true' for host to device transfer
+ * @param d2h 'true' for device to host transfer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebbworker::initialize(uint16_t Src, uint16_t Dst, bool h2d, bool d2h) {
+  src_node = Src;
+  dst_node = Dst;
+  bidirect = d2h && h2d;
+
+  prop_d2h = d2h;
+  prop_h2d = h2d;
+
+  pHsa = rvs::hsa::Get();
+
+  running_size = 0;
+  running_duration = 0;
+
+  total_size = 0;
+  total_duration = 0;
+
+  return 0;
+}
+
+/**
+ * @brief Executes data transfer
+ *
+ * Based on transfer parameters, initiates and performs one way or
+ * bidirectional data transfer. Resulting measurements are compounded in running
+ * totals for periodical printout during the test.
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebbworker::do_transfer() {
+  double duration;
+  int sts;
+  unsigned int startsec;
+  unsigned int startusec;
+  unsigned int endsec;
+  unsigned int endusec;
+
+  RVSTRACE_
+
+  // host memory is accessed from CPUs of its own NUMA node; in serial mode
+  // this runs on the action thread, so its affinity is restored on return
+  rvs::CpuPinGuard pin_guard(pin_cpus);
+  if (!pin_cpus.empty()) {
+    pinned = pin_guard.pinned();
+  }
+
+  brun = true;
+  if (loglevel >= rvs::logdebug)
+    rvs::lp::get_ticks(&startsec, &startusec);
+
+  if (block_size.size() == 0) {
+    RVSTRACE_
+    block_size = pHsa->size_list;
+  }
+
+  std::vector<size_t> sizes;
+  std::vector<rvs::AtomicHistogram*> hist;
+  {
+    std::lock_guard<std::mutex> lk(cntmutex);
+    if (adaptive) {
+      sweep.pending(&sizes);
+    } else {
+      sizes.assign(block_size.begin(), block_size.end());
+    }
+    for (size_t i = 0; i < sizes.size(); i++) {
+      hist.push_back(get_recorder(sizes[i]));
+    }
+  }
+
+  for (size_t i = 0; brun && i < sizes.size(); i++) {
+    RVSTRACE_
+    current_size = sizes[i];
+
+    if (rvs::lp::Stopping()) {
+      RVSTRACE_
+      return -1;
+    }
+    // if needed, swap source and destination
+    if (!prop_h2d && prop_d2h) {
+      RVSTRACE_
+      sts = pHsa->SendTraffic(dst_node, src_node, current_size,
+                              bidirect, &duration, queue_depth);
+    } else {
+      RVSTRACE_
+      sts = pHsa->SendTraffic(src_node, dst_node, current_size,
+                              bidirect, &duration, queue_depth);
+    }
+    if (sts) {
+      std::string msg = "internal error, src: " + std::to_string(src_node)
+      + "   dst: " +std::to_string(dst_node)
+      + "   current size: " + std::to_string(current_size)
+      + " status "+ std::to_string(sts);
+      rvs::lp::Err(msg, MODULE_NAME, action_name);
+      return sts;
+    }
+
+    hist[i]->record(static_cast<uint64_t>(duration * 1e9));
+    {
+      RVSTRACE_
+      std::lock_guard<std::mutex> lk(cntmutex);
+      running_size += current_size * queue_depth;
+      running_duration += duration;
+      if (adaptive) {
+        sweep.add(current_size, duration);
+      }
+    }
+  }
+
+  RVSTRACE_
+  if (loglevel >= rvs::logdebug) {
+    RVSTRACE_
+    rvs::lp::get_ticks(&endsec, &endusec);
+    rvs::lp::LogLazyExt(rvs::logdebug, startsec, startusec, "[", action_name,
+                        "] pebb transfer ", src_node, " ", dst_node, " start");
+    rvs::lp::LogLazyExt(rvs::logdebug, endsec, endusec, "[", action_name,
+                        "] pebb transfer ", src_node, " ", dst_node, " finish");
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Get running cumulatives for data trnasferred and time ellapsed
+ *
+ * @param Src [out] source NUMA node
+ * @param Dst [out] destination NUMA node
+ * @param Bidirect [out] 'true' for bidirectional transfer
+ * @param Size [out] cumulative size of transferred data in this sampling
+ * interval (in bytes)
+ * @param Duration [out] cumulative duration of transfers in this sampling
+ * interval (in seconds)
+ * @param pHist [out] optional, per size transfer time (nsec) histograms
+ * in this sampling interval
+ *
+ * */
+void pebbworker::get_running_data(uint16_t* Src,  uint16_t* Dst, bool* Bidirect,
+                                 size_t* Size, double* Duration,
+                                 rvs::HistogramMap* pHist) {
+  // lock data until totalling has finished
+  std::lock_guard<std::mutex> lk(cntmutex);
+
+  // update total
+  total_size += running_size;
+  total_duration += running_duration;
+
+  rvs::HistogramMap interval;
+  drain_recorders(&interval);
+  rvs::merge(interval, &total_hist);
+  if (pHist) {
+    pHist->swap(interval);
+  }
+
+  *Src = src_node;
+  *Dst = dst_node;
+  *Bidirect = bidirect;
+  *Size = running_size;
+  *Duration = running_duration;
+
+  // reset running totas
+  running_size = 0;
+  running_duration = 0;
+}
+
+/**
+ * @brief Get final cumulatives for data trnasferred and time ellapsed
+ *
+ * @param Src [out] source NUMA node
+ * @param Dst [out] destination NUMA node
+ * @param Bidirect [out] 'true' for bidirectional transfer
+ * @param Size [out] cumulative size of transferred data in
+ * this test (in bytes)
+ * @param Duration [out] cumulative duration of transfers in
+ * this test (in seconds)
+ * @param bReset [in] if 'true' set final totals to zero
+ * @param pHist [out] optional, per size transfer time (nsec) histograms
+ * in this test
+ *
+ * */
+void pebbworker::get_final_data(uint16_t* Src, uint16_t* Dst, bool* Bidirect,
+                               size_t* Size, double* Duration, bool bReset,
+                               rvs::HistogramMap* pHist) {
+  // lock data until totalling has finished
+  std::lock_guard<std::mutex> lk(cntmutex);
+
+  // update total
+  total_size += running_size;
+  total_duration += running_duration;
+
+  drain_recorders(&total_hist);
+  if (pHist) {
+    *pHist = total_hist;
+  }
+
+  *Src = src_node;
+  *Dst = dst_node;
+  *Bidirect = bidirect;
+  *Size = total_size;
+  *Duration = total_duration;
+
+  // reset running totas
+  running_size = 0;
+  running_duration = 0;
+
+  // reset final totals
+  if (bReset) {
+    total_size = 0;
+    total_duration = 0;
+    total_hist.clear();
+  }
+}
+
+/**
+ * @brief (Re)starts adaptive size sweep
+ *
+ * Sweep starts from configured block sizes (or default size list if none
+ * are configured).
+ *
+ * */
+void pebbworker::start_sweep() {
+  if (block_size.size() == 0) {
+    block_size = pHsa->size_list;
+  }
+
+  std::lock_guard<std::mutex> lk(cntmutex);
+  sweep.initialize(block_size, adaptive_tolerance);
+}
+
+/**
+ * @brief Check if adaptive size sweep has finished
+ *
+ * @return 'true' if adaptive sweep is enabled and all sizes have settled
+ *
+ * */
+bool pebbworker::sweep_done() {
+  std::lock_guard<std::mutex> lk(cntmutex);
+  return adaptive && sweep.done();
+}
+
+/**
+ * @brief Get results of adaptive size sweep
+ *
+ * @return measured sizes in increasing order
+ *
+ * */
+std::vector<rvs::SizeSweep::Point> pebbworker::get_sweep_points() {
+  std::lock_guard<std::mutex> lk(cntmutex);
+  return sweep.points();
+}
+
+/**
+ * @brief Get transfer time recorder for given size
+ *
+ * Recorder is created on first use. Caller must hold cntmutex.
+ *
+ * @param Size transfer size in bytes
+ * @return ptr to recorder, valid for the lifetime of this worker
+ *
+ * */
+rvs::AtomicHistogram* pebbworker::get_recorder(size_t Size) {
+  std::unique_ptr<rvs::AtomicHistogram>& p = recorder[Size];
+  if (!p) {
+    p.reset(new rvs::AtomicHistogram);
+  }
+  return p.get();
+}
+
+/**
+ * @brief Move transfer times recorded so far into histograms
+ *
+ * Caller must hold cntmutex.
+ *
+ * @param pHist [out] per size histograms recorded times are added to
+ *
+ * */
+void pebbworker::drain_recorders(rvs::HistogramMap* pHist) {
+  for (auto it = recorder.begin(); it != recorder.end(); ++it) {
+    rvs::Histogram interval;
+    it->second->drain(&interval);
+    if (interval.count() > 0) {
+      (*pHist)[it->first].merge(interval);
+    }
+  }
+}
@@ -0,0 +1,192 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef PQT_SO_INCLUDE_WORKER_H_
+#define PQT_SO_INCLUDE_WORKER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "include/rvsthreadbase.h"
+#include "include/rvssizesweep.h"
+#include "include/rvshistogram.h"
+
+
+/**
+ * @class pqtworker
+ * @ingroup PQT
+ *
+ * @brief Bandwidth test implementation class
+ *
+ * Derives from rvs::ThreadBase and implements actual test functionality
+ * in its run() method.
+ *
+ */
+
+namespace rvs {
+class hsa;
+}
+
+class pqtworker : public rvs::ThreadBase {
+ public:
+  //! default constructor
+  pqtworker();
+  //! default destructor
+  virtual ~pqtworker();
+
+  //! stop thread loop and exit thread
+  void stop();
+  //! Sets initiating action name
+  void set_name(const std::string& name) { action_name = name; }
+  //! sets stopping action name
+  void set_stop_name(const std::string& name) { stop_action_name = name; }
+  //! Sets JSON flag
+  void json(const bool flag) { bjson = flag; }
+  //! Returns initiating action name
+  const std::string& get_name(void) { return action_name; }
+
+  int initialize(uint16_t Src, uint16_t Dst, bool Bidirect);
+  int do_transfer();
+  void get_running_data(uint16_t* Src, uint16_t* Dst, bool* Bidirect,
+                        size_t* Size, double* Duration,
+                        rvs::HistogramMap* pHist = nullptr);
+  void get_final_data(uint16_t* Src, uint16_t* Dst, bool* Bidirect,
+                      size_t* Size, double* Duration, bool bReset = true,
+                      rvs::HistogramMap* pHist = nullptr);
+  //! Set transfer index
+  void set_transfer_ix(uint16_t val) { transfer_ix = val; }
+  //! Get transfer index
+  uint16_t get_transfer_ix() { return transfer_ix; }
+  //! Set total number of transfers
+  void set_transfer_num(uint16_t val) { transfer_num = val; }
+  //! Get total number of transfers
+  uint16_t get_transfer_num() { return transfer_num; }
+  //! Set list of test sizes
+  void set_block_sizes(const std::vector<uint32_t>& val) { block_size = val; }
+  //! Set number of copies kept in flight per direction
+  void set_queue_depth(const int val) { queue_depth = val; }
+  //! Get number of copies kept in flight per direction
+  int get_queue_depth() { return queue_depth; }
+  //! Enable adaptive size sweep with given relative tolerance
+  void set_adaptive(const bool val, const double tolerance) {
+    adaptive = val;
+    adaptive_tolerance = tolerance;
+  }
+  //! Returns 'true' if adaptive size sweep is enabled
+  bool is_adaptive() { return adaptive; }
+  void start_sweep();
+  bool sweep_done();
+  std::vector<rvs::SizeSweep::Point> get_sweep_points();
+  //! Enable ping-pong latency mode with given number of chained round trips
+  void set_latency(const bool val, const int rounds) {
+    latency = val;
+    latency_rounds = rounds;
+  }
+  //! Returns 'true' if ping-pong latency mode is enabled
+  bool is_latency() { return latency; }
+  void get_running_pingpong(rvs::HistogramMap* pOneWay,
+                            rvs::HistogramMap* pRoundTrip);
+  void get_final_pingpong(rvs::HistogramMap* pOneWay,
+                          rvs::HistogramMap* pRoundTrip, bool bReset = true);
+
+ protected:
+  virtual void run(void);
+  int do_pingpong();
+  rvs::AtomicHistogram* get_recorder(size_t Size);
+  void drain_recorders(rvs::HistogramMap* pHist);
+
+ protected:
+  //! TRUE if JSON output is required
+  bool    bjson;
+  //! Loops while TRUE
+  bool    brun;
+  //! Name of the action which initiated thread
+  std::string  action_name;
+  //! Name of the action which stops thread
+  std::string  stop_action_name;
+
+  //! ptr to RVS HSA singleton wrapper
+  rvs::hsa* pHsa;
+  //! source NUMA node
+  uint16_t src_node;
+  //! destination NUMA node
+  uint16_t dst_node;
+  //! 'true' for bidirectional transfer
+  bool bidirect;
+
+  //! Current size of transfer data
+  size_t current_size;
+
+  //! running total for size (bytes)
+  size_t running_size;
+  //! running total for duration (sec)
+  double running_duration;
+
+  //! final total size (bytes)
+  size_t total_size;
+  //! final total duration (sec)
+  double total_duration;
+
+  //! transfer index
+  uint16_t transfer_ix;
+  //! total number of transfers
+  uint16_t transfer_num;
+
+  //! list of test block sizes
+  std::vector<uint32_t> block_size;
+  //! number of copies kept in flight per direction
+  int queue_depth;
+  //! 'true' if sizes are chosen by adaptive sweep instead of block_size
+  bool adaptive;
+  //! relative confidence interval adaptive sweep converges to
+  double adaptive_tolerance;
+  //! adaptive size sweep (guarded by cntmutex)
+  rvs::SizeSweep sweep;
+  //! per size transfer time recorders (map guarded by cntmutex,
+  //! recording itself is lock-free)
+  std::map<size_t, std::unique_ptr<rvs::AtomicHistogram>> recorder;
+  //! per size transfer time (nsec) histograms in this test
+  rvs::HistogramMap total_hist;
+
+  //! 'true' if ping-pong latency is measured instead of bandwidth
+  bool latency;
+  //! number of chained round trips per ping-pong measurement
+  int latency_rounds;
+  //! per size one-way latency (nsec) in this sampling interval
+  rvs::HistogramMap running_oneway;
+  //! per size round trip latency (nsec) in this sampling interval
+  rvs::HistogramMap running_roundtrip;
+  //! per size one-way latency (nsec) in this test
+  rvs::HistogramMap total_oneway;
+  //! per size round trip latency (nsec) in this test
+  rvs::HistogramMap total_roundtrip;
+
+  //! synchronization mutex
+  std::mutex cntmutex;
+};
+
+#endif  // PQT_SO_INCLUDE_WORKER_H_
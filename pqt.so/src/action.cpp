@@ -0,0 +1,1722 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+extern "C" {
+#include <pci/pci.h>
+#include <linux/pci.h>
+}
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "include/rvs_key_def.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvscontention.h"
+#include "include/rvshsa.h"
+#include "include/rvslinkmap.h"
+#include "include/rvslinksched.h"
+#include "include/rvspingpong.h"
+#include "include/rvstimer.h"
+
+#include "include/rvs_module.h"
+#include "include/worker.h"
+#include "include/worker_b2b.h"
+
+
+#define MODULE_NAME "pqt"
+#define MODULE_NAME_CAPS "PQT"
+#define JSON_CREATE_NODE_ERROR "JSON cannot create node"
+
+using std::string;
+using std::vector;
+
+//! Default constructor
+pqt_action::pqt_action() {
+  prop_peer_deviceid = 0u;
+  bjson = false;
+  queue_depth = 1;
+  adaptive = false;
+  adaptive_tolerance = RVS_SWEEP_TOLERANCE;
+  latency = false;
+  latency_rounds = RVS_PINGPONG_ROUNDS;
+  all_to_all = false;
+  collective_chunks = RVS_COLL_CHUNKS;
+  link_schedule = false;
+}
+
+//! Default destructor
+pqt_action::~pqt_action() {
+  property.clear();
+}
+
+/**
+ * gets the peer gpu_id list from the module's properties collection
+ * @param error pointer to a memory location where the error code will be stored
+ * @return true if "all" is selected, false otherwise
+ */
+bool pqt_action::property_get_peers(int *error) {
+    *error = 0;  // init with 'no error'
+    auto it = property.find("peers");
+    if (it != property.end()) {
+        if (it->second == "all") {
+            return true;
+        } else {
+            // split the list of gpu_id
+            prop_peers = str_split(it->second,
+                    YAML_DEVICE_PROP_DELIMITER);
+            if (prop_peers.empty()) {
+                *error = 1;  // list of gpu_id cannot be empty
+            } else {
+                for (vector<string>::iterator it_gpu_id =
+                        prop_peers.begin();
+                        it_gpu_id != prop_peers.end(); ++it_gpu_id)
+                    if (!is_positive_integer(*it_gpu_id)) {
+                        *error = 1;
+                        break;
+                    }
+            }
+            return false;
+        }
+
+    } else {
+        *error = 1;
+        // when error is set, it doesn't really matter whether the method
+        // returns true or false
+        return false;
+    }
+}
+
+/**
+ * gets the peer deviceid from the module's properties collection
+ * @param error pointer to a memory location where the error code will be stored
+ * @return deviceid value if valid, -1 otherwise
+ */
+/*int pqt_action::property_get_peer_deviceid(int *error) {
+    auto it = property.find("peer_deviceid");
+    int deviceid = -1;
+    *error = 0;  // init with 'no error'
+
+    if (it != property.end()) {
+        if (it->second != "") {
+            if (is_positive_integer(it->second)) {
+                deviceid = std::stoi(it->second);
+            } else {
+                *error = 1;  // we have something but it's not a number
+            }
+        } else {
+            *error = 1;  // we have an empty string
+        }
+    }
+    return deviceid;
+}*/
+
+/**
+ * @brief reads the module's properties collection to see whether bandwidth
+ * tests should be run after peer check
+ */
+void pqt_action::property_get_test_bandwidth(int *error) {
+  prop_test_bandwidth = false;
+  auto it = property.find("test_bandwidth");
+  if (it != property.end()) {
+    if (it->second == "true") {
+      prop_test_bandwidth = true;
+      *error = 0;
+    } else if (it->second == "false") {
+      *error = 0;
+    } else {
+      *error = 1;
+    }
+  } else {
+    *error = 2;
+  }
+}
+
+/**
+ * @brief reads the module's properties collection to see whether bandwidth
+ * tests should be run in both directions
+ */
+void pqt_action::property_get_bidirectional(int *error) {
+  prop_bidirectional = false;
+  auto it = property.find("bidirectional");
+  if (it != property.end()) {
+    if (it->second == "true") {
+      prop_bidirectional = true;
+      *error = 0;
+    } else if (it->second == "false") {
+      *error = 0;
+    } else {
+      *error = 1;
+    }
+  } else {
+    *error = 2;
+  }
+}
+
+/**
+ * @brief reads all PQT related configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pqt_action::get_all_pqt_config_keys(void) {
+  int    error;
+  string msg;
+  bool   res;
+  res = true;
+
+  prop_peer_device_all_selected = property_get_peers(&error);
+  if (error) {
+    msg =  "invalid peers";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get_int<uint32_t>("peer_deviceid", &prop_peer_deviceid, 0u)) {
+    msg = "invalid 'peer_deviceid ' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  property_get_test_bandwidth(&error);
+  if (error) {
+    msg = "invalid 'test_bandwidth'";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  property_get_bidirectional(&error);
+  if (error) {
+    if (prop_test_bandwidth == true) {
+      msg = "invalid 'bidirectional'";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+    }
+  }
+
+  error = property_get_uint_list<uint32_t>(RVS_CONF_BLOCK_SIZE_KEY,
+                                 YAML_DEVICE_PROP_DELIMITER,
+                                &block_size, &b_block_size_all);
+  if (error == 1) {
+      msg =  "invalid '" + std::string(RVS_CONF_BLOCK_SIZE_KEY) + "' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  } else if (error == 2) {
+    b_block_size_all = true;
+    block_size.clear();
+  }
+
+  error = property_get_int<uint32_t>
+  (RVS_CONF_B2B_BLOCK_SIZE_KEY, &b2b_block_size);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_B2B_BLOCK_SIZE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_QUEUE_DEPTH_KEY, &queue_depth, 1);
+  if (error == 1 || queue_depth < 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_QUEUE_DEPTH_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_ADAPTIVE_KEY, &adaptive, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_ADAPTIVE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_ADAPTIVE_TOL_KEY, &adaptive_tolerance,
+                   static_cast<float>(RVS_SWEEP_TOLERANCE)) ||
+      adaptive_tolerance <= 0 || adaptive_tolerance >= 1) {
+    msg = "invalid '" + std::string(RVS_CONF_ADAPTIVE_TOL_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_LATENCY_KEY, &latency, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_LATENCY_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_LATENCY_ROUNDS_KEY, &latency_rounds,
+                                RVS_PINGPONG_ROUNDS);
+  if (error == 1 || latency_rounds < 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_LATENCY_ROUNDS_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_ALL_TO_ALL_KEY, &all_to_all, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_ALL_TO_ALL_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_ALL_TO_ALL_CSV_KEY, &all_to_all_csv,
+                   std::string())) {
+    msg = "invalid '" + std::string(RVS_CONF_ALL_TO_ALL_CSV_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_COLLECTIVE_KEY, &collective, std::string()) ||
+      (!collective.empty() && rvs::Collective::parse(collective) < 0)) {
+    msg = "invalid '" + std::string(RVS_CONF_COLLECTIVE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_COLLECTIVE_CHUNKS_KEY,
+                                &collective_chunks, RVS_COLL_CHUNKS);
+  if (error == 1 || collective_chunks < 1) {
+    msg = "invalid '" + std::string(RVS_CONF_COLLECTIVE_CHUNKS_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get(RVS_CONF_LINK_SCHEDULE_KEY, &link_schedule, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_LINK_SCHEDULE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  // ping-pong chains do not measure bandwidth
+  if (latency) {
+    all_to_all = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_LINK_TYPE_KEY, &link_type);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_LINK_TYPE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  return res;
+}
+
+/**
+ * @brief reads all common configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pqt_action::get_all_common_config_keys(void) {
+  string msg, sdevid, sdev;
+  int    error;
+  bool   res;
+  res = true;
+
+  // get the action name
+  if (property_get(RVS_CONF_NAME_KEY, &action_name)) {
+    rvs::lp::Err("Action name missing", MODULE_NAME_CAPS);
+    res = false;
+  }
+
+  // get <device> property value (a list of gpu id)
+  if ((error = property_get_device())) {
+    switch (error) {
+    case 1:
+      msg = "Invalid 'device' key value.";
+      break;
+    case 2:
+      msg = "Missing 'device' key.";
+      break;
+    }
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  // get the <deviceid> property value if provided
+  if (property_get_int<uint16_t>(RVS_CONF_DEVICEID_KEY,
+                                &property_device_id, 0u)) {
+    msg = "Invalid 'deviceid' key value.";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  // get the other action/GST related properties
+  if (property_get(RVS_CONF_PARALLEL_KEY, &property_parallel, false)) {
+      msg = "invalid '" + std::string(RVS_CONF_PARALLEL_KEY) +
+          "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_COUNT_KEY, &property_count, 1)) {
+      msg = "invalid '" + std::string(RVS_CONF_COUNT_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_WAIT_KEY, &property_wait, 0)) {
+      msg = "invalid '" + std::string(RVS_CONF_WAIT_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_DURATION_KEY,
+                                 &property_duration, DEFAULT_DURATION)) {
+      msg = "invalid '" + std::string(RVS_CONF_DURATION_KEY) +
+          "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_LOG_INTERVAL_KEY,
+                            &property_log_interval, DEFAULT_LOG_INTERVAL)) {
+    msg = "invalid '" + std::string(RVS_CONF_LOG_INTERVAL_KEY) + "'";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  return res;
+}
+
+/**
+ * @brief Create thread objects based on action description in configuation
+ * file.
+ *
+ * Threads are created but are not started. Execution, one by one of parallel,
+ * depends on "parallel" key in configuration file. Pointers to created objects
+ * are stored in "test_array" member
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::create_threads() {
+  std::string msg;
+
+  std::vector<uint16_t> gpu_id;
+  std::vector<uint16_t> gpu_device_id;
+  uint16_t transfer_ix = 0;
+  bool bmatch_found = false;
+
+  gpu_get_all_gpu_id(&gpu_id);
+  gpu_get_all_device_id(&gpu_device_id);
+
+  for (size_t i = 0; i < gpu_id.size(); i++) {    // all possible sources
+    // filter out by source device id
+    if (property_device_id > 0) {
+      if (property_device_id != gpu_device_id[i]) {
+        continue;
+      }
+    }
+
+    // filter out by listed sources
+    if (!property_device_all) {
+      const auto it = std::find(property_device.cbegin(),
+                                property_device.cend(),
+                                gpu_id[i]);
+      if (it == property_device.cend()) {
+            continue;
+      }
+    }
+
+    for (size_t j = 0; j < gpu_id.size(); j++) {  // all possible peers
+      RVSTRACE_
+      // filter out by peer id
+      if (prop_peer_deviceid > 0) {
+        RVSTRACE_
+        if (prop_peer_deviceid != gpu_device_id[j]) {
+          RVSTRACE_
+          continue;
+        }
+      }
+
+      RVSTRACE_
+      // filter out by listed peers
+      if (!prop_peer_device_all_selected) {
+        RVSTRACE_
+        const auto it = std::find(prop_peers.cbegin(),
+                                  prop_peers.cend(),
+                                  std::to_string(gpu_id[j]));
+        if (it == prop_peers.cend()) {
+          RVSTRACE_
+          continue;
+        }
+      }
+
+      RVSTRACE_
+      // signal that at lease one matching src-dst combination
+      // has been found:
+      bmatch_found = true;
+
+      // get NUMA nodes
+      uint16_t srcnode;
+      if (rvs::gpulist::gpu2node(gpu_id[i], &srcnode)) {
+        msg + "no node found for GPU ID " + std::to_string(gpu_id[i]);
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+
+      uint16_t dstnode;
+      if (rvs::gpulist::gpu2node(gpu_id[j], &dstnode)) {
+        RVSTRACE_
+        msg = "no node found for GPU ID " + std::to_string(gpu_id[j]);
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+
+      RVSTRACE_
+      uint32_t distance = 0;
+      std::vector<rvs::linkinfo_t> arr_linkinfo;
+      rvs::hsa::Get()->GetLinkInfo(srcnode, dstnode,
+                                         &distance, &arr_linkinfo);
+
+      // perform peer check
+      if (is_peer(gpu_id[i], gpu_id[j])) {
+        RVSTRACE_
+        msg = "[" + action_name + "] p2p "
+            + std::to_string(gpu_id[i]) + " "
+            + std::to_string(gpu_id[j]) + " peers:true ";
+
+        if (distance == rvs::hsa::NO_CONN) {
+          msg += "distance:-1";
+        } else {
+          msg += "distance:" + std::to_string(distance);
+        }
+        // iterate through individual hops
+        for (auto it = arr_linkinfo.begin(); it != arr_linkinfo.end(); it++) {
+          msg += " " + it->strtype + ":";
+          if (it->distance == rvs::hsa::NO_CONN) {
+            msg += "-1";
+          } else {
+            msg +=std::to_string(it->distance);
+          }
+        }
+        rvs::lp::Log(msg, rvs::logresults);
+
+        if (bjson) {
+          RVSTRACE_
+          unsigned int sec;
+          unsigned int usec;
+          rvs::lp::get_ticks(&sec, &usec);
+          void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+          if (pjson != NULL) {
+            RVSTRACE_
+            rvs::lp::AddString(pjson, "src",
+                               std::to_string(gpu_id[i]));
+            rvs::lp::AddString(pjson, "dst",
+                               std::to_string(gpu_id[j]));
+            rvs::lp::AddString(pjson, "p2p", "true");
+            if (distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(pjson, "distance", -1);
+            } else {
+                rvs::lp::AddInt(pjson, "distance", distance);
+            }
+
+            void* phops = rvs::lp::CreateNode(pjson, "hops");
+            rvs::lp::AddNode(pjson, phops);
+
+            // iterate through individual hops
+            for (uint i = 0; i < arr_linkinfo.size(); i++) {
+              char sbuff[64];
+              snprintf(sbuff, sizeof(sbuff), "hop%d", i);
+             void* phop = rvs::lp::CreateNode(phops, sbuff);
+              rvs::lp::AddString(phop, "type", arr_linkinfo[i].strtype);
+              if (arr_linkinfo[i].distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(phop, "distance", -1);
+              } else {
+                rvs::lp::AddInt(phop, "distance", arr_linkinfo[i].distance);
+              }
+             rvs::lp::AddNode(phops, phop);
+            }
+
+            rvs::lp::LogRecordFlush(pjson);
+          }
+        }
+
+        RVSTRACE_
+        // GPUs are peers, create transaction for them
+        if (prop_test_bandwidth) {
+          RVSTRACE_
+          pqtworker* p = nullptr;
+
+          transfer_ix += 1;
+          if (b2b_block_size > 0 && property_parallel && !latency &&
+              !all_to_all) {
+            RVSTRACE_
+            pqtworker_b2b* pb2b = new pqtworker_b2b;
+            if (pb2b == nullptr) {
+              RVSTRACE_
+              msg = "internal error";
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              return -1;
+            }
+            pb2b->initialize(srcnode, dstnode, prop_bidirectional,
+                             b2b_block_size);
+            p = pb2b;
+
+          } else {
+            RVSTRACE_
+            p = new pqtworker;
+            if (p == nullptr) {
+              RVSTRACE_
+              msg = "internal error";
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              return -1;
+            }
+            p->initialize(srcnode, dstnode, prop_bidirectional);
+            p->set_adaptive(adaptive && !latency && !all_to_all,
+                            adaptive_tolerance);
+            p->set_latency(latency, latency_rounds);
+          }
+          RVSTRACE_
+          p->set_name(action_name);
+          p->set_stop_name(action_name);
+          p->set_transfer_ix(transfer_ix);
+          p->set_block_sizes(block_size);
+          p->set_queue_depth(queue_depth);
+          test_array.push_back(p);
+        }
+
+      } else {
+        RVSTRACE_
+        msg = "[" + action_name + "] p2p "
+            + std::to_string(gpu_id[i]) + " "
+            + std::to_string(gpu_id[j]) + " peers:false ";
+
+        if (distance == rvs::hsa::NO_CONN) {
+          msg += "distance:-1";
+        } else {
+          msg += "distance:" + std::to_string(distance);
+        }
+        // iterate through individual hops
+        for (auto it = arr_linkinfo.begin(); it != arr_linkinfo.end(); it++) {
+          msg += " " + it->strtype + ":";
+          if (it->distance == rvs::hsa::NO_CONN) {
+            msg += "-1";
+          } else {
+            msg +=std::to_string(it->distance);
+          }
+        }
+
+        rvs::lp::Log(msg, rvs::logresults);
+
+        if (bjson) {
+          RVSTRACE_
+          unsigned int sec;
+          unsigned int usec;
+          rvs::lp::get_ticks(&sec, &usec);
+          void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+          if (pjson != NULL) {
+            RVSTRACE_
+            rvs::lp::AddString(pjson,
+                               "src", std::to_string(gpu_id[i]));
+            rvs::lp::AddString(pjson,
+                               "dst", std::to_string(gpu_id[j]));
+            rvs::lp::AddString(pjson,
+                               "p2p", "false");
+            if (distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(pjson, "distance", -1);
+            } else {
+                rvs::lp::AddInt(pjson, "distance", distance);
+            }
+
+            void* phops = rvs::lp::CreateNode(pjson, "hops");
+            rvs::lp::AddNode(pjson, phops);
+
+            // iterate through individual hops
+            for (uint i = 0; i < arr_linkinfo.size(); i++) {
+              char sbuff[64];
+              snprintf(sbuff, sizeof(sbuff), "hop%d", i);
+             void* phop = rvs::lp::CreateNode(phops, sbuff);
+              rvs::lp::AddString(phop, "type", arr_linkinfo[i].strtype);
+              if (arr_linkinfo[i].distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(phop, "distance", -1);
+              } else {
+                rvs::lp::AddInt(phop, "distance", arr_linkinfo[i].distance);
+              }
+             rvs::lp::AddNode(phops, phop);
+            }
+
+            rvs::lp::LogRecordFlush(pjson);
+          }
+        }
+      }
+    }
+  }
+
+  RVSTRACE_
+  if (prop_test_bandwidth && test_array.size() < 1) {
+    RVSTRACE_
+    std::string diag;
+    if (bmatch_found) {
+      RVSTRACE_
+      diag = "No peers found";
+    } else {
+      RVSTRACE_
+      diag = "No devices match criteria from the test configuation";
+    }
+    RVSTRACE_
+    msg = "[" + action_name + "] p2p-bandwidth " + diag;
+    rvs::lp::Log(msg, rvs::logerror);
+    if (bjson) {
+      RVSTRACE_
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate("p2p-bandwidth",
+                              action_name.c_str(), rvs::logerror, sec, usec);
+      if (pjson != NULL) {
+        RVSTRACE_
+        rvs::lp::AddString(pjson,
+          "message",
+          diag);
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    RVSTRACE_
+    return 0;
+  }
+
+  RVSTRACE_
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->set_transfer_num(test_array.size());
+  }
+
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Group test transfers into rounds of link-disjoint transfers
+ *
+ * Links used by each transfer are derived from hop information of its
+ * path (both paths for bidirectional transfers), see rvs::LinkMap. Rounds
+ * are stored in "rounds" member and logged.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::build_schedule() {
+  uint16_t src_node, dst_node;
+  uint16_t src_id, dst_id;
+  bool     bidir;
+  size_t   current_size;
+  double   duration;
+  std::string msg;
+
+  rvs::LinkMap link_map;
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+    uint32_t distance = 0;
+    std::vector<rvs::linkinfo_t> path;
+    rvs::hsa::Get()->GetLinkInfo(src_node, dst_node, &distance, &path);
+    size_t t = link_map.add(src_node, dst_node, path);
+    if (bidir) {
+      rvs::hsa::Get()->GetLinkInfo(dst_node, src_node, &distance, &path);
+      link_map.add_path(t, dst_node, src_node, path);
+    }
+  }
+
+  rvs::LinkScheduler::schedule(link_map, &rounds);
+
+  msg = "[" + action_name + "] pqt link schedule: "
+      + std::to_string(test_array.size()) + " transfers in "
+      + std::to_string(rounds.size()) + " rounds (lower bound "
+      + std::to_string(rvs::LinkScheduler::lower_bound(link_map)) + ")";
+  rvs::lp::Log(msg, rvs::loginfo);
+
+  for (size_t r = 0; r < rounds.size(); r++) {
+    msg = "[" + action_name + "] pqt link schedule round "
+        + std::to_string(r) + ":";
+    for (auto t : rounds[r]) {
+      if (rvs::gpulist::node2gpu(link_map.src(t), &src_id) ||
+          rvs::gpulist::node2gpu(link_map.dst(t), &dst_id)) {
+        msg = "could not find GPU id for nodes "
+            + std::to_string(link_map.src(t)) + " "
+            + std::to_string(link_map.dst(t));
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+      msg += " " + std::to_string(src_id) + "->" + std::to_string(dst_id);
+    }
+    rvs::lp::Log(msg, rvs::loginfo);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Delete test thread objects at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::destroy_threads() {
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->set_stop_name(action_name);
+    (*it)->stop();
+    delete *it;
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Check if two GPU can access each other memory
+ *
+ * @param Src GPU ID of the source GPU
+ * @param Dst GPU ID of the destination GPU
+ *
+ * @return 0 - no access, 1 - Src can acces Dst, 2 - both have access
+ *
+ * */
+int pqt_action::is_peer(uint16_t Src, uint16_t Dst) {
+  //! ptr to RVS HSA singleton wrapper
+  rvs::hsa* pHsa;
+  string msg;
+
+  if (Src == Dst) {
+    return 0;
+  }
+  pHsa = rvs::hsa::Get();
+
+  // GPUs are peers, create transaction for them
+  // get NUMA nodes
+  uint16_t srcnode;
+  if (rvs::gpulist::gpu2node(Src, &srcnode)) {
+    msg + "no node found for GPU ID " + std::to_string(Src);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  uint16_t dstnode;
+  if (rvs::gpulist::gpu2node(Dst, &dstnode)) {
+    RVSTRACE_
+    msg = "no node found for GPU ID " + std::to_string(Dst);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  return pHsa->rvs::hsa::GetPeerStatus(srcnode, dstnode);
+}
+
+/**
+ * @brief Collect running average bandwidth data for all the tests and prints
+ * them out every log_interval msecs.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_running_average() {
+  for (auto it = test_array.begin(); brun && it != test_array.end(); ++it) {
+    print_running_average(*it);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Collect running average for this particular transfer.
+ *
+ * @param pWorker ptr to a pqtworker class
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_running_average(pqtworker* pWorker) {
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[64];
+  double      bandwidth;
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+
+  if (pWorker->is_latency()) {
+    return print_pingpong(pWorker, false);
+  }
+
+  rvs::HistogramMap hist;
+
+  // get running average
+  pWorker->get_running_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, &hist);
+
+  if (duration > 0) {
+    bandwidth = current_size/duration/1000 / 1000 / 1000;
+    if (bidir) {
+      bandwidth *=2;
+    }
+    snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+  } else {
+    // no running average in this iteration, try getting total so far
+    // (do not reset final totals as this is just intermediate query)
+    pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, false);
+    if (duration > 0) {
+      bandwidth = current_size/duration/1000 / 1000 / 1000;
+      if (bidir) {
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps (*)", bandwidth);
+    } else {
+      // not transfers at all - print "pending"
+      snprintf( buff, sizeof(buff), "(pending)");
+    }
+  }
+
+//   src_id = rvs::gpulist::GetGpuIdFromNodeId(src_node);
+//   dst_id = rvs::gpulist::GetGpuIdFromNodeId(dst_node);
+
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(src_node, &src_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(src_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(dst_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  transfer_ix = pWorker->get_transfer_ix();
+  transfer_num = pWorker->get_transfer_num();
+
+  msg = "[" + action_name + "] p2p-bandwidth  ["
+      + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+      + "] " + std::to_string(src_id) + " " + std::to_string(dst_id)
+      + "  bidirectional: " + std::string(bidir ? "true" : "false")
+      + "  " + buff;
+  rvs::lp::Log(msg, rvs::loginfo);
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::loginfo, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson,
+                          "transfer_ix", std::to_string(transfer_ix));
+      rvs::lp::AddString(pjson,
+                          "transfer_num", std::to_string(transfer_num));
+      rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+      rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+      rvs::lp::AddString(pjson, "p2p", "true");
+      rvs::lp::AddString(pjson, "bidirectional",
+                          std::string(bidir ? "true" : "false"));
+      rvs::lp::AddString(pjson, "bandwidth (GBs)", buff);
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  print_latency(pWorker, src_id, dst_id, hist, "p2p-latency", rvs::loginfo);
+
+  return 0;
+}
+
+/**
+ * @brief Collect bandwidth totals for all the tests and prints
+ * them out at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_final_average() {
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  double      bandwidth;
+  char        buff[128];
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+
+  rvs::HistogramMap hist;
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    if ((*it)->is_latency()) {
+      print_pingpong(*it, true);
+      continue;
+    }
+
+    // keep totals until the reverse direction of this pair is printed
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, false, &hist);
+
+    if (duration) {
+      bandwidth = current_size/duration/1000 / 1000 / 1000;
+      if (bidir) {
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+    } else {
+      snprintf( buff, sizeof(buff), "(not measured)");
+    }
+//     src_id = rvs::gpulist::GetGpuIdFromNodeId(src_node);
+//     dst_id = rvs::gpulist::GetGpuIdFromNodeId(dst_node);
+
+    RVSTRACE_
+    if (rvs::gpulist::node2gpu(src_node, &src_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(src_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    RVSTRACE_
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    transfer_ix = (*it)->get_transfer_ix();
+    transfer_num = (*it)->get_transfer_num();
+
+    msg = "[" + action_name + "] p2p-bandwidth  ["
+        + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+        + "] " + std::to_string(src_id) + " " + std::to_string(dst_id)
+        + "  bidirectional: " + std::string(bidir ? "true" : "false")
+        + "  " + buff + "  duration: " + std::to_string(duration) + " sec";
+
+    rvs::lp::Log(msg, rvs::logresults);
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson,
+                            "transfer_ix", std::to_string(transfer_ix));
+        rvs::lp::AddString(pjson,
+                            "transfer_num", std::to_string(transfer_num));
+        rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+        rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+        rvs::lp::AddString(pjson, "p2p", "true");
+        rvs::lp::AddString(pjson, "bidirectional",
+                           std::string(bidir ? "true" : "false"));
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        rvs::lp::AddString(pjson, "duration (sec)",
+                           std::to_string(duration));
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    print_latency(*it, src_id, dst_id, hist, "p2p-latency", rvs::logresults);
+    if (bidir) {
+      print_latency_pair(*it, src_id, dst_id, hist);
+    }
+    if ((*it)->is_adaptive()) {
+      print_sweep(*it, src_id, dst_id);
+    }
+    sleep(1);
+  }
+
+  // all pairs are printed, reset final totals
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Check if all adaptive size sweeps have finished
+ *
+ * @return 'true' if adaptive mode is on and every worker has finished
+ * its sweep, 'false' otherwise
+ *
+ * */
+bool pqt_action::sweep_done() {
+  if (!adaptive) {
+    return false;
+  }
+
+  bool bfound = false;
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    if (!(*it)->is_adaptive()) {
+      continue;
+    }
+    bfound = true;
+    if (!(*it)->sweep_done()) {
+      return false;
+    }
+  }
+
+  return bfound;
+}
+
+/**
+ * @brief Print results of adaptive size sweep for one transfer
+ *
+ * @param pWorker ptr to a pqtworker class
+ * @param SrcId source ID as printed in results
+ * @param DstId destination GPU ID
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_sweep(pqtworker* pWorker, uint16_t SrcId, uint16_t DstId) {
+  uint16_t    src_node, dst_node;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[128];
+
+  // only direction is needed here, totals are left intact
+  pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+
+  std::vector<rvs::SizeSweep::Point> points = pWorker->get_sweep_points();
+  for (auto it = points.begin(); it != points.end(); ++it) {
+    double bandwidth = it->bandwidth() * pWorker->get_queue_depth()
+                     / 1000 / 1000 / 1000;
+    if (bidir) {
+      bandwidth *= 2;
+    }
+    double ci = it->mean > 0 ? 100 * it->ci() / it->mean : 0;
+    if (it->samples < 2) {
+      snprintf(buff, sizeof(buff), "%.3f GBps", bandwidth);
+    } else {
+      snprintf(buff, sizeof(buff), "%.3f GBps +/- %.1f%%", bandwidth, ci);
+    }
+
+    msg = "[" + action_name + "] p2p-bandwidth-sweep  ["
+        + std::to_string(pWorker->get_transfer_ix()) + "/"
+        + std::to_string(pWorker->get_transfer_num()) + "] "
+        + std::to_string(SrcId) + " " + std::to_string(DstId)
+        + "  size: " + std::to_string(it->size)
+        + "  samples: " + std::to_string(it->samples)
+        + "  " + buff
+        + (it->converged ? "" : "  (not converged)");
+    rvs::lp::Log(msg, rvs::logresults);
+
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "transfer_ix",
+                           std::to_string(pWorker->get_transfer_ix()));
+        rvs::lp::AddString(pjson, "transfer_num",
+                           std::to_string(pWorker->get_transfer_num()));
+        rvs::lp::AddString(pjson, "src", std::to_string(SrcId));
+        rvs::lp::AddString(pjson, "dst", std::to_string(DstId));
+        rvs::lp::AddInt(pjson, "size", static_cast<int>(it->size));
+        rvs::lp::AddInt(pjson, "samples", it->samples);
+        snprintf(buff, sizeof(buff), "%.3f", bandwidth);
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        snprintf(buff, sizeof(buff), "%.2f", ci);
+        rvs::lp::AddString(pjson, "ci (%)", buff);
+        rvs::lp::AddString(pjson, "converged",
+                           it->converged ? "true" : "false");
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print transfer time percentiles for one transfer
+ *
+ * Prints one line (and JSON record) per transfer size.
+ *
+ * @param pWorker ptr to a pqtworker class
+ * @param SrcId source GPU ID
+ * @param DstId destination GPU ID
+ * @param Hist per size transfer time (nsec) histograms
+ * @param Tag message tag
+ * @param LogLevel logging level
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_latency(pqtworker* pWorker,
+                              uint16_t SrcId, uint16_t DstId,
+                              const rvs::HistogramMap& Hist,
+                              const char* Tag, int LogLevel) {
+  const double pct[] = {50, 90, 99, 99.9};
+  const char* pct_name[] = {"p50", "p90", "p99", "p99.9"};
+  const size_t pct_num = sizeof(pct) / sizeof(pct[0]);
+  uint16_t    src_node, dst_node;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[128];
+
+  // only direction is needed here, totals are left intact
+  pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+
+  for (auto it = Hist.begin(); it != Hist.end(); ++it) {
+    const rvs::Histogram& h = it->second;
+    if (h.count() == 0) {
+      continue;
+    }
+
+    // bytes moved by one measured transfer
+    double bytes = static_cast<double>(it->first)
+                 * pWorker->get_queue_depth() * (bidir ? 2 : 1);
+    uint64_t p50 = h.percentile(50);
+    uint64_t p99 = h.percentile(99);
+    double bw_p50 = p50 > 0 ? bytes / p50 : 0;
+    double bw_p99 = p99 > 0 ? bytes / p99 : 0;
+
+    msg = "[" + action_name + "] " + Tag + "  ["
+        + std::to_string(pWorker->get_transfer_ix()) + "/"
+        + std::to_string(pWorker->get_transfer_num()) + "] "
+        + std::to_string(SrcId) + " " + std::to_string(DstId)
+        + "  bidirectional: " + std::string(bidir ? "true" : "false")
+        + "  size: " + std::to_string(it->first)
+        + "  samples: " + std::to_string(h.count());
+    for (size_t i = 0; i < pct_num; i++) {
+      snprintf(buff, sizeof(buff), "  %s: %.3f us", pct_name[i],
+               h.percentile(pct[i]) / 1000.0);
+      msg += buff;
+    }
+    snprintf(buff, sizeof(buff),
+             "  max: %.3f us  p50: %.3f GBps  p99: %.3f GBps",
+             h.max() / 1000.0, bw_p50, bw_p99);
+    msg += buff;
+    rvs::lp::Log(msg, LogLevel);
+
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), LogLevel, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "transfer_ix",
+                           std::to_string(pWorker->get_transfer_ix()));
+        rvs::lp::AddString(pjson, "transfer_num",
+                           std::to_string(pWorker->get_transfer_num()));
+        rvs::lp::AddString(pjson, "src", std::to_string(SrcId));
+        rvs::lp::AddString(pjson, "dst", std::to_string(DstId));
+        rvs::lp::AddString(pjson, "latency", Tag);
+        rvs::lp::AddString(pjson, "bidirectional",
+                           std::string(bidir ? "true" : "false"));
+        rvs::lp::AddInt(pjson, "size", static_cast<int>(it->first));
+        rvs::lp::AddString(pjson, "samples", std::to_string(h.count()));
+        for (size_t i = 0; i < pct_num; i++) {
+          snprintf(buff, sizeof(buff), "%.3f", h.percentile(pct[i]) / 1000.0);
+          rvs::lp::AddString(pjson, std::string(pct_name[i]) + " (us)", buff);
+        }
+        snprintf(buff, sizeof(buff), "%.3f", h.max() / 1000.0);
+        rvs::lp::AddString(pjson, "max (us)", buff);
+        snprintf(buff, sizeof(buff), "%.3f", bw_p50);
+        rvs::lp::AddString(pjson, "p50 bandwidth (GBps)", buff);
+        snprintf(buff, sizeof(buff), "%.3f", bw_p99);
+        rvs::lp::AddString(pjson, "p99 bandwidth (GBps)", buff);
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print transfer time percentiles of both directions of a pair
+ *
+ * Histograms of this worker are merged with those of the worker
+ * transferring in opposite direction (if any). Each pair is printed once,
+ * from the worker whose source GPU ID is lower.
+ *
+ * @param pWorker ptr to a pqtworker class
+ * @param SrcId source GPU ID
+ * @param DstId destination GPU ID
+ * @param Hist per size transfer time (nsec) histograms of pWorker
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_latency_pair(pqtworker* pWorker,
+                                   uint16_t SrcId, uint16_t DstId,
+                                   const rvs::HistogramMap& Hist) {
+  uint16_t    src_node, dst_node;
+  uint16_t    rsrc_node, rdst_node;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+
+  if (SrcId >= DstId) {
+    return 0;
+  }
+
+  pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    rvs::HistogramMap rhist;
+    (*it)->get_final_data(&rsrc_node, &rdst_node, &bidir,
+                          &current_size, &duration, false, &rhist);
+    if (rsrc_node != dst_node || rdst_node != src_node) {
+      continue;
+    }
+
+    rvs::merge(Hist, &rhist);
+    return print_latency(pWorker, SrcId, DstId, rhist,
+                         "p2p-latency-pair", rvs::logresults);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print ping-pong latencies for one transfer
+ *
+ * Prints one line (and JSON record) per message size with percentiles of
+ * one-way and round trip latency.
+ *
+ * @param pWorker ptr to a pqtworker class
+ * @param bFinal 'true' to print results of the whole test, 'false' to
+ * print the last sampling interval
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_pingpong(pqtworker* pWorker, bool bFinal) {
+  const double pct[] = {50, 90, 99, 99.9};
+  const char* pct_name[] = {"p50", "p90", "p99", "p99.9"};
+  const size_t pct_num = sizeof(pct) / sizeof(pct[0]);
+  const char* kind[] = {"one-way", "round-trip"};
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[128];
+  rvs::HistogramMap oneway;
+  rvs::HistogramMap roundtrip;
+  int         loglevel = bFinal ? rvs::logresults : rvs::loginfo;
+
+  if (bFinal) {
+    pWorker->get_final_pingpong(&oneway, &roundtrip);
+  } else {
+    pWorker->get_running_pingpong(&oneway, &roundtrip);
+  }
+
+  // only direction is needed here
+  pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(src_node, &src_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(src_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(dst_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  msg = "[" + action_name + "] p2p-pingpong  ["
+      + std::to_string(pWorker->get_transfer_ix()) + "/"
+      + std::to_string(pWorker->get_transfer_num()) + "] "
+      + std::to_string(src_id) + " " + std::to_string(dst_id);
+  if (roundtrip.empty()) {
+    rvs::lp::Log(msg + "  (pending)", loglevel);
+    return 0;
+  }
+
+  for (auto it = roundtrip.begin(); it != roundtrip.end(); ++it) {
+    const rvs::Histogram* h[] = {&oneway[it->first], &it->second};
+
+    std::string line = msg + "  size: " + std::to_string(it->first)
+                     + "  round trips: " + std::to_string(h[1]->count());
+    for (int k = 0; k < 2; k++) {
+      line += std::string("  ") + kind[k] + " (us)";
+      for (size_t i = 0; i < pct_num; i++) {
+        snprintf(buff, sizeof(buff), " %s: %.3f", pct_name[i],
+                 h[k]->percentile(pct[i]) / 1000.0);
+        line += buff;
+      }
+      snprintf(buff, sizeof(buff), " max: %.3f", h[k]->max() / 1000.0);
+      line += buff;
+    }
+    rvs::lp::Log(line, loglevel);
+
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), loglevel, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "transfer_ix",
+                           std::to_string(pWorker->get_transfer_ix()));
+        rvs::lp::AddString(pjson, "transfer_num",
+                           std::to_string(pWorker->get_transfer_num()));
+        rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+        rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+        rvs::lp::AddString(pjson, "pingpong", "true");
+        rvs::lp::AddInt(pjson, "size", static_cast<int>(it->first));
+        rvs::lp::AddString(pjson, "round trips",
+                           std::to_string(h[1]->count()));
+        for (int k = 0; k < 2; k++) {
+          for (size_t i = 0; i < pct_num; i++) {
+            snprintf(buff, sizeof(buff), "%.3f",
+                     h[k]->percentile(pct[i]) / 1000.0);
+            rvs::lp::AddString(pjson, std::string(kind[k]) + " "
+                               + pct_name[i] + " (us)", buff);
+          }
+          snprintf(buff, sizeof(buff), "%.3f", h[k]->max() / 1000.0);
+          rvs::lp::AddString(pjson, std::string(kind[k]) + " max (us)", buff);
+        }
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print results of all-to-all run
+ *
+ * Compares bandwidth each transfer reached with all transfers running
+ * concurrently to bandwidth it reached alone (see run_isolated()). Prints
+ * NxN matrix of concurrent bandwidth, aggregate and bisection bandwidth,
+ * and contention factor of every link on transfer paths. Results are also
+ * written as CSV if 'all_to_all_csv' key is given.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_all_to_all() {
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[128];
+  rvs::Contention contention;
+
+  for (size_t i = 0; i < test_array.size(); i++) {
+    // totals are still needed by print_final_average()
+    test_array[i]->get_final_data(&src_node, &dst_node, &bidir,
+                                  &current_size, &duration, false);
+    double concurrent = 0;
+    if (duration > 0) {
+      concurrent = current_size / duration / 1000 / 1000 / 1000;
+      if (bidir) {
+        concurrent *= 2;
+      }
+    }
+    double isolated = i < isolated_bw.size() ? isolated_bw[i] : 0;
+
+    if (rvs::gpulist::node2gpu(src_node, &src_id) ||
+        rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      msg = "could not find GPU id for nodes " + std::to_string(src_node)
+          + " " + std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    uint32_t distance = 0;
+    std::vector<rvs::linkinfo_t> path;
+    rvs::hsa::Get()->GetLinkInfo(src_node, dst_node, &distance, &path);
+
+    if (!bidir) {
+      contention.add(src_id, dst_id, src_node, dst_node, path,
+                     isolated, concurrent);
+      continue;
+    }
+
+    // bidirectional transfer loads paths in both directions equally
+    std::vector<rvs::linkinfo_t> rpath;
+    rvs::hsa::Get()->GetLinkInfo(dst_node, src_node, &distance, &rpath);
+    contention.add(src_id, dst_id, src_node, dst_node, path,
+                   isolated / 2, concurrent / 2);
+    contention.add(dst_id, src_id, dst_node, src_node, rpath,
+                   isolated / 2, concurrent / 2);
+  }
+
+  const std::vector<uint16_t>& ids = contention.ids();
+  std::vector<std::vector<double>> matrix;
+  contention.matrix(&matrix);
+
+  msg = "[" + action_name + "] p2p-all-to-all  src\\dst";
+  for (auto id : ids) {
+    msg += " " + std::to_string(id);
+  }
+  rvs::lp::Log(msg, rvs::logresults);
+
+  unsigned int sec;
+  unsigned int usec;
+  void* pjson = nullptr;
+  if (bjson) {
+    rvs::lp::get_ticks(&sec, &usec);
+    pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+  }
+
+  for (size_t i = 0; i < ids.size(); i++) {
+    std::string row;
+    for (size_t j = 0; j < ids.size(); j++) {
+      if (matrix[i][j] >= 0) {
+        snprintf(buff, sizeof(buff), "%.3f", matrix[i][j]);
+      } else {
+        snprintf(buff, sizeof(buff), "-");
+      }
+      row += std::string(j ? " " : "") + buff;
+    }
+    msg = "[" + action_name + "] p2p-all-to-all  " + std::to_string(ids[i])
+        + "  GBps: " + row;
+    rvs::lp::Log(msg, rvs::logresults);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "src " + std::to_string(ids[i]) + " (GBps)",
+                         row);
+    }
+  }
+
+  std::vector<uint16_t> half;
+  double aggregate = contention.aggregate();
+  double bisection = contention.bisection(&half);
+  std::string shalf;
+  for (auto id : half) {
+    shalf += std::string(shalf.empty() ? "" : " ") + std::to_string(id);
+  }
+  snprintf(buff, sizeof(buff), "aggregate: %.3f GBps  bisection: %.3f GBps",
+           aggregate, bisection);
+  msg = "[" + action_name + "] p2p-all-to-all  " + buff
+      + "  bisection half: " + shalf;
+  rvs::lp::Log(msg, rvs::logresults);
+
+  if (pjson != NULL) {
+    snprintf(buff, sizeof(buff), "%.3f", aggregate);
+    rvs::lp::AddString(pjson, "aggregate (GBps)", buff);
+    snprintf(buff, sizeof(buff), "%.3f", bisection);
+    rvs::lp::AddString(pjson, "bisection (GBps)", buff);
+    rvs::lp::AddString(pjson, "bisection half", shalf);
+    rvs::lp::LogRecordFlush(pjson);
+  }
+
+  std::vector<rvs::Contention::Link> links;
+  contention.links(&links);
+  for (auto it = links.begin(); it != links.end(); ++it) {
+    snprintf(buff, sizeof(buff),
+             "  isolated: %.3f GBps  concurrent: %.3f GBps  contention: %.3f",
+             it->isolated, it->concurrent, it->factor);
+    msg = "[" + action_name + "] p2p-all-to-all-link  " + it->name
+        + "  transfers: " + std::to_string(it->transfers) + buff;
+    rvs::lp::Log(msg, rvs::logresults);
+
+    if (bjson) {
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjlink = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjlink != NULL) {
+        rvs::lp::AddString(pjlink, "link", it->name);
+        rvs::lp::AddInt(pjlink, "transfers", static_cast<int>(it->transfers));
+        snprintf(buff, sizeof(buff), "%.3f", it->isolated);
+        rvs::lp::AddString(pjlink, "isolated (GBps)", buff);
+        snprintf(buff, sizeof(buff), "%.3f", it->concurrent);
+        rvs::lp::AddString(pjlink, "concurrent (GBps)", buff);
+        snprintf(buff, sizeof(buff), "%.3f", it->factor);
+        rvs::lp::AddString(pjlink, "contention", buff);
+        rvs::lp::LogRecordFlush(pjlink);
+      }
+    }
+  }
+
+  if (!all_to_all_csv.empty()) {
+    std::ofstream csv(all_to_all_csv);
+    if (!csv) {
+      msg = "could not open '" + all_to_all_csv + "' for writing";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    contention.write_csv(csv);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print average time and bandwidth of a collective
+ *
+ * @param Coll collective
+ * @param Duration total duration of all runs (sec)
+ * @param Count number of runs
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_collective(const rvs::Collective& Coll,
+                                 double Duration, uint64_t Count) {
+  std::string msg;
+  std::string ranks;
+  char buff[128];
+
+  for (auto node : Coll.ranks()) {
+    uint16_t id;
+    if (rvs::gpulist::node2gpu(node, &id)) {
+      msg = "could not find GPU id for node " + std::to_string(node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    ranks += std::string(ranks.empty() ? "" : " ") + std::to_string(id);
+  }
+
+  double avg = Count > 0 ? Duration / Count : 0;
+  double algbw = Coll.alg_bandwidth(avg);
+  double busbw = Coll.bus_bandwidth(avg);
+
+  snprintf(buff, sizeof(buff),
+           "  time: %.3f us  algbw: %.3f GBps  busbw: %.3f GBps",
+           avg * 1e6, algbw, busbw);
+  msg = "[" + action_name + "] p2p-collective  "
+      + rvs::Collective::name(Coll.kind()) + "  ranks: " + ranks
+      + "  size: " + std::to_string(Coll.size())
+      + "  chunks: " + std::to_string(Coll.chunks())
+      + "  iterations: " + std::to_string(Count) + buff;
+  rvs::lp::Log(msg, rvs::logresults);
+
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "collective",
+                         rvs::Collective::name(Coll.kind()));
+      rvs::lp::AddString(pjson, "ranks", ranks);
+      rvs::lp::AddInt(pjson, "size", static_cast<int>(Coll.size()));
+      rvs::lp::AddInt(pjson, "chunks", Coll.chunks());
+      rvs::lp::AddString(pjson, "iterations", std::to_string(Count));
+      snprintf(buff, sizeof(buff), "%.3f", avg * 1e6);
+      rvs::lp::AddString(pjson, "time (us)", buff);
+      snprintf(buff, sizeof(buff), "%.3f", algbw);
+      rvs::lp::AddString(pjson, "algbw (GBps)", buff);
+      snprintf(buff, sizeof(buff), "%.3f", busbw);
+      rvs::lp::AddString(pjson, "busbw (GBps)", buff);
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief timer callback used to signal end of test
+ *
+ * timer callback used to signal end of test and to initiate
+ * calculation of final average
+ *
+ * */
+void pqt_action::do_final_average() {
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  rvs::lp::get_ticks(&sec, &usec);
+
+  msg = "[" + action_name + "] pqt in do_final_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "message", "pqt in do_final_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  brun = false;
+
+  // signal worker threads to stop
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->stop();
+  }
+}
+
+/**
+ * @brief timer callback used to signal end of log interval
+ *
+ * timer callback used to signal end of log interval and to initiate
+ * calculation of moving average
+ *
+ * */
+void pqt_action::do_running_average() {
+  unsigned int sec;
+  unsigned int usec;
+  std::string msg;
+
+  rvs::lp::get_ticks(&sec, &usec);
+  msg = "[" + action_name + "] pqt in do_running_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson,
+                         "message",
+                         "in do_running_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+  print_running_average();
+}
@@ -0,0 +1,472 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+extern "C" {
+#include <pci/pci.h>
+#include <linux/pci.h>
+}
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "include/rvs_key_def.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvstimer.h"
+
+#include "include/rvs_module.h"
+#include "include/worker.h"
+
+
+#define MODULE_NAME "pqt"
+#define MODULE_NAME_CAPS "PQT"
+
+using std::string;
+using std::vector;
+
+uint64_t test_duration;
+
+/**
+ * @brief computes the difference (in milliseconds) between 2 points in time
+ * @param t_end second point in time
+ * @param t_start first point in time
+ * @return time difference in milliseconds
+ */
+uint64_t time_diff(
+                std::chrono::time_point<std::chrono::system_clock> t_end,
+                std::chrono::time_point<std::chrono::system_clock> t_start) {
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            t_end - t_start);
+    return milliseconds.count();
+}
+
+
+/**
+ * @brief Main action execution entry point. Implements test logic.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run() {
+  int sts;
+  string msg;
+  std::chrono::time_point<std::chrono::system_clock> pqt_start_time;
+  std::chrono::time_point<std::chrono::system_clock> pqt_end_time;
+
+  rvs::lp::Log("int pqt_action::run()", rvs::logtrace);
+
+  if (property.find("cli.-j") != property.end()) {
+    bjson = true;
+  }
+
+  if (!get_all_common_config_keys()) {
+    msg = "Error in get_all_common_config_keys()";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  if (!get_all_pqt_config_keys()) {
+    msg = "Error in get_all_pqt_config_keys()";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  // log_interval must be less than duration
+  if (property_log_interval > 0 && property_duration > 0) {
+    if (static_cast<uint64_t>(property_log_interval) > property_duration) {
+      msg = "log_interval must be less than duration";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+  }
+
+  test_duration = property_duration;
+ 
+  sts = create_threads();
+  if (sts) {
+    RVSTRACE_
+    return sts;
+  }
+
+  if (!prop_test_bandwidth || test_array.size() < 1) {
+    RVSTRACE_
+    // do cleanup
+    destroy_threads();
+    return 0;
+  }
+
+  // collective replaces pair transfers
+  if (!collective.empty()) {
+    sts = run_collective();
+    destroy_threads();
+    return sts;
+  }
+
+  RVSTRACE_
+  // define timers
+  rvs::timer<pqt_action> timer_running(&pqt_action::do_running_average, this);
+  rvs::timer<pqt_action> timer_final(&pqt_action::do_final_average, this);
+
+  unsigned int iter = property_count > 0 ? property_count : 1;
+  unsigned int step = 1;
+
+  // rounds of link-disjoint transfers share the duration
+  bool bscheduled = link_schedule && property_parallel && !all_to_all;
+  if (bscheduled) {
+    sts = build_schedule();
+    if (sts || rounds.empty()) {
+      destroy_threads();
+      return sts;
+    }
+    test_duration = property_duration / rounds.size();
+  }
+
+  // reference bandwidth of every transfer running alone
+  if (all_to_all) {
+    sts = run_isolated();
+    if (sts) {
+      destroy_threads();
+      return sts;
+    }
+  }
+
+  do {
+    RVSTRACE_
+    // let the test run in this iteration
+    brun = true;
+
+    // every iteration sweeps sizes from the beginning
+    for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+      if ((*it)->is_adaptive()) {
+        (*it)->start_sweep();
+      }
+    }
+
+    // start timers
+    if (property_duration) {
+      RVSTRACE_
+      timer_final.start(property_duration, true);  // ticks only once
+    }
+
+    if (property_log_interval) {
+      RVSTRACE_
+      timer_running.start(property_log_interval);        // ticks continuously
+    }
+
+    pqt_start_time = std::chrono::system_clock::now();
+
+    RVSTRACE_
+    do {
+      if (bscheduled) {
+        sts = run_scheduled();
+      } else if (property_parallel || all_to_all) {
+        sts = run_parallel();
+      } else {
+        sts = run_single();
+      }
+      pqt_end_time = std::chrono::system_clock::now();
+      uint64_t test_time = time_diff(pqt_end_time, pqt_start_time) ;
+      if(test_time >= property_duration) {
+          pqt_action::do_final_average();
+          break;
+      }
+      // adaptive sweep may finish before duration elapses
+      if (sweep_done()) {
+          pqt_action::do_final_average();
+          break;
+      }
+    } while (brun);
+
+    RVSTRACE_
+    timer_running.stop();
+    timer_final.stop();
+
+    iter -= step;
+
+    // insert wait between runs if needed
+    if (iter > 0 && property_wait > 0) {
+      RVSTRACE_
+      sleep(property_wait);
+    }
+  } while (iter && !rvs::lp::Stopping());
+
+  RVSTRACE_
+  sts = rvs::lp::Stopping() ? -1 : 0;
+
+  // needs concurrent totals which are reset by print_final_average()
+  if (all_to_all) {
+    print_all_to_all();
+  }
+  print_final_average();
+
+
+  // do cleanup
+  destroy_threads();
+
+  return sts;
+}
+
+
+/**
+ * @brief Execute test transfers one by one, in round robin fashion, for the
+ * duration of the action.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_single() {
+  RVSTRACE_
+  int sts = 0;
+
+  // iterate through test array and invoke tests one by one
+  for (auto it = test_array.begin(); brun && it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->do_transfer();
+
+    // if log interval is zero, print current results immediately
+    if (property_log_interval == 0) {
+      print_running_average(*it);
+    }
+
+    if (rvs::lp::Stopping()) {
+      RVSTRACE_
+      brun = false;
+      sts = -1;
+      break;
+    }
+  }
+
+  return sts;
+}
+
+/**
+ * @brief Execute every test transfer once, one at a time, and store
+ * its bandwidth as reference for all-to-all contention.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_isolated() {
+  RVSTRACE_
+  uint16_t src_node, dst_node;
+  bool     bidir;
+  size_t   current_size;
+  double   duration;
+
+  isolated_bw.clear();
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->do_transfer();
+
+    // isolated transfer must not count into concurrent totals
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration);
+    double bandwidth = 0;
+    if (duration > 0) {
+      bandwidth = current_size / duration / 1000 / 1000 / 1000;
+      if (bidir) {
+        bandwidth *= 2;
+      }
+    }
+    isolated_bw.push_back(bandwidth);
+
+    if (rvs::lp::Stopping()) {
+      RVSTRACE_
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Run collective operation among all GPUs of the test transfers
+ *
+ * Ranks are GPUs taking part in at least one transfer, ordered into a ring
+ * by rvs::Collective::ring_order(). The collective is run once for every
+ * block size in turn, repeatedly for the duration of the action.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_collective() {
+  RVSTRACE_
+  std::string msg;
+  uint16_t src_node, dst_node;
+  bool     bidir;
+  size_t   current_size;
+  double   duration;
+
+  std::vector<uint32_t> nodes;
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration, false);
+    nodes.push_back(src_node);
+    nodes.push_back(dst_node);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  if (nodes.size() < 2) {
+    msg = "collective needs at least two GPUs";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  std::vector<uint32_t> ring;
+  rvs::Collective::ring_order(rvs::hsa::Get()->GetTopology(), nodes, &ring);
+
+  std::vector<uint32_t> sizes(block_size);
+  if (sizes.empty()) {
+    sizes = rvs::hsa::Get()->size_list;
+  }
+
+  int kind = rvs::Collective::parse(collective);
+  std::vector<rvs::Collective> colls;
+  size_t max_size = 0;
+  size_t max_steps = 0;
+  for (auto size : sizes) {
+    rvs::Collective coll;
+    if (coll.build(kind, ring, size, collective_chunks)) {
+      msg = "[" + action_name + "] " + collective + " skipping size "
+          + std::to_string(size);
+      rvs::lp::Log(msg, rvs::loginfo);
+      continue;
+    }
+    max_size = std::max(max_size, coll.size());
+    max_steps = std::max(max_steps, coll.steps().size());
+    colls.push_back(coll);
+  }
+  if (colls.empty()) {
+    msg = "no valid size for collective";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  // every copy of the schedule needs peer access
+  for (auto it = colls[0].steps().begin(); it != colls[0].steps().end();
+       ++it) {
+    if (rvs::hsa::Get()->GetPeerStatus(ring[it->src], ring[it->dst]) == 0) {
+      msg = "nodes " + std::to_string(ring[it->src]) + " and "
+          + std::to_string(ring[it->dst]) + " are not peers";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+  }
+
+  rvs::HsaCollectiveEngine engine(rvs::hsa::Get());
+  if (engine.initialize(ring, max_size, max_steps)) {
+    msg = "could not allocate collective buffers";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  std::vector<double> total(colls.size(), 0);
+  uint64_t count = 0;
+  auto start_time = std::chrono::system_clock::now();
+  do {
+    for (size_t i = 0; i < colls.size(); i++) {
+      if (colls[i].run(&engine, &duration)) {
+        msg = collective + " failed for size "
+            + std::to_string(colls[i].size());
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+      total[i] += duration;
+    }
+    count++;
+    if (rvs::lp::Stopping()) {
+      return -1;
+    }
+  } while (time_diff(std::chrono::system_clock::now(), start_time)
+           < property_duration);
+
+  for (size_t i = 0; i < colls.size(); i++) {
+    print_collective(colls[i], total[i], count);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Execute test transfers all at once, for the
+ * duration of the action.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_parallel() {
+  RVSTRACE_
+
+  // start all worker threads
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->start();
+  }
+
+  // join all worker threads
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->join();
+  }
+
+  return rvs::lp::Stopping() ? -1 : 0;
+}
+
+/**
+ * @brief Execute rounds of link-disjoint test transfers one after another,
+ * transfers of a round all at once.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_scheduled() {
+  RVSTRACE_
+
+  for (auto round = rounds.begin(); brun && round != rounds.end(); ++round) {
+    // start worker threads of this round
+    for (auto t : *round) {
+      test_array[t]->start();
+    }
+
+    // join worker threads of this round
+    for (auto t : *round) {
+      test_array[t]->join();
+    }
+
+    if (rvs::lp::Stopping()) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
@@ -0,0 +1,470 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/worker.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <pci/pci.h>
+#include <linux/pci.h>
+#ifdef __cplusplus
+}
+#endif
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+#include "include/rvs_module.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvspingpong.h"
+#define MODULE_NAME "PQT"
+
+
+pqtworker::pqtworker() {
+  // set to 'true' so that do_transfer() will also work
+  // when parallel: false
+  brun = true;
+  queue_depth = 1;
+  adaptive = false;
+  adaptive_tolerance = RVS_SWEEP_TOLERANCE;
+  latency = false;
+  latency_rounds = RVS_PINGPONG_ROUNDS;
+}
+pqtworker::~pqtworker() {}
+
+extern uint64_t time_diff(
+                std::chrono::time_point<std::chrono::system_clock> t_end,
+                std::chrono::time_point<std::chrono::system_clock> t_start);
+extern uint64_t test_duration;
+ 
+/**
+ * @brief Thread function
+ *
+ * Loops while brun == TRUE and performs polled monitoring avery 1msec.
+ *
+ * */
+void pqtworker::run() {
+  std::chrono::time_point<std::chrono::system_clock> pqt_start_time;
+  std::chrono::time_point<std::chrono::system_clock> pqt_end_time;
+
+  rvs::lp::LogLazy(rvs::logdebug, "[", action_name, "] pqt thread ",
+                   src_node, " ", dst_node, " has started");
+
+  brun = true;
+
+  pqt_start_time = std::chrono::system_clock::now();
+  do {
+      do_transfer();
+
+      pqt_end_time = std::chrono::system_clock::now();
+
+      uint64_t test_time = time_diff(pqt_end_time, pqt_start_time) ;
+
+      if(test_time >= test_duration) {
+          break;
+      }
+      if (sweep_done()) {
+        break;
+      }
+   } while (brun);
+
+  rvs::lp::LogLazy(rvs::logdebug, "[", action_name, "] pqt thread ",
+                   src_node, " ", dst_node, " has finished");
+}
+
+/**
+ * @brief Stop processing
+ *
+ * Sets brun member to FALSE thus signaling end of processing.
+ * Then it waits for std::thread to exit before returning.
+ *
+ * */
+void pqtworker::stop() {
+  rvs::lp::LogLazy(rvs::logtrace, "[", stop_action_name, "] pqt transfer ",
+                   src_node, " ", dst_node, " in pqtworker::stop()");
+
+  brun = false;
+}
+
+/**
+ * @brief Init worker object and set transfer parameters
+ *
+ * @param Src source NUMA node
+ * @param Dst destination NUMA node
+ * @param Bidirect 'true' for bidirectional transfer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqtworker::initialize(uint16_t Src, uint16_t Dst, bool Bidirect) {
+  src_node = Src;
+  dst_node = Dst;
+  bidirect = Bidirect;
+  pHsa = rvs::hsa::Get();
+
+  running_size = 0;
+  running_duration = 0;
+
+  total_size = 0;
+  total_duration = 0;
+
+  return 0;
+}
+
+/**
+ * @brief Executes data transfer
+ *
+ * Based on transfer parameters, initiates and performs one way or
+ * bidirectional data transfer. Resulting measurements are compounded in running
+ * totals for periodical printout during the test.
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqtworker::do_transfer() {
+  double duration;
+  int sts;
+  unsigned int startsec;
+  unsigned int startusec;
+  unsigned int endsec;
+  unsigned int endusec;
+  std::string msg;
+
+  if (latency) {
+    return do_pingpong();
+  }
+
+  rvs::lp::get_ticks(&startsec, &startusec);
+
+  if (block_size.size() == 0) {
+    block_size = pHsa->size_list;
+  }
+
+  std::vector<size_t> sizes;
+  std::vector<rvs::AtomicHistogram*> hist;
+  {
+    std::lock_guard<std::mutex> lk(cntmutex);
+    if (adaptive) {
+      sweep.pending(&sizes);
+    } else {
+      sizes.assign(block_size.begin(), block_size.end());
+    }
+    for (size_t i = 0; i < sizes.size(); i++) {
+      hist.push_back(get_recorder(sizes[i]));
+    }
+  }
+
+  for (size_t i = 0; brun && i < sizes.size(); i++) {
+    current_size = sizes[i];
+    sts = pHsa->SendTraffic(src_node, dst_node, current_size,
+                            bidirect, &duration, queue_depth);
+
+    if (sts) {
+      msg = "internal error, src: " + std::to_string(src_node)
+                + "   dst: " + std::to_string(dst_node)
+                + "   current size: " + std::to_string(current_size);
+      rvs::lp::Err(msg, MODULE_NAME, action_name);
+      return sts;
+    }
+
+    hist[i]->record(static_cast<uint64_t>(duration * 1e9));
+    {
+      std::lock_guard<std::mutex> lk(cntmutex);
+      running_size += current_size * queue_depth;
+      running_duration += duration;
+      if (adaptive) {
+        sweep.add(current_size, duration);
+      }
+    }
+  }
+
+  rvs::lp::get_ticks(&endsec, &endusec);
+  rvs::lp::LogLazyExt(rvs::logdebug, startsec, startusec, "[", action_name,
+                      "] pqt transfer ", src_node, " ", dst_node, " start");
+  rvs::lp::LogLazyExt(rvs::logdebug, endsec, endusec, "[", action_name,
+                      "] pqt transfer ", src_node, " ", dst_node, " finish");
+
+  return 0;
+}
+
+/**
+ * @brief Measures small message latency
+ *
+ * Runs one chain of ping-pong round trips for every message size and adds
+ * results to running totals. Sizes are taken from block_size if given,
+ * otherwise powers of two from 4B to 64KB are used.
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqtworker::do_pingpong() {
+  int sts;
+  std::string msg;
+  std::vector<uint32_t> sizes(block_size);
+
+  if (sizes.size() == 0) {
+    rvs::PingPong::default_sizes(&sizes);
+  }
+
+  for (size_t i = 0; brun && i < sizes.size(); i++) {
+    current_size = sizes[i];
+    rvs::Histogram oneway;
+    rvs::Histogram roundtrip;
+    sts = pHsa->SendPingPong(src_node, dst_node, current_size,
+                             latency_rounds, &oneway, &roundtrip);
+    if (sts) {
+      msg = "internal error, src: " + std::to_string(src_node)
+                + "   dst: " + std::to_string(dst_node)
+                + "   current size: " + std::to_string(current_size);
+      rvs::lp::Err(msg, MODULE_NAME, action_name);
+      return sts;
+    }
+
+    std::lock_guard<std::mutex> lk(cntmutex);
+    running_oneway[current_size].merge(oneway);
+    running_roundtrip[current_size].merge(roundtrip);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Get running cumulatives for data trnasferred and time ellapsed
+ *
+ * @param Src [out] source NUMA node
+ * @param Dst [out] destination NUMA node
+ * @param Bidirect [out] 'true' for bidirectional transfer
+ * @param Size [out] cumulative size of transferred data in this sampling
+ * interval (in bytes)
+ * @param Duration [out] cumulative duration of transfers in this sampling
+ * interval (in seconds)
+ * @param pHist [out] optional, per size transfer time (nsec) histograms
+ * in this sampling interval
+ *
+ * */
+void pqtworker::get_running_data(uint16_t* Src,  uint16_t* Dst, bool* Bidirect,
+                             size_t* Size, double* Duration,
+                             rvs::HistogramMap* pHist) {
+  // lock data until totalling has finished
+  std::lock_guard<std::mutex> lk(cntmutex);
+
+  // update total
+  total_size += running_size;
+  total_duration += running_duration;
+
+  rvs::HistogramMap interval;
+  drain_recorders(&interval);
+  rvs::merge(interval, &total_hist);
+  if (pHist) {
+    pHist->swap(interval);
+  }
+
+  *Src = src_node;
+  *Dst = dst_node;
+  *Bidirect = bidirect;
+  *Size = running_size;
+  *Duration = running_duration;
+
+  // reset running totas
+  running_size = 0;
+  running_duration = 0;
+}
+
+/**
+ * @brief Get final cumulatives for data trnasferred and time ellapsed
+ *
+ * @param Src [out] source NUMA node
+ * @param Dst [out] destination NUMA node
+ * @param Bidirect [out] 'true' for bidirectional transfer
+ * @param Size [out] cumulative size of transferred data in
+ * this test (in bytes)
+ * @param Duration [out] cumulative duration of transfers in
+ * this test (in seconds)
+ * @param bReset [in] if 'true' set final totals to zero
+ * @param pHist [out] optional, per size transfer time (nsec) histograms
+ * in this test
+ *
+ * */
+void pqtworker::get_final_data(uint16_t* Src,  uint16_t* Dst, bool* Bidirect,
+                           size_t* Size, double* Duration, bool bReset,
+                           rvs::HistogramMap* pHist) {
+  // lock data until totalling has finished
+  std::lock_guard<std::mutex> lk(cntmutex);
+
+  // update total
+  total_size += running_size;
+  total_duration += running_duration;
+
+  drain_recorders(&total_hist);
+  if (pHist) {
+    *pHist = total_hist;
+  }
+
+  *Src = src_node;
+  *Dst = dst_node;
+  *Bidirect = bidirect;
+  *Size = total_size;
+  *Duration = total_duration;
+
+  // reset running totas
+  running_size = 0;
+  running_duration = 0;
+
+  // reset final totals
+  if (bReset) {
+    total_size = 0;
+    total_duration = 0;
+    total_hist.clear();
+  }
+}
+
+/**
+ * @brief (Re)starts adaptive size sweep
+ *
+ * Sweep starts from configured block sizes (or default size list if none
+ * are configured).
+ *
+ * */
+void pqtworker::start_sweep() {
+  if (block_size.size() == 0) {
+    block_size = pHsa->size_list;
+  }
+
+  std::lock_guard<std::mutex> lk(cntmutex);
+  sweep.initialize(block_size, adaptive_tolerance);
+}
+
+/**
+ * @brief Check if adaptive size sweep has finished
+ *
+ * @return 'true' if adaptive sweep is enabled and all sizes have settled
+ *
+ * */
+bool pqtworker::sweep_done() {
+  std::lock_guard<std::mutex> lk(cntmutex);
+  return adaptive && sweep.done();
+}
+
+/**
+ * @brief Get results of adaptive size sweep
+ *
+ * @return measured sizes in increasing order
+ *
+ * */
+std::vector<rvs::SizeSweep::Point> pqtworker::get_sweep_points() {
+  std::lock_guard<std::mutex> lk(cntmutex);
+  return sweep.points();
+}
+
+/**
+ * @brief Get transfer time recorder for given size
+ *
+ * Recorder is created on first use. Caller must hold cntmutex.
+ *
+ * @param Size transfer size in bytes
+ * @return ptr to recorder, valid for the lifetime of this worker
+ *
+ * */
+rvs::AtomicHistogram* pqtworker::get_recorder(size_t Size) {
+  std::unique_ptr<rvs::AtomicHistogram>& p = recorder[Size];
+  if (!p) {
+    p.reset(new rvs::AtomicHistogram);
+  }
+  return p.get();
+}
+
+/**
+ * @brief Move transfer times recorded so far into histograms
+ *
+ * Caller must hold cntmutex.
+ *
+ * @param pHist [out] per size histograms recorded times are added to
+ *
+ * */
+void pqtworker::drain_recorders(rvs::HistogramMap* pHist) {
+  for (auto it = recorder.begin(); it != recorder.end(); ++it) {
+    rvs::Histogram interval;
+    it->second->drain(&interval);
+    if (interval.count() > 0) {
+      (*pHist)[it->first].merge(interval);
+    }
+  }
+}
+
+/**
+ * @brief Get ping-pong latencies measured in this sampling interval
+ *
+ * @param pOneWay [out] per size one-way latency (nsec) histograms
+ * @param pRoundTrip [out] per size round trip latency (nsec) histograms
+ *
+ * */
+void pqtworker::get_running_pingpong(rvs::HistogramMap* pOneWay,
+                                     rvs::HistogramMap* pRoundTrip) {
+  std::lock_guard<std::mutex> lk(cntmutex);
+
+  // update total
+  rvs::merge(running_oneway, &total_oneway);
+  rvs::merge(running_roundtrip, &total_roundtrip);
+
+  pOneWay->swap(running_oneway);
+  pRoundTrip->swap(running_roundtrip);
+
+  // reset running totals
+  running_oneway.clear();
+  running_roundtrip.clear();
+}
+
+/**
+ * @brief Get ping-pong latencies measured in this test
+ *
+ * @param pOneWay [out] per size one-way latency (nsec) histograms
+ * @param pRoundTrip [out] per size round trip latency (nsec) histograms
+ * @param bReset [in] if 'true' set final totals to zero
+ *
+ * */
+void pqtworker::get_final_pingpong(rvs::HistogramMap* pOneWay,
+                                   rvs::HistogramMap* pRoundTrip,
+                                   bool bReset) {
+  std::lock_guard<std::mutex> lk(cntmutex);
+
+  // update total
+  rvs::merge(running_oneway, &total_oneway);
+  rvs::merge(running_roundtrip, &total_roundtrip);
+  running_oneway.clear();
+  running_roundtrip.clear();
+
+  *pOneWay = total_oneway;
+  *pRoundTrip = total_roundtrip;
+
+  // reset final totals
+  if (bReset) {
+    total_oneway.clear();
+    total_roundtrip.clear();
+  }
+}
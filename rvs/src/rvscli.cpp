@@ -135,6 +135,13 @@ void rvs::cli::init_grammar() {
   grammar.insert(gpair("-a", sp));
   grammar.insert(gpair("--appendLog", sp));
 
+  sp = std::make_shared<optbase>("-b", command);
+  grammar.insert(gpair("-b", sp));
+  grammar.insert(gpair("--bufferedLog", sp));
+
+  sp = std::make_shared<optbase>("-bin", command);
+  grammar.insert(gpair("--binaryLog", sp));
+
   sp = std::make_shared<optbase>("-c", command, value);
   grammar.insert(gpair("-c", sp));
   grammar.insert(gpair("--config", sp));
@@ -162,6 +169,16 @@ void rvs::cli::init_grammar() {
   grammar.insert(gpair("-l", sp));
   grammar.insert(gpair("--debugLogFile", sp));
 
+  sp = std::make_shared<optbase>("-rs", command, value);
+  grammar.insert(gpair("--logRotateSize", sp));
+
+  sp = std::make_shared<optbase>("-rt", command, value);
+  grammar.insert(gpair("--logRotateTime", sp));
+
+  sp = std::make_shared<optbase>("-n", command);
+  grammar.insert(gpair("-n", sp));
+  grammar.insert(gpair("--ndjson", sp));
+
   sp = std::make_shared<optbase>("-q", command);
   grammar.insert(gpair("-q", sp));
   grammar.insert(gpair("--quiet", sp));
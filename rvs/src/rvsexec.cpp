@@ -113,6 +113,16 @@ int rvs::exec::run() {
     logger::append(true);
   }
 
+  // check -b option
+  if (rvs::options::has_option("-b", &val)) {
+    logger::buffered(true);
+  }
+
+  // check --binaryLog option
+  if (rvs::options::has_option("-bin", &val)) {
+    logger::binary(true);
+  }
+
   // check -l option
   std::string s_log_file;
   if (rvs::options::has_option("-l", &s_log_file)) {
@@ -124,6 +134,44 @@ int rvs::exec::run() {
     logger::to_json(true);
   }
 
+  // check -n option (implies -j)
+  if (rvs::options::has_option("-n", &val)) {
+    logger::to_json(true);
+    logger::ndjson(true);
+  }
+
+  // check --logRotateSize option (in MB)
+  if (rvs::options::has_option("-rs", &val)) {
+    unsigned long size;  // NOLINT
+    try {
+      size = std::stoul(val);
+    }
+    catch(...) {
+      char buff[1024];
+      snprintf(buff, sizeof(buff),
+                "log rotation size not integer: %s", val.c_str());
+      rvs::logger::Err(buff, MODULE_NAME_CAPS);
+      return -1;
+    }
+    logger::rotate_size(static_cast<uint64_t>(size) * 1024 * 1024);
+  }
+
+  // check --logRotateTime option (in minutes)
+  if (rvs::options::has_option("-rt", &val)) {
+    unsigned long minutes;  // NOLINT
+    try {
+      minutes = std::stoul(val);
+    }
+    catch(...) {
+      char buff[1024];
+      snprintf(buff, sizeof(buff),
+                "log rotation time not integer: %s", val.c_str());
+      rvs::logger::Err(buff, MODULE_NAME_CAPS);
+      return -1;
+    }
+    logger::rotate_time(static_cast<uint32_t>(minutes * 60));
+  }
+
   string config_file;
   if (rvs::options::has_option("-c", &val)) {
     config_file = val;
@@ -224,6 +272,12 @@ void rvs::exec::do_help() {
                               "overwrite the contents\n";
   cout << "                   of a current log. Used in conjuction with the"
                                "-d and -l options.\n";
+  cout << "-b --bufferedLog   Buffer log messages per thread and output "
+                              "them from a\n";
+  cout << "                   separate thread in timestamp order.\n";
+  cout << "   --binaryLog     Write log file in compact binary format. Use "
+                              "rvslogconv to\n";
+  cout << "                   convert it to text or JSON log.\n";
   cout << "-c --config        Specify the configuration file to be used.\n";
   cout << "                   The default is <install base>/conf/RVS.conf\n";
   cout << "   --configless    Run RVS in a configless mode. Executes a "
@@ -247,9 +301,23 @@ void rvs::exec::do_help() {
                               "This will produce a log\n";
   cout << "                   file intended for post-run analysis after "
                               "an error.\n";
+  cout << "   --logRotateSize Start new log file when current one reaches "
+                              "the given size\n";
+  cout << "                   in MB. Previous log file is renamed to "
+                              "<logfile>.N and gzip\n";
+  cout << "                   compressed in the background. Each "
+                              "segment is complete.\n";
+  cout << "   --logRotateTime Start new log file after the given number of "
+                              "minutes. See\n";
+  cout << "                   --logRotateSize.\n";
   cout << "   --quiet         No console output given. See logs and return "
                               "code for errors.\n";
   cout << "-m --modulepath    Specify a custom path for the RVS modules.\n";
+  cout << "-n --ndjson        Output JSON records one per line (implies "
+                              "-j). Log file can be\n";
+  cout << "                   appended to and read while RVS is running. "
+                              "Use rvsndjson to\n";
+  cout << "                   convert it to the -j format.\n";
   cout << "   --specifiedtest Run a specific test in a configless mode. "
                               "Multiple word tests\n";
   cout << "                   should be in quotes. This action will default "
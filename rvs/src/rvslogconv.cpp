@@ -0,0 +1,93 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <string.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "include/rvslogbinary.h"
+#include "include/rvsliblogger.h"
+
+#define MODULE_NAME_CAPS "LOGCONV"
+
+/**
+ *
+ * @ingroup Launcher
+ * @brief Main method
+ *
+ * Converts binary log file produced by "rvs --binaryLog -l <file>" into
+ * text log file (or JSON log file if "-j" is given; the binary log must
+ * then have been written with "rvs -j --binaryLog").
+ *
+ * Usage: rvslogconv [-j] <binary log> [<output log>]
+ * If output file is not given, result is printed to standard output.
+ *
+ * @param Argc standard C argc parameter to main()
+ * @param Argv standard C argv parameter to main()
+ * @return 0 - all OK, non-zero error
+ *
+ * */
+int main(int Argc, char** Argv) {
+  bool json = false;
+  int arg = 1;
+
+  if (Argc > 1 && strcmp(Argv[1], "-j") == 0) {
+    json = true;
+    arg++;
+  }
+  if (Argc - arg < 1 || Argc - arg > 2) {
+    std::cerr << "Usage: rvslogconv [-j] <binary log> [<output log>]\n";
+    return -1;
+  }
+
+  std::ifstream in(Argv[arg], std::ios::in | std::ios::binary);
+  if (!in.is_open()) {
+    std::string msg = std::string("could not open ") + Argv[arg];
+    rvs::logger::Err(msg.c_str(), MODULE_NAME_CAPS);
+    return -1;
+  }
+
+  std::ofstream fout;
+  if (Argc - arg == 2) {
+    fout.open(Argv[arg + 1], std::fstream::out | std::fstream::trunc);
+    if (!fout.is_open()) {
+      std::string msg = std::string("could not create ") + Argv[arg + 1];
+      rvs::logger::Err(msg.c_str(), MODULE_NAME_CAPS);
+      return -1;
+    }
+  }
+  std::ostream& out = fout.is_open() ? fout : std::cout;
+
+  int count = 0;
+  int sts = json ? rvs::LogBinaryReader::ToJson(in, out, &count)
+                 : rvs::LogBinaryReader::ToText(in, out, &count);
+  if (sts) {
+    rvs::logger::Err("malformed binary log", MODULE_NAME_CAPS);
+    return -1;
+  }
+
+  return 0;
+}
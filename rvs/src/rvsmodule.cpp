@@ -243,6 +243,7 @@ int rvs::module::initialize() {
   d.cbStop            = rvs::logger::Stop;
   d.cbStopping        = rvs::logger::Stopping;
   d.cbErr             = rvs::logger::Err;
+  d.cbLogLevel        = rvs::logger::log_level;
 
   return (*rvs_module_init)(reinterpret_cast<void*>(&d));
 }
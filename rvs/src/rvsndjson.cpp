@@ -0,0 +1,84 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "include/rvslogndjson.h"
+#include "include/rvsliblogger.h"
+
+#define MODULE_NAME_CAPS "NDJSON"
+
+/**
+ *
+ * @ingroup Launcher
+ * @brief Main method
+ *
+ * Converts NDJSON log file produced by "rvs -j -n -l <file>" into
+ * JSON array log file.
+ *
+ * Usage: rvsndjson <ndjson log> [<json log>]
+ * If output file is not given, result is printed to standard output.
+ *
+ * @param Argc standard C argc parameter to main()
+ * @param Argv standard C argv parameter to main()
+ * @return 0 - all OK, non-zero error
+ *
+ * */
+int main(int Argc, char** Argv) {
+  if (Argc < 2 || Argc > 3) {
+    std::cerr << "Usage: rvsndjson <ndjson log> [<json log>]\n";
+    return -1;
+  }
+
+  std::ifstream in(Argv[1]);
+  if (!in.is_open()) {
+    std::string msg = std::string("could not open ") + Argv[1];
+    rvs::logger::Err(msg.c_str(), MODULE_NAME_CAPS);
+    return -1;
+  }
+
+  std::ofstream fout;
+  if (Argc == 3) {
+    fout.open(Argv[2], std::fstream::out | std::fstream::trunc);
+    if (!fout.is_open()) {
+      std::string msg = std::string("could not create ") + Argv[2];
+      rvs::logger::Err(msg.c_str(), MODULE_NAME_CAPS);
+      return -1;
+    }
+  }
+  std::ostream& out = Argc == 3 ? fout : std::cout;
+
+  int count = 0;
+  if (rvs::LogNdjson::ToArray(in, out, &count)) {
+    rvs::logger::Err("error writing output", MODULE_NAME_CAPS);
+    return -1;
+  }
+  if (Argc == 2) {
+    out << '\n';
+  }
+
+  return 0;
+}
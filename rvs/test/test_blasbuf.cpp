@@ -0,0 +1,167 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <map>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsblasbuf.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// hands out heap memory and keeps track of what is still allocated
+class FakeAllocator : public rvs::BlasAllocator {
+ public:
+  FakeAllocator() : fail_after(-1), calls(0) {}
+
+  void* AllocHost(size_t Size) override {
+    return alloc(&host, Size);
+  }
+  void FreeHost(void* Ptr) override {
+    release(&host, Ptr);
+  }
+  void* AllocDevice(size_t Size) override {
+    return alloc(&device, Size);
+  }
+  void FreeDevice(void* Ptr) override {
+    release(&device, Ptr);
+  }
+
+  size_t total(const std::map<void*, size_t>& Buffers) const {
+    size_t sum = 0;
+    for (auto it = Buffers.begin(); it != Buffers.end(); ++it) {
+      sum += it->second;
+    }
+    return sum;
+  }
+
+  //! number of successful allocations before failing, -1 never fails
+  int fail_after;
+  int calls;
+  std::map<void*, size_t> host;
+  std::map<void*, size_t> device;
+
+ private:
+  void* alloc(std::map<void*, size_t>* pBuffers, size_t Size) {
+    if (fail_after >= 0 && calls >= fail_after) {
+      return nullptr;
+    }
+    calls++;
+    void* ptr = new char[Size];
+    (*pBuffers)[ptr] = Size;
+    return ptr;
+  }
+  void release(std::map<void*, size_t>* pBuffers, void* Ptr) {
+    ASSERT_EQ(pBuffers->count(Ptr), 1u);
+    pBuffers->erase(Ptr);
+    delete [] static_cast<char*>(Ptr);
+  }
+};
+
+}  // namespace
+
+TEST(blasbuf, parse_ops_type) {
+  EXPECT_EQ(rvs::BlasBuffersBase::parse_ops_type("sgemm"), RVS_BLAS_SGEMM);
+  EXPECT_EQ(rvs::BlasBuffersBase::parse_ops_type("dgemm"), RVS_BLAS_DGEMM);
+  EXPECT_EQ(rvs::BlasBuffersBase::parse_ops_type("hgemm"), RVS_BLAS_HGEMM);
+  EXPECT_EQ(rvs::BlasBuffersBase::parse_ops_type(""), -1);
+  EXPECT_EQ(rvs::BlasBuffersBase::parse_ops_type("zgemm"), -1);
+
+  EXPECT_STREQ(rvs::BlasBuffersBase::ops_name(RVS_BLAS_SGEMM), "sgemm");
+  EXPECT_STREQ(rvs::BlasBuffersBase::ops_name(RVS_BLAS_DGEMM), "dgemm");
+  EXPECT_STREQ(rvs::BlasBuffersBase::ops_name(RVS_BLAS_HGEMM), "hgemm");
+}
+
+TEST(blasbuf, single_precision_only) {
+  FakeAllocator alloc;
+  rvs::BlasBuffers<double> buffers(&alloc, 100, 200, 300);
+
+  ASSERT_TRUE(buffers.allocate_host());
+  ASSERT_TRUE(buffers.allocate_device());
+
+  // exactly one host and one device copy of A, B and C
+  EXPECT_EQ(alloc.host.size(), 3u);
+  EXPECT_EQ(alloc.device.size(), 3u);
+  EXPECT_EQ(alloc.total(alloc.host), 600 * sizeof(double));
+  EXPECT_EQ(alloc.total(alloc.device), 600 * sizeof(double));
+
+  EXPECT_EQ(buffers.element_size(), sizeof(double));
+  EXPECT_EQ(buffers.count(RVS_BLAS_MATRIX_B), 200u);
+  EXPECT_EQ(buffers.bytes(RVS_BLAS_MATRIX_C), 300 * sizeof(double));
+  EXPECT_EQ(buffers.bytes(), 600 * sizeof(double));
+
+  EXPECT_EQ(alloc.host[buffers.host_ptr(RVS_BLAS_MATRIX_A)],
+            100 * sizeof(double));
+  EXPECT_EQ(alloc.device[buffers.device_ptr(RVS_BLAS_MATRIX_C)],
+            300 * sizeof(double));
+  buffers.host_data(RVS_BLAS_MATRIX_A)[99] = 1.0;
+
+  buffers.release_device();
+  EXPECT_EQ(alloc.device.size(), 0u);
+  EXPECT_EQ(buffers.device_ptr(RVS_BLAS_MATRIX_A), nullptr);
+  EXPECT_EQ(alloc.host.size(), 3u);
+  buffers.release_host();
+  EXPECT_EQ(alloc.host.size(), 0u);
+}
+
+TEST(blasbuf, half_element_size) {
+  FakeAllocator alloc;
+  // rocblas_half is a 16 bit type
+  rvs::BlasBuffers<uint16_t> buffers(&alloc, 64, 64, 64);
+
+  ASSERT_TRUE(buffers.allocate_host());
+  EXPECT_EQ(alloc.total(alloc.host), 3 * 64 * sizeof(uint16_t));
+  EXPECT_EQ(buffers.bytes(), 3 * 64 * sizeof(uint16_t));
+  buffers.release_host();
+}
+
+TEST(blasbuf, all_or_nothing) {
+  FakeAllocator alloc;
+  rvs::BlasBuffers<float> buffers(&alloc, 10, 10, 10);
+
+  // third allocation fails, first two must be returned
+  alloc.fail_after = 2;
+  EXPECT_FALSE(buffers.allocate_host());
+  EXPECT_EQ(alloc.host.size(), 0u);
+  EXPECT_EQ(buffers.host_ptr(RVS_BLAS_MATRIX_A), nullptr);
+  EXPECT_EQ(buffers.host_ptr(RVS_BLAS_MATRIX_B), nullptr);
+
+  alloc.calls = 0;
+  alloc.fail_after = 1;
+  EXPECT_FALSE(buffers.allocate_device());
+  EXPECT_EQ(alloc.device.size(), 0u);
+
+  // destructor releases whatever is left
+  alloc.fail_after = -1;
+  {
+    rvs::BlasBuffers<float> scoped(&alloc, 10, 10, 10);
+    ASSERT_TRUE(scoped.allocate_host());
+    ASSERT_TRUE(scoped.allocate_device());
+  }
+  EXPECT_EQ(alloc.host.size(), 0u);
+  EXPECT_EQ(alloc.device.size(), 0u);
+}
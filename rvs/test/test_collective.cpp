@@ -0,0 +1,258 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvscollective.h"
+#include "include/rvstopology.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// simulated engine: copy takes 1 ns per byte, starts when its dependencies
+// completed and previous copy over the same link finished
+class SimEngine : public rvs::CollectiveEngine {
+ public:
+  SimEngine() : fail_at(SIZE_MAX), waits(0) {}
+
+  int Submit(size_t Index, const rvs::CollectiveStep& Step) override {
+    if (Index == fail_at) {
+      return -1;
+    }
+    EXPECT_EQ(Index, start.size());
+    uint64_t t = 0;
+    for (auto d : Step.deps) {
+      EXPECT_LT(d, Index);
+      t = std::max(t, end[d]);
+    }
+    uint64_t& link = link_free[std::make_pair(Step.src, Step.dst)];
+    t = std::max(t, link);
+    start.push_back(t);
+    end.push_back(t + Step.size);
+    link = t + Step.size;
+    return 0;
+  }
+
+  int Wait(size_t Index) override {
+    EXPECT_LT(Index, start.size());
+    waits++;
+    return 0;
+  }
+
+  int CopyTime(size_t Index, uint64_t* pStart, uint64_t* pEnd) override {
+    *pStart = start[Index];
+    *pEnd = end[Index];
+    return 0;
+  }
+
+  size_t fail_at;
+  size_t waits;
+  std::vector<uint64_t> start;
+  std::vector<uint64_t> end;
+  std::map<std::pair<int, int>, uint64_t> link_free;
+};
+
+std::vector<uint32_t> nodes(size_t N) {
+  std::vector<uint32_t> v;
+  for (size_t i = 0; i < N; i++) {
+    v.push_back(static_cast<uint32_t>(i + 10));
+  }
+  return v;
+}
+
+// replays schedule and checks that every copy sends data its source
+// already has, either from the start or delivered by one of its
+// dependencies, and that in the end every rank has all data
+void check_data_flow(const rvs::Collective& Coll) {
+  size_t n = Coll.ranks().size();
+  size_t size = Coll.size();
+  std::vector<std::vector<bool>> have(n, std::vector<bool>(size, false));
+  for (size_t b = 0; b < size; b++) {
+    if (Coll.kind() == rvs::Collective::parse("allgather")) {
+      // rank r starts with block r
+      for (size_t r = 0; r < n; r++) {
+        if (b >= size * r / n && b < size * (r + 1) / n) {
+          have[r][b] = true;
+        }
+      }
+    } else {
+      have[0][b] = true;
+    }
+  }
+  std::vector<std::vector<bool>> initial(have);
+
+  const std::vector<rvs::CollectiveStep>& steps = Coll.steps();
+  for (size_t i = 0; i < steps.size(); i++) {
+    const rvs::CollectiveStep& s = steps[i];
+    ASSERT_GT(s.size, 0u);
+    ASSERT_NE(s.src, s.dst);
+    for (size_t b = s.offset; b < s.offset + s.size; b++) {
+      bool ok = initial[s.src][b];
+      for (auto d : s.deps) {
+        ASSERT_LT(d, i);
+        const rvs::CollectiveStep& ds = steps[d];
+        if (ds.dst == s.src && b >= ds.offset && b < ds.offset + ds.size) {
+          ok = true;
+        }
+      }
+      ASSERT_TRUE(ok) << "copy " << i << " sends byte " << b
+                      << " before it arrived";
+      have[s.dst][b] = true;
+    }
+  }
+
+  for (size_t r = 0; r < n; r++) {
+    for (size_t b = 0; b < size; b++) {
+      ASSERT_TRUE(have[r][b]) << "rank " << r << " misses byte " << b;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(collective, data_flow) {
+  for (int kind = RVS_COLL_ALLGATHER; kind <= RVS_COLL_BROADCAST_TREE;
+       kind++) {
+    for (size_t n = 2; n <= 9; n++) {
+      for (int chunks = 1; chunks <= 5; chunks++) {
+        rvs::Collective coll;
+        ASSERT_EQ(coll.build(kind, nodes(n), 101, chunks), 0);
+        SCOPED_TRACE(std::string(rvs::Collective::name(kind)) + " ranks "
+                     + std::to_string(n) + " chunks "
+                     + std::to_string(chunks));
+        check_data_flow(coll);
+        if (kind == RVS_COLL_ALLGATHER) {
+          EXPECT_EQ(coll.steps().size(), (n - 1) * n * chunks);
+        } else {
+          EXPECT_EQ(coll.steps().size(), (n - 1) * chunks);
+        }
+      }
+    }
+  }
+}
+
+TEST(collective, small_size) {
+  rvs::Collective coll;
+  // fewer bytes than chunks, chunk count is reduced
+  ASSERT_EQ(coll.build(RVS_COLL_BROADCAST, nodes(3), 2, 4), 0);
+  EXPECT_EQ(coll.steps().size(), 4u);
+  check_data_flow(coll);
+
+  // all-gather needs at least one byte per rank
+  EXPECT_NE(coll.build(RVS_COLL_ALLGATHER, nodes(3), 2, 1), 0);
+  EXPECT_NE(coll.build(RVS_COLL_ALLGATHER, nodes(1), 100, 1), 0);
+  EXPECT_NE(coll.build(RVS_COLL_BROADCAST, nodes(2), 100, 0), 0);
+  EXPECT_NE(coll.build(7, nodes(2), 100, 1), 0);
+}
+
+TEST(collective, allgather_bandwidth) {
+  // 3 steps of 100 byte blocks, all links busy in parallel
+  rvs::Collective coll;
+  ASSERT_EQ(coll.build(RVS_COLL_ALLGATHER, nodes(4), 400, 1), 0);
+  SimEngine engine;
+  double duration = 0;
+  ASSERT_EQ(coll.run(&engine, &duration), 0);
+  EXPECT_DOUBLE_EQ(duration, 300e-9);
+  EXPECT_NEAR(coll.alg_bandwidth(duration), 400 / 300.0, 1e-9);
+  EXPECT_NEAR(coll.bus_bandwidth(duration), 1.0, 1e-9);
+  EXPECT_EQ(engine.waits, coll.steps().size());
+}
+
+TEST(collective, broadcast_pipelining) {
+  rvs::Collective coll;
+  SimEngine whole;
+  double duration = 0;
+  ASSERT_EQ(coll.build(RVS_COLL_BROADCAST, nodes(4), 400, 1), 0);
+  ASSERT_EQ(coll.run(&whole, &duration), 0);
+  EXPECT_DOUBLE_EQ(duration, 1200e-9);
+
+  // 4 chunks over 3 hops take (4 + 3 - 1) chunk times
+  SimEngine chunked;
+  ASSERT_EQ(coll.build(RVS_COLL_BROADCAST, nodes(4), 400, 4), 0);
+  ASSERT_EQ(coll.run(&chunked, &duration), 0);
+  EXPECT_DOUBLE_EQ(duration, 600e-9);
+  EXPECT_DOUBLE_EQ(coll.bus_factor(), 1);
+
+  // tree of 7 ranks has depth 2, root sends every chunk twice
+  SimEngine tree;
+  ASSERT_EQ(coll.build(RVS_COLL_BROADCAST_TREE, nodes(7), 400, 4), 0);
+  ASSERT_EQ(coll.run(&tree, &duration), 0);
+  EXPECT_DOUBLE_EQ(duration, 500e-9);
+}
+
+TEST(collective, submit_failure) {
+  rvs::Collective coll;
+  ASSERT_EQ(coll.build(RVS_COLL_ALLGATHER, nodes(4), 400, 2), 0);
+  SimEngine engine;
+  engine.fail_at = 5;
+  double duration = -1;
+  EXPECT_NE(coll.run(&engine, &duration), 0);
+  // copies already submitted are waited for
+  EXPECT_EQ(engine.waits, 5u);
+  EXPECT_DOUBLE_EQ(duration, -1);
+}
+
+TEST(collective, ring_order) {
+  // 10-12-11-13 connected by xGMI, all other pairs over PCIe,
+  // 14 not reachable
+  std::vector<uint32_t> n = nodes(5);
+  rvs::Topology topo;
+  topo.reset(n);
+  for (auto a : n) {
+    for (auto b : n) {
+      if (a != b && a != 14 && b != 14) {
+        topo.at(a, b)->peer = 2;
+        topo.at(a, b)->distance = 40;
+      }
+    }
+  }
+  uint32_t near[][2] = {{10, 12}, {12, 11}, {11, 13}};
+  for (auto& p : near) {
+    topo.at(p[0], p[1])->distance = 15;
+    topo.at(p[1], p[0])->distance = 15;
+  }
+
+  std::vector<uint32_t> ring;
+  rvs::Collective::ring_order(topo, n, &ring);
+  std::vector<uint32_t> expected = {10, 12, 11, 13, 14};
+  EXPECT_EQ(ring, expected);
+
+  rvs::Collective::ring_order(topo, std::vector<uint32_t>(), &ring);
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(collective, names) {
+  EXPECT_EQ(rvs::Collective::parse("allgather"), RVS_COLL_ALLGATHER);
+  EXPECT_EQ(rvs::Collective::parse("broadcast"), RVS_COLL_BROADCAST);
+  EXPECT_EQ(rvs::Collective::parse("broadcast_tree"),
+            RVS_COLL_BROADCAST_TREE);
+  EXPECT_EQ(rvs::Collective::parse("allreduce"), -1);
+  EXPECT_STREQ(rvs::Collective::name(RVS_COLL_BROADCAST), "broadcast");
+  EXPECT_STREQ(rvs::Collective::name(-1), "unknown");
+}
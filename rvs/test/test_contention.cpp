@@ -0,0 +1,212 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvscontention.h"
+#include "include/rvslinkmap.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+rvs::linkinfo_t hop(int Type) {
+  rvs::linkinfo_t info;
+  info.distance = 15;
+  info.etype = Type;
+  info.strtype = Type == RVS_LINK_TYPE_XGMI ? "xGMI" :
+                 Type == RVS_LINK_TYPE_PCIE ? "PCIe" : "QPI";
+  return info;
+}
+
+const std::vector<rvs::linkinfo_t> xgmi = {hop(RVS_LINK_TYPE_XGMI)};
+const std::vector<rvs::linkinfo_t> pcie = {hop(RVS_LINK_TYPE_PCIE)};
+
+// exposes bandwidth crossing a partition
+class ContentionProbe : public rvs::Contention {
+ public:
+  using rvs::Contention::crossing;
+};
+
+}  // namespace
+
+TEST(linkmap, path_links) {
+  std::vector<std::string> names;
+
+  rvs::LinkMap::path_links(1, 2, xgmi, &names);
+  ASSERT_EQ(names.size(), 1u);
+  EXPECT_EQ(names[0], "xGMI 1->2");
+
+  rvs::LinkMap::path_links(1, 2, pcie, &names);
+  ASSERT_EQ(names.size(), 2u);
+  EXPECT_EQ(names[0], "PCIe 1 up");
+  EXPECT_EQ(names[1], "PCIe 2 down");
+
+  // repeated hops of one type are one link, QPI is shared fabric
+  std::vector<rvs::linkinfo_t> path = {hop(RVS_LINK_TYPE_PCIE), hop(0),
+                                       hop(RVS_LINK_TYPE_PCIE)};
+  rvs::LinkMap::path_links(1, 2, path, &names);
+  ASSERT_EQ(names.size(), 3u);
+  EXPECT_EQ(names[2], "QPI");
+}
+
+TEST(linkmap, disjoint) {
+  rvs::LinkMap map;
+  size_t a = map.add(1, 2, xgmi);
+  size_t b = map.add(2, 1, xgmi);
+  size_t c = map.add(1, 3, pcie);
+  size_t d = map.add(1, 4, pcie);
+  size_t e = map.add(4, 3, pcie);
+
+  EXPECT_EQ(map.size(), 5u);
+  // xGMI is full duplex
+  EXPECT_TRUE(map.disjoint(a, b));
+  EXPECT_TRUE(map.disjoint(a, c));
+  // same upstream link
+  EXPECT_FALSE(map.disjoint(c, d));
+  // same downstream link
+  EXPECT_FALSE(map.disjoint(c, e));
+  // 4 down and 4 up are different links
+  EXPECT_TRUE(map.disjoint(d, e));
+  EXPECT_EQ(map.link_count(), 6u);
+
+  map.clear();
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.link_count(), 0u);
+}
+
+TEST(contention, matrix) {
+  rvs::Contention c;
+  c.add(3, 1, 13, 11, xgmi, 40, 30);
+  c.add(1, 3, 11, 13, xgmi, 40, 20);
+  c.add(1, 2, 11, 12, xgmi, 40, 10);
+
+  ASSERT_EQ(c.ids().size(), 3u);
+  EXPECT_EQ(c.ids()[0], 1);
+  EXPECT_EQ(c.ids()[2], 3);
+
+  std::vector<std::vector<double>> m;
+  c.matrix(&m);
+  ASSERT_EQ(m.size(), 3u);
+  EXPECT_DOUBLE_EQ(m[0][2], 20);
+  EXPECT_DOUBLE_EQ(m[2][0], 30);
+  EXPECT_DOUBLE_EQ(m[0][1], 10);
+  EXPECT_LT(m[1][0], 0);
+  EXPECT_LT(m[0][0], 0);
+  EXPECT_DOUBLE_EQ(c.aggregate(), 60);
+}
+
+TEST(contention, bidirectional_matrix) {
+  // bidirectional workers (1,2) and (2,1), each added as two halves the
+  // way PQT all-to-all does
+  ContentionProbe c;
+  c.add(1, 2, 11, 12, xgmi, 20, 16);
+  c.add(2, 1, 12, 11, xgmi, 20, 16);
+  c.add(2, 1, 12, 11, xgmi, 20, 12);
+  c.add(1, 2, 11, 12, xgmi, 20, 12);
+  // unidirectional 1 -> 3
+  c.add(1, 3, 11, 13, pcie, 30, 25);
+
+  std::vector<std::vector<double>> m;
+  c.matrix(&m);
+  ASSERT_EQ(m.size(), 3u);
+  EXPECT_DOUBLE_EQ(m[0][1], 28);
+  EXPECT_DOUBLE_EQ(m[1][0], 28);
+  EXPECT_DOUBLE_EQ(m[0][2], 25);
+  EXPECT_LT(m[2][0], 0);
+  EXPECT_LT(m[1][2], 0);
+  EXPECT_LT(m[1][1], 0);
+
+  // matrix, aggregate and crossing agree
+  double sum = 0;
+  for (auto& row : m) {
+    for (double bw : row) {
+      if (bw > 0) {
+        sum += bw;
+      }
+    }
+  }
+  EXPECT_DOUBLE_EQ(c.aggregate(), sum);
+  EXPECT_DOUBLE_EQ(c.aggregate(), 81);
+  // GPU 1 alone against 2 and 3
+  EXPECT_DOUBLE_EQ(c.crossing({true, false, false}),
+                   m[0][1] + m[1][0] + m[0][2]);
+  // GPU 3 alone against 1 and 2
+  EXPECT_DOUBLE_EQ(c.crossing({false, false, true}), m[0][2]);
+}
+
+TEST(contention, bisection) {
+  // ring 0-1-2-3-0, each neighbour pair 10 GBps per direction
+  rvs::Contention c;
+  for (uint16_t i = 0; i < 4; i++) {
+    uint16_t j = (i + 1) % 4;
+    c.add(i, j, i, j, xgmi, 10, 10);
+    c.add(j, i, j, i, xgmi, 10, 10);
+  }
+
+  // cutting ring into two arcs crosses two links in both directions,
+  // {0, 2} | {1, 3} would cross all four
+  std::vector<uint16_t> half;
+  EXPECT_DOUBLE_EQ(c.bisection(&half), 40);
+  ASSERT_EQ(half.size(), 2u);
+  EXPECT_EQ(half[0], 0);
+  EXPECT_NE(half[1], 2);
+
+  rvs::Contention one;
+  one.add(0, 0, 0, 0, xgmi, 1, 1);
+  EXPECT_DOUBLE_EQ(one.bisection(), 0);
+}
+
+TEST(contention, links) {
+  // two transfers from GPU 1 over PCIe share its upstream link
+  rvs::Contention c;
+  c.add(1, 2, 11, 12, pcie, 24, 12);
+  c.add(1, 3, 11, 13, pcie, 24, 12);
+
+  std::vector<rvs::Contention::Link> links;
+  c.links(&links);
+  ASSERT_EQ(links.size(), 3u);
+  EXPECT_EQ(links[0].name, "PCIe 11 up");
+  EXPECT_EQ(links[0].transfers, 2u);
+  EXPECT_DOUBLE_EQ(links[0].isolated, 48);
+  EXPECT_DOUBLE_EQ(links[0].concurrent, 24);
+  EXPECT_DOUBLE_EQ(links[0].factor, 2);
+  EXPECT_DOUBLE_EQ(links[1].factor, 2);
+  EXPECT_EQ(links[1].transfers, 1u);
+
+  std::ostringstream os;
+  c.write_csv(os);
+  std::string csv = os.str();
+  EXPECT_EQ(csv.find("src\\dst,1,2,3\n1,,12.000,12.000\n2,,,\n3,,,\n"), 0u);
+  EXPECT_NE(csv.find("aggregate (GBps),24.000\n"), std::string::npos);
+  EXPECT_NE(csv.find("PCIe 11 up,2,48.000,24.000,2.000\n"),
+            std::string::npos);
+
+  c.clear();
+  EXPECT_EQ(c.transfers().size(), 0u);
+  EXPECT_EQ(c.ids().size(), 0u);
+}
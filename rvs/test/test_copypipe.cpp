@@ -0,0 +1,185 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvscopypipe.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+typedef std::pair<uint64_t, uint64_t> interval_t;
+
+// simulated copy engine: one FIFO engine per direction, host clock advances
+// by submit overhead and while waiting for copies
+class SimEngine : public rvs::CopyEngine {
+ public:
+  SimEngine(int Dirs, int Depth, uint64_t Overhead, uint64_t Latency)
+  : now(0), overhead(Overhead), latency(Latency), submits(0), fail_at(-1),
+    engine_free(Dirs, 0), order(Dirs),
+    busy(Dirs, std::vector<bool>(Depth, false)),
+    times(Dirs, std::vector<interval_t>(Depth)) {}
+
+  int Submit(int Dir, int Slot, size_t Size) override {
+    if (submits++ == fail_at) {
+      return -1;
+    }
+    EXPECT_FALSE(busy[Dir][Slot]) << "slot reused while in flight";
+    now += overhead;
+    uint64_t start = std::max(now, engine_free[Dir]);
+    // 1 byte per ns
+    uint64_t end = start + latency + Size;
+    engine_free[Dir] = end;
+    times[Dir][Slot] = interval_t(start, end);
+    busy[Dir][Slot] = true;
+    order[Dir].push_back(Slot);
+    intervals.push_back(interval_t(start, end));
+    return 0;
+  }
+
+  int Wait(int Dir, int Slot) override {
+    EXPECT_TRUE(busy[Dir][Slot]);
+    EXPECT_EQ(order[Dir].front(), Slot) << "copies not completed in order";
+    order[Dir].pop_front();
+    busy[Dir][Slot] = false;
+    now = std::max(now, times[Dir][Slot].second);
+    return 0;
+  }
+
+  int CopyTime(int Dir, int Slot, uint64_t* pStart, uint64_t* pEnd) override {
+    *pStart = times[Dir][Slot].first;
+    *pEnd = times[Dir][Slot].second;
+    return 0;
+  }
+
+  // reference: union of all copy intervals in seconds
+  double busy_time() {
+    std::vector<interval_t> v(intervals);
+    std::sort(v.begin(), v.end());
+    uint64_t total = 0;
+    uint64_t end = 0;
+    for (auto& i : v) {
+      uint64_t start = std::max(i.first, end);
+      if (i.second > start) total += i.second - start;
+      end = std::max(end, i.second);
+    }
+    return total / 1e9;
+  }
+
+  int outstanding() {
+    int n = 0;
+    for (auto& o : order) n += o.size();
+    return n;
+  }
+
+  uint64_t now;
+  uint64_t overhead;
+  uint64_t latency;
+  int submits;
+  int fail_at;
+  std::vector<uint64_t> engine_free;
+  std::vector<std::deque<int>> order;
+  std::vector<std::vector<bool>> busy;
+  std::vector<std::vector<interval_t>> times;
+  std::vector<interval_t> intervals;
+};
+
+}  // namespace
+
+TEST(CopyPipeline, depth_hides_submit_overhead) {
+  const size_t size = 4096;
+  const uint64_t count = 64;
+  double duration;
+
+  // one copy at a time: engine idles while host submits next copy
+  SimEngine serial(1, 1, 2000, 1000);
+  rvs::CopyPipeline p1(&serial, 1, 1);
+  ASSERT_EQ(p1.run(size, count, &duration), 0);
+  EXPECT_NEAR(duration, count * (size + 1000) / 1e9, 1e-12);
+  EXPECT_EQ(serial.now, count * (2000 + size + 1000));
+
+  // four copies in flight: engine is busy all the time
+  SimEngine piped(1, 4, 2000, 1000);
+  rvs::CopyPipeline p4(&piped, 1, 4);
+  ASSERT_EQ(p4.run(size, count, &duration), 0);
+  EXPECT_NEAR(duration, count * (size + 1000) / 1e9, 1e-12);
+  EXPECT_EQ(piped.now, 2000 + count * (size + 1000));
+  EXPECT_EQ(piped.outstanding(), 0);
+}
+
+TEST(CopyPipeline, bidirectional_union) {
+  double duration;
+
+  for (int depth = 1; depth <= 8; depth *= 2) {
+    SimEngine sim(2, depth, 700, 300);
+    rvs::CopyPipeline p(&sim, 2, depth);
+    ASSERT_EQ(p.run(1024 * depth, 3 * depth + 1, &duration), 0);
+    EXPECT_EQ(sim.intervals.size(), 2u * (3 * depth + 1));
+    EXPECT_NEAR(duration, sim.busy_time(), 1e-12) << "depth " << depth;
+    EXPECT_EQ(sim.outstanding(), 0);
+  }
+
+  // fewer copies than slots
+  SimEngine sim(2, 8, 700, 300);
+  rvs::CopyPipeline p(&sim, 2, 8);
+  ASSERT_EQ(p.run(1024, 3, &duration), 0);
+  EXPECT_EQ(sim.intervals.size(), 6u);
+  EXPECT_NEAR(duration, sim.busy_time(), 1e-12);
+}
+
+TEST(CopyPipeline, continuous) {
+  SimEngine sim(2, 3, 500, 200);
+  rvs::CopyPipeline p(&sim, 2, 3);
+  double total = 0;
+  double duration;
+  uint64_t count;
+
+  ASSERT_EQ(p.start(2048), 0);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(p.next(&duration), 0);
+    total += duration;
+  }
+  ASSERT_EQ(p.finish(&duration, &count), 0);
+  total += duration;
+
+  EXPECT_EQ(count, 3u);
+  EXPECT_EQ(sim.intervals.size(), 2u * (100 + 3));
+  EXPECT_NEAR(total, sim.busy_time(), 1e-12);
+  EXPECT_EQ(sim.outstanding(), 0);
+}
+
+TEST(CopyPipeline, submit_failure_drains) {
+  double duration;
+
+  SimEngine sim(2, 4, 100, 100);
+  sim.fail_at = 9;
+  rvs::CopyPipeline p(&sim, 2, 4);
+  EXPECT_NE(p.run(1024, 16, &duration), 0);
+  EXPECT_EQ(sim.outstanding(), 0);
+}
@@ -0,0 +1,76 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "include/rvscpuusage.h"
+#include "include/rvs_unit_testing_defs.h"
+
+TEST(cpuusage, busy) {
+  rvs::ThreadCpuUsage usage;
+  auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+  volatile uint64_t spins = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    spins++;
+  }
+
+  EXPECT_GE(usage.wall_time(), 0.2);
+  EXPECT_GT(usage.cpu_time(), 0.1);
+  // leave room for preemption on loaded machines
+  EXPECT_GT(usage.utilization(), 0.5);
+  EXPECT_LE(usage.utilization(), 1.0);
+}
+
+TEST(cpuusage, sleeping) {
+  rvs::ThreadCpuUsage usage;
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  EXPECT_GE(usage.wall_time(), 0.2);
+  EXPECT_LT(usage.utilization(), 0.1);
+}
+
+TEST(cpuusage, per_thread) {
+  rvs::ThreadCpuUsage usage;
+
+  // another thread spinning is not accounted to this one
+  std::thread busy([]() {
+    auto end = std::chrono::steady_clock::now() +
+               std::chrono::milliseconds(200);
+    volatile uint64_t spins = 0;
+    while (std::chrono::steady_clock::now() < end) {
+      spins++;
+    }
+  });
+  busy.join();
+
+  EXPECT_LT(usage.utilization(), 0.1);
+
+  // restart
+  usage.start();
+  EXPECT_LT(usage.cpu_time(), 0.1);
+  EXPECT_LT(usage.wall_time(), 0.1);
+}
@@ -0,0 +1,252 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsgemmpipe.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// simulated runtime: host clock advances while filling and waiting, copy
+// and compute streams are FIFO engines, a GEMM starts after its slot's copy
+class SimRuntime : public rvs::GemmRuntime {
+ public:
+  SimRuntime(int Slots, uint64_t Fill, uint64_t Copy, uint64_t Gemm)
+  : now(0), fill_ns(Fill), copy_ns(Copy), gemm_ns(Gemm), generation(0),
+    copy_free(0), compute_free(0), fail_call(-1), calls(0),
+    host_gen(Slots, 0), dev_gen(Slots, 0), copy_pending(Slots, false),
+    gemm_pending(Slots, false), copy_start(Slots, 0), copy_end(Slots, 0),
+    gemm_start(Slots, 0), gemm_end(Slots, 0) {}
+
+  int Fill(int Slot) override {
+    if (fail()) {
+      return -1;
+    }
+    EXPECT_FALSE(copy_pending[Slot]) << "staging filled while copied";
+    EXPECT_FALSE(gemm_pending[Slot]) << "staging filled while in use";
+    now += fill_ns;
+    host_gen[Slot] = ++generation;
+    return 0;
+  }
+
+  int CopyAsync(int Slot) override {
+    if (fail()) {
+      return -1;
+    }
+    EXPECT_FALSE(copy_pending[Slot]);
+    EXPECT_FALSE(gemm_pending[Slot]) << "device matrices overwritten";
+    copy_start[Slot] = std::max(now, copy_free);
+    copy_end[Slot] = copy_start[Slot] + copy_ns;
+    copy_free = copy_end[Slot];
+    dev_gen[Slot] = host_gen[Slot];
+    copy_pending[Slot] = true;
+    return 0;
+  }
+
+  int GemmAsync(int Slot) override {
+    if (fail()) {
+      return -1;
+    }
+    EXPECT_TRUE(copy_pending[Slot]) << "GEMM without fresh data";
+    EXPECT_FALSE(gemm_pending[Slot]);
+    gemm_start[Slot] = std::max(std::max(now, compute_free), copy_end[Slot]);
+    gemm_end[Slot] = gemm_start[Slot] + gemm_ns;
+    compute_free = gemm_end[Slot];
+    consumed.push_back(dev_gen[Slot]);
+    gemm_pending[Slot] = true;
+    return 0;
+  }
+
+  int WaitCopy(int Slot) override {
+    EXPECT_TRUE(copy_pending[Slot]);
+    EXPECT_FALSE(gemm_pending[Slot]);
+    now = std::max(now, copy_end[Slot]);
+    copy_pending[Slot] = false;
+    return 0;
+  }
+
+  int WaitGemm(int Slot) override {
+    EXPECT_TRUE(gemm_pending[Slot]);
+    now = std::max(now, gemm_end[Slot]);
+    gemm_pending[Slot] = false;
+    copy_pending[Slot] = false;
+    return 0;
+  }
+
+  int CopyTime(int Slot, double* pSeconds) override {
+    *pSeconds = (copy_end[Slot] - copy_start[Slot]) / 1e9;
+    return 0;
+  }
+
+  int GemmTime(int Slot, double* pSeconds) override {
+    *pSeconds = (gemm_end[Slot] - gemm_start[Slot]) / 1e9;
+    return 0;
+  }
+
+  bool idle() const {
+    for (size_t i = 0; i < host_gen.size(); i++) {
+      if (copy_pending[i] || gemm_pending[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint64_t now;
+  uint64_t fill_ns;
+  uint64_t copy_ns;
+  uint64_t gemm_ns;
+  uint64_t generation;
+  uint64_t copy_free;
+  uint64_t compute_free;
+  //! index of failing call, -1 never fails
+  int fail_call;
+  int calls;
+  std::vector<uint64_t> host_gen;
+  std::vector<uint64_t> dev_gen;
+  std::vector<bool> copy_pending;
+  std::vector<bool> gemm_pending;
+  std::vector<uint64_t> copy_start;
+  std::vector<uint64_t> copy_end;
+  std::vector<uint64_t> gemm_start;
+  std::vector<uint64_t> gemm_end;
+  //! generation of data each GEMM ran on, in issue order
+  std::vector<uint64_t> consumed;
+
+ private:
+  bool fail() {
+    return calls++ == fail_call;
+  }
+};
+
+void run_steps(rvs::GemmPipeline* pPipe, int Steps) {
+  ASSERT_EQ(pPipe->start(), 0);
+  for (int i = 0; i < Steps; i++) {
+    ASSERT_EQ(pPipe->step(), 0);
+  }
+  ASSERT_EQ(pPipe->finish(), 0);
+}
+
+}  // namespace
+
+TEST(gemmpipe, every_gemm_gets_fresh_data) {
+  for (int slots : {2, 3, 5}) {
+    SimRuntime rt(slots, 1, 4, 10);
+    rvs::GemmPipeline pipe(&rt, slots);
+    EXPECT_EQ(pipe.slots(), slots);
+    run_steps(&pipe, 20);
+
+    ASSERT_EQ(rt.consumed.size(), 20u);
+    for (uint64_t i = 0; i < rt.consumed.size(); i++) {
+      EXPECT_EQ(rt.consumed[i], i + 1);
+    }
+    EXPECT_TRUE(rt.idle());
+    EXPECT_EQ(pipe.gemms(), 20u);
+    // the copy prepared for the step after the last one is waited for too
+    EXPECT_EQ(pipe.copies(), 21u);
+  }
+}
+
+TEST(gemmpipe, copies_overlap_gemms) {
+  const int steps = 100;
+  SimRuntime rt(2, 1, 4, 10);
+  rvs::GemmPipeline pipe(&rt, 2);
+  run_steps(&pipe, steps);
+
+  // serialized: steps * (1 + 4 + 10), overlapped: first fill and copy
+  // then GEMMs back to back
+  EXPECT_EQ(rt.now, 1 + 4 + steps * 10u);
+  EXPECT_NEAR(pipe.gemm_time(), steps * 10 / 1e9, 1e-15);
+  EXPECT_NEAR(pipe.copy_time(), (steps + 1) * 4 / 1e9, 1e-15);
+}
+
+TEST(gemmpipe, copy_bound) {
+  const int steps = 50;
+  SimRuntime rt(2, 1, 20, 10);
+  rvs::GemmPipeline pipe(&rt, 2);
+  run_steps(&pipe, steps);
+
+  // copies are the bottleneck, GEMMs hide behind them
+  EXPECT_GE(rt.now, (steps + 1) * 20u);
+  EXPECT_LE(rt.now, (steps + 1) * 21u + 10);
+  EXPECT_LT(rt.now, steps * (1 + 20 + 10u));
+}
+
+TEST(gemmpipe, restart_and_stats) {
+  SimRuntime rt(2, 1, 4, 10);
+  rvs::GemmPipeline pipe(&rt, 1);
+  // at least double buffered
+  EXPECT_EQ(pipe.slots(), 2);
+
+  // step requires start
+  EXPECT_NE(pipe.step(), 0);
+
+  run_steps(&pipe, 3);
+  EXPECT_EQ(pipe.gemms(), 3u);
+  pipe.reset_stats();
+  EXPECT_EQ(pipe.gemms(), 0u);
+  EXPECT_EQ(pipe.copies(), 0u);
+  EXPECT_EQ(pipe.copy_time(), 0.0);
+
+  run_steps(&pipe, 4);
+  EXPECT_EQ(pipe.gemms(), 4u);
+  EXPECT_EQ(rt.consumed.size(), 7u);
+  EXPECT_TRUE(rt.idle());
+}
+
+TEST(gemmpipe, errors) {
+  // failing fill in start
+  {
+    SimRuntime rt(2, 1, 4, 10);
+    rt.fail_call = 0;
+    rvs::GemmPipeline pipe(&rt, 2);
+    EXPECT_NE(pipe.start(), 0);
+  }
+  // failing GEMM: Fill, Copy, then GemmAsync is the third call
+  {
+    SimRuntime rt(2, 1, 4, 10);
+    rt.fail_call = 2;
+    rvs::GemmPipeline pipe(&rt, 2);
+    ASSERT_EQ(pipe.start(), 0);
+    EXPECT_NE(pipe.step(), 0);
+    // what was started can still be drained
+    EXPECT_EQ(pipe.finish(), 0);
+    EXPECT_TRUE(rt.idle());
+  }
+  // failing copy of the next slot
+  {
+    SimRuntime rt(2, 1, 4, 10);
+    rt.fail_call = 4;
+    rvs::GemmPipeline pipe(&rt, 2);
+    ASSERT_EQ(pipe.start(), 0);
+    EXPECT_NE(pipe.step(), 0);
+    EXPECT_EQ(pipe.finish(), 0);
+    EXPECT_TRUE(rt.idle());
+    EXPECT_EQ(pipe.gemms(), 1u);
+  }
+}
@@ -0,0 +1,219 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsgemmqueue.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// simulated runtime: host clock advances by launch overhead on each launch
+// and by wake-up latency on each wait, every stream is a FIFO engine and
+// streams run concurrently
+class SimQueueRuntime : public rvs::GemmQueueRuntime {
+ public:
+  SimQueueRuntime(int Streams, int Slots, uint64_t Launch, uint64_t Wake,
+                  uint64_t Gemm)
+  : now(0), launch_ns(Launch), wake_ns(Wake), gemm_ns(Gemm), fail_call(-1),
+    calls(0), running(0), max_running(0), stream_free(Streams, 0),
+    stream_gemms(Streams, 0), slot_pending(Slots, false), slot_end(Slots, 0),
+    busy_ns(0) {}
+
+  int QueueGemm(int Stream, int Slot) override {
+    if (fail()) {
+      return -1;
+    }
+    EXPECT_FALSE(slot_pending[Slot]) << "event of a GEMM in flight reused";
+    now += launch_ns;
+    uint64_t start = std::max(now, stream_free[Stream]);
+    stream_free[Stream] = start + gemm_ns;
+    slot_end[Slot] = stream_free[Stream];
+    slot_pending[Slot] = true;
+    stream_gemms[Stream]++;
+    busy_ns += gemm_ns;
+    running++;
+    max_running = std::max(max_running, running);
+    return 0;
+  }
+
+  int WaitQueued(int Slot) override {
+    if (fail()) {
+      return -1;
+    }
+    EXPECT_TRUE(slot_pending[Slot]);
+    now = std::max(now, slot_end[Slot]) + wake_ns;
+    slot_pending[Slot] = false;
+    running--;
+    return 0;
+  }
+
+  bool idle() const {
+    for (bool pending : slot_pending) {
+      if (pending) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint64_t now;
+  uint64_t launch_ns;
+  uint64_t wake_ns;
+  uint64_t gemm_ns;
+  //! index of failing call, -1 never fails
+  int fail_call;
+  int calls;
+  int running;
+  int max_running;
+  std::vector<uint64_t> stream_free;
+  std::vector<uint64_t> stream_gemms;
+  std::vector<bool> slot_pending;
+  std::vector<uint64_t> slot_end;
+  //! total GEMM time summed over streams
+  uint64_t busy_ns;
+
+ private:
+  bool fail() {
+    return calls++ == fail_call;
+  }
+};
+
+}  // namespace
+
+TEST(gemmqueue, depth_bounds_gemms_in_flight) {
+  for (int depth : {1, 2, 4, 7}) {
+    SimQueueRuntime rt(1, depth, 1, 1, 10);
+    rvs::GemmQueue queue(&rt, 1, depth);
+    EXPECT_EQ(queue.depth(), depth);
+
+    ASSERT_EQ(queue.submit(50), 0);
+    EXPECT_EQ(rt.max_running, depth);
+    EXPECT_EQ(queue.in_flight(), depth);
+    EXPECT_EQ(queue.submitted(), 50u);
+    EXPECT_EQ(queue.completed(), 50u - depth);
+
+    ASSERT_EQ(queue.drain(), 0);
+    EXPECT_EQ(queue.in_flight(), 0);
+    EXPECT_EQ(queue.completed(), 50u);
+    EXPECT_TRUE(rt.idle());
+  }
+}
+
+TEST(gemmqueue, depth_hides_launch_gaps) {
+  const int gemms = 100;
+  // launch and wake-up latency comparable to a small GEMM
+  SimQueueRuntime serial_rt(1, 1, 3, 5, 10);
+  rvs::GemmQueue serial(&serial_rt, 1, 1);
+  ASSERT_EQ(serial.submit(gemms), 0);
+  ASSERT_EQ(serial.drain(), 0);
+  // GPU idles while the host wakes up and launches the next GEMM
+  EXPECT_EQ(serial_rt.now, gemms * (3 + 10 + 5u));
+
+  SimQueueRuntime deep_rt(1, 4, 3, 5, 10);
+  rvs::GemmQueue deep(&deep_rt, 1, 4);
+  ASSERT_EQ(deep.submit(gemms), 0);
+  ASSERT_EQ(deep.drain(), 0);
+  // GEMMs back to back after the first launch
+  EXPECT_EQ(deep_rt.stream_free[0], 3 + gemms * 10u);
+  EXPECT_LE(deep_rt.now, 3 + gemms * 10u + 5);
+}
+
+TEST(gemmqueue, streams_run_concurrently) {
+  const int gemms = 120;
+  for (int streams : {1, 2, 3, 4}) {
+    SimQueueRuntime rt(streams, 2 * streams, 1, 1, 40);
+    rvs::GemmQueue queue(&rt, streams, 2 * streams);
+    ASSERT_EQ(queue.submit(gemms), 0);
+    ASSERT_EQ(queue.drain(), 0);
+
+    // round robin
+    for (int s = 0; s < streams; s++) {
+      EXPECT_EQ(rt.stream_gemms[s], static_cast<uint64_t>(gemms / streams));
+    }
+    // each stream busy back to back
+    EXPECT_LE(rt.now, static_cast<uint64_t>(gemms / streams * 40 +
+                                            streams + 1));
+    EXPECT_EQ(rt.busy_ns, gemms * 40u);
+  }
+}
+
+TEST(gemmqueue, depth_at_least_streams) {
+  SimQueueRuntime rt(4, 4, 1, 1, 10);
+  rvs::GemmQueue queue(&rt, 4, 1);
+  EXPECT_EQ(queue.streams(), 4);
+  EXPECT_EQ(queue.depth(), 4);
+
+  rvs::GemmQueue single(&rt, 0, 0);
+  EXPECT_EQ(single.streams(), 1);
+  EXPECT_EQ(single.depth(), 1);
+}
+
+TEST(gemmqueue, submit_in_chunks_and_stats) {
+  SimQueueRuntime rt(2, 3, 1, 1, 10);
+  rvs::GemmQueue queue(&rt, 2, 3);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(queue.submit(4), 0);
+    EXPECT_LE(queue.in_flight(), 3);
+  }
+  EXPECT_EQ(queue.submitted(), 40u);
+  EXPECT_EQ(queue.submitted() - queue.completed(),
+            static_cast<uint64_t>(queue.in_flight()));
+
+  queue.reset_stats();
+  EXPECT_EQ(queue.submitted(), 0u);
+  EXPECT_EQ(queue.completed(), 0u);
+  ASSERT_EQ(queue.drain(), 0);
+  // GEMMs in flight at reset complete after it
+  EXPECT_EQ(queue.completed(), 3u);
+  EXPECT_TRUE(rt.idle());
+}
+
+TEST(gemmqueue, errors) {
+  // failing launch
+  {
+    SimQueueRuntime rt(1, 2, 1, 1, 10);
+    rt.fail_call = 1;
+    rvs::GemmQueue queue(&rt, 1, 2);
+    EXPECT_NE(queue.submit(5), 0);
+    EXPECT_EQ(queue.submitted(), 1u);
+    // what was launched can still be drained
+    EXPECT_EQ(queue.drain(), 0);
+    EXPECT_TRUE(rt.idle());
+  }
+  // failing wait for the oldest GEMM: 2 launches, then the wait
+  {
+    SimQueueRuntime rt(1, 2, 1, 1, 10);
+    rt.fail_call = 2;
+    rvs::GemmQueue queue(&rt, 1, 2);
+    EXPECT_NE(queue.submit(5), 0);
+    EXPECT_EQ(queue.in_flight(), 2);
+    EXPECT_EQ(queue.drain(), 0);
+    EXPECT_TRUE(rt.idle());
+    EXPECT_EQ(queue.completed(), 2u);
+  }
+}
@@ -0,0 +1,204 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvshistogram.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// exact percentile of sorted values, same rank rule as rvs::Histogram
+uint64_t exact_percentile(const std::vector<uint64_t>& Sorted, double P) {
+  size_t rank = static_cast<size_t>(ceil(P / 100 * Sorted.size()));
+  rank = std::max(rank, static_cast<size_t>(1));
+  return Sorted[rank - 1];
+}
+
+void expect_close(uint64_t Expected, uint64_t Actual) {
+  EXPECT_LE(fabs(static_cast<double>(Actual) - Expected),
+            Expected * 0.01 + 1) << "expected " << Expected
+                                 << " actual " << Actual;
+}
+
+}  // namespace
+
+TEST(histogram, buckets) {
+  // buckets cover value range without gaps or overlap
+  for (size_t i = 1; i < RVS_HIST_BUCKETS; i++) {
+    EXPECT_EQ(rvs::Histogram::bucket_high(i - 1) + 1,
+              rvs::Histogram::bucket_low(i));
+  }
+  EXPECT_EQ(rvs::Histogram::bucket_high(RVS_HIST_BUCKETS - 1),
+            (1ull << RVS_HIST_VALUE_BITS) - 1);
+
+  // every value maps to the bucket containing it
+  std::mt19937_64 gen(42);
+  for (int i = 0; i < 100000; i++) {
+    uint64_t v = gen() >> (gen() % 64);
+    v = std::min(v, static_cast<uint64_t>((1ull << RVS_HIST_VALUE_BITS) - 1));
+    size_t ix = rvs::Histogram::bucket_index(v);
+    ASSERT_LT(ix, static_cast<size_t>(RVS_HIST_BUCKETS));
+    EXPECT_LE(rvs::Histogram::bucket_low(ix), v);
+    EXPECT_GE(rvs::Histogram::bucket_high(ix), v);
+  }
+
+  // values out of range are clamped into the last bucket
+  EXPECT_EQ(rvs::Histogram::bucket_index(~0ull),
+            static_cast<size_t>(RVS_HIST_BUCKETS - 1));
+}
+
+TEST(histogram, percentiles) {
+  rvs::Histogram h;
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.percentile(50), 0u);
+  EXPECT_EQ(h.max(), 0u);
+
+  // transfer times around 40 usec with a tail of 5..10 msec stalls
+  std::mt19937 gen(7);
+  std::lognormal_distribution<double> body(log(40000.0), 0.1);
+  std::uniform_real_distribution<double> tail(5e6, 1e7);
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 100000; i++) {
+    double v = (i % 500 == 0) ? tail(gen) : body(gen);
+    values.push_back(static_cast<uint64_t>(v));
+    h.record(values.back());
+  }
+  std::sort(values.begin(), values.end());
+
+  EXPECT_EQ(h.count(), values.size());
+  EXPECT_EQ(h.min(), values.front());
+  EXPECT_EQ(h.max(), values.back());
+  EXPECT_EQ(h.percentile(100), values.back());
+  double ps[] = {0, 50, 90, 99, 99.5, 99.9, 99.99};
+  for (double p : ps) {
+    expect_close(exact_percentile(values, p), h.percentile(p));
+  }
+
+  // 0.2% of transfers stall, so p99.9 must see it while p99 does not
+  EXPECT_GT(h.percentile(99.9), 5000000u);
+  EXPECT_LT(h.percentile(99), 100000u);
+
+  h.reset();
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.percentile(99), 0u);
+}
+
+TEST(histogram, small_values_exact) {
+  rvs::Histogram h;
+  for (uint64_t v = 1; v <= 100; v++) {
+    h.record(v);
+  }
+  EXPECT_EQ(h.percentile(50), 50u);
+  EXPECT_EQ(h.percentile(90), 90u);
+  EXPECT_EQ(h.percentile(99), 99u);
+  EXPECT_EQ(h.min(), 1u);
+  EXPECT_EQ(h.max(), 100u);
+}
+
+TEST(histogram, merge) {
+  rvs::Histogram fwd;
+  rvs::Histogram rev;
+  rvs::Histogram both;
+
+  for (uint64_t v = 1000; v < 2000; v++) {
+    fwd.record(v);
+    both.record(v);
+  }
+  rev.record(50000, 10);
+  both.record(50000, 10);
+
+  rvs::Histogram merged;
+  merged.merge(fwd);
+  merged.merge(rev);
+  merged.merge(rvs::Histogram());
+
+  EXPECT_EQ(merged.count(), both.count());
+  EXPECT_EQ(merged.min(), 1000u);
+  EXPECT_EQ(merged.max(), 50000u);
+  double ps[] = {50, 90, 99, 99.9};
+  for (double p : ps) {
+    EXPECT_EQ(merged.percentile(p), both.percentile(p));
+  }
+
+  rvs::HistogramMap src;
+  rvs::HistogramMap dst;
+  src[4096] = fwd;
+  src[8192] = rev;
+  dst[4096] = rev;
+  rvs::merge(src, &dst);
+  EXPECT_EQ(dst.size(), 2u);
+  EXPECT_EQ(dst[4096].count(), fwd.count() + rev.count());
+  EXPECT_EQ(dst[8192].count(), rev.count());
+}
+
+TEST(histogram, atomic_drain) {
+  const int writers = 4;
+  const uint64_t per_writer = 200000;
+  rvs::AtomicHistogram rec;
+  rvs::Histogram total;
+  std::atomic<int> running(writers);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < writers; t++) {
+    threads.push_back(std::thread([&rec, &running, t]() {
+      for (uint64_t i = 0; i < per_writer; i++) {
+        rec.record(1000 + t * 1000 + i % 997);
+      }
+      running--;
+    }));
+  }
+
+  // drain concurrently into interval histograms, the way
+  // get_running_data() does it
+  int intervals = 0;
+  while (running > 0) {
+    rvs::Histogram interval;
+    rec.drain(&interval);
+    total.merge(interval);
+    intervals++;
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  rec.drain(&total);
+
+  EXPECT_GT(intervals, 0);
+  EXPECT_EQ(total.count(), writers * per_writer);
+  EXPECT_EQ(total.min(), 1000u);
+  EXPECT_EQ(total.max(), 1000u + (writers - 1) * 1000 + 996);
+
+  // recorder is empty after drain
+  rvs::Histogram empty;
+  rec.drain(&empty);
+  EXPECT_EQ(empty.count(), 0u);
+}
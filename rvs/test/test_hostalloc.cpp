@@ -0,0 +1,182 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvshostalloc.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// records pin calls, fails on request
+class FakePinner : public rvs::HostPinner {
+ public:
+  FakePinner() : fail(false), pinned(0), unpinned(0), peer(-1) {}
+
+  int Pin(void* Ptr, size_t, int Peer, void** pDevPtr) override {
+    if (fail) {
+      return -1;
+    }
+    pinned++;
+    peer = Peer;
+    // device sees the buffer at a different address
+    *pDevPtr = static_cast<char*>(Ptr) + 1;
+    return 0;
+  }
+  void Unpin(void*) override {
+    unpinned++;
+  }
+
+  bool fail;
+  int pinned;
+  int unpinned;
+  int peer;
+};
+
+}  // namespace
+
+TEST(hostalloc, parse_page) {
+  size_t page;
+  EXPECT_EQ(rvs::HostAllocator::parse_page("4K", &page), 0);
+  EXPECT_EQ(page, 4096u);
+  EXPECT_EQ(rvs::HostAllocator::parse_page("2m", &page), 0);
+  EXPECT_EQ(page, RVS_HOSTALLOC_PAGE_2M);
+  EXPECT_EQ(rvs::HostAllocator::parse_page("1G", &page), 0);
+  EXPECT_EQ(page, RVS_HOSTALLOC_PAGE_1G);
+  EXPECT_EQ(rvs::HostAllocator::parse_page("65536", &page), 0);
+  EXPECT_EQ(page, 65536u);
+
+  EXPECT_NE(rvs::HostAllocator::parse_page("", &page), 0);
+  EXPECT_NE(rvs::HostAllocator::parse_page("0", &page), 0);
+  EXPECT_NE(rvs::HostAllocator::parse_page("3M", &page), 0);
+  EXPECT_NE(rvs::HostAllocator::parse_page("2MB", &page), 0);
+  EXPECT_NE(rvs::HostAllocator::parse_page("2T", &page), 0);
+  EXPECT_NE(rvs::HostAllocator::parse_page("huge", &page), 0);
+
+  EXPECT_EQ(rvs::HostAllocator::page_name(4096), "4K");
+  EXPECT_EQ(rvs::HostAllocator::page_name(RVS_HOSTALLOC_PAGE_2M), "2M");
+  EXPECT_EQ(rvs::HostAllocator::page_name(RVS_HOSTALLOC_PAGE_1G), "1G");
+  EXPECT_EQ(rvs::HostAllocator::page_name(1000), "1000");
+}
+
+TEST(hostalloc, map_regular) {
+  rvs::HostBuffer buff;
+  size_t base = rvs::HostAllocator::base_page();
+
+  ASSERT_EQ(rvs::HostAllocator::map(base + 1, 0, &buff), 0);
+  ASSERT_NE(buff.ptr, nullptr);
+  EXPECT_EQ(buff.dev_ptr, buff.ptr);
+  EXPECT_EQ(buff.size, base + 1);
+  EXPECT_EQ(buff.map_size, 2 * base);
+  EXPECT_EQ(buff.page_size, base);
+  EXPECT_EQ(buff.page_req, base);
+  EXPECT_FALSE(buff.transparent);
+  EXPECT_FALSE(buff.pinned);
+  memset(buff.ptr, 0xa5, buff.size);
+
+  rvs::HostAllocator::unmap(&buff);
+  EXPECT_EQ(buff.ptr, nullptr);
+  EXPECT_EQ(buff.map_size, 0u);
+
+  EXPECT_NE(rvs::HostAllocator::map(0, 0, &buff), 0);
+}
+
+// whether huge pages are available depends on the host, so only the
+// fallback chain is checked: explicit pages of requested or smaller size,
+// otherwise regular pages with transparent huge pages requested
+TEST(hostalloc, map_huge_fallback) {
+  size_t base = rvs::HostAllocator::base_page();
+
+  for (size_t page : {RVS_HOSTALLOC_PAGE_2M, RVS_HOSTALLOC_PAGE_1G}) {
+    rvs::HostBuffer buff;
+    ASSERT_EQ(rvs::HostAllocator::map(3 * 1024 * 1024, page, &buff), 0);
+    ASSERT_NE(buff.ptr, nullptr);
+    EXPECT_EQ(buff.page_req, page);
+    EXPECT_LE(buff.page_size, page);
+    EXPECT_EQ(buff.map_size % buff.page_size, 0u);
+    EXPECT_GE(buff.map_size, buff.size);
+    if (buff.page_size == base) {
+      EXPECT_TRUE(buff.transparent);
+    } else {
+      EXPECT_FALSE(buff.transparent);
+      EXPECT_TRUE(buff.page_size == RVS_HOSTALLOC_PAGE_2M ||
+                  buff.page_size == RVS_HOSTALLOC_PAGE_1G);
+    }
+    memset(buff.ptr, 0x5a, buff.size);
+    rvs::HostAllocator::unmap(&buff);
+  }
+}
+
+TEST(hostalloc, pin_and_stats) {
+  FakePinner pinner;
+  rvs::HostAllocator alloc(&pinner);
+  size_t base = rvs::HostAllocator::base_page();
+
+  rvs::HostBuffer a;
+  rvs::HostBuffer b;
+  ASSERT_EQ(alloc.allocate(1000, 0, 3, &a), 0);
+  EXPECT_TRUE(a.pinned);
+  EXPECT_EQ(a.dev_ptr, static_cast<char*>(a.ptr) + 1);
+  EXPECT_GE(a.pin_time, 0);
+  EXPECT_EQ(pinner.peer, 3);
+
+  ASSERT_EQ(alloc.allocate(5000, RVS_HOSTALLOC_PAGE_2M, 1, &b), 0);
+  EXPECT_EQ(pinner.pinned, 2);
+
+  EXPECT_EQ(alloc.buffers(), 2u);
+  EXPECT_EQ(alloc.bytes(), 6000u);
+  EXPECT_EQ(alloc.min_page(), base);
+  EXPECT_EQ(alloc.fallbacks(), b.page_size < RVS_HOSTALLOC_PAGE_2M ? 1u : 0u);
+  EXPECT_GE(alloc.pin_time(), alloc.pin_time_max());
+
+  alloc.release(&a);
+  alloc.release(&b);
+  EXPECT_EQ(pinner.unpinned, 2);
+  EXPECT_EQ(a.ptr, nullptr);
+
+  alloc.reset_stats();
+  EXPECT_EQ(alloc.buffers(), 0u);
+  EXPECT_EQ(alloc.min_page(), 0u);
+
+  // failed pinning releases the mapping and is not accounted
+  pinner.fail = true;
+  EXPECT_NE(alloc.allocate(1000, 0, 0, &a), 0);
+  EXPECT_EQ(a.ptr, nullptr);
+  EXPECT_EQ(alloc.buffers(), 0u);
+}
+
+TEST(hostalloc, no_pinner) {
+  rvs::HostAllocator alloc;
+  rvs::HostBuffer buff;
+  ASSERT_EQ(alloc.allocate(100, 0, 0, &buff), 0);
+  EXPECT_FALSE(buff.pinned);
+  EXPECT_EQ(buff.dev_ptr, buff.ptr);
+  EXPECT_EQ(buff.pin_time, 0);
+  alloc.release(&buff);
+}
@@ -0,0 +1,126 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvshostcopy.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// CPUs this process may run on
+std::vector<int> allowed_cpus() {
+  cpu_set_t set;
+  std::vector<int> cpus;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+TEST(hostcopy, method_names) {
+  EXPECT_EQ(rvs::HostCopy::parse_method("memcpy"), RVS_HOSTCOPY_MEMCPY);
+  EXPECT_EQ(rvs::HostCopy::parse_method("stream"), RVS_HOSTCOPY_STREAM);
+  EXPECT_EQ(rvs::HostCopy::parse_method("nt"), -1);
+  EXPECT_STREQ(rvs::HostCopy::method_name(RVS_HOSTCOPY_MEMCPY), "memcpy");
+  EXPECT_STREQ(rvs::HostCopy::method_name(RVS_HOSTCOPY_STREAM), "stream");
+}
+
+TEST(hostcopy, copy_stream_unaligned) {
+  std::vector<uint8_t> src(1024);
+  for (size_t i = 0; i < src.size(); i++) {
+    src[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+
+  // every combination of misaligned start and odd length
+  for (size_t offset = 0; offset < 17; offset++) {
+    for (size_t len : {0, 1, 15, 16, 63, 64, 65, 200, 1000}) {
+      std::vector<uint8_t> dst(src.size() + 32, 0xff);
+      rvs::HostCopy::copy_stream(&dst[offset], &src[0], len);
+      for (size_t i = 0; i < len; i++) {
+        ASSERT_EQ(dst[offset + i], src[i]) << offset << " " << len;
+      }
+      for (size_t i = offset + len; i < dst.size(); i++) {
+        ASSERT_EQ(dst[i], 0xff) << offset << " " << len;
+      }
+    }
+  }
+}
+
+TEST(hostcopy, invalid) {
+  rvs::HostCopy copy;
+  uint64_t bytes;
+  double duration;
+  std::vector<int> none;
+  EXPECT_NE(copy.run(RVS_HOSTCOPY_MEMCPY, 0, &bytes, &duration), 0);
+  EXPECT_NE(copy.initialize(none, none, none, 0, 1, false), 0);
+  EXPECT_NE(copy.initialize(std::vector<int>({-1}), none, none,
+                            4096, 1, false), 0);
+}
+
+TEST(hostcopy, run) {
+  std::vector<int> cpus = allowed_cpus();
+  ASSERT_FALSE(cpus.empty());
+  std::vector<int> one(1, cpus[0]);
+
+  for (bool huge : {false, true}) {
+    for (int method : {RVS_HOSTCOPY_MEMCPY, RVS_HOSTCOPY_STREAM}) {
+      rvs::HostCopy copy;
+      size_t size = 1024 * 1024 + 100;
+      ASSERT_EQ(copy.initialize(one, cpus, one, size, 3, huge), 0);
+      EXPECT_EQ(copy.size(), size);
+      EXPECT_EQ(copy.threads(), 3);
+      EXPECT_GT(copy.page_size(), 0u);
+
+      // at least one full pass even if no time is given
+      uint64_t bytes;
+      double duration;
+      ASSERT_EQ(copy.run(method, 0, &bytes, &duration), 0);
+      EXPECT_EQ(bytes, size);
+      EXPECT_GT(duration, 0);
+
+      ASSERT_EQ(copy.run(method, 0.02, &bytes, &duration), 0);
+      EXPECT_GE(bytes, size);
+      EXPECT_GE(duration, 0.02);
+    }
+  }
+
+  // thread count defaults to number of copy CPUs
+  rvs::HostCopy copy;
+  ASSERT_EQ(copy.initialize(one, one, cpus, 4096, 0, false), 0);
+  EXPECT_EQ(copy.threads(), static_cast<int>(cpus.size()));
+}
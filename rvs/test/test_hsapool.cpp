@@ -0,0 +1,220 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvshsapool.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// fake allocator keeping track of live buffers and signals
+class FakeAllocator : public rvs::TransferAllocator {
+ public:
+  FakeAllocator() : allocations(0), signals(0), max_size(0),
+                    fail_signal(false), next_signal(1) {}
+
+  ~FakeAllocator() override {
+    for (auto p : buffers) {
+      delete[] static_cast<char*>(p);
+    }
+  }
+
+  int AllocateBuffers(int, int, size_t Size,
+                      void** pSrcBuff, void** pDstBuff) override {
+    std::lock_guard<std::mutex> lk(mtx);
+    if (max_size && Size > max_size) {
+      return -1;
+    }
+    allocations++;
+    sizes.push_back(Size);
+    *pSrcBuff = new char[1];
+    *pDstBuff = new char[1];
+    buffers.insert(*pSrcBuff);
+    buffers.insert(*pDstBuff);
+    return 0;
+  }
+
+  void FreeBuffer(void* Buff) override {
+    std::lock_guard<std::mutex> lk(mtx);
+    ASSERT_EQ(buffers.erase(Buff), 1u);
+    delete[] static_cast<char*>(Buff);
+  }
+
+  int CreateSignal(uint64_t* pSignal) override {
+    std::lock_guard<std::mutex> lk(mtx);
+    if (fail_signal) {
+      return -1;
+    }
+    signals++;
+    *pSignal = next_signal++;
+    live_signals.insert(*pSignal);
+    return 0;
+  }
+
+  void DestroySignal(uint64_t Signal) override {
+    std::lock_guard<std::mutex> lk(mtx);
+    ASSERT_EQ(live_signals.erase(Signal), 1u);
+  }
+
+  std::mutex mtx;
+  int allocations;
+  int signals;
+  size_t max_size;
+  bool fail_signal;
+  uint64_t next_signal;
+  std::vector<size_t> sizes;
+  std::set<void*> buffers;
+  std::set<uint64_t> live_signals;
+};
+
+}  // namespace
+
+TEST(TransferPool, size_class) {
+  EXPECT_EQ(rvs::TransferPool::size_class(1), 1u);
+  EXPECT_EQ(rvs::TransferPool::size_class(1024), 1024u);
+  EXPECT_EQ(rvs::TransferPool::size_class(1025), 2048u);
+  EXPECT_EQ(rvs::TransferPool::size_class(3 * 1024 * 1024), 4u * 1024 * 1024);
+}
+
+TEST(TransferPool, reuse) {
+  FakeAllocator fake;
+  {
+    rvs::TransferPool pool(&fake);
+    const uint32_t sizes[] = { 1024, 4096, 1000, 65536 };
+
+    // repeated loops over size list allocate once per pair and size class
+    for (int loop = 0; loop < 10; loop++) {
+      for (auto size : sizes) {
+        rvs::TransferPool::Entry* e = pool.acquire(0, 1, size);
+        ASSERT_NE(e, nullptr);
+        EXPECT_GE(e->size, size);
+        EXPECT_TRUE(e->in_use);
+        pool.release(e);
+      }
+    }
+    EXPECT_EQ(fake.allocations, 3);
+    EXPECT_EQ(fake.signals, 3);
+    EXPECT_EQ(pool.entries(), 3u);
+
+    // other direction is a different key
+    pool.release(pool.acquire(1, 0, 1024));
+    EXPECT_EQ(fake.allocations, 4);
+
+    // entry in use is not handed out twice
+    rvs::TransferPool::Entry* a = pool.acquire(0, 1, 1024);
+    rvs::TransferPool::Entry* b = pool.acquire(0, 1, 1024);
+    EXPECT_NE(a, b);
+    EXPECT_NE(a->signal, b->signal);
+    pool.release(a);
+    pool.release(b);
+    EXPECT_EQ(fake.allocations, 5);
+  }
+
+  // everything released with the pool
+  EXPECT_TRUE(fake.buffers.empty());
+  EXPECT_TRUE(fake.live_signals.empty());
+}
+
+TEST(TransferPool, exact_size_fallback) {
+  FakeAllocator fake;
+  rvs::TransferPool pool(&fake);
+  fake.max_size = 3000;
+
+  rvs::TransferPool::Entry* e = pool.acquire(0, 1, 2500);
+  ASSERT_NE(e, nullptr);
+  EXPECT_EQ(e->size, 2500u);
+  EXPECT_EQ(e->size_class, 4096u);
+  pool.release(e);
+
+  // entry is reused by smaller transfers of the same class
+  e = pool.acquire(0, 1, 2100);
+  EXPECT_EQ(e->size, 2500u);
+  pool.release(e);
+  EXPECT_EQ(fake.allocations, 1);
+
+  // but not by bigger ones
+  EXPECT_EQ(pool.acquire(0, 1, 4000), nullptr);
+
+  // signal failure releases buffers
+  fake.fail_signal = true;
+  EXPECT_EQ(pool.acquire(2, 3, 1024), nullptr);
+  pool.clear();
+  EXPECT_TRUE(fake.buffers.empty());
+}
+
+TEST(TransferPool, trim_biggest_first) {
+  FakeAllocator fake;
+  // room for idle 1K, 2K and 4K entries (both buffers)
+  rvs::TransferPool pool(&fake, 2 * (1024 + 2048 + 4096));
+
+  rvs::TransferPool::Entry* big = pool.acquire(0, 1, 64 * 1024);
+  pool.release(pool.acquire(0, 1, 1024));
+  pool.release(pool.acquire(0, 1, 2048));
+  pool.release(pool.acquire(0, 1, 4096));
+
+  // big entry in use is kept even over limit
+  EXPECT_EQ(pool.entries(), 4u);
+  pool.release(big);
+  EXPECT_EQ(pool.entries(), 3u);
+  EXPECT_EQ(pool.cached_bytes(), 2u * (1024 + 2048 + 4096));
+
+  // small entries survive while big transfer comes and goes
+  int allocations = fake.allocations;
+  pool.release(pool.acquire(0, 1, 64 * 1024));
+  pool.release(pool.acquire(0, 1, 1024));
+  pool.release(pool.acquire(0, 1, 2048));
+  EXPECT_EQ(fake.allocations, allocations + 1);
+}
+
+TEST(TransferPool, concurrent) {
+  FakeAllocator fake;
+  rvs::TransferPool pool(&fake);
+  const int threads = 8;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&pool, t]() {
+      for (int i = 0; i < 1000; i++) {
+        rvs::TransferPool::Entry* e = pool.acquire(t % 2, 2, 1024 << (i % 4));
+        ASSERT_NE(e, nullptr);
+        ASSERT_TRUE(e->in_use);
+        pool.release(e);
+      }
+    }));
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  // 8 keys, each shared by 4 threads at most
+  EXPECT_LE(fake.allocations, 8 * 4);
+  pool.clear();
+  EXPECT_TRUE(fake.buffers.empty());
+  EXPECT_TRUE(fake.live_signals.empty());
+}
@@ -0,0 +1,184 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvslinkmap.h"
+#include "include/rvslinksched.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+std::vector<rvs::linkinfo_t> path(int Type, int Hops = 1) {
+  rvs::linkinfo_t info;
+  info.distance = 15;
+  info.etype = Type;
+  info.strtype = Type == RVS_LINK_TYPE_XGMI ? "xGMI" :
+                 Type == RVS_LINK_TYPE_PCIE ? "PCIe" : "QPI";
+  return std::vector<rvs::linkinfo_t>(Hops, info);
+}
+
+// checks that every transfer is scheduled exactly once and that
+// transfers of one round share no link
+void check_rounds(const rvs::LinkMap& Map,
+                  const std::vector<std::vector<size_t>>& Rounds) {
+  std::vector<int> seen(Map.size(), 0);
+  for (auto& round : Rounds) {
+    ASSERT_FALSE(round.empty());
+    for (size_t i = 0; i < round.size(); i++) {
+      ASSERT_LT(round[i], Map.size());
+      seen[round[i]]++;
+      for (size_t j = i + 1; j < round.size(); j++) {
+        EXPECT_TRUE(Map.disjoint(round[i], round[j]))
+          << round[i] << " and " << round[j] << " share a link";
+      }
+    }
+  }
+  for (size_t t = 0; t < Map.size(); t++) {
+    EXPECT_EQ(seen[t], 1) << "transfer " << t;
+  }
+}
+
+}  // namespace
+
+TEST(linksched, xgmi_hive) {
+  // every directed pair of a fully connected hive has its own link
+  rvs::LinkMap map;
+  for (uint32_t s = 0; s < 8; s++) {
+    for (uint32_t d = 0; d < 8; d++) {
+      if (s != d) {
+        map.add(s, d, path(RVS_LINK_TYPE_XGMI));
+      }
+    }
+  }
+  std::vector<std::vector<size_t>> rounds;
+  EXPECT_EQ(rvs::LinkScheduler::schedule(map, &rounds), 1u);
+  EXPECT_EQ(rvs::LinkScheduler::lower_bound(map), 1u);
+  check_rounds(map, rounds);
+
+  // bidirectional transfers in both directions share links
+  rvs::LinkMap bidir;
+  for (uint32_t s = 0; s < 4; s++) {
+    for (uint32_t d = 0; d < 4; d++) {
+      if (s != d) {
+        size_t t = bidir.add(s, d, path(RVS_LINK_TYPE_XGMI));
+        bidir.add_path(t, d, s, path(RVS_LINK_TYPE_XGMI));
+      }
+    }
+  }
+  EXPECT_EQ(rvs::LinkScheduler::lower_bound(bidir), 2u);
+  EXPECT_EQ(rvs::LinkScheduler::schedule(bidir, &rounds), 2u);
+  check_rounds(bidir, rounds);
+}
+
+TEST(linksched, pcie_all_pairs) {
+  // N GPUs under PCIe: each GPU sends N-1 and receives N-1 transfers
+  for (uint32_t n = 2; n <= 16; n++) {
+    rvs::LinkMap map;
+    for (uint32_t s = 0; s < n; s++) {
+      for (uint32_t d = 0; d < n; d++) {
+        if (s != d) {
+          map.add(s, d, path(RVS_LINK_TYPE_PCIE));
+        }
+      }
+    }
+    std::vector<std::vector<size_t>> rounds;
+    size_t count = rvs::LinkScheduler::schedule(map, &rounds);
+    EXPECT_EQ(rvs::LinkScheduler::lower_bound(map), n - 1);
+    // N-1 rounds instead of N*(N-1) one at a time
+    EXPECT_EQ(count, n - 1) << n << " GPUs";
+    EXPECT_EQ(count, rounds.size());
+    check_rounds(map, rounds);
+  }
+}
+
+TEST(linksched, shared_fabric) {
+  // two sockets: GPUs 0-3 on one, 4-7 on the other, all pairs across
+  // sockets cross the same QPI link
+  rvs::LinkMap map;
+  for (uint32_t s = 0; s < 8; s++) {
+    for (uint32_t d = 0; d < 8; d++) {
+      if (s == d) {
+        continue;
+      }
+      std::vector<rvs::linkinfo_t> p = path(RVS_LINK_TYPE_PCIE);
+      if ((s < 4) != (d < 4)) {
+        std::vector<rvs::linkinfo_t> q = path(0);
+        p.insert(p.end(), q.begin(), q.end());
+      }
+      map.add(s, d, p);
+    }
+  }
+  std::vector<std::vector<size_t>> rounds;
+  size_t count = rvs::LinkScheduler::schedule(map, &rounds);
+  // 32 transfers cross the QPI link, one per round
+  EXPECT_EQ(rvs::LinkScheduler::lower_bound(map), 32u);
+  EXPECT_EQ(count, 32u);
+  check_rounds(map, rounds);
+}
+
+TEST(linksched, random_topology) {
+  srand(1);
+  for (int iter = 0; iter < 50; iter++) {
+    rvs::LinkMap map;
+    uint32_t n = 2 + rand() % 15;
+    for (uint32_t s = 0; s < n; s++) {
+      for (uint32_t d = 0; d < n; d++) {
+        if (s == d || rand() % 3 == 0) {
+          continue;
+        }
+        int type = rand() % 4 ? RVS_LINK_TYPE_XGMI : RVS_LINK_TYPE_PCIE;
+        map.add(s, d, path(type, 1 + rand() % 2));
+      }
+    }
+    std::vector<std::vector<size_t>> rounds;
+    size_t count = rvs::LinkScheduler::schedule(map, &rounds);
+    EXPECT_GE(count, rvs::LinkScheduler::lower_bound(map));
+    EXPECT_LE(count, map.size());
+    check_rounds(map, rounds);
+  }
+}
+
+TEST(linksched, unknown_path) {
+  rvs::LinkMap map;
+  map.add(0, 1, path(RVS_LINK_TYPE_XGMI));
+  map.add(2, 3, std::vector<rvs::linkinfo_t>());
+  map.add(1, 0, path(RVS_LINK_TYPE_XGMI));
+  map.add(3, 2, std::vector<rvs::linkinfo_t>());
+
+  std::vector<std::vector<size_t>> rounds;
+  ASSERT_EQ(rvs::LinkScheduler::schedule(map, &rounds), 3u);
+  check_rounds(map, rounds);
+  EXPECT_EQ(rounds[0], std::vector<size_t>({0, 2}));
+  EXPECT_EQ(rounds[1], std::vector<size_t>({1}));
+  EXPECT_EQ(rounds[2], std::vector<size_t>({3}));
+
+  rvs::LinkMap empty;
+  EXPECT_EQ(rvs::LinkScheduler::schedule(empty, &rounds), 0u);
+  EXPECT_EQ(rvs::LinkScheduler::lower_bound(empty), 0u);
+}
@@ -0,0 +1,177 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvslogarena.h"
+#include "include/rvslognode.h"
+#include "include/rvslognodeint.h"
+#include "include/rvslognoderec.h"
+#include "include/rvslognodestring.h"
+#include "include/rvs_unit_testing_defs.h"
+
+// count heap allocations made by this process
+static std::atomic<uint64_t> num_new(0);
+
+// every replaced new has its matching delete; kept out of line so that
+// the compiler never pairs an inlined malloc()/free() with new/delete
+__attribute__((noinline)) static void* counted_alloc(size_t size) {
+  num_new++;
+  void* p = malloc(size ? size : 1);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+__attribute__((noinline)) static void counted_free(void* p) noexcept {
+  free(p);
+}
+
+void* operator new(size_t size) {
+  return counted_alloc(size);
+}
+
+void* operator new[](size_t size) {
+  return counted_alloc(size);
+}
+
+void operator delete(void* p) noexcept {
+  counted_free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  counted_free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  counted_free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  counted_free(p);
+}
+
+// build GM-like metrics record through logger API
+void build_record_api() {
+  void* r = rvs::logger::LogRecordCreate("gm", "action_1", rvs::loginfo, 0, 0);
+  rvs::logger::AddString(r, "gpu_id", "3254");
+  rvs::logger::AddString(r, "info", "met metric values");
+  for (int i = 0; i < 8; i++) {
+    rvs::logger::AddInt(r, "metric_value_with_long_key", i);
+  }
+  void* n = rvs::logger::CreateNode(r, "hops");
+  for (int i = 0; i < 4; i++) {
+    rvs::logger::AddString(n, "type", "PCIe link in between the two GPUs");
+  }
+  rvs::logger::AddNode(r, n);
+  rvs::logger::LogRecordFlush(r);
+}
+
+// same record built on the heap
+void build_record_heap() {
+  rvs::LogNodeRec* r = new rvs::LogNodeRec("action_1", rvs::loginfo, 1, 2);
+  r->Add(new rvs::LogNodeString("action", "action_1", r));
+  r->Add(new rvs::LogNodeString("module", "gm", r));
+  r->Add(new rvs::LogNodeString("loglevelname", "INFO  ", r));
+  r->Add(new rvs::LogNodeString("gpu_id", "3254", r));
+  r->Add(new rvs::LogNodeString("info", "met metric values", r));
+  for (int i = 0; i < 8; i++) {
+    r->Add(new rvs::LogNodeInt("metric_value_with_long_key", i, r));
+  }
+  rvs::LogNode* n = new rvs::LogNode("hops", r);
+  for (int i = 0; i < 4; i++) {
+    n->Add(new rvs::LogNodeString("type",
+                                  "PCIe link in between the two GPUs", n));
+  }
+  r->Add(n);
+  delete r;
+}
+
+TEST(logarena, allocate_reset) {
+  rvs::LogArena arena(256);
+  uint64_t blocks = rvs::LogArena::block_allocations();
+
+  // alignment is honored
+  for (int i = 0; i < 10; i++) {
+    arena.allocate(1, 1);
+    void* p = arena.allocate(24, 8);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 8, 0u);
+  }
+
+  // oversized request gets its own block
+  arena.allocate(1000);
+  const char* s = arena.copy("hello");
+  EXPECT_STREQ(s, "hello");
+  size_t nblocks = arena.blocks();
+  EXPECT_EQ(rvs::LogArena::block_allocations() - blocks, nblocks);
+
+  // after reset the same sequence reuses existing blocks
+  arena.reset();
+  for (int i = 0; i < 10; i++) {
+    arena.allocate(1, 1);
+    arena.allocate(24, 8);
+  }
+  arena.allocate(1000);
+  arena.copy("hello");
+  EXPECT_EQ(arena.blocks(), nblocks);
+  EXPECT_EQ(rvs::LogArena::block_allocations() - blocks, nblocks);
+}
+
+TEST(logarena, allocations_per_record) {
+  const int num_records = 1000;
+
+  rvs::logger::to_json(false);
+
+  // warm-up: fills per-thread arena cache
+  build_record_api();
+
+  uint64_t n0 = num_new.load();
+  for (int i = 0; i < num_records; i++) {
+    build_record_api();
+  }
+  uint64_t n1 = num_new.load();
+  for (int i = 0; i < num_records; i++) {
+    build_record_heap();
+  }
+  uint64_t n2 = num_new.load();
+
+  double arena_allocs = static_cast<double>(n1 - n0) / num_records;
+  double heap_allocs = static_cast<double>(n2 - n1) / num_records;
+
+  std::cout << "allocations per record: arena " << arena_allocs
+            << ", heap " << heap_allocs << std::endl;
+
+  EXPECT_LE(arena_allocs, 1.0);
+  EXPECT_GE(heap_allocs, 20.0);
+}
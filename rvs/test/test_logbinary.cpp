@@ -0,0 +1,172 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvslogbinary.h"
+#include "include/rvs_unit_testing_defs.h"
+
+class LogBinaryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string pid = std::to_string(getpid());
+    text_file = "rvs_test_text_" + pid + ".log";
+    json_file = "rvs_test_json_" + pid + ".log";
+    bin_file = "rvs_test_bin_" + pid + ".log";
+    bin_json_file = "rvs_test_bin_json_" + pid + ".log";
+    rvs::logger::quiet();
+    rvs::logger::log_level(rvs::loginfo);
+  }
+
+  void TearDown() override {
+    rvs::logger::to_json(false);
+    rvs::logger::binary(false);
+    rvs::logger::append(false);
+    rvs::logger::set_log_file("");
+    unlink(text_file.c_str());
+    unlink(json_file.c_str());
+    unlink(bin_file.c_str());
+    unlink(bin_json_file.c_str());
+  }
+
+  // log typical gst/pqt rows and records [first, last) through the logger
+  static void log_run(int first, int last) {
+    for (int i = first; i < last; i++) {
+      uint32_t sec = 1000 + i / 10;
+      uint32_t usec = (i * 7919) % 1000000;
+      std::string msg = "[action_1] gst " + std::to_string(i % 4) +
+                        " Gflops " + std::to_string(11000.5 + i);
+      rvs::logger::LogExt(msg.c_str(), rvs::loginfo, sec, usec);
+
+      void* r = rvs::logger::LogRecordCreate("gst", "action_1",
+                                             rvs::loginfo, sec, usec);
+      rvs::logger::AddString(r, "gpu_id", std::to_string(i % 4).c_str());
+      rvs::logger::AddString(r, "Gflops",
+                             std::to_string(11000.5 + i).c_str());
+      void* n = rvs::logger::CreateNode(r, "counters");
+      rvs::logger::AddInt(n, "iteration", i);
+      rvs::logger::AddInt(n, "delta", -i);
+      rvs::logger::AddNode(r, n);
+      rvs::logger::LogRecordFlush(r);
+    }
+  }
+
+  // run logger session writing given file
+  static double session(const std::string& file, bool json, bool binary,
+                        bool append, int first, int last) {
+    rvs::logger::to_json(json);
+    rvs::logger::binary(binary);
+    rvs::logger::append(append);
+    rvs::logger::set_log_file(file);
+    EXPECT_EQ(rvs::logger::init_log_file(), 0);
+    auto t0 = std::chrono::steady_clock::now();
+    log_run(first, last);
+    rvs::logger::flush();
+    auto t1 = std::chrono::steady_clock::now();
+    rvs::logger::terminate();
+    return std::chrono::duration<double>(t1 - t0).count();
+  }
+
+  static std::string read_file(const std::string& name) {
+    std::ifstream is(name, std::ios::in | std::ios::binary);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+  }
+
+  std::string text_file;
+  std::string json_file;
+  std::string bin_file;
+  std::string bin_json_file;
+};
+
+TEST_F(LogBinaryTest, varint) {
+  std::string buf;
+  rvs::LogBinaryWriter::put_varint(&buf, 0);
+  rvs::LogBinaryWriter::put_varint(&buf, 127);
+  rvs::LogBinaryWriter::put_varint(&buf, 128);
+  rvs::LogBinaryWriter::put_varint(&buf, 0xffffffffffffffffULL);
+  EXPECT_EQ(buf.size(), 1u + 1u + 2u + 10u);
+  EXPECT_EQ(static_cast<uint8_t>(buf[2]), 0x80);
+  EXPECT_EQ(static_cast<uint8_t>(buf[3]), 0x01);
+}
+
+TEST_F(LogBinaryTest, convert_and_size) {
+  const int num = 2000;
+
+  double t_text = session(text_file, false, false, false, 0, num);
+  double t_json = session(json_file, true, false, false, 0, num);
+  // binary logs in two appended sessions
+  double t_bin = session(bin_file, false, true, false, 0, num / 2);
+  t_bin += session(bin_file, false, true, true, num / 2, num);
+  double t_bin_json = session(bin_json_file, true, true, false, 0, num / 2);
+  t_bin_json += session(bin_json_file, true, true, true, num / 2, num);
+
+  std::string text = read_file(text_file);
+  std::string json = read_file(json_file);
+  std::string bin = read_file(bin_file);
+  std::string bin_json = read_file(bin_json_file);
+
+  int count;
+  std::ifstream in_text(bin_file, std::ios::in | std::ios::binary);
+  std::ostringstream out_text;
+  EXPECT_EQ(rvs::LogBinaryReader::ToText(in_text, out_text, &count), 0);
+  EXPECT_EQ(count, num);
+  EXPECT_EQ(out_text.str(), text);
+
+  std::ifstream in_json(bin_json_file, std::ios::in | std::ios::binary);
+  std::ostringstream out_json;
+  EXPECT_EQ(rvs::LogBinaryReader::ToJson(in_json, out_json, &count), 0);
+  EXPECT_EQ(count, num);
+  EXPECT_EQ(out_json.str(), json);
+
+  // log still being written: trailing partial element is ignored
+  std::istringstream partial(bin_json.substr(0, bin_json.size() - 3));
+  std::ostringstream out_partial;
+  EXPECT_EQ(rvs::LogBinaryReader::ToJson(partial, out_partial, &count), 0);
+  EXPECT_EQ(count, num - 1);
+
+  std::cout << "text log  : " << text.size() << " bytes, "
+            << t_text * 1e9 / num << " ns/row" << std::endl;
+  std::cout << "JSON log  : " << json.size() << " bytes, "
+            << t_json * 1e9 / num << " ns/record" << std::endl;
+  std::cout << "binary text log: " << bin.size() << " bytes, "
+            << t_bin * 1e9 / num << " ns/row" << std::endl;
+  std::cout << "binary JSON log: " << bin_json.size() << " bytes, "
+            << t_bin_json * 1e9 / num << " ns/record" << std::endl;
+
+  // each binary log holds only the stream its session is configured for
+  EXPECT_LT(bin.size() * 3, text.size());
+  EXPECT_LT(bin_json.size() * 6, json.size());
+}
@@ -0,0 +1,138 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvslognodebase.h"
+#include "include/rvs_unit_testing_defs.h"
+
+class ext_logger : public rvs::logger {
+ public:
+  // open/append/close per row (writer thread bypassed)
+  static int to_file_direct(const std::string& Row) {
+    return rvs::logger::ToFileDirect(Row);
+  }
+};
+
+class LoggerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    log_file = "rvs_test_logger_" + std::to_string(getpid()) + ".log";
+    rvs::logger::quiet();
+    rvs::logger::to_json(false);
+    rvs::logger::append(false);
+    rvs::logger::log_level(rvs::loginfo);
+    rvs::logger::set_log_file(log_file);
+  }
+
+  void TearDown() override {
+    rvs::logger::set_log_file("");
+    unlink(log_file.c_str());
+  }
+
+  // count non-empty lines in log file
+  int count_rows() {
+    std::ifstream is(log_file);
+    std::string line;
+    int cnt = 0;
+    while (std::getline(is, line)) {
+      if (line.size() > 0)
+        cnt++;
+    }
+    return cnt;
+  }
+
+  std::string log_file;
+};
+
+TEST_F(LoggerTest, writer_thread_no_loss) {
+  const int num_threads = 8;
+  const int num_rows = 2000;
+
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+
+  std::vector<std::thread> t;
+  for (int i = 0; i < num_threads; i++) {
+    t.push_back(std::thread([i, num_rows]() {
+      for (int j = 0; j < num_rows; j++) {
+        std::string msg = "[unit] thread " + std::to_string(i) +
+                          " row " + std::to_string(j);
+        rvs::logger::LogExt(msg.c_str(), rvs::loginfo, 0, 0);
+      }
+    }));
+  }
+  for (auto it = t.begin(); it != t.end(); ++it) {
+    it->join();
+  }
+
+  // rows are visible after flush() while file is still open
+  rvs::logger::flush();
+  EXPECT_EQ(count_rows(), num_threads * num_rows);
+
+  EXPECT_EQ(rvs::logger::terminate(), 0);
+  EXPECT_EQ(count_rows(), num_threads * num_rows);
+}
+
+TEST_F(LoggerTest, writer_thread_rows_per_second) {
+  const int num_rows = 20000;
+  const std::string row = "[INFO  ] [ 1234.567890] [unit] benchmark row";
+
+  // before: open/append/close for every row
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+  rvs::logger::terminate();
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_rows; i++) {
+    ext_logger::to_file_direct(RVSENDL + row);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double direct_s = std::chrono::duration<double>(t1 - t0).count();
+
+  // after: queued rows written by background writer thread
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+  t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_rows; i++) {
+    rvs::logger::LogExt(row.c_str(), rvs::loginfo, 1234, 567890);
+  }
+  rvs::logger::terminate();
+  t1 = std::chrono::steady_clock::now();
+  double queued_s = std::chrono::duration<double>(t1 - t0).count();
+
+  EXPECT_EQ(count_rows(), num_rows);
+
+  std::cout << "open/close per row : " << num_rows / direct_s
+            << " rows/s" << std::endl;
+  std::cout << "writer thread      : " << num_rows / queued_s
+            << " rows/s" << std::endl;
+}
@@ -0,0 +1,107 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvsloglp.h"
+#include "include/rvs_unit_testing_defs.h"
+
+class ext_lp : public rvs::lp {
+ public:
+  template <typename... Args>
+  static std::string format(const Args&... args) {
+    std::string msg;
+    Format(&msg, args...);
+    return msg;
+  }
+};
+
+TEST(loglazy, format) {
+  std::string action_name("action_1");
+  uint16_t src = 3;
+  int32_t dst = -1;
+  uint64_t size = 1ULL << 40;
+  double gflops = 1234.5;
+
+  std::string eager = "[" + action_name + "] pqt transfer "
+    + std::to_string(src) + " " + std::to_string(dst) + " "
+    + std::to_string(size) + " " + std::to_string(gflops) + 'x';
+  EXPECT_EQ(ext_lp::format("[", action_name, "] pqt transfer ", src, " ",
+                           dst, " ", size, " ", gflops, 'x'), eager);
+  EXPECT_EQ(ext_lp::format(), "");
+}
+
+TEST(loglazy, level_gate) {
+  rvs::logger::log_level(rvs::loginfo);
+  EXPECT_EQ(rvs::lp::LogLevel(), rvs::loginfo);
+  EXPECT_TRUE(rvs::lp::Enabled(rvs::logresults));
+  EXPECT_TRUE(rvs::lp::Enabled(rvs::loginfo));
+  EXPECT_FALSE(rvs::lp::Enabled(rvs::logdebug));
+  EXPECT_FALSE(rvs::lp::Enabled(rvs::logtrace));
+  EXPECT_EQ(rvs::lp::LogLazy(rvs::logtrace, "not ", "printed ", 1), 0);
+  rvs::logger::log_level(rvs::logerror);
+}
+
+TEST(loglazy, filtered_cost) {
+  const int iter = 1000000;
+  std::string action_name("action_1");
+  uint16_t src = 3;
+  uint16_t dst = 4;
+  int sts = 0;
+
+  rvs::logger::log_level(rvs::logerror);
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iter; i++) {
+    std::string msg = "[" + action_name + "] pqt transfer "
+      + std::to_string(src) + " " + std::to_string(dst) + " "
+      + std::to_string(i) + " start";
+    sts |= rvs::lp::Log(msg, rvs::logdebug);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iter; i++) {
+    sts |= rvs::lp::LogLazy(rvs::logdebug, "[", action_name,
+                            "] pqt transfer ", src, " ", dst, " ", i,
+                            " start");
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(sts, 0);
+
+  double eager = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  double lazy = std::chrono::duration<double, std::nano>(t2 - t1).count();
+  std::cout << "filtered message, eager formatting: " << eager / iter
+            << " ns/call" << std::endl;
+  std::cout << "filtered message, lazy formatting : " << lazy / iter
+            << " ns/call" << std::endl;
+  EXPECT_LT(lazy, eager);
+}
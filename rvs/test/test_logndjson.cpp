@@ -0,0 +1,153 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvslogndjson.h"
+#include "include/rvslognode.h"
+#include "include/rvslognodeint.h"
+#include "include/rvslognoderec.h"
+#include "include/rvslognodestring.h"
+#include "include/rvs_unit_testing_defs.h"
+
+class LogNdjsonTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string pid = std::to_string(getpid());
+    array_file = "rvs_test_array_" + pid + ".json";
+    ndjson_file = "rvs_test_ndjson_" + pid + ".json";
+    rvs::logger::quiet();
+    rvs::logger::log_level(rvs::loginfo);
+  }
+
+  void TearDown() override {
+    rvs::logger::to_json(false);
+    rvs::logger::ndjson(false);
+    rvs::logger::append(false);
+    rvs::logger::set_log_file("");
+    unlink(array_file.c_str());
+    unlink(ndjson_file.c_str());
+  }
+
+  // log records [first, last) through the logger
+  static void log_records(int first, int last) {
+    for (int i = first; i < last; i++) {
+      void* r = rvs::logger::LogRecordCreate("unit", "action_1",
+                                             rvs::logresults, 100 + i, i);
+      rvs::logger::AddString(r, "msg", ("record " + std::to_string(i)).c_str());
+      void* n = rvs::logger::CreateNode(r, "nested");
+      rvs::logger::AddInt(n, "index", i);
+      rvs::logger::AddNode(r, n);
+      rvs::logger::LogRecordFlush(r);
+    }
+  }
+
+  static std::string read_file(const std::string& name) {
+    std::ifstream is(name);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+  }
+
+  std::string array_file;
+  std::string ndjson_file;
+};
+
+TEST_F(LogNdjsonTest, reindent) {
+  rvs::LogNodeRec* rec = new rvs::LogNodeRec("action", rvs::loginfo, 12, 34);
+  rec->Add(new rvs::LogNodeString("msg", "a, {quoted \\\"} value", rec));
+  rvs::LogNode* node = new rvs::LogNode("node", rec);
+  node->Add(new rvs::LogNodeInt("val", -5, node));
+  node->Add(new rvs::LogNode("empty", node));
+  rec->Add(node);
+
+  std::string line;
+  rec->WriteJson(&line, "", RVSJSONLINE);
+  EXPECT_EQ(line.find('\n'), std::string::npos);
+
+  std::string out;
+  EXPECT_TRUE(rvs::LogNdjson::Reindent(line, "  ", &out));
+  EXPECT_EQ(out, rec->ToJson("  "));
+
+  // incomplete record is rejected
+  out.clear();
+  EXPECT_FALSE(rvs::LogNdjson::Reindent(line.substr(0, line.size() / 2),
+                                        "  ", &out));
+  delete rec;
+}
+
+TEST_F(LogNdjsonTest, convert_appended_log) {
+  // reference: the whole run written as JSON array
+  rvs::logger::to_json(true);
+  rvs::logger::set_log_file(array_file);
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+  log_records(0, 20);
+  rvs::logger::terminate();
+
+  // the same records in two NDJSON sessions, second one appending
+  rvs::logger::ndjson(true);
+  rvs::logger::set_log_file(ndjson_file);
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+  log_records(0, 10);
+  rvs::logger::flush();
+
+  // records are complete lines while file is still open
+  std::string partial = read_file(ndjson_file);
+  std::istringstream is(partial);
+  std::string line;
+  int rows = 0;
+  while (std::getline(is, line)) {
+    EXPECT_EQ(line[0], '{');
+    EXPECT_EQ(line[line.size() - 1], '}');
+    rows++;
+  }
+  EXPECT_EQ(rows, 10);
+  rvs::logger::terminate();
+
+  rvs::logger::append(true);
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+  log_records(10, 20);
+  rvs::logger::terminate();
+
+  std::ifstream in(ndjson_file);
+  std::ostringstream out;
+  int count = 0;
+  EXPECT_EQ(rvs::LogNdjson::ToArray(in, out, &count), 0);
+  EXPECT_EQ(count, 20);
+  EXPECT_EQ(out.str(), read_file(array_file));
+
+  // record being written at the end of a running log is skipped
+  std::istringstream tail(partial + partial.substr(0, 40));
+  std::ostringstream out_tail;
+  EXPECT_EQ(rvs::LogNdjson::ToArray(tail, out_tail, &count), 0);
+  EXPECT_EQ(count, 10);
+}
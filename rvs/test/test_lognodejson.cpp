@@ -0,0 +1,186 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "include/rvslognodebase.h"
+#include "include/rvslognode.h"
+#include "include/rvslognodeint.h"
+#include "include/rvslognoderec.h"
+#include "include/rvslognodestring.h"
+#include "include/rvs_unit_testing_defs.h"
+
+// recursive string concatenation as done before streaming JSON output
+std::string legacy_json(rvs::LogNodeBase* p, const std::string& Lead);
+
+class ext_string : public rvs::LogNodeString {
+ public:
+  std::string legacy(const std::string& Lead) {
+    std::string result(RVSENDL);
+    result += Lead + "\"" + Name + "\"" + " : " + "\"" + Value + "\"";
+    return result;
+  }
+};
+
+class ext_int : public rvs::LogNodeInt {
+ public:
+  std::string legacy(const std::string& Lead) {
+    std::string result(RVSENDL);
+    result += Lead + "\"" + Name + "\"" + " : " + std::to_string(Value);
+    return result;
+  }
+};
+
+class ext_node : public rvs::LogNode {
+ public:
+  std::string legacy(const std::string& Lead) {
+    std::string result(RVSENDL);
+    result += Lead + "\"" + Name + "\"" + " : {";
+    int  size = Child.size();
+    for (int i = 0; i < size; i++) {
+      result += legacy_json(Child[i], Lead + RVSINDENT);
+      if (i+ 1 < size) {
+        result += ",";
+      }
+    }
+    result += RVSENDL + Lead + "}";
+    return result;
+  }
+};
+
+class ext_rec : public rvs::LogNodeRec {
+ public:
+  std::string legacy(const std::string& Lead) {
+    std::string result(RVSENDL);
+    result += Lead + "{";
+    result += RVSENDL;
+    result += Lead + RVSINDENT;
+    result += std::string("\"") + "loglevel" + "\"" + " : " +
+              std::to_string(Level) + ",";
+    char  buff[64];
+    snprintf(buff, sizeof(buff), "%6d.%-6d", sec, usec);
+    result += RVSENDL;
+    result += Lead + RVSINDENT;
+    result += std::string("\"") + "time" + "\"" + " : " +
+              std::string("\"") + buff + std::string("\"")  + ",";
+    int  size = Child.size();
+    for (int i = 0; i < size; i++) {
+      result += legacy_json(Child[i], Lead + RVSINDENT);
+      if (i+ 1 < size) {
+        result += ",";
+      }
+    }
+    result += RVSENDL + Lead + "}";
+    return result;
+  }
+};
+
+std::string legacy_json(rvs::LogNodeBase* p, const std::string& Lead) {
+  if (dynamic_cast<rvs::LogNodeRec*>(p))
+    return static_cast<ext_rec*>(p)->legacy(Lead);
+  if (dynamic_cast<rvs::LogNode*>(p))
+    return static_cast<ext_node*>(p)->legacy(Lead);
+  if (dynamic_cast<rvs::LogNodeString*>(p))
+    return static_cast<ext_string*>(p)->legacy(Lead);
+  return static_cast<ext_int*>(p)->legacy(Lead);
+}
+
+// build record similar to large gpup/peqt dumps
+rvs::LogNodeRec* make_tree(int num_nodes, int num_props, int depth) {
+  rvs::LogNodeRec* rec = new rvs::LogNodeRec("action", 3, 1234, 56);
+  rec->Add(new rvs::LogNodeString("action", "action_1", rec));
+  rec->Add(new rvs::LogNodeString("module", "gpup", rec));
+
+  for (int i = 0; i < num_nodes; i++) {
+    std::string name = "gpu_" + std::to_string(i);
+    rvs::LogNode* parent = new rvs::LogNode(name.c_str(), rec);
+    rec->Add(parent);
+    for (int d = 0; d < depth; d++) {
+      std::string key = "level_" + std::to_string(d);
+      rvs::LogNode* child = new rvs::LogNode(key.c_str(), parent);
+      for (int j = 0; j < num_props; j++) {
+        std::string k = "prop_" + std::to_string(j);
+        std::string v = "value " + std::to_string(i * j);
+        child->Add(new rvs::LogNodeString(k.c_str(), v.c_str(), child));
+        k = "num_" + std::to_string(j);
+        child->Add(new rvs::LogNodeInt(k.c_str(), i * j - 100, child));
+      }
+      parent->Add(child);
+      parent = child;
+    }
+  }
+  return rec;
+}
+
+TEST(lognodejson, identical_output) {
+  // empty record
+  rvs::LogNodeRec empty("empty", -1, -1, -1);
+  EXPECT_EQ(empty.ToJson("T "), legacy_json(&empty, "T "));
+
+  // nested record
+  rvs::LogNodeRec* rec = make_tree(3, 4, 3);
+  EXPECT_EQ(rec->ToJson(), legacy_json(rec, ""));
+  EXPECT_EQ(rec->ToJson("  "), legacy_json(rec, "  "));
+
+  // output is appended to existing buffer content
+  std::string out(",");
+  rec->WriteJson(&out, "  ", 0);
+  EXPECT_EQ(out, "," + legacy_json(rec, "  "));
+  delete rec;
+}
+
+TEST(lognodejson, benchmark) {
+  const int iter = 20;
+  rvs::LogNodeRec* rec = make_tree(64, 32, 4);
+
+  std::string legacy;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iter; i++) {
+    legacy = legacy_json(rec, "  ");
+  }
+  auto t1 = std::chrono::steady_clock::now();
+
+  std::string out;
+  for (int i = 0; i < iter; i++) {
+    out.clear();
+    rec->WriteJson(&out, "  ", 0);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(out, legacy);
+
+  double mb = static_cast<double>(out.size()) * iter / (1024 * 1024);
+  std::cout << "record size " << out.size() << " bytes" << std::endl;
+  std::cout << "recursive concatenation: "
+            << mb / std::chrono::duration<double>(t1 - t0).count()
+            << " MB/s" << std::endl;
+  std::cout << "streaming writer       : "
+            << mb / std::chrono::duration<double>(t2 - t1).count()
+            << " MB/s" << std::endl;
+  delete rec;
+}
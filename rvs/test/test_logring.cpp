@@ -0,0 +1,234 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvslogring.h"
+#include "include/rvsthreadbase.h"
+#include "include/rvs_unit_testing_defs.h"
+
+class log_worker : public rvs::ThreadBase {
+ public:
+  log_worker(int Id, int Rows) : id(Id), rows(Rows) {
+  }
+  virtual ~log_worker() {
+  }
+
+ protected:
+  void run() {
+    for (int i = 0; i < rows; i++) {
+      std::string msg = "[unit] [worker] " + std::to_string(id) +
+                        " row " + std::to_string(i);
+      rvs::logger::LogExt(msg.c_str(), rvs::loginfo, 0, 0);
+    }
+  }
+
+  int id;
+  int rows;
+};
+
+TEST(logring, push_pop_wrap) {
+  rvs::LogRing ring(5);
+  rvs::LogRingRecord rec;
+
+  // capacity is rounded up to power of 2
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_FALSE(ring.pop(&rec));
+
+  for (int pass = 0; pass < 3; pass++) {
+    for (uint32_t i = 0; i < 8; i++) {
+      EXPECT_TRUE(ring.push(pass, i, rvs::loginfo, "msg"));
+    }
+    // full
+    EXPECT_FALSE(ring.push(pass, 8, rvs::loginfo, "msg"));
+    EXPECT_EQ(ring.size(), 8u);
+
+    for (uint32_t i = 0; i < 8; i++) {
+      ASSERT_TRUE(ring.pop(&rec));
+      EXPECT_EQ(rec.sec, static_cast<uint32_t>(pass));
+      EXPECT_EQ(rec.usec, i);
+      EXPECT_STREQ(rec.msg.c_str(), "msg");
+    }
+    EXPECT_FALSE(ring.pop(&rec));
+  }
+}
+
+TEST(logring, merge_in_timestamp_order) {
+  const int num_threads = 4;
+  const int num_rows = 500;
+  std::vector<rvs::LogRingRecord> recs;
+
+  // discard anything left over by other tests
+  rvs::LogRingSet::drain(&recs);
+  recs.clear();
+
+  // each thread logs every num_threads-th microsecond
+  std::vector<std::thread> t;
+  for (int i = 0; i < num_threads; i++) {
+    t.push_back(std::thread([i, num_threads, num_rows]() {
+      rvs::LogRing* ring = rvs::LogRingSet::local();
+      for (int j = 0; j < num_rows; j++) {
+        uint32_t usec = j * num_threads + i;
+        ring->push(10, usec, rvs::loginfo, std::to_string(usec).c_str());
+      }
+    }));
+  }
+  for (auto it = t.begin(); it != t.end(); ++it) {
+    it->join();
+  }
+
+  EXPECT_EQ(rvs::LogRingSet::drain(&recs),
+            static_cast<size_t>(num_threads * num_rows));
+  ASSERT_EQ(recs.size(), static_cast<size_t>(num_threads * num_rows));
+  for (size_t i = 0; i < recs.size(); i++) {
+    EXPECT_EQ(recs[i].usec, i);
+    EXPECT_STREQ(recs[i].msg.c_str(), std::to_string(i).c_str());
+  }
+
+  // rings of exited threads are released once drained
+  EXPECT_EQ(rvs::LogRingSet::count(), 0u);
+}
+
+// exposes merge thread control to tests
+class merge_probe : public rvs::logger {
+ public:
+  using rvs::logger::StopMerge;
+};
+
+class LogRingBench : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    log_file = "rvs_test_logring_" + std::to_string(getpid()) + ".log";
+    rvs::logger::quiet();
+    rvs::logger::to_json(false);
+    rvs::logger::append(false);
+    rvs::logger::log_level(rvs::loginfo);
+    rvs::logger::set_log_file(log_file);
+  }
+
+  void TearDown() override {
+    rvs::logger::buffered(false);
+    rvs::logger::set_log_file("");
+    unlink(log_file.c_str());
+  }
+
+  // log from num_threads workers, return rows/s as seen by workers
+  double run_workers(int num_threads, int num_rows) {
+    std::vector<log_worker*> w;
+    for (int i = 0; i < num_threads; i++) {
+      w.push_back(new log_worker(i, num_rows));
+    }
+    EXPECT_EQ(rvs::logger::init_log_file(), 0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto it = w.begin(); it != w.end(); ++it) {
+      (*it)->start();
+    }
+    for (auto it = w.begin(); it != w.end(); ++it) {
+      (*it)->join();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    rvs::logger::terminate();
+
+    for (auto it = w.begin(); it != w.end(); ++it) {
+      delete *it;
+    }
+
+    // check nothing is lost
+    EXPECT_EQ(count_rows(), num_threads * num_rows);
+
+    return num_threads * num_rows /
+           std::chrono::duration<double>(t1 - t0).count();
+  }
+
+  // count non-empty rows in log file
+  int count_rows() {
+    std::ifstream is(log_file);
+    std::string line;
+    int cnt = 0;
+    while (std::getline(is, line)) {
+      if (line.size() > 0)
+        cnt++;
+    }
+    return cnt;
+  }
+
+  std::string log_file;
+};
+
+TEST_F(LogRingBench, stop_while_logging) {
+  const int num_threads = 4;
+  const int num_rows = 5000;
+
+  rvs::logger::buffered(true);
+  for (int iter = 0; iter < 20; iter++) {
+    std::vector<log_worker*> w;
+    for (int i = 0; i < num_threads; i++) {
+      w.push_back(new log_worker(i, num_rows));
+    }
+    ASSERT_EQ(rvs::logger::init_log_file(), 0);
+
+    for (auto it = w.begin(); it != w.end(); ++it) {
+      (*it)->start();
+    }
+    // stop merge thread while workers are still logging
+    std::this_thread::sleep_for(std::chrono::microseconds(100 * iter));
+    merge_probe::StopMerge();
+    for (auto it = w.begin(); it != w.end(); ++it) {
+      (*it)->join();
+      delete *it;
+    }
+    rvs::logger::terminate();
+
+    // rows logged around shutdown are not lost
+    EXPECT_EQ(count_rows(), num_threads * num_rows);
+  }
+}
+
+TEST_F(LogRingBench, contention) {
+  const int num_rows = 20000;
+
+  for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+    rvs::logger::buffered(false);
+    double locked = run_workers(num_threads, num_rows);
+
+    rvs::logger::buffered(true);
+    double buffered = run_workers(num_threads, num_rows);
+
+    std::cout << num_threads << " threads: mutex " << locked
+              << " rows/s, per-thread rings " << buffered
+              << " rows/s (worker side)" << std::endl;
+  }
+}
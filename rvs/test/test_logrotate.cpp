@@ -0,0 +1,259 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <unistd.h>
+#include <zlib.h>
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsliblog.h"
+#include "include/rvsliblogger.h"
+#include "include/rvslogbinary.h"
+#include "include/rvs_unit_testing_defs.h"
+
+class LogRotateTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    log_file = "rvs_test_rotate_" + std::to_string(getpid()) + ".log";
+    rvs::logger::quiet();
+    rvs::logger::log_level(rvs::loginfo);
+  }
+
+  void TearDown() override {
+    rvs::logger::to_json(false);
+    rvs::logger::binary(false);
+    rvs::logger::rotate_size(0);
+    rvs::logger::rotate_compress(true);
+    rvs::logger::set_log_file("");
+    unlink(log_file.c_str());
+    for (int i = 1; ; i++) {
+      std::string segment = log_file + "." + std::to_string(i);
+      if (unlink(segment.c_str()) && unlink((segment + ".gz").c_str())) {
+        break;
+      }
+    }
+  }
+
+  // reads file, gzip compressed or not
+  static bool read_file(const std::string& name, std::string* pOut) {
+    gzFile in = gzopen(name.c_str(), "rb");
+    if (in == nullptr) {
+      return false;
+    }
+    char buff[4096];
+    int len;
+    pOut->clear();
+    while ((len = gzread(in, buff, sizeof(buff))) > 0) {
+      pOut->append(buff, len);
+    }
+    gzclose(in);
+    return len == 0;
+  }
+
+  // reads all rotated segments followed by the current log file
+  std::vector<std::string> read_segments(const std::string& suffix) {
+    std::vector<std::string> segments;
+    std::string content;
+    for (int i = 1; ; i++) {
+      std::string name = log_file + "." + std::to_string(i) + suffix;
+      if (access(name.c_str(), F_OK)) {
+        break;
+      }
+      EXPECT_TRUE(read_file(name, &content)) << name;
+      segments.push_back(content);
+    }
+    EXPECT_TRUE(read_file(log_file, &content));
+    segments.push_back(content);
+    return segments;
+  }
+
+  // minimal JSON syntax check
+  static bool json_value(const std::string& s, size_t* p) {
+    while (*p < s.size() && isspace(s[*p])) (*p)++;
+    if (*p >= s.size()) return false;
+    char c = s[*p];
+    if (c == '{' || c == '[') {
+      char close = c == '{' ? '}' : ']';
+      (*p)++;
+      for (bool first = true; ; first = false) {
+        while (*p < s.size() && isspace(s[*p])) (*p)++;
+        if (*p < s.size() && s[*p] == close && first) break;
+        if (c == '{') {
+          if (!json_value(s, p) || s[*p - 1] != '"') return false;
+          while (*p < s.size() && isspace(s[*p])) (*p)++;
+          if (*p >= s.size() || s[(*p)++] != ':') return false;
+        }
+        if (!json_value(s, p)) return false;
+        while (*p < s.size() && isspace(s[*p])) (*p)++;
+        if (*p < s.size() && s[*p] == ',') { (*p)++; continue; }
+        break;
+      }
+      return *p < s.size() && s[(*p)++] == close;
+    }
+    if (c == '"') {
+      for ((*p)++; *p < s.size(); (*p)++) {
+        if (s[*p] == '\\') (*p)++;
+        else if (s[*p] == '"') return ++(*p) <= s.size();
+      }
+      return false;
+    }
+    size_t start = *p;
+    while (*p < s.size() && (isalnum(s[*p]) || s[*p] == '-' || s[*p] == '.'))
+      (*p)++;
+    return *p > start;
+  }
+
+  static bool valid_json(const std::string& s) {
+    size_t p = 0;
+    if (!json_value(s, &p)) return false;
+    while (p < s.size() && isspace(s[p])) p++;
+    return p == s.size();
+  }
+
+  // counts occurrences of each "id" value found in segment
+  static void count_ids(const std::string& s, std::vector<int>* pSeen) {
+    const std::string key("\"id\" : ");
+    for (size_t p = s.find(key); p != std::string::npos;
+         p = s.find(key, p + 1)) {
+      int id = std::stoi(s.substr(p + key.size()));
+      ASSERT_GE(id, 0);
+      ASSERT_LT(id, static_cast<int>(pSeen->size()));
+      (*pSeen)[id]++;
+    }
+  }
+
+  std::string log_file;
+};
+
+TEST_F(LogRotateTest, json_concurrent_writers) {
+  const int threads = 8;
+  const int records = 200;
+
+  rvs::logger::to_json(true);
+  rvs::logger::rotate_size(8192);
+  rvs::logger::set_log_file(log_file);
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < threads; t++) {
+    writers.push_back(std::thread([t]() {
+      for (int i = 0; i < records; i++) {
+        void* r = rvs::logger::LogRecordCreate("unit", "rotate",
+                                               rvs::logresults, 0, 0);
+        rvs::logger::AddString(r, "msg", "concurrent record");
+        rvs::logger::AddInt(r, "id", t * records + i);
+        rvs::logger::LogRecordFlush(r);
+      }
+    }));
+  }
+  for (auto& w : writers) {
+    w.join();
+  }
+  rvs::logger::terminate();
+
+  std::vector<std::string> segments = read_segments(".gz");
+  EXPECT_GT(segments.size(), 10u);
+
+  // no segment is left uncompressed
+  EXPECT_NE(access((log_file + ".1").c_str(), F_OK), 0);
+
+  std::vector<int> seen(threads * records, 0);
+  for (size_t i = 0; i < segments.size(); i++) {
+    EXPECT_TRUE(valid_json(segments[i])) << "segment " << i + 1;
+    count_ids(segments[i], &seen);
+  }
+  for (size_t id = 0; id < seen.size(); id++) {
+    EXPECT_EQ(seen[id], 1) << "record id " << id;
+  }
+}
+
+TEST_F(LogRotateTest, text_uncompressed) {
+  const int rows = 500;
+
+  rvs::logger::rotate_size(2048);
+  rvs::logger::rotate_compress(false);
+  rvs::logger::set_log_file(log_file);
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+
+  for (int i = 0; i < rows; i++) {
+    rvs::logger::Log(("text row " + std::to_string(i)).c_str(),
+                     rvs::logresults);
+  }
+  rvs::logger::terminate();
+
+  std::vector<std::string> segments = read_segments("");
+  EXPECT_GT(segments.size(), 5u);
+
+  // segments are complete logs holding consecutive rows
+  int next = 0;
+  for (auto& segment : segments) {
+    EXPECT_NE(segment[0], '\n');
+    EXPECT_EQ(segment[segment.size() - 1], '\n');
+    EXPECT_LE(segment.size(), 2048u + 128u);
+    std::istringstream is(segment);
+    std::string row;
+    while (std::getline(is, row)) {
+      EXPECT_NE(row.find("text row " + std::to_string(next)),
+                std::string::npos) << row;
+      next++;
+    }
+  }
+  EXPECT_EQ(next, rows);
+}
+
+TEST_F(LogRotateTest, binary_segments) {
+  const int rows = 300;
+
+  rvs::logger::binary(true);
+  rvs::logger::rotate_size(1024);
+  rvs::logger::set_log_file(log_file);
+  ASSERT_EQ(rvs::logger::init_log_file(), 0);
+
+  for (int i = 0; i < rows; i++) {
+    rvs::logger::Log(("binary row " + std::to_string(i)).c_str(),
+                     rvs::logresults);
+  }
+  rvs::logger::terminate();
+
+  std::vector<std::string> segments = read_segments(".gz");
+  EXPECT_GT(segments.size(), 2u);
+
+  // every segment carries its own header and string table
+  int total = 0;
+  for (auto& segment : segments) {
+    std::istringstream in(segment);
+    std::ostringstream out;
+    int count = 0;
+    EXPECT_EQ(rvs::LogBinaryReader::ToText(in, out, &count), 0);
+    total += count;
+  }
+  EXPECT_EQ(total, rows);
+}
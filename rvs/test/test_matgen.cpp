@@ -0,0 +1,202 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <math.h>
+#include <string.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsmatgen.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// spans several chunks with a tail not multiple of any SIMD width
+const size_t count = 3 * RVS_MATGEN_MIN_CHUNK + 13;
+
+// decodes normal/zero IEEE binary16
+float half_to_float(uint16_t Bits) {
+  int exp = (Bits >> 10) & 0x1F;
+  int mant = Bits & 0x3FF;
+  if (exp == 0 && mant == 0) {
+    return 0.0f;
+  }
+  return ldexpf(1.0f + mant / 1024.0f, exp - 15);
+}
+
+template <typename T>
+void expect_same(const std::vector<T>& A, const std::vector<T>& B) {
+  ASSERT_EQ(A.size(), B.size());
+  EXPECT_EQ(memcmp(A.data(), B.data(), A.size() * sizeof(T)), 0);
+}
+
+}  // namespace
+
+TEST(matgen, hash) {
+  EXPECT_EQ(rvs::MatrixGen::hash(1, 2), rvs::MatrixGen::hash(1, 2));
+  EXPECT_NE(rvs::MatrixGen::hash(1, 2), rvs::MatrixGen::hash(1, 3));
+  EXPECT_NE(rvs::MatrixGen::hash(1, 2), rvs::MatrixGen::hash(2, 2));
+  EXPECT_NE(rvs::MatrixGen::key(7, 0, 0), rvs::MatrixGen::key(7, 1, 0));
+  EXPECT_NE(rvs::MatrixGen::key(7, 0, 0), rvs::MatrixGen::key(7, 0, 1));
+  EXPECT_NE(rvs::MatrixGen::key(7, 0, 0), rvs::MatrixGen::key(8, 0, 0));
+
+  EXPECT_STREQ(rvs::MatrixGen::simd_name(RVS_MATGEN_SCALAR), "scalar");
+  EXPECT_STREQ(rvs::MatrixGen::simd_name(RVS_MATGEN_AVX2), "avx2");
+  EXPECT_STREQ(rvs::MatrixGen::simd_name(RVS_MATGEN_AVX512), "avx512");
+}
+
+TEST(matgen, half_bits) {
+  // every 11 bit value maps exactly
+  for (uint32_t k = 0; k < 2048; k++) {
+    uint16_t bits = rvs::MatrixGen::half_bits(k << 21);
+    EXPECT_EQ(half_to_float(bits), k / 2048.0f) << "k = " << k;
+  }
+}
+
+TEST(matgen, independent_of_threads) {
+  rvs::MatrixGen gen(12345, 1);
+  std::vector<float> single(count);
+  gen.generate(single.data(), count, 0);
+
+  for (int threads : {2, 3, 7, 64}) {
+    gen.set_threads(threads);
+    std::vector<float> multi(count);
+    gen.generate(multi.data(), count, 0);
+    expect_same(single, multi);
+  }
+
+  // other stream and other seed give other data
+  std::vector<float> other(count);
+  gen.generate(other.data(), count, 1);
+  EXPECT_NE(memcmp(single.data(), other.data(), count * sizeof(float)), 0);
+  gen.set_seed(54321);
+  gen.generate(other.data(), count, 0);
+  EXPECT_NE(memcmp(single.data(), other.data(), count * sizeof(float)), 0);
+}
+
+TEST(matgen, independent_of_simd) {
+  rvs::MatrixGen gen(99, 4);
+  gen.set_scale(1000.0);
+
+  gen.set_simd(RVS_MATGEN_SCALAR);
+  ASSERT_EQ(gen.simd(), RVS_MATGEN_SCALAR);
+  std::vector<float> fref(count);
+  std::vector<double> dref(count);
+  std::vector<uint16_t> href(count);
+  gen.generate(fref.data(), count, 0);
+  gen.generate(dref.data(), count, 1);
+  gen.generate_half(href.data(), count, 2);
+
+  int best = rvs::MatrixGen::simd_supported();
+  std::cout << "best SIMD path: " << rvs::MatrixGen::simd_name(best)
+            << std::endl;
+  for (int level = RVS_MATGEN_AVX2; level <= best; level++) {
+    gen.set_simd(level);
+    ASSERT_EQ(gen.simd(), level);
+    std::vector<float> f(count);
+    std::vector<double> d(count);
+    std::vector<uint16_t> h(count);
+    gen.generate(f.data(), count, 0);
+    gen.generate(d.data(), count, 1);
+    gen.generate_half(h.data(), count, 2);
+    expect_same(fref, f);
+    expect_same(dref, d);
+    expect_same(href, h);
+  }
+}
+
+TEST(matgen, range) {
+  rvs::MatrixGen gen(2024, 0);
+  gen.set_scale(10.0);
+
+  std::vector<float> f(count);
+  gen.generate(f.data(), count, 0);
+  double sum = 0;
+  for (float v : f) {
+    ASSERT_GE(v, 0.0f);
+    ASSERT_LT(v, 10.0f);
+    sum += v;
+  }
+  EXPECT_NEAR(sum / count, 5.0, 0.05);
+
+  std::vector<double> d(count);
+  gen.generate(d.data(), count, 0);
+  sum = 0;
+  for (double v : d) {
+    ASSERT_GE(v, 0.0);
+    ASSERT_LT(v, 10.0);
+    sum += v;
+  }
+  EXPECT_NEAR(sum / count, 5.0, 0.05);
+
+  std::vector<uint16_t> h(count);
+  gen.generate_half(h.data(), count, 0);
+  sum = 0;
+  for (uint16_t v : h) {
+    float x = half_to_float(v);
+    ASSERT_GE(x, 0.0f);
+    ASSERT_LT(x, 1.0f);
+    sum += x;
+  }
+  EXPECT_NEAR(sum / count, 0.5, 0.01);
+
+  // empty matrix is fine
+  gen.generate(f.data(), 0, 0);
+}
+
+TEST(matgen, benchmark) {
+  const size_t n = 8 * RVS_MATGEN_MIN_CHUNK;
+  const int iter = 5;
+  std::vector<float> data(n);
+  rvs::MatrixGen gen(1, 1);
+
+  auto measure = [&]() {
+    gen.generate(data.data(), n, 0);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iter; i++) {
+      gen.generate(data.data(), n, i);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return static_cast<double>(n * sizeof(float)) * iter /
+           std::chrono::duration<double>(t1 - t0).count() / 1e9;
+  };
+
+  gen.set_simd(RVS_MATGEN_SCALAR);
+  double scalar = measure();
+  gen.set_simd(-1);
+  double simd = measure();
+  gen.set_threads(0);
+  double parallel = measure();
+
+  const char* name = rvs::MatrixGen::simd_name(gen.simd());
+  std::cout << "scalar, 1 thread: " << scalar << " GBps" << std::endl;
+  std::cout << name << ", 1 thread: " << simd << " GBps" << std::endl;
+  std::cout << name << ", " << gen.threads() << " thread(s): " << parallel
+            << " GBps" << std::endl;
+  EXPECT_GT(parallel, 0.0);
+}
@@ -0,0 +1,235 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvsnuma.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// fake sysfs tree of a dual socket host: NUMA nodes 0 (CPUs 0-3) and
+// 1 (CPUs 4-7), KFD CPU agents 0 and 1, GPU agents 2 (03:00.0 on node 0),
+// 3 (83:00.0 on node 1) and 4 (c3:00.0, NUMA node not reported)
+class NumaSysfsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char tmpl[] = "/tmp/rvs_numa_XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    root = tmpl;
+
+    write("devices/system/node/node0/cpulist", "0-3\n");
+    write("devices/system/node/node0/distance", "10 21\n");
+    write("devices/system/node/node1/cpulist", "4-7\n");
+    write("devices/system/node/node1/distance", "21 10\n");
+    write("devices/system/node/possible", "0-1\n");
+
+    std::string kfd = "class/kfd/kfd/topology/nodes/";
+    write(kfd + "0/properties", "cpu_cores_count 4\nsimd_count 0\n");
+    write(kfd + "1/properties", "cpu_cores_count 4\nsimd_count 0\n");
+    write(kfd + "2/properties",
+          "cpu_cores_count 0\nsimd_count 256\nlocation_id 768\ndomain 0\n");
+    write(kfd + "3/properties",
+          "cpu_cores_count 0\nsimd_count 256\nlocation_id 33536\n"
+          "domain 0\n");
+    write(kfd + "4/properties",
+          "cpu_cores_count 0\nsimd_count 256\nlocation_id 49920\n"
+          "domain 0\n");
+    write("bus/pci/devices/0000:03:00.0/numa_node", "0\n");
+    write("bus/pci/devices/0000:83:00.0/numa_node", "1\n");
+    write("bus/pci/devices/0000:c3:00.0/numa_node", "-1\n");
+  }
+
+  void TearDown() override {
+    std::string cmd = "rm -rf " + root;
+    EXPECT_EQ(system(cmd.c_str()), 0);
+  }
+
+  void write(const std::string& Path, const std::string& Content) {
+    size_t pos = 0;
+    while ((pos = Path.find('/', pos)) != std::string::npos) {
+      mkdir((root + "/" + Path.substr(0, pos)).c_str(), 0755);
+      pos++;
+    }
+    std::ofstream f(root + "/" + Path);
+    f << Content;
+  }
+
+  std::string root;
+};
+
+}  // namespace
+
+TEST(numa, parse_cpulist) {
+  std::vector<int> cpus;
+  ASSERT_EQ(rvs::NumaTopology::parse_cpulist("0-3,8,10-11\n", &cpus), 0);
+  EXPECT_EQ(cpus, std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_EQ(rvs::NumaTopology::parse_cpulist("", &cpus), 0);
+  EXPECT_TRUE(cpus.empty());
+  EXPECT_NE(rvs::NumaTopology::parse_cpulist("3-1", &cpus), 0);
+  EXPECT_NE(rvs::NumaTopology::parse_cpulist("a", &cpus), 0);
+  EXPECT_NE(rvs::NumaTopology::parse_cpulist("1-2-3", &cpus), 0);
+}
+
+TEST(numa, placement_names) {
+  EXPECT_EQ(rvs::NumaTopology::parse_placement("all"),
+            RVS_NUMA_PLACEMENT_ALL);
+  EXPECT_EQ(rvs::NumaTopology::parse_placement("local"),
+            RVS_NUMA_PLACEMENT_LOCAL);
+  EXPECT_EQ(rvs::NumaTopology::parse_placement("remote"),
+            RVS_NUMA_PLACEMENT_REMOTE);
+  EXPECT_EQ(rvs::NumaTopology::parse_placement("near"), -1);
+  EXPECT_STREQ(rvs::NumaTopology::placement_name(RVS_NUMA_PLACEMENT_LOCAL),
+               "local");
+  EXPECT_STREQ(rvs::NumaTopology::relation(0, 0), "local");
+  EXPECT_STREQ(rvs::NumaTopology::relation(0, 1), "remote");
+  EXPECT_STREQ(rvs::NumaTopology::relation(-1, 1), "unknown");
+}
+
+TEST_F(NumaSysfsTest, load) {
+  rvs::NumaTopology topo;
+  ASSERT_EQ(topo.load(root), 0);
+  EXPECT_EQ(topo.nodes(), std::vector<int>({0, 1}));
+  EXPECT_EQ(topo.cpus(1), std::vector<int>({4, 5, 6, 7}));
+  EXPECT_TRUE(topo.cpus(2).empty());
+  EXPECT_EQ(topo.distance(0, 1), 21);
+  EXPECT_EQ(topo.distance(1, 1), 10);
+  EXPECT_EQ(topo.distance(0, 5), -1);
+  EXPECT_EQ(topo.nearest_remote(0), 1);
+  EXPECT_EQ(topo.kfd_numa(0), 0);
+  EXPECT_EQ(topo.kfd_numa(1), 1);
+  EXPECT_EQ(topo.kfd_numa(2), 0);
+  EXPECT_EQ(topo.kfd_numa(3), 1);
+  EXPECT_EQ(topo.kfd_numa(4), -1);
+  EXPECT_EQ(topo.kfd_numa(9), -1);
+}
+
+TEST_F(NumaSysfsTest, select) {
+  rvs::NumaTopology topo;
+  ASSERT_EQ(topo.load(root), 0);
+  std::vector<uint32_t> cpu_nodes = {0, 1};
+  std::vector<uint32_t> sel;
+
+  EXPECT_EQ(topo.select(RVS_NUMA_PLACEMENT_ALL, 2, cpu_nodes, &sel), 0);
+  EXPECT_EQ(sel, cpu_nodes);
+  EXPECT_EQ(topo.select(RVS_NUMA_PLACEMENT_LOCAL, 2, cpu_nodes, &sel), 0);
+  EXPECT_EQ(sel, std::vector<uint32_t>({0}));
+  EXPECT_EQ(topo.select(RVS_NUMA_PLACEMENT_LOCAL, 3, cpu_nodes, &sel), 0);
+  EXPECT_EQ(sel, std::vector<uint32_t>({1}));
+  EXPECT_EQ(topo.select(RVS_NUMA_PLACEMENT_REMOTE, 3, cpu_nodes, &sel), 0);
+  EXPECT_EQ(sel, std::vector<uint32_t>({0}));
+
+  // unknown GPU node falls back to all CPU agents
+  EXPECT_EQ(topo.select(RVS_NUMA_PLACEMENT_LOCAL, 4, cpu_nodes, &sel), 1);
+  EXPECT_EQ(sel, cpu_nodes);
+}
+
+TEST_F(NumaSysfsTest, single_node) {
+  // remove second socket
+  std::string cmd = "rm -rf " + root + "/devices/system/node/node1";
+  ASSERT_EQ(system(cmd.c_str()), 0);
+
+  rvs::NumaTopology topo;
+  ASSERT_EQ(topo.load(root), 0);
+  EXPECT_EQ(topo.nearest_remote(0), -1);
+  std::vector<uint32_t> sel;
+  EXPECT_EQ(topo.select(RVS_NUMA_PLACEMENT_REMOTE, 2, {0, 1}, &sel), 1);
+  EXPECT_EQ(sel.size(), 2u);
+  // second CPU agent has no NUMA node to map to
+  EXPECT_EQ(topo.kfd_numa(1), -1);
+}
+
+TEST(numa, missing_sysfs) {
+  rvs::NumaTopology topo;
+  EXPECT_NE(topo.load("/nonexistent"), 0);
+  EXPECT_TRUE(topo.nodes().empty());
+  EXPECT_EQ(topo.kfd_numa(0), -1);
+}
+
+TEST(numa, pin) {
+  EXPECT_NE(rvs::NumaTopology::pin(std::vector<int>()), 0);
+  EXPECT_NE(rvs::NumaTopology::pin(std::vector<int>({-1})), 0);
+
+  // pinning to CPUs the thread may already run on succeeds
+  cpu_set_t set;
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(set), &set), 0);
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  ASSERT_FALSE(cpus.empty());
+  EXPECT_EQ(rvs::NumaTopology::pin(std::vector<int>({cpus[0]})), 0);
+  cpu_set_t pinned;
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(pinned), &pinned),
+            0);
+  EXPECT_EQ(CPU_COUNT(&pinned), 1);
+  EXPECT_EQ(rvs::NumaTopology::pin(cpus), 0);
+}
+
+TEST(numa, pin_guard) {
+  cpu_set_t set;
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(set), &set), 0);
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  ASSERT_FALSE(cpus.empty());
+
+  // nothing to pin to
+  {
+    rvs::CpuPinGuard guard{std::vector<int>()};
+    EXPECT_FALSE(guard.pinned());
+  }
+  {
+    rvs::CpuPinGuard guard(std::vector<int>({-1}));
+    EXPECT_FALSE(guard.pinned());
+  }
+
+  {
+    rvs::CpuPinGuard guard(std::vector<int>({cpus[0]}));
+    EXPECT_TRUE(guard.pinned());
+    cpu_set_t pinned;
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(pinned),
+                                     &pinned), 0);
+    EXPECT_EQ(CPU_COUNT(&pinned), 1);
+  }
+
+  // previous affinity is back
+  cpu_set_t restored;
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(restored),
+                                   &restored), 0);
+  EXPECT_TRUE(CPU_EQUAL(&set, &restored));
+}
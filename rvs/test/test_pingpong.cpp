@@ -0,0 +1,194 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvspingpong.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// simulated engine with a single copy queue: copy takes Latency + 1 ns per
+// byte, dependent copy starts DepDelay ns after its dependency completed,
+// host clock advances by Overhead per submit and while waiting
+class SimEngine : public rvs::CopyEngine {
+ public:
+  SimEngine(int Slots, uint64_t Overhead, uint64_t Latency, uint64_t DepDelay)
+  : now(0), overhead(Overhead), latency(Latency), dep_delay(DepDelay),
+    submits(0), waits(0), fail_at(-1),
+    submitted(2, std::vector<bool>(Slots, false)),
+    start(2, std::vector<uint64_t>(Slots, 0)),
+    end(2, std::vector<uint64_t>(Slots, 0)) {}
+
+  int Submit(int Dir, int Slot, size_t Size) override {
+    return submit(Dir, Slot, Size, 0);
+  }
+
+  int SubmitAfter(int Dir, int Slot, size_t Size,
+                  int DepDir, int DepSlot) override {
+    EXPECT_TRUE(submitted[DepDir][DepSlot]) << "dependency not submitted";
+    return submit(Dir, Slot, Size, end[DepDir][DepSlot] + dep_delay);
+  }
+
+  int Wait(int Dir, int Slot) override {
+    EXPECT_TRUE(submitted[Dir][Slot]);
+    waits++;
+    now = std::max(now, end[Dir][Slot]);
+    return 0;
+  }
+
+  int CopyTime(int Dir, int Slot, uint64_t* pStart, uint64_t* pEnd) override {
+    *pStart = start[Dir][Slot];
+    *pEnd = end[Dir][Slot];
+    return 0;
+  }
+
+  uint64_t copy_time(size_t Size) const { return latency + Size; }
+
+  uint64_t now;
+  uint64_t overhead;
+  uint64_t latency;
+  uint64_t dep_delay;
+  int submits;
+  int waits;
+  int fail_at;
+  std::vector<std::vector<bool>> submitted;
+  std::vector<std::vector<uint64_t>> start;
+  std::vector<std::vector<uint64_t>> end;
+
+ protected:
+  int submit(int Dir, int Slot, size_t Size, uint64_t NotBefore) {
+    if (submits++ == fail_at) {
+      return -1;
+    }
+    now += overhead;
+    start[Dir][Slot] = std::max(now, NotBefore);
+    end[Dir][Slot] = start[Dir][Slot] + copy_time(Size);
+    submitted[Dir][Slot] = true;
+    return 0;
+  }
+};
+
+// engine without dependency support, falls back to waiting on the host
+class HostWaitEngine : public SimEngine {
+ public:
+  HostWaitEngine(int Slots, uint64_t Overhead, uint64_t Latency)
+  : SimEngine(Slots, Overhead, Latency, 0) {}
+
+  int SubmitAfter(int Dir, int Slot, size_t Size,
+                  int DepDir, int DepSlot) override {
+    return rvs::CopyEngine::SubmitAfter(Dir, Slot, Size, DepDir, DepSlot);
+  }
+};
+
+}  // namespace
+
+TEST(pingpong, chained) {
+  const int rounds = 8;
+  const size_t size = 64;
+  SimEngine engine(rounds, 1000, 1500, 200);
+  rvs::PingPong pingpong(&engine, rounds);
+  rvs::Histogram oneway;
+  rvs::Histogram roundtrip;
+
+  EXPECT_EQ(pingpong.run(size, &oneway, &roundtrip), 0);
+
+  // all copies submitted up front, host waits only once
+  EXPECT_EQ(engine.submits, 2 * rounds);
+  EXPECT_EQ(engine.waits, 1);
+
+  // every copy starts when the previous one in the chain has completed,
+  // not when host submitted it
+  for (int k = 0; k < rounds; k++) {
+    EXPECT_EQ(engine.start[1][k], engine.end[0][k] + engine.dep_delay);
+    if (k > 0) {
+      EXPECT_EQ(engine.start[0][k], engine.end[1][k - 1] + engine.dep_delay);
+    }
+  }
+
+  uint64_t copy = engine.copy_time(size);
+  EXPECT_EQ(oneway.count(), 2u * rounds);
+  EXPECT_EQ(oneway.min(), copy);
+  EXPECT_EQ(oneway.max(), copy);
+  EXPECT_EQ(roundtrip.count(), static_cast<uint64_t>(rounds));
+  EXPECT_EQ(roundtrip.min(), 2 * copy + engine.dep_delay);
+  EXPECT_EQ(roundtrip.max(), 2 * copy + engine.dep_delay);
+
+  // slots are reused by the next measurement
+  EXPECT_EQ(pingpong.run(size, &oneway, &roundtrip), 0);
+  EXPECT_EQ(oneway.count(), 4u * rounds);
+  EXPECT_EQ(roundtrip.count(), 2u * rounds);
+}
+
+TEST(pingpong, host_wait_fallback) {
+  const int rounds = 4;
+  const size_t size = 4096;
+  const uint64_t overhead = 3000;
+  HostWaitEngine engine(rounds, overhead, 1500);
+  rvs::PingPong pingpong(&engine, rounds);
+  rvs::Histogram oneway;
+  rvs::Histogram roundtrip;
+
+  EXPECT_EQ(pingpong.run(size, &oneway, &roundtrip), 0);
+
+  // host waits for every dependency and once at the end
+  EXPECT_EQ(engine.waits, 2 * rounds);
+
+  // submit overhead now shows up in round trip
+  uint64_t copy = engine.copy_time(size);
+  EXPECT_EQ(oneway.percentile(50), copy);
+  EXPECT_EQ(roundtrip.percentile(50), 2 * copy + overhead);
+}
+
+TEST(pingpong, submit_failure) {
+  const int rounds = 4;
+  SimEngine engine(rounds, 1000, 1500, 200);
+  engine.fail_at = 5;
+  rvs::PingPong pingpong(&engine, rounds);
+  rvs::Histogram oneway;
+  rvs::Histogram roundtrip;
+
+  EXPECT_NE(pingpong.run(16, &oneway, &roundtrip), 0);
+
+  // copies already in the chain are waited for before returning,
+  // nothing is recorded from an incomplete chain
+  EXPECT_EQ(engine.waits, 1);
+  EXPECT_EQ(engine.now, engine.end[0][2]);
+  EXPECT_EQ(oneway.count(), 0u);
+  EXPECT_EQ(roundtrip.count(), 0u);
+}
+
+TEST(pingpong, default_sizes) {
+  std::vector<uint32_t> sizes;
+  rvs::PingPong::default_sizes(&sizes);
+  ASSERT_EQ(sizes.size(), 15u);
+  EXPECT_EQ(sizes.front(), 4u);
+  EXPECT_EQ(sizes.back(), 64u * 1024);
+  for (size_t i = 1; i < sizes.size(); i++) {
+    EXPECT_EQ(sizes[i], 2 * sizes[i - 1]);
+  }
+}
@@ -0,0 +1,226 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <math.h>
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvssizesweep.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// 1 KB .. 512 MB, same as rvs::hsa::DEFAULT_SIZE_LIST
+std::vector<uint32_t> default_sizes() {
+  std::vector<uint32_t> sizes;
+  for (uint32_t s = 1024; s <= 512u * 1024 * 1024; s *= 2) {
+    sizes.push_back(s);
+  }
+  return sizes;
+}
+
+// transfer time of a link with fixed latency and peak bandwidth,
+// bandwidth curve has its knee at latency * peak bytes
+class Link {
+ public:
+  Link(double Latency, double Bandwidth, double Noise)
+  : latency(Latency), peak(Bandwidth), noise(Noise), gen(1234), dist(0, 1) {}
+
+  double time(size_t Size) {
+    double t = latency + Size / peak;
+    if (noise > 0) {
+      t *= std::max(0.1, 1 + noise * dist(gen));
+    }
+    return t;
+  }
+
+  double knee() const { return latency * peak; }
+
+ private:
+  double latency;
+  double peak;
+  double noise;
+  std::mt19937 gen;
+  std::normal_distribution<double> dist;
+};
+
+// runs sweep to completion, returns total number of samples
+int run_sweep(rvs::SizeSweep* pSweep, Link* pLink) {
+  std::vector<size_t> sizes;
+  int samples = 0;
+  // guard against sweep never finishing
+  for (int pass = 0; pass < 100000 && pSweep->pending(&sizes); pass++) {
+    for (auto s : sizes) {
+      pSweep->add(s, pLink->time(s));
+      samples++;
+    }
+  }
+  return samples;
+}
+
+}  // namespace
+
+TEST(sizesweep, t_quantile) {
+  EXPECT_NEAR(rvs::SizeSweep::t_quantile(1), 12.706, 1e-9);
+  EXPECT_NEAR(rvs::SizeSweep::t_quantile(30), 2.042, 1e-9);
+  EXPECT_GT(rvs::SizeSweep::t_quantile(31), 1.96);
+  EXPECT_LT(rvs::SizeSweep::t_quantile(31), 2.042);
+  EXPECT_NEAR(rvs::SizeSweep::t_quantile(100000), 1.96, 1e-3);
+}
+
+TEST(sizesweep, seed) {
+  rvs::SizeSweep sweep;
+  sweep.initialize(default_sizes());
+
+  std::vector<size_t> sizes;
+  ASSERT_TRUE(sweep.pending(&sizes));
+  std::vector<size_t> expected = {1024, 16 * 1024, 256 * 1024,
+                                  4 * 1024 * 1024, 64 * 1024 * 1024,
+                                  512 * 1024 * 1024};
+  EXPECT_EQ(sizes, expected);
+}
+
+TEST(sizesweep, empty) {
+  rvs::SizeSweep sweep;
+  std::vector<size_t> sizes;
+
+  sweep.initialize(std::vector<uint32_t>());
+  EXPECT_TRUE(sweep.done());
+  EXPECT_FALSE(sweep.pending(&sizes));
+  EXPECT_TRUE(sizes.empty());
+
+  // zero sizes are ignored
+  sweep.initialize(std::vector<uint32_t>(3, 0));
+  EXPECT_TRUE(sweep.done());
+}
+
+TEST(sizesweep, noiseless_refines_knee) {
+  // 10 us latency, 20 GB/s -> knee at 200 KB
+  Link link(10e-6, 20e9, 0);
+  rvs::SizeSweep sweep;
+  sweep.initialize(default_sizes());
+
+  int samples = run_sweep(&sweep, &link);
+  ASSERT_TRUE(sweep.done());
+
+  const std::vector<rvs::SizeSweep::Point>& pts = sweep.points();
+  int near_knee = 0;
+  for (auto& p : pts) {
+    EXPECT_TRUE(p.converged);
+    EXPECT_EQ(p.samples, static_cast<uint32_t>(RVS_SWEEP_MIN_SAMPLES));
+    if (p.size >= link.knee() / 16 && p.size <= link.knee() * 16) {
+      near_knee++;
+    }
+  }
+  // most of the sizes are around the knee
+  EXPECT_GT(near_knee * 2, static_cast<int>(pts.size()));
+  // and refined more densely than the configured list
+  EXPECT_GT(near_knee, 8);
+
+  // neighbouring sizes differ by less than refinement step
+  // or are too close to be refined any further
+  double peak = 0;
+  for (auto& p : pts) {
+    peak = std::max(peak, p.bandwidth());
+  }
+  for (size_t i = 0; i + 1 < pts.size(); i++) {
+    double diff = fabs(pts[i + 1].bandwidth() - pts[i].bandwidth());
+    EXPECT_TRUE(diff <= RVS_SWEEP_REFINE_STEP * peak ||
+                pts[i + 1].size < pts[i].size * RVS_SWEEP_MIN_RATIO * 2)
+      << pts[i].size << " " << pts[i + 1].size;
+  }
+
+  // fewer samples than walking whole list for a minimum number of times
+  EXPECT_LT(samples, static_cast<int>(default_sizes().size()) * 10);
+}
+
+TEST(sizesweep, noisy_converges) {
+  // 3% noise, 2 us latency, 50 GB/s -> knee at 100 KB
+  Link link(2e-6, 50e9, 0.03);
+  rvs::SizeSweep sweep;
+  sweep.initialize(default_sizes(), 0.02);
+
+  run_sweep(&sweep, &link);
+  ASSERT_TRUE(sweep.done());
+
+  const std::vector<rvs::SizeSweep::Point>& pts = sweep.points();
+  ASSERT_GT(pts.size(), 6u);
+  for (auto& p : pts) {
+    EXPECT_TRUE(p.converged) << p.size;
+    EXPECT_LE(p.ci(), 0.02 * p.mean);
+    EXPECT_GE(p.samples, static_cast<uint32_t>(RVS_SWEEP_MIN_SAMPLES));
+  }
+
+  // largest size sees close to peak bandwidth
+  EXPECT_NEAR(pts.back().bandwidth() / 50e9, 1.0, 0.05);
+}
+
+TEST(sizesweep, gives_up) {
+  // tolerance can't be reached with this much noise
+  Link link(1e-6, 10e9, 0.5);
+  rvs::SizeSweep sweep;
+  sweep.initialize(default_sizes(), 0.001, 3, 20);
+
+  run_sweep(&sweep, &link);
+  ASSERT_TRUE(sweep.done());
+  for (auto& p : sweep.points()) {
+    EXPECT_FALSE(p.converged);
+    EXPECT_EQ(p.samples, 20u);
+  }
+}
+
+TEST(sizesweep, max_points) {
+  Link link(10e-6, 20e9, 0);
+  rvs::SizeSweep sweep;
+  sweep.initialize(default_sizes(), RVS_SWEEP_TOLERANCE,
+                   RVS_SWEEP_MIN_SAMPLES, RVS_SWEEP_MAX_SAMPLES, 8);
+
+  run_sweep(&sweep, &link);
+  ASSERT_TRUE(sweep.done());
+  EXPECT_EQ(sweep.points().size(), 8u);
+}
+
+TEST(sizesweep, ignores_unknown_sizes) {
+  rvs::SizeSweep sweep;
+  sweep.initialize(std::vector<uint32_t>{4096});
+
+  sweep.add(1000, 1.0);
+  std::vector<size_t> sizes;
+  ASSERT_TRUE(sweep.pending(&sizes));
+  ASSERT_EQ(sizes.size(), 1u);
+  EXPECT_EQ(sweep.points()[0].samples, 0u);
+
+  for (int i = 0; i < RVS_SWEEP_MIN_SAMPLES; i++) {
+    sweep.add(4096, 1.0);
+  }
+  // settled size doesn't take more samples
+  sweep.add(4096, 5.0);
+  EXPECT_EQ(sweep.points()[0].samples,
+            static_cast<uint32_t>(RVS_SWEEP_MIN_SAMPLES));
+  EXPECT_FALSE(sweep.pending(&sizes));
+  EXPECT_TRUE(sweep.done());
+}
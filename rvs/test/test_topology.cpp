@@ -0,0 +1,199 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvstopology.h"
+#include "include/rvs_unit_testing_defs.h"
+
+namespace {
+
+// two CPU sockets (nodes 0, 1) with eight GPUs each (nodes 2..17),
+// GPUs on the same socket are connected over xGMI, everything else over PCIe
+void build_box(rvs::Topology* pTopo) {
+  std::vector<uint32_t> nodes;
+  for (uint32_t n = 0; n < 18; n++) {
+    nodes.push_back(n);
+  }
+  pTopo->reset(nodes);
+
+  for (uint32_t s = 0; s < 18; s++) {
+    for (uint32_t d = 0; d < 18; d++) {
+      if (s == d) {
+        continue;
+      }
+      rvs::Topology::Pair& p = pTopo->pair(s, d);
+      bool sgpu = s > 1;
+      bool dgpu = d > 1;
+      bool same_socket = sgpu && dgpu && ((s - 2) / 8 == (d - 2) / 8);
+      rvs::linkinfo_t hop;
+      if (same_socket) {
+        hop.etype = 4;
+        hop.strtype = "xGMI";
+        hop.distance = 15;
+        p.path.push_back(hop);
+      } else {
+        hop.etype = 2;
+        hop.strtype = "PCIe";
+        hop.distance = 20;
+        p.path.push_back(hop);
+        if (sgpu && dgpu) {
+          // cross socket GPUs go through both root complexes
+          p.path.push_back(hop);
+        }
+      }
+      p.hops = p.path.size();
+      p.distance = 0;
+      for (auto& h : p.path) {
+        p.distance += h.distance;
+      }
+      p.peer = (sgpu && dgpu && !same_socket) ? 0 : 2;
+    }
+  }
+}
+
+void expect_equal(const rvs::Topology& a, const rvs::Topology& b) {
+  ASSERT_EQ(a.agents(), b.agents());
+  for (auto s : a.agents()) {
+    for (auto d : a.agents()) {
+      const rvs::Topology::Pair* pa = a.at(s, d);
+      const rvs::Topology::Pair* pb = b.at(s, d);
+      ASSERT_NE(pa, nullptr);
+      ASSERT_NE(pb, nullptr);
+      EXPECT_EQ(pa->peer, pb->peer);
+      EXPECT_EQ(pa->distance, pb->distance);
+      EXPECT_EQ(pa->hops, pb->hops);
+      ASSERT_EQ(pa->path.size(), pb->path.size());
+      for (size_t i = 0; i < pa->path.size(); i++) {
+        EXPECT_EQ(pa->path[i].etype, pb->path[i].etype);
+        EXPECT_EQ(pa->path[i].distance, pb->path[i].distance);
+        EXPECT_EQ(pa->path[i].strtype, pb->path[i].strtype);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(topology, lookup) {
+  rvs::Topology topo;
+  build_box(&topo);
+
+  EXPECT_EQ(topo.size(), 18u);
+  EXPECT_EQ(topo.index(0), 0);
+  EXPECT_EQ(topo.index(17), 17);
+  EXPECT_EQ(topo.index(18), -1);
+  EXPECT_EQ(topo.at(3, 18), nullptr);
+
+  const rvs::Topology::Pair* p = topo.at(2, 9);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(p->peer, 2);
+  EXPECT_EQ(p->hops, 1u);
+  EXPECT_EQ(p->distance, 15u);
+  EXPECT_EQ(p->path[0].strtype, "xGMI");
+
+  p = topo.at(2, 10);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(p->peer, 0);
+  EXPECT_EQ(p->hops, 2u);
+  EXPECT_EQ(p->distance, 40u);
+
+  // diagonal is left in initial state
+  p = topo.at(5, 5);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(p->peer, 0);
+  EXPECT_EQ(p->distance, rvs::Topology::NO_CONN);
+  EXPECT_EQ(p->hops, 0u);
+}
+
+TEST(topology, sparse_nodes) {
+  rvs::Topology topo;
+  std::vector<uint32_t> nodes = {7, 3, 120};
+  topo.reset(nodes);
+
+  EXPECT_EQ(topo.index(7), 0);
+  EXPECT_EQ(topo.index(3), 1);
+  EXPECT_EQ(topo.index(120), 2);
+  EXPECT_EQ(topo.index(0), -1);
+  EXPECT_EQ(topo.index(119), -1);
+
+  topo.pair(1, 2).peer = 1;
+  ASSERT_NE(topo.at(3, 120), nullptr);
+  EXPECT_EQ(topo.at(3, 120)->peer, 1);
+  EXPECT_EQ(topo.at(120, 3)->peer, 0);
+}
+
+TEST(topology, round_trip) {
+  rvs::Topology topo;
+  build_box(&topo);
+  // unnamed link type survives serialization
+  topo.pair(0, 1).path.assign(1, rvs::linkinfo_t{7, "", 9});
+  topo.pair(0, 1).hops = 1;
+
+  std::stringstream ss;
+  topo.serialize(ss);
+
+  rvs::Topology loaded;
+  ASSERT_EQ(loaded.deserialize(ss), 0);
+  expect_equal(topo, loaded);
+}
+
+TEST(topology, partial_input) {
+  std::istringstream in(
+    RVS_TOPOLOGY_MAGIC "\n"
+    "agents 3 0 4 5\n"
+    "pair 4 5 2 15 1 4 15 xGMI\n");
+
+  rvs::Topology topo;
+  ASSERT_EQ(topo.deserialize(in), 0);
+  EXPECT_EQ(topo.size(), 3u);
+  EXPECT_EQ(topo.at(4, 5)->peer, 2);
+  EXPECT_EQ(topo.at(4, 5)->path[0].strtype, "xGMI");
+  EXPECT_EQ(topo.at(5, 4)->peer, 0);
+  EXPECT_EQ(topo.at(5, 4)->distance, rvs::Topology::NO_CONN);
+}
+
+TEST(topology, malformed_input) {
+  const char* bad[] = {
+    "",
+    "RVSTOPOLOGY 2\nagents 1 0\n",
+    RVS_TOPOLOGY_MAGIC "\nnodes 1 0\n",
+    RVS_TOPOLOGY_MAGIC "\nagents 2 0\n",
+    RVS_TOPOLOGY_MAGIC "\nagents 1 100000\n",
+    RVS_TOPOLOGY_MAGIC "\nagents 2 0 1\npair 0 2 2 15 0\n",
+    RVS_TOPOLOGY_MAGIC "\nagents 2 0 1\npair 0 1 2 15 2 4 15 xGMI\n",
+    RVS_TOPOLOGY_MAGIC "\nagents 2 0 1\nlink 0 1 2 15 0\n",
+  };
+
+  for (auto text : bad) {
+    std::istringstream in(text);
+    rvs::Topology topo;
+    EXPECT_EQ(topo.deserialize(in), -1) << text;
+    EXPECT_EQ(topo.size(), 0u);
+  }
+}
@@ -199,7 +199,7 @@ FOREACH(SINGLE_TEST ${TESTSOURCES})
   target_link_libraries(${TEST_NAME}
     ${PROJECT_LINK_LIBS}
     ${PROJECT_TEST_LINK_LIBS}
-    rvshelper rvslib rvslibut gtest_main gtest pthread
+    rvshelper rvslib rvslibut gtest_main gtest pthread z
   )
   target_compile_definitions(${TEST_NAME} PRIVATE RVS_UNIT_TEST)
   add_compile_options(-Wall -Wextra -save-temps)
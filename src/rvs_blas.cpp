@@ -25,7 +25,9 @@
 #include "include/rvs_blas.h"
 
 #include <time.h>
+#include <algorithm>
 #include <iostream>
+#include <new>
 
 #define RANDOM_CT               320000
 #define RANDOM_DIV_CT           0.1234
@@ -37,20 +39,34 @@
  * @param _m matrix size
  * @param _n matrix size
  * @param _k matrix size
+ * @param _ops_type GEMM operation ("sgemm", "dgemm" or "hgemm"), only
+ * matrices of its precision are allocated
+ * @param _host_page page size of pinned host matrices (0 - regular heap
+ * memory, not pinned)
  */
 rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k, int transA, int transB, 
-                    float alpha , float beta, int lda, int ldb, int ldc) : gpu_device_index(_gpu_device_index),
-                             m(_m), n(_n), k(_k){
+                    float alpha , float beta, int lda, int ldb, int ldc,
+                    const std::string& _ops_type, size_t _host_page)
+                    : gpu_device_index(_gpu_device_index),
+                             m(_m), n(_n), k(_k), host_page(_host_page),
+                             host_alloc(&host_pinner) {
     is_handle_init = false;
+    is_batch_event_init = false;
     is_error = false;
-    da = db = dc = NULL;
-    ha = hb = hc = nullptr;
+    pin_host = false;
+    is_copy_stream_init = false;
+    fill_seed = 0;
 
     size_a = k * m;
     size_b = k * n;
     size_c = n * m;
 
-    if (alocate_host_matrix_mem()) {
+    matrix_gen.set_scale(RANDOM_CT / RANDOM_DIV_CT);
+
+    ops_precision = rvs::BlasBuffersBase::parse_ops_type(_ops_type);
+    buffers.reset(create_buffers());
+
+    if (buffers && alocate_host_matrix_mem()) {
         if (!init_gpu_device())
             is_error = true;
     } else {
@@ -90,8 +106,29 @@ rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k, int transA, in
  * @brief class destructor
  */
 rvs_blas::~rvs_blas() {
+    release_gemm_queue();
+    release_pipeline();
     release_host_matrix_mem();
     release_gpu_matrix_mem();
+    buffers.reset();
+}
+
+/**
+ * @brief creates (not yet allocated) matrices of the configured precision
+ * @return matrices, nullptr if ops_type is not valid
+ */
+rvs::BlasBuffersBase* rvs_blas::create_buffers(void) {
+    switch (ops_precision) {
+        case RVS_BLAS_SGEMM:
+            return new rvs::BlasBuffers<float>(this, size_a, size_b, size_c);
+        case RVS_BLAS_DGEMM:
+            return new rvs::BlasBuffers<double>(this, size_a, size_b, size_c);
+        case RVS_BLAS_HGEMM:
+            return new rvs::BlasBuffers<rocblas_half>(this,
+                                size_a, size_b, size_c);
+        default:
+            return nullptr;
+    }
 }
 
 /**
@@ -115,100 +152,41 @@ bool rvs_blas::init_gpu_device(void) {
         } else {
             return false;
         }
+        // waiting threads sleep instead of spinning on these
+        if (hipEventCreateWithFlags(&batch_start, hipEventBlockingSync)
+            != hipSuccess)
+            return false;
+        if (hipEventCreateWithFlags(&batch_done, hipEventBlockingSync)
+            != hipSuccess) {
+            hipEventDestroy(batch_start);
+            return false;
+        }
+        is_batch_event_init = true;
     }
     return true;
 }
 
 /**
  * @brief copy data matrix from host to gpu
+ * @param ops_type GEMM operation, must be the one given to the constructor
  * @return true if everything went fine, otherwise false
  */
 bool rvs_blas::copy_data_to_gpu(std::string ops_type) {
+    // matrices exist only for the precision given to the constructor
+    if (!buffers ||
+        rvs::BlasBuffersBase::parse_ops_type(ops_type) != ops_precision) {
+        is_error = true;
+        return false;
+    }
 
-      if(ops_type == "sgemm") {
-
-            if (da) {
-                 if (hipMemcpy(da, ha, sizeof(float) * size_a, hipMemcpyHostToDevice)
-                                 != hipSuccess) {
-                      is_error = true;
-                      return false;
-                  }
-            }
-
-            if (db) {
-                if (hipMemcpy(db, hb, sizeof(float) * size_b, hipMemcpyHostToDevice)
-                                != hipSuccess) {
-                      is_error = true;
-                      return false;
-                  }
-            }
-
-            if (dc) {
-                  if (hipMemcpy(dc, hc, sizeof(float) * size_c, hipMemcpyHostToDevice)
-                          != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-             }
-      }
-
-
-      if(ops_type == "dgemm") {
-
-            if (ddbla) {
-                  if (hipMemcpy(ddbla, hdbla, sizeof(double) * size_a, hipMemcpyHostToDevice)
-                                     != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
-
-            if (ddblb) {
-                  if (hipMemcpy(ddblb, hdblb, sizeof(double) * size_b, hipMemcpyHostToDevice)
-                                    != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
-
-            if (ddblc) {
-                  if (hipMemcpy(ddblc, hdblc, sizeof(double) * size_c, hipMemcpyHostToDevice)
-                                  != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-            }
-
-      }
-
-      if(ops_type == "hgemm") {
-
-            if (dhlfa) {
-                  if (hipMemcpy(dhlfa, hhlfa, sizeof(rocblas_half) * size_a, hipMemcpyHostToDevice)
-                                     != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
-
-            if (dhlfb) {
-                  if (hipMemcpy(dhlfb, hhlfb, sizeof(rocblas_half) * size_b, hipMemcpyHostToDevice)
-                                    != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
-
-            if (dhlfc) {
-                  if (hipMemcpy(dhlfc, hhlfc, sizeof(rocblas_half) * size_c, hipMemcpyHostToDevice)
-                                  != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-            }
-
-      }
-
+    for (int i = RVS_BLAS_MATRIX_A; i <= RVS_BLAS_MATRIX_C; i++) {
+        if (hipMemcpy(buffers->device_ptr(i), buffers->host_ptr(i),
+                      buffers->bytes(i), hipMemcpyHostToDevice)
+                      != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+    }
 
     is_error = false;
     return true;
@@ -219,120 +197,108 @@ bool rvs_blas::copy_data_to_gpu(std::string ops_type) {
  * @return true if everything went fine, otherwise false
  */
 bool rvs_blas::allocate_gpu_matrix_mem(void) {
-    if (hipMalloc(&da, size_a * sizeof(float)) != hipSuccess)
-        return false;
-    if (hipMalloc(&db, size_b * sizeof(float)) != hipSuccess)
-        return false;
-    if (hipMalloc(&dc, size_c * sizeof(float)) != hipSuccess)
-        return false;
-
-    if (hipMalloc(&ddbla, size_a * sizeof(double)) != hipSuccess)
-        return false;
-    if (hipMalloc(&ddblb, size_b * sizeof(double)) != hipSuccess)
-        return false;
-    if (hipMalloc(&ddblc, size_c * sizeof(double)) != hipSuccess)
-        return false;
-
-    if (hipMalloc(&dhlfa, size_a * sizeof(rocblas_half)) != hipSuccess)
-        return false;
-    if (hipMalloc(&dhlfb, size_b * sizeof(rocblas_half)) != hipSuccess)
-        return false;
-    if (hipMalloc(&dhlfc, size_c * sizeof(rocblas_half)) != hipSuccess)
-        return false;
-
-    return true;
+    return buffers->allocate_device();
 }
-
-/**
- * @brief gets time
- */
-double rvs_blas::get_time_us(void)
-{
-    hipDeviceSynchronize();
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (tv.tv_sec * 1000 * 1000) + tv.tv_usec;
-};
  
 
 /**
  * @brief releases GPU mem & destroys the rocBlas handle
  */
 void rvs_blas::release_gpu_matrix_mem(void) {
-    if (da)
-        hipFree(da);
-    if (db)
-        hipFree(db);
-    if (dc)
-        hipFree(dc);
-
-    if (ddbla)
-        hipFree(ddbla);
-    if (ddblb)
-        hipFree(ddblb);
-    if (ddblc)
-        hipFree(ddblc);
-
-    if (dhlfa)
-        hipFree(dhlfa);
-    if (dhlfb)
-        hipFree(dhlfb);
-    if (dhlfc)
-        hipFree(dhlfc);
+    if (buffers)
+        buffers->release_device();
+
+    if (is_batch_event_init) {
+        hipEventDestroy(batch_start);
+        hipEventDestroy(batch_done);
+        is_batch_event_init = false;
+    }
 
     if (is_handle_init)
         rocblas_destroy_handle(blas_handle);
 }
 
 /**
- * @brief allocate host matrix memory
- * @return true if everything went fine, otherwise false
+ * @brief pins host memory for all GPUs
+ * @return 0 if successful, otherwise non-zero
  */
-bool rvs_blas::alocate_host_matrix_mem(void) {
-
-    try {
-        ha = new float[size_a];
-        hb = new float[size_b];
-        hc = new float[size_c];
+int rvs_blas_pinner::Pin(void* Ptr, size_t Size, int Peer, void** pDevPtr) {
+    if (hipHostRegister(Ptr, Size, hipHostRegisterPortable) != hipSuccess)
+        return -1;
+    *pDevPtr = Ptr;
+    return 0;
+}
 
-        hdbla = new double[size_a];
-        hdblb = new double[size_b];
-        hdblc = new double[size_c];
+/**
+ * @brief unpins host memory pinned by Pin()
+ */
+void rvs_blas_pinner::Unpin(void* Ptr) {
+    hipHostUnregister(Ptr);
+}
 
-        hhlfa = new rocblas_half[size_a];
-        hhlfb = new rocblas_half[size_b];
-        hhlfc = new rocblas_half[size_c];
+/**
+ * @brief allocates host memory for a matrix, on heap or mapped with
+ * host_page pages and pinned (regular pages when pipelined)
+ * @param Size size in bytes
+ * @return pointer to memory, nullptr on failure
+ */
+void* rvs_blas::AllocHost(size_t Size) {
+    if (host_page == 0 && !pin_host)
+        return new (std::nothrow) char[Size];
+
+    rvs::HostBuffer buff;
+    if (host_alloc.allocate(Size, host_page, gpu_device_index, &buff))
+        return nullptr;
+    host_buffers[buff.ptr] = buff;
+    return buff.ptr;
+}
 
-        return true;
-    } catch (std::bad_alloc&) {
-        return false;
+/**
+ * @brief releases host memory obtained through AllocHost()
+ */
+void rvs_blas::FreeHost(void* Ptr) {
+    auto it = host_buffers.find(Ptr);
+    if (it != host_buffers.end()) {
+        host_alloc.release(&it->second);
+        host_buffers.erase(it);
+        return;
     }
+    delete [] static_cast<char*>(Ptr);
 }
 
 /**
- * @brief releases the host matrix memory
+ * @brief allocates memory for a matrix on the selected GPU
+ * @param Size size in bytes
+ * @return pointer to memory, nullptr on failure
  */
-void rvs_blas::release_host_matrix_mem(void) {
-    if (ha)
-        delete []ha;
-    if (hb)
-        delete []hb;
-    if (hc)
-        delete []hc;
+void* rvs_blas::AllocDevice(size_t Size) {
+    void* ptr = nullptr;
+    if (hipMalloc(&ptr, Size) != hipSuccess)
+        return nullptr;
+    return ptr;
+}
 
-    if (hdbla)
-        delete []hdbla;
-    if (hdblb)
-        delete []hdblb;
-    if (hdblc)
-        delete []hdblc;
+/**
+ * @brief releases GPU memory obtained through AllocDevice()
+ */
+void rvs_blas::FreeDevice(void* Ptr) {
+    hipFree(Ptr);
+}
 
-    if (hhlfa)
-        delete []hhlfa;
-    if (hhlfb)
-        delete []hhlfb;
-    if (hhlfc)
-        delete []hhlfc;
+/**
+ * @brief allocate host matrix memory
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::alocate_host_matrix_mem(void) {
+    return buffers->allocate_host();
+}
+
+/**
+ * @brief releases the host matrix memory
+ */
+void rvs_blas::release_host_matrix_mem(void) {
+    if (buffers)
+        buffers->release_host();
 }
 
 /**
@@ -349,65 +315,154 @@ bool rvs_blas::is_gemm_op_complete(void) {
 
 /**
  * @brief performs the SGEMM matrix multiplication
+ * @param ops_type GEMM operation, must be the one given to the constructor
  * @return true if GPU was able to enqueue the GEMM operation, otherwise false
  */
 bool rvs_blas::run_blass_gemm(std::string ops_type) {
 
-    if (!is_error) {
-      
-        if(ops_type == "sgemm") {
+    if (is_error || !buffers ||
+        rvs::BlasBuffersBase::parse_ops_type(ops_type) != ops_precision)
+        return false;
+
+    return enqueue_gemm(buffers.get(), blas_handle);
+}
 
+/**
+ * @brief enqueues Count GEMMs between two events on the rocBlas stream
+ *
+ * Completion is waited for with wait_gemm_batch(), duration measured on
+ * the device is returned by get_gemm_batch_time_us().
+ *
+ * @param Count number of GEMMs (at least 1)
+ * @return true if GPU was able to enqueue the GEMMs, otherwise false
+ */
+bool rvs_blas::run_gemm_batch(int Count) {
+    if (is_error || !buffers || !is_batch_event_init || Count < 1)
+        return false;
+
+    if (hipEventRecord(batch_start, hip_stream) != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    for (int i = 0; i < Count; i++) {
+        if (!enqueue_gemm(buffers.get(), blas_handle))
+            return false;
+    }
+    if (hipEventRecord(batch_done, hip_stream) != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief waits for the last GEMM batch, calling thread sleeps meanwhile
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::wait_gemm_batch(void) {
+    if (!is_batch_event_init)
+        return false;
+    if (hipEventSynchronize(batch_done) != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief returns duration of the last completed GEMM batch, measured on
+ * the device (no host wakeup latency included)
+ * @return time in microseconds, 0 if not available
+ */
+double rvs_blas::get_gemm_batch_time_us(void) {
+    float ms;
+    if (!is_batch_event_init ||
+        hipEventElapsedTime(&ms, batch_start, batch_done) != hipSuccess)
+        return 0;
+    return ms * 1e3;
+}
+
+/**
+ * @brief runs Count GEMMs and waits for them
+ * @param Count number of GEMMs (at least 1)
+ * @param pTimeUs [out] duration of the batch measured on the device in
+ * microseconds
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::timed_gemm_batch(int Count, double* pTimeUs) {
+    if (!run_gemm_batch(Count) || !wait_gemm_batch())
+        return false;
+    *pTimeUs = get_gemm_batch_time_us();
+    return *pTimeUs > 0;
+}
+
+/**
+ * @brief enqueues GEMM of the configured precision on the stream of a
+ * rocBlas handle
+ * @param pBuff matrices to multiply (device copies)
+ * @param Handle rocBlas handle to enqueue on
+ * @return true if GPU was able to enqueue the GEMM operation, otherwise false
+ */
+bool rvs_blas::enqueue_gemm(rvs::BlasBuffersBase* pBuff,
+                            rocblas_handle Handle) {
+    rocblas_status status = rocblas_status_success;
+
+    switch (ops_precision) {
+        case RVS_BLAS_SGEMM: {
+                 auto mat = static_cast<rvs::BlasBuffers<float>*>(
+                                pBuff);
                  float alpha = blas_alpha_val, beta = blas_beta_val;
-                 
-                 if (rocblas_sgemm(blas_handle, transa, transb,
+
+                 status = rocblas_sgemm(Handle, transa, transb,
                          rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                         &alpha, da, blas_lda_offset,
-                         db, blas_ldb_offset, &beta,
-                         dc, blas_ldc_offset) != rocblas_status_success) {
-                 is_error = true;  // GPU cannot enqueue the gemm
-                 return false;
-                 } else {
-                      return true;
-                 }
+                         &alpha, mat->device_data(RVS_BLAS_MATRIX_A),
+                         blas_lda_offset,
+                         mat->device_data(RVS_BLAS_MATRIX_B),
+                         blas_ldb_offset, &beta,
+                         mat->device_data(RVS_BLAS_MATRIX_C),
+                         blas_ldc_offset);
+                 break;
         }
 
-       if(ops_type == "dgemm") {
-
+        case RVS_BLAS_DGEMM: {
+                  auto mat = static_cast<rvs::BlasBuffers<double>*>(
+                                pBuff);
                   double alpha = blas_alpha_val, beta = blas_beta_val;
 
-                  if (rocblas_dgemm(blas_handle, transa, transb,
+                  status = rocblas_dgemm(Handle, transa, transb,
                           rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                          &alpha, ddbla, blas_lda_offset,
-                          ddblb, blas_ldb_offset, &beta,
-                          ddblc, blas_ldc_offset) != rocblas_status_success) {
-                  is_error = true;  // GPU cannot enqueue the gemm
-                  return false;
-                  } else {
-                       return true;
-                  }
-       }
-
-      if(ops_type == "hgemm") {
+                          &alpha, mat->device_data(RVS_BLAS_MATRIX_A),
+                          blas_lda_offset,
+                          mat->device_data(RVS_BLAS_MATRIX_B),
+                          blas_ldb_offset, &beta,
+                          mat->device_data(RVS_BLAS_MATRIX_C),
+                          blas_ldc_offset);
+                  break;
+        }
+
+        case RVS_BLAS_HGEMM: {
+                  auto mat = static_cast<rvs::BlasBuffers<rocblas_half>*>(
+                                pBuff);
                   rocblas_half alpha;
                   rocblas_half beta;
 
                   alpha.data = blas_alpha_val;
                   beta.data = blas_beta_val;
 
-                  if (rocblas_hgemm(blas_handle, transa, transb,
+                  status = rocblas_hgemm(Handle, transa, transb,
                           rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                          &alpha, dhlfa, blas_lda_offset,
-                          dhlfb, blas_ldb_offset, &beta,
-                          dhlfc, blas_ldc_offset) != rocblas_status_success) {
-                  is_error = true;  // GPU cannot enqueue the gemm
-                  return false;
-                  } else {
-                       return true;
-                  }
-       }
-
+                          &alpha, mat->device_data(RVS_BLAS_MATRIX_A),
+                          blas_lda_offset,
+                          mat->device_data(RVS_BLAS_MATRIX_B),
+                          blas_ldb_offset, &beta,
+                          mat->device_data(RVS_BLAS_MATRIX_C),
+                          blas_ldc_offset);
+                  break;
+        }
+    }
 
-    } else {
+    if (status != rocblas_status_success) {
+        is_error = true;  // GPU cannot enqueue the gemm
         return false;
     }
 
@@ -417,52 +472,427 @@ bool rvs_blas::run_blass_gemm(std::string ops_type) {
 /**
  * @brief generate matrix random data
  * it should be called before rocBlas GEMM
+ *
+ * Matrices are filled in parallel by rvs::MatrixGen, one stream per matrix.
  */
 void rvs_blas::generate_random_matrix_data(void) {
-    int i;
-    if (!is_error) {
-        uint64_t nextr = time(NULL);
+    if (!is_error && buffers) {
+        matrix_gen.set_seed(time(NULL));
+        generate_matrix_data(buffers.get());
+    }
+}
 
-        //SGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            ha[i] = fast_pseudo_rand(&nextr);
+/**
+ * @brief fills host matrices with data of the current matrix_gen seed
+ * @param pBuff matrices to fill
+ */
+void rvs_blas::generate_matrix_data(rvs::BlasBuffersBase* pBuff) {
+    for (int mat = RVS_BLAS_MATRIX_A; mat <= RVS_BLAS_MATRIX_C; mat++) {
+        size_t count = pBuff->count(mat);
+
+        switch (ops_precision) {
+            case RVS_BLAS_SGEMM:
+                matrix_gen.generate(
+                    static_cast<float*>(pBuff->host_ptr(mat)), count, mat);
+                break;
+            case RVS_BLAS_DGEMM:
+                matrix_gen.generate(
+                    static_cast<double*>(pBuff->host_ptr(mat)), count, mat);
+                break;
+            case RVS_BLAS_HGEMM:
+                static_assert(sizeof(rocblas_half) == sizeof(uint16_t),
+                              "rocblas_half must be IEEE binary16");
+                matrix_gen.generate_half(
+                    static_cast<uint16_t*>(pBuff->host_ptr(mat)), count, mat);
+                break;
+        }
+    }
+}
+
+
+/**
+ * @brief allocates pinned staging and device matrices for Slots GEMMs,
+ * creates the copy stream and starts the first copy
+ *
+ * Heap matrices are reallocated pinned, async copies from pageable memory
+ * are not asynchronous.
+ *
+ * @param Slots number of matrix sets (at least 2)
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::start_pipeline(int Slots) {
+    if (is_error || !buffers)
+        return false;
+
+    release_pipeline();
+    Slots = std::max(Slots, 2);
+
+    if (host_page == 0 && !pin_host) {
+        pin_host = true;
+        buffers->release_host();
+        if (!buffers->allocate_host()) {
+            is_error = true;
+            return false;
+        }
+    }
+
+    for (int i = 1; i < Slots; i++) {
+        std::unique_ptr<rvs::BlasBuffersBase> buff(create_buffers());
+        if (!buff->allocate_host() || !buff->allocate_device()) {
+            release_pipeline();
+            return false;
+        }
+        slot_extra.push_back(std::move(buff));
+    }
+
+    // non-blocking, so that copies don't serialize with the rocBlas stream
+    // (which may be the null stream)
+    if (hipStreamCreateWithFlags(&copy_stream, hipStreamNonBlocking)
+        != hipSuccess) {
+        release_pipeline();
+        return false;
+    }
+    is_copy_stream_init = true;
+
+    slot_events.assign(Slots, rvs_blas_events());
+    for (auto& ev : slot_events) {
+        hipEvent_t* events[] = {&ev.copy_start, &ev.copy_done,
+                                &ev.gemm_start, &ev.gemm_done};
+        // waiting thread sleeps instead of spinning on these; timing is
+        // kept for CopyTime()/GemmTime()
+        for (hipEvent_t* event : events) {
+            if (hipEventCreateWithFlags(event, hipEventBlockingSync)
+                != hipSuccess) {
+                *event = nullptr;
+                release_pipeline();
+                return false;
+            }
+        }
+    }
+
+    fill_seed = time(NULL);
+    pipeline.reset(new rvs::GemmPipeline(this, Slots));
+    if (pipeline->start()) {
+        is_error = true;
+        release_pipeline();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief starts GEMM on matrices copied during the previous call and
+ * prepares matrices of the next one
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::run_pipelined_gemm(void) {
+    if (is_error || !pipeline)
+        return false;
+    if (pipeline->step()) {
+        is_error = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief waits for all pipelined copies and GEMMs, statistics are kept
+ * until the next start_pipeline()
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::finish_pipeline(void) {
+    if (!pipeline)
+        return false;
+    if (pipeline->finish()) {
+        is_error = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief releases pipeline matrices, events and the copy stream
+ */
+void rvs_blas::release_pipeline(void) {
+    if (pipeline || is_copy_stream_init)
+        hipDeviceSynchronize();
+    pipeline.reset();
+
+    for (auto& ev : slot_events) {
+        hipEvent_t events[] = {ev.copy_start, ev.copy_done,
+                               ev.gemm_start, ev.gemm_done};
+        for (hipEvent_t event : events) {
+            if (event)
+                hipEventDestroy(event);
+        }
+    }
+    slot_events.clear();
+
+    if (is_copy_stream_init) {
+        hipStreamDestroy(copy_stream);
+        is_copy_stream_init = false;
+    }
+    slot_extra.clear();
+}
+
+/**
+ * @brief returns matrices of a pipeline slot
+ */
+rvs::BlasBuffersBase* rvs_blas::slot_buffers(int Slot) {
+    return Slot == 0 ? buffers.get() : slot_extra[Slot - 1].get();
+}
+
+/**
+ * @brief fills staging matrices of the slot with fresh data
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::Fill(int Slot) {
+    matrix_gen.set_seed(fill_seed++);
+    generate_matrix_data(slot_buffers(Slot));
+    return 0;
+}
+
+/**
+ * @brief enqueues copy of staging matrices of the slot to its device
+ * matrices on the copy stream
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::CopyAsync(int Slot) {
+    rvs::BlasBuffersBase* buff = slot_buffers(Slot);
+    rvs_blas_events& ev = slot_events[Slot];
+
+    if (hipEventRecord(ev.copy_start, copy_stream) != hipSuccess)
+        return -1;
+    for (int i = RVS_BLAS_MATRIX_A; i <= RVS_BLAS_MATRIX_C; i++) {
+        if (hipMemcpyAsync(buff->device_ptr(i), buff->host_ptr(i),
+                           buff->bytes(i), hipMemcpyHostToDevice,
+                           copy_stream) != hipSuccess)
+            return -1;
+    }
+    if (hipEventRecord(ev.copy_done, copy_stream) != hipSuccess)
+        return -1;
+    return 0;
+}
 
-        for (i = 0; i < size_b; ++i)
-            hb[i] = fast_pseudo_rand(&nextr);
+/**
+ * @brief enqueues GEMM on device matrices of the slot on the rocBlas
+ * stream, behind the copy of the slot
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::GemmAsync(int Slot) {
+    rvs_blas_events& ev = slot_events[Slot];
+
+    if (hipStreamWaitEvent(hip_stream, ev.copy_done, 0) != hipSuccess)
+        return -1;
+    if (hipEventRecord(ev.gemm_start, hip_stream) != hipSuccess)
+        return -1;
+    if (!enqueue_gemm(slot_buffers(Slot), blas_handle))
+        return -1;
+    if (hipEventRecord(ev.gemm_done, hip_stream) != hipSuccess)
+        return -1;
+    return 0;
+}
 
-        for (int i = 0; i < size_c; ++i)
-            hc[i] = fast_pseudo_rand(&nextr);
+/**
+ * @brief waits for copy of the slot
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::WaitCopy(int Slot) {
+    return hipEventSynchronize(slot_events[Slot].copy_done) == hipSuccess ?
+           0 : -1;
+}
 
-        //DGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            hdbla[i] = (double)fast_pseudo_rand(&nextr);
+/**
+ * @brief waits for GEMM of the slot
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::WaitGemm(int Slot) {
+    return hipEventSynchronize(slot_events[Slot].gemm_done) == hipSuccess ?
+           0 : -1;
+}
 
-        for (i = 0; i < size_b; ++i)
-            hdblb[i] = (double)fast_pseudo_rand(&nextr);
+/**
+ * @brief returns duration of the completed copy of the slot
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::CopyTime(int Slot, double* pSeconds) {
+    float ms;
+    if (hipEventElapsedTime(&ms, slot_events[Slot].copy_start,
+                            slot_events[Slot].copy_done) != hipSuccess)
+        return -1;
+    *pSeconds = ms / 1e3;
+    return 0;
+}
 
-        for (int i = 0; i < size_c; ++i)
-            hdblc[i] = (double)fast_pseudo_rand(&nextr);
+/**
+ * @brief returns duration of the completed GEMM of the slot
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::GemmTime(int Slot, double* pSeconds) {
+    float ms;
+    if (hipEventElapsedTime(&ms, slot_events[Slot].gemm_start,
+                            slot_events[Slot].gemm_done) != hipSuccess)
+        return -1;
+    *pSeconds = ms / 1e3;
+    return 0;
+}
 
-        for (i = 0; i < size_a; ++i)
-            hhlfa[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+/**
+ * @brief creates Streams - 1 additional streams, each with a rocBlas handle
+ * and device matrices holding a copy of the current ones, and a queue
+ * keeping up to Depth GEMMs in flight across all streams
+ *
+ * Small GEMMs leave the GPU idle between completion of one GEMM and
+ * launch of the next one and may not fill it. Queued GEMMs start as soon
+ * as the previous one on their stream completes, GEMMs on different streams
+ * may run concurrently.
+ *
+ * @param Streams number of streams (at least 1)
+ * @param Depth maximum number of GEMMs in flight (at least Streams)
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::start_gemm_queue(int Streams, int Depth) {
+    if (is_error || !buffers || !is_handle_init)
+        return false;
+
+    release_gemm_queue();
+    Streams = std::max(Streams, 1);
+
+    for (int s = 1; s < Streams; s++) {
+        std::unique_ptr<rvs::BlasBuffersBase> buff(create_buffers());
+        if (!buff->allocate_device()) {
+            release_gemm_queue();
+            return false;
+        }
+        for (int i = RVS_BLAS_MATRIX_A; i <= RVS_BLAS_MATRIX_C; i++) {
+            if (hipMemcpy(buff->device_ptr(i), buffers->device_ptr(i),
+                          buff->bytes(i), hipMemcpyDeviceToDevice)
+                          != hipSuccess) {
+                release_gemm_queue();
+                return false;
+            }
+        }
+        queue_buffers.push_back(std::move(buff));
 
-        for (i = 0; i < size_b; ++i)
-            hhlfb[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+        hipStream_t stream;
+        if (hipStreamCreateWithFlags(&stream, hipStreamNonBlocking)
+            != hipSuccess) {
+            release_gemm_queue();
+            return false;
+        }
+        queue_streams.push_back(stream);
 
-        for (int i = 0; i < size_c; ++i)
-            hhlfc[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+        rocblas_handle handle;
+        if (rocblas_create_handle(&handle) != rocblas_status_success) {
+            release_gemm_queue();
+            return false;
+        }
+        queue_handles.push_back(handle);
+        if (rocblas_set_stream(handle, stream) != rocblas_status_success) {
+            release_gemm_queue();
+            return false;
+        }
     }
+
+    gemm_queue.reset(new rvs::GemmQueue(this, Streams, Depth));
+
+    // waiting thread sleeps instead of spinning on these
+    queue_events.assign(gemm_queue->depth(), nullptr);
+    for (auto& event : queue_events) {
+        if (hipEventCreateWithFlags(&event,
+                hipEventBlockingSync | hipEventDisableTiming) != hipSuccess) {
+            event = nullptr;
+            release_gemm_queue();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief launches Count GEMMs through the GEMM queue, waits for the oldest
+ * GEMM in flight whenever the queue is full
+ * @param Count number of GEMMs
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::run_queued_gemms(int Count) {
+    if (is_error || !gemm_queue)
+        return false;
+    if (gemm_queue->submit(Count)) {
+        is_error = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief waits for all queued GEMMs, counters are kept until the next
+ * start_gemm_queue()
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::finish_gemm_queue(void) {
+    if (!gemm_queue)
+        return false;
+    if (gemm_queue->drain()) {
+        is_error = true;
+        return false;
+    }
+    return true;
 }
 
+/**
+ * @brief releases queue events, handles, streams and matrices
+ */
+void rvs_blas::release_gemm_queue(void) {
+    if (gemm_queue || !queue_streams.empty())
+        hipDeviceSynchronize();
+    gemm_queue.reset();
+
+    for (hipEvent_t event : queue_events) {
+        if (event)
+            hipEventDestroy(event);
+    }
+    queue_events.clear();
+
+    for (rocblas_handle handle : queue_handles)
+        rocblas_destroy_handle(handle);
+    queue_handles.clear();
 
+    for (hipStream_t stream : queue_streams)
+        hipStreamDestroy(stream);
+    queue_streams.clear();
+
+    queue_buffers.clear();
+}
 
 /**
- * @brief fast pseudo random generator 
- * @return floating point random number
+ * @brief enqueues GEMM on matrices of the stream and records the event of
+ * the slot behind it
+ * @return 0 if successful, otherwise non-zero
  */
-float rvs_blas::fast_pseudo_rand(u_long *nextr) {
-    *nextr = *nextr * 1103515245 + 12345;
-    return static_cast<float>(static_cast<uint32_t>
-                    ((*nextr / 65536) % RANDOM_CT)) / RANDOM_DIV_CT;
+int rvs_blas::QueueGemm(int Stream, int Slot) {
+    rocblas_handle handle = blas_handle;
+    hipStream_t stream = hip_stream;
+    rvs::BlasBuffersBase* buff = buffers.get();
+
+    if (Stream > 0) {
+        handle = queue_handles[Stream - 1];
+        stream = queue_streams[Stream - 1];
+        buff = queue_buffers[Stream - 1].get();
+    }
+
+    if (!enqueue_gemm(buff, handle))
+        return -1;
+    if (hipEventRecord(queue_events[Slot], stream) != hipSuccess)
+        return -1;
+    return 0;
 }
 
+/**
+ * @brief waits for the GEMM last launched through the slot, calling thread
+ * sleeps meanwhile
+ * @return 0 if successful, otherwise non-zero
+ */
+int rvs_blas::WaitQueued(int Slot) {
+    return hipEventSynchronize(queue_events[Slot]) == hipSuccess ? 0 : -1;
+}
@@ -0,0 +1,152 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvsblasbuf.h"
+
+/**
+ * @brief Constructor, no memory is allocated yet
+ *
+ * @param pAlloc provides host and device memory
+ * @param ElemSize size of one element in bytes
+ * @param SizeA number of elements of matrix A
+ * @param SizeB number of elements of matrix B
+ * @param SizeC number of elements of matrix C
+ *
+ * */
+rvs::BlasBuffersBase::BlasBuffersBase(BlasAllocator* pAlloc, size_t ElemSize,
+                                      size_t SizeA, size_t SizeB,
+                                      size_t SizeC)
+: allocator(pAlloc), elem_size(ElemSize) {
+  counts[RVS_BLAS_MATRIX_A] = SizeA;
+  counts[RVS_BLAS_MATRIX_B] = SizeB;
+  counts[RVS_BLAS_MATRIX_C] = SizeC;
+  for (int i = 0; i < 3; i++) {
+    host[i] = nullptr;
+    device[i] = nullptr;
+  }
+}
+
+//! Destructor, releases all memory
+rvs::BlasBuffersBase::~BlasBuffersBase() {
+  release_host();
+  release_device();
+}
+
+/**
+ * @brief Allocates host copies of A, B and C
+ *
+ * @return true if successfull, false otherwise (nothing is kept allocated)
+ *
+ * */
+bool rvs::BlasBuffersBase::allocate_host() {
+  for (int i = 0; i < 3; i++) {
+    if (host[i] == nullptr &&
+        (host[i] = allocator->AllocHost(bytes(i))) == nullptr) {
+      release_host();
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Allocates device copies of A, B and C
+ *
+ * @return true if successfull, false otherwise (nothing is kept allocated)
+ *
+ * */
+bool rvs::BlasBuffersBase::allocate_device() {
+  for (int i = 0; i < 3; i++) {
+    if (device[i] == nullptr &&
+        (device[i] = allocator->AllocDevice(bytes(i))) == nullptr) {
+      release_device();
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Releases host copies
+void rvs::BlasBuffersBase::release_host() {
+  for (int i = 0; i < 3; i++) {
+    if (host[i]) {
+      allocator->FreeHost(host[i]);
+      host[i] = nullptr;
+    }
+  }
+}
+
+//! Releases device copies
+void rvs::BlasBuffersBase::release_device() {
+  for (int i = 0; i < 3; i++) {
+    if (device[i]) {
+      allocator->FreeDevice(device[i]);
+      device[i] = nullptr;
+    }
+  }
+}
+
+//! Returns size of A, B and C together in bytes
+size_t rvs::BlasBuffersBase::bytes() const {
+  return (counts[RVS_BLAS_MATRIX_A] + counts[RVS_BLAS_MATRIX_B] +
+          counts[RVS_BLAS_MATRIX_C]) * elem_size;
+}
+
+/**
+ * @brief Converts GEMM operation name into precision
+ *
+ * @param Name "sgemm", "dgemm" or "hgemm"
+ * @return one of RVS_BLAS_*GEMM, -1 if Name is not valid
+ *
+ * */
+int rvs::BlasBuffersBase::parse_ops_type(const std::string& Name) {
+  if (Name == "sgemm") {
+    return RVS_BLAS_SGEMM;
+  }
+  if (Name == "dgemm") {
+    return RVS_BLAS_DGEMM;
+  }
+  if (Name == "hgemm") {
+    return RVS_BLAS_HGEMM;
+  }
+  return -1;
+}
+
+/**
+ * @brief Returns GEMM operation name
+ *
+ * @param Precision one of RVS_BLAS_*GEMM
+ * @return operation name
+ *
+ * */
+const char* rvs::BlasBuffersBase::ops_name(int Precision) {
+  switch (Precision) {
+    case RVS_BLAS_DGEMM:
+      return "dgemm";
+    case RVS_BLAS_HGEMM:
+      return "hgemm";
+    default:
+      return "sgemm";
+  }
+}
@@ -0,0 +1,368 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvscollective.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! "no dependency" value for Collective::add()
+const size_t kNoDep = SIZE_MAX;
+
+//! names of collectives, indexed by RVS_COLL_*
+const char* const kNames[] = {"allgather", "broadcast", "broadcast_tree"};
+
+//! Returns Part-th of Parts (nearly) equal pieces of Len bytes at Offset
+void split(size_t Offset, size_t Len, size_t Parts, size_t Part,
+           size_t* pOffset, size_t* pSize) {
+  size_t begin = Len * Part / Parts;
+  size_t end = Len * (Part + 1) / Parts;
+  *pOffset = Offset + begin;
+  *pSize = end - begin;
+}
+
+//! Returns distance from one node to another, NO_CONN if not connected
+uint32_t distance(const rvs::Topology& Topo, uint32_t Src, uint32_t Dst) {
+  const rvs::Topology::Pair* p = Topo.at(Src, Dst);
+  if (p == nullptr || p->peer == 0) {
+    return rvs::Topology::NO_CONN;
+  }
+  return p->distance;
+}
+
+}  // namespace
+
+//! Default constructor
+rvs::Collective::Collective()
+: coll_kind(RVS_COLL_ALLGATHER), data_size(0), chunk_count(RVS_COLL_CHUNKS) {
+}
+
+/**
+ * @brief Builds copy schedule of a collective operation
+ *
+ * - all-gather: Size is split into one block per rank; in each of N-1
+ *   steps every rank sends the block it received last to its successor
+ *   on the ring,
+ * - broadcast: Size is sent from the first rank along the ring, every rank
+ *   but the last forwarding it to its successor,
+ * - broadcast_tree: Size is sent from the first rank along a binary tree
+ *   laid over the ring order (parent of rank k is rank (k-1)/2).
+ *
+ * Each block is split into Chunks chunks (fewer if block is smaller than
+ * Chunks bytes) and each chunk is forwarded as soon as it arrives.
+ *
+ * @param Kind collective kind (one of RVS_COLL_*)
+ * @param Ranks NUMA nodes of ranks in ring order, first one is the root
+ * @param Size data size in bytes (size of each rank buffer)
+ * @param Chunks number of chunks each block is split into
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::Collective::build(int Kind, const std::vector<uint32_t>& Ranks,
+                           size_t Size, int Chunks) {
+  schedule.clear();
+
+  size_t blocks = Kind == RVS_COLL_ALLGATHER ? Ranks.size() : 1;
+  if (Kind < RVS_COLL_ALLGATHER || Kind > RVS_COLL_BROADCAST_TREE ||
+      Ranks.size() < 2 || Chunks < 1 || Size < blocks) {
+    return -1;
+  }
+
+  coll_kind = Kind;
+  rank_nodes = Ranks;
+  data_size = Size;
+  chunk_count = Chunks;
+
+  size_t pieces = std::min(static_cast<size_t>(Chunks), Size / blocks);
+  switch (Kind) {
+  case RVS_COLL_ALLGATHER:
+    build_allgather(pieces);
+    break;
+  case RVS_COLL_BROADCAST:
+    build_broadcast(pieces);
+    break;
+  default:
+    build_broadcast_tree(pieces);
+    break;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Appends one copy to the schedule
+ *
+ * @param Src source rank
+ * @param Dst destination rank
+ * @param Offset offset of data in rank buffers
+ * @param Size number of bytes to copy
+ * @param Dep index of copy to wait for, kNoDep if none
+ *
+ * */
+void rvs::Collective::add(int Src, int Dst, size_t Offset, size_t Size,
+                          size_t Dep) {
+  CollectiveStep step;
+  step.src = Src;
+  step.dst = Dst;
+  step.offset = Offset;
+  step.size = Size;
+  if (Dep != kNoDep) {
+    step.deps.push_back(Dep);
+  }
+  schedule.push_back(step);
+}
+
+/**
+ * @brief Builds ring all-gather schedule
+ *
+ * Copy of chunk p sent by rank i in step s has index (s*N + i)*Pieces + p
+ * and waits for the same chunk sent to rank i in step s-1.
+ *
+ * @param Pieces number of chunks per block
+ *
+ * */
+void rvs::Collective::build_allgather(size_t Pieces) {
+  size_t n = rank_nodes.size();
+  for (size_t s = 0; s + 1 < n; s++) {
+    for (size_t i = 0; i < n; i++) {
+      // block rank i received in previous step (own block in first step)
+      size_t block = (i + n - s) % n;
+      size_t block_offset, block_size;
+      split(0, data_size, n, block, &block_offset, &block_size);
+      for (size_t p = 0; p < Pieces; p++) {
+        size_t offset, size;
+        split(block_offset, block_size, Pieces, p, &offset, &size);
+        size_t dep = kNoDep;
+        if (s > 0) {
+          dep = ((s - 1) * n + (i + n - 1) % n) * Pieces + p;
+        }
+        add(i, (i + 1) % n, offset, size, dep);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Builds broadcast pipelined along the ring
+ *
+ * Chunks are submitted one after another, each through all hops, so
+ * every link gets chunks in order.
+ *
+ * @param Pieces number of chunks
+ *
+ * */
+void rvs::Collective::build_broadcast(size_t Pieces) {
+  size_t hops = rank_nodes.size() - 1;
+  for (size_t p = 0; p < Pieces; p++) {
+    size_t offset, size;
+    split(0, data_size, Pieces, p, &offset, &size);
+    for (size_t h = 0; h < hops; h++) {
+      add(h, h + 1, offset, size, h > 0 ? p * hops + h - 1 : kNoDep);
+    }
+  }
+}
+
+/**
+ * @brief Builds broadcast along binary tree
+ *
+ * Parent of rank k is rank (k-1)/2. Since parents precede their children,
+ * copy to rank k can wait for the copy to its parent of the same chunk.
+ *
+ * @param Pieces number of chunks
+ *
+ * */
+void rvs::Collective::build_broadcast_tree(size_t Pieces) {
+  size_t edges = rank_nodes.size() - 1;
+  for (size_t p = 0; p < Pieces; p++) {
+    size_t offset, size;
+    split(0, data_size, Pieces, p, &offset, &size);
+    for (size_t k = 1; k <= edges; k++) {
+      size_t parent = (k - 1) / 2;
+      add(parent, k, offset, size,
+          parent > 0 ? p * edges + parent - 1 : kNoDep);
+    }
+  }
+}
+
+/**
+ * @brief Submits all copies and waits for them to complete
+ *
+ * Copies are submitted up front with their dependencies, so the host does
+ * not take part in forwarding chunks. If a submit fails, copies already
+ * submitted are still waited for.
+ *
+ * @param pEngine copy engine
+ * @param pDuration [out] time from start of the first copy to end of the
+ * last one (sec)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::Collective::run(CollectiveEngine* pEngine, double* pDuration) const {
+  int sts = 0;
+  size_t submitted = 0;
+
+  for (; submitted < schedule.size(); submitted++) {
+    if (pEngine->Submit(submitted, schedule[submitted])) {
+      sts = -1;
+      break;
+    }
+  }
+
+  uint64_t first = UINT64_MAX;
+  uint64_t last = 0;
+  for (size_t i = 0; i < submitted; i++) {
+    uint64_t start, end;
+    if (pEngine->Wait(i) || pEngine->CopyTime(i, &start, &end)) {
+      sts = -1;
+      continue;
+    }
+    first = std::min(first, start);
+    last = std::max(last, end);
+  }
+
+  if (sts || submitted == 0) {
+    return -1;
+  }
+
+  *pDuration = (last - first) / 1e9;
+  return 0;
+}
+
+/**
+ * @brief Returns ratio of bus to algorithm bandwidth
+ *
+ * In all-gather every rank receives (N-1)/N of the data, in broadcast
+ * every rank but the root receives all of it once.
+ *
+ * */
+double rvs::Collective::bus_factor() const {
+  if (coll_kind == RVS_COLL_ALLGATHER && rank_nodes.size() > 0) {
+    return static_cast<double>(rank_nodes.size() - 1) / rank_nodes.size();
+  }
+  return 1;
+}
+
+/**
+ * @brief Returns algorithm bandwidth
+ *
+ * @param Duration duration of collective (sec)
+ * @return data size over duration (GBps), 0 if Duration is not positive
+ *
+ * */
+double rvs::Collective::alg_bandwidth(double Duration) const {
+  if (Duration <= 0) {
+    return 0;
+  }
+  return data_size / Duration / 1000 / 1000 / 1000;
+}
+
+/**
+ * @brief Returns bus bandwidth
+ *
+ * @param Duration duration of collective (sec)
+ * @return algorithm bandwidth times bus_factor() (GBps)
+ *
+ * */
+double rvs::Collective::bus_bandwidth(double Duration) const {
+  return alg_bandwidth(Duration) * bus_factor();
+}
+
+/**
+ * @brief Converts collective name to kind
+ *
+ * @param Name "allgather", "broadcast" or "broadcast_tree"
+ * @return one of RVS_COLL_*, -1 if name is not known
+ *
+ * */
+int rvs::Collective::parse(const std::string& Name) {
+  for (int i = RVS_COLL_ALLGATHER; i <= RVS_COLL_BROADCAST_TREE; i++) {
+    if (Name == kNames[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Converts collective kind to name
+ *
+ * @param Kind one of RVS_COLL_*
+ * @return collective name, "unknown" if Kind is not valid
+ *
+ * */
+const char* rvs::Collective::name(int Kind) {
+  if (Kind < RVS_COLL_ALLGATHER || Kind > RVS_COLL_BROADCAST_TREE) {
+    return "unknown";
+  }
+  return kNames[Kind];
+}
+
+/**
+ * @brief Orders nodes into a ring following the topology
+ *
+ * Starting from the first node, the nearest (smallest NUMA distance) not
+ * yet visited node is appended until all nodes are in the ring. Ties are
+ * broken by order in Nodes. On fully connected xGMI hives this yields
+ * ring of direct links; on PCIe it keeps GPUs under the same switch or
+ * socket together.
+ *
+ * @param Topo all-pairs topology
+ * @param Nodes NUMA nodes to order, first one stays first
+ * @param pRing [out] nodes in ring order
+ *
+ * */
+void rvs::Collective::ring_order(const Topology& Topo,
+                                 const std::vector<uint32_t>& Nodes,
+                                 std::vector<uint32_t>* pRing) {
+  pRing->clear();
+  if (Nodes.empty()) {
+    return;
+  }
+
+  std::vector<bool> used(Nodes.size(), false);
+  size_t current = 0;
+  used[0] = true;
+  pRing->push_back(Nodes[0]);
+
+  for (size_t n = 1; n < Nodes.size(); n++) {
+    size_t best = Nodes.size();
+    uint64_t best_dist = UINT64_MAX;
+    for (size_t i = 0; i < Nodes.size(); i++) {
+      if (used[i]) {
+        continue;
+      }
+      uint64_t d = distance(Topo, Nodes[current], Nodes[i]);
+      if (best == Nodes.size() || d < best_dist) {
+        best = i;
+        best_dist = d;
+      }
+    }
+    used[best] = true;
+    current = best;
+    pRing->push_back(Nodes[best]);
+  }
+}
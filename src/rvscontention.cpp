@@ -0,0 +1,265 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvscontention.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! Returns index of ID in sorted list
+size_t id_index(const std::vector<uint16_t>& Ids, uint16_t Id) {
+  return std::lower_bound(Ids.begin(), Ids.end(), Id) - Ids.begin();
+}
+
+}  // namespace
+
+/**
+ * @brief Adds measurements of one transfer
+ *
+ * @param SrcId source GPU ID
+ * @param DstId destination GPU ID
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Path hop by hop link information from Src to Dst
+ * @param Isolated bandwidth measured alone (GBps)
+ * @param Concurrent bandwidth measured with all transfers running (GBps)
+ *
+ * */
+void rvs::Contention::add(uint16_t SrcId, uint16_t DstId,
+                          uint32_t SrcNode, uint32_t DstNode,
+                          const std::vector<linkinfo_t>& Path,
+                          double Isolated, double Concurrent) {
+  Transfer t;
+  t.src = SrcId;
+  t.dst = DstId;
+  t.isolated = Isolated;
+  t.concurrent = Concurrent;
+  xfers.push_back(t);
+  link_map.add(SrcNode, DstNode, Path);
+
+  uint16_t ids[] = {SrcId, DstId};
+  for (auto id : ids) {
+    auto it = std::lower_bound(gpu_ids.begin(), gpu_ids.end(), id);
+    if (it == gpu_ids.end() || *it != id) {
+      gpu_ids.insert(it, id);
+    }
+  }
+}
+
+//! Removes all transfers
+void rvs::Contention::clear() {
+  xfers.clear();
+  link_map.clear();
+  gpu_ids.clear();
+}
+
+/**
+ * @brief Builds NxN matrix of concurrent bandwidth
+ *
+ * Transfers with the same source and destination (e.g. halves of two
+ * bidirectional transfers between the same GPUs) are summed, so that the
+ * matrix adds up to aggregate().
+ *
+ * @param pMatrix [out] bandwidth (GBps) from ids()[row] to ids()[column],
+ * -1 where there was no transfer
+ *
+ * */
+void rvs::Contention::matrix(std::vector<std::vector<double>>* pMatrix) const {
+  size_t n = gpu_ids.size();
+  std::vector<std::vector<bool>> used(n, std::vector<bool>(n, false));
+  pMatrix->assign(n, std::vector<double>(n, 0));
+  for (auto it = xfers.begin(); it != xfers.end(); ++it) {
+    size_t row = id_index(gpu_ids, it->src);
+    size_t col = id_index(gpu_ids, it->dst);
+    (*pMatrix)[row][col] += it->concurrent;
+    used[row][col] = true;
+  }
+  for (size_t row = 0; row < n; row++) {
+    for (size_t col = 0; col < n; col++) {
+      if (!used[row][col]) {
+        (*pMatrix)[row][col] = -1;
+      }
+    }
+  }
+}
+
+//! Returns sum of concurrent bandwidth of all transfers (GBps)
+double rvs::Contention::aggregate() const {
+  double sum = 0;
+  for (auto it = xfers.begin(); it != xfers.end(); ++it) {
+    sum += it->concurrent;
+  }
+  return sum;
+}
+
+/**
+ * @brief Returns concurrent bandwidth crossing a partition of GPUs
+ *
+ * @param Side side of every GPU (indexed as ids())
+ * @return sum of bandwidth of transfers between GPUs on different sides
+ *
+ * */
+double rvs::Contention::crossing(const std::vector<bool>& Side) const {
+  double sum = 0;
+  for (auto it = xfers.begin(); it != xfers.end(); ++it) {
+    if (Side[id_index(gpu_ids, it->src)] != Side[id_index(gpu_ids, it->dst)]) {
+      sum += it->concurrent;
+    }
+  }
+  return sum;
+}
+
+/**
+ * @brief Returns bisection bandwidth
+ *
+ * Bisection bandwidth is the smallest concurrent bandwidth crossing any
+ * split of GPUs into two halves. With more than RVS_CONTENTION_MAX_BISECT
+ * GPUs only the split into lower and upper half of GPU IDs is evaluated.
+ *
+ * @param pHalf [out] optional, GPU IDs of one half of the worst split
+ * @return bisection bandwidth (GBps), 0 if there are less than two GPUs
+ *
+ * */
+double rvs::Contention::bisection(std::vector<uint16_t>* pHalf) const {
+  size_t n = gpu_ids.size();
+  size_t half = n / 2;
+  std::vector<bool> best(n, false);
+  double min_bw = 0;
+
+  if (n >= 2 && n <= RVS_CONTENTION_MAX_BISECT) {
+    min_bw = std::numeric_limits<double>::max();
+    std::vector<bool> side(n);
+    for (uint32_t mask = 0; mask < (1u << n); mask++) {
+      if (static_cast<size_t>(__builtin_popcount(mask)) != half) {
+        continue;
+      }
+      // with even count each split is seen twice, keep the one with GPU 0
+      if (n % 2 == 0 && !(mask & 1)) {
+        continue;
+      }
+      for (size_t i = 0; i < n; i++) {
+        side[i] = mask & (1u << i);
+      }
+      double bw = crossing(side);
+      if (bw < min_bw) {
+        min_bw = bw;
+        best = side;
+      }
+    }
+  } else if (n >= 2) {
+    for (size_t i = 0; i < half; i++) {
+      best[i] = true;
+    }
+    min_bw = crossing(best);
+  }
+
+  if (pHalf) {
+    pHalf->clear();
+    for (size_t i = 0; i < n; i++) {
+      if (best[i]) {
+        pHalf->push_back(gpu_ids[i]);
+      }
+    }
+  }
+
+  return min_bw;
+}
+
+/**
+ * @brief Computes load and contention factor of every link
+ *
+ * @param pLinks [out] per link statistics, most contended first
+ *
+ * */
+void rvs::Contention::links(std::vector<Link>* pLinks) const {
+  pLinks->clear();
+  for (size_t l = 0; l < link_map.link_count(); l++) {
+    Link link;
+    link.name = link_map.name(l);
+    link.transfers = link_map.users(l).size();
+    link.isolated = 0;
+    link.concurrent = 0;
+    for (auto t : link_map.users(l)) {
+      link.isolated += xfers[t].isolated;
+      link.concurrent += xfers[t].concurrent;
+    }
+    link.factor = link.concurrent > 0 ? link.isolated / link.concurrent : 0;
+    pLinks->push_back(link);
+  }
+
+  std::stable_sort(pLinks->begin(), pLinks->end(),
+                   [](const Link& a, const Link& b) {
+                     return a.factor > b.factor;
+                   });
+}
+
+/**
+ * @brief Writes results as CSV
+ *
+ * Output consists of bandwidth matrix (rows are sources, columns are
+ * destinations), aggregate and bisection bandwidth, and a table of links,
+ * separated by empty lines.
+ *
+ * @param Out output stream
+ *
+ * */
+void rvs::Contention::write_csv(std::ostream& Out) const {
+  std::vector<std::vector<double>> m;
+  matrix(&m);
+
+  Out << std::fixed << std::setprecision(3);
+  Out << "src\\dst";
+  for (auto id : gpu_ids) {
+    Out << "," << id;
+  }
+  Out << "\n";
+  for (size_t i = 0; i < gpu_ids.size(); i++) {
+    Out << gpu_ids[i];
+    for (size_t j = 0; j < gpu_ids.size(); j++) {
+      Out << ",";
+      if (m[i][j] >= 0) {
+        Out << m[i][j];
+      }
+    }
+    Out << "\n";
+  }
+
+  Out << "\n";
+  Out << "aggregate (GBps)," << aggregate() << "\n";
+  Out << "bisection (GBps)," << bisection() << "\n";
+
+  std::vector<Link> l;
+  links(&l);
+  Out << "\n";
+  Out << "link,transfers,isolated (GBps),concurrent (GBps),contention\n";
+  for (auto it = l.begin(); it != l.end(); ++it) {
+    Out << it->name << "," << it->transfers << "," << it->isolated << ","
+        << it->concurrent << "," << it->factor << "\n";
+  }
+}
@@ -0,0 +1,269 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvscopypipe.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Constructor
+ *
+ * @param pEngine copy engine
+ * @param Directions number of copy directions (1 or 2)
+ * @param Depth number of copies kept in flight per direction
+ *
+ */
+rvs::CopyPipeline::CopyPipeline(CopyEngine* pEngine, int Directions,
+                                int Depth)
+: engine(pEngine),
+directions(Directions),
+queue_depth(Depth < 1 ? 1 : Depth),
+size(0),
+busy_end(0) {
+}
+
+/**
+ * @brief Performs Count copies in every direction
+ *
+ * @param Size size of each copy
+ * @param Count number of copies per direction
+ * @param pDuration [out] time copies were in progress (seconds)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+int rvs::CopyPipeline::run(size_t Size, uint64_t Count, double* pDuration) {
+  std::vector<uint64_t> issued(directions, 0);
+  bool bmore = true;
+
+  reset(Size);
+  *pDuration = 0;
+
+  // fill the pipeline
+  for (int d = 0; d < directions; d++) {
+    for (; issued[d] < Count && issued[d] < uint64_t(queue_depth);
+         issued[d]++) {
+      if (submit(d)) {
+        drain();
+        return -1;
+      }
+    }
+  }
+
+  // complete the oldest copy in each direction, reuse its slot
+  while (bmore) {
+    bmore = false;
+    for (int d = 0; d < directions; d++) {
+      if (inflight[d] == 0) {
+        continue;
+      }
+      if (complete(d)) {
+        drain();
+        return -1;
+      }
+      if (issued[d] < Count) {
+        if (submit(d)) {
+          drain();
+          return -1;
+        }
+        issued[d]++;
+      }
+      bmore = true;
+    }
+    *pDuration += commit(false);
+  }
+
+  *pDuration += commit(true);
+  return 0;
+}
+
+/**
+ * @brief Fills the pipeline for continuous transfer
+ *
+ * @param Size size of each copy
+ * @return 0 - if successfull, non-zero otherwise (call finish() anyway)
+ *
+ */
+int rvs::CopyPipeline::start(size_t Size) {
+  reset(Size);
+  for (int d = 0; d < directions; d++) {
+    for (int i = 0; i < queue_depth; i++) {
+      if (submit(d)) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Completes the oldest copy in every direction and issues new one
+ *
+ * @param pDuration [out] busy time accounted for by this call (seconds)
+ * @return 0 - if successfull, non-zero otherwise (call finish() anyway)
+ *
+ */
+int rvs::CopyPipeline::next(double* pDuration) {
+  *pDuration = 0;
+  for (int d = 0; d < directions; d++) {
+    if (complete(d)) {
+      return -1;
+    }
+    if (submit(d)) {
+      return -1;
+    }
+  }
+  *pDuration = commit(false);
+  return 0;
+}
+
+/**
+ * @brief Waits for all outstanding copies
+ *
+ * @param pDuration [out] busy time not yet reported by next() (seconds)
+ * @param pCount [out] number of copies completed by this call per direction
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+int rvs::CopyPipeline::finish(double* pDuration, uint64_t* pCount) {
+  uint64_t before = completed.empty() ? 0 : completed[0];
+  int sts = drain();
+  *pDuration = commit(true);
+  *pCount = completed.empty() ? 0 : completed[0] - before;
+  return sts;
+}
+
+/**
+ * @brief Resets pipeline state
+ *
+ * @param Size size of each copy
+ *
+ */
+void rvs::CopyPipeline::reset(size_t Size) {
+  size = Size;
+  head.assign(directions, 0);
+  inflight.assign(directions, 0);
+  completed.assign(directions, 0);
+  last_start.assign(directions, 0);
+  pending.clear();
+  busy_end = 0;
+}
+
+/**
+ * @brief Issues copy in the next free slot of a direction
+ *
+ * @param Dir copy direction
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+int rvs::CopyPipeline::submit(int Dir) {
+  int slot = (head[Dir] + inflight[Dir]) % queue_depth;
+  if (engine->Submit(Dir, slot, size)) {
+    return -1;
+  }
+  inflight[Dir]++;
+  return 0;
+}
+
+/**
+ * @brief Waits for the oldest copy of a direction and records its interval
+ *
+ * @param Dir copy direction
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+int rvs::CopyPipeline::complete(int Dir) {
+  int slot = head[Dir];
+  uint64_t start;
+  uint64_t end;
+
+  head[Dir] = (head[Dir] + 1) % queue_depth;
+  inflight[Dir]--;
+
+  if (engine->Wait(Dir, slot) || engine->CopyTime(Dir, slot, &start, &end)) {
+    return -1;
+  }
+
+  pending.push_back(std::make_pair(start, end));
+  last_start[Dir] = start;
+  completed[Dir]++;
+  return 0;
+}
+
+/**
+ * @brief Waits for all outstanding copies in all directions
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ */
+int rvs::CopyPipeline::drain() {
+  int sts = 0;
+  for (int d = 0; d < directions; d++) {
+    while (inflight[d] > 0) {
+      if (complete(d)) {
+        sts = -1;
+      }
+    }
+  }
+  return sts;
+}
+
+/**
+ * @brief Accounts busy time of completed copies
+ *
+ * Copy intervals are merged in start order. Unless all are requested, only
+ * intervals starting before the latest start seen in every direction are
+ * taken, as copies still to complete can not start earlier than that.
+ *
+ * @param bAll 'true' to account for all completed copies
+ * @return busy time not overlapping already accounted intervals (seconds)
+ *
+ */
+double rvs::CopyPipeline::commit(bool bAll) {
+  uint64_t watermark = UINT64_MAX;
+  uint64_t busy = 0;
+
+  if (!bAll) {
+    for (int d = 0; d < directions; d++) {
+      if (inflight[d] > 0) {
+        watermark = std::min(watermark, last_start[d]);
+      }
+    }
+  }
+
+  std::sort(pending.begin(), pending.end());
+
+  size_t i = 0;
+  for (; i < pending.size() && pending[i].first <= watermark; i++) {
+    uint64_t start = std::max(pending[i].first, busy_end);
+    if (pending[i].second > start) {
+      busy += pending[i].second - start;
+    }
+    busy_end = std::max(busy_end, pending[i].second);
+  }
+  pending.erase(pending.begin(), pending.begin() + i);
+
+  return static_cast<double>(busy) / 1000000000;
+}
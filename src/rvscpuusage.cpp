@@ -0,0 +1,90 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvscpuusage.h"
+
+#include <time.h>
+
+//! Constructor, starts measuring the calling thread
+rvs::ThreadCpuUsage::ThreadCpuUsage() {
+  start();
+}
+
+//! Restarts measuring the calling thread
+void rvs::ThreadCpuUsage::start() {
+  cpu_start = thread_cpu_time();
+  wall_start = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Returns CPU time consumed by the calling thread since start()
+ *
+ * @return CPU time in seconds
+ *
+ * */
+double rvs::ThreadCpuUsage::cpu_time() const {
+  return thread_cpu_time() - cpu_start;
+}
+
+/**
+ * @brief Returns wall clock time elapsed since start()
+ *
+ * @return time in seconds
+ *
+ * */
+double rvs::ThreadCpuUsage::wall_time() const {
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - wall_start;
+  return elapsed.count();
+}
+
+/**
+ * @brief Returns share of wall clock time the calling thread was on CPU
+ *
+ * @return utilization, 0 (idle) to 1 (one core fully busy)
+ *
+ * */
+double rvs::ThreadCpuUsage::utilization() const {
+  // CPU time first so that it never exceeds wall time
+  double cpu = cpu_time();
+  double wall = wall_time();
+  if (wall <= 0) {
+    return 0;
+  }
+  return cpu > wall ? 1.0 : cpu / wall;
+}
+
+/**
+ * @brief Returns CPU time consumed by the calling thread
+ *
+ * @return CPU time in seconds, 0 if not available
+ *
+ * */
+double rvs::ThreadCpuUsage::thread_cpu_time() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)) {
+    return 0;
+  }
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
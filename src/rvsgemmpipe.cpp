@@ -0,0 +1,155 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvsgemmpipe.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructor
+ *
+ * @param pRuntime GPU runtime
+ * @param Slots number of staging slots (at least 2)
+ *
+ * */
+rvs::GemmPipeline::GemmPipeline(GemmRuntime* pRuntime, int Slots)
+: runtime(pRuntime), num_slots(std::max(Slots, 2)), current(0),
+  state(num_slots, SLOT_IDLE) {
+  reset_stats();
+}
+
+//! Clears copy and GEMM statistics
+void rvs::GemmPipeline::reset_stats() {
+  stat_copies = 0;
+  stat_gemms = 0;
+  stat_copy_time = 0;
+  stat_gemm_time = 0;
+}
+
+/**
+ * @brief Prepares the first slot
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmPipeline::start() {
+  std::fill(state.begin(), state.end(), SLOT_IDLE);
+  current = 0;
+  return prepare(current);
+}
+
+/**
+ * @brief Starts GEMM of the current slot and prepares the next one
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmPipeline::step() {
+  if (state[current] != SLOT_COPYING) {
+    return -1;
+  }
+  if (runtime->GemmAsync(current)) {
+    return -1;
+  }
+  state[current] = SLOT_COMPUTING;
+
+  current = (current + 1) % num_slots;
+  return prepare(current);
+}
+
+/**
+ * @brief Waits for everything in flight
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmPipeline::finish() {
+  int result = 0;
+  // oldest first
+  for (int i = 1; i <= num_slots; i++) {
+    if (retire((current + i) % num_slots)) {
+      result = -1;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Fills slot and starts its copy
+ *
+ * @param Slot slot to prepare
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmPipeline::prepare(int Slot) {
+  // staging and device matrices are free once GEMM that used them is done
+  if (retire(Slot)) {
+    return -1;
+  }
+  if (runtime->Fill(Slot)) {
+    return -1;
+  }
+  if (runtime->CopyAsync(Slot)) {
+    return -1;
+  }
+  state[Slot] = SLOT_COPYING;
+  return 0;
+}
+
+/**
+ * @brief Waits for slot to become idle and accounts its copy and GEMM
+ *
+ * @param Slot slot to retire
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmPipeline::retire(int Slot) {
+  double seconds;
+
+  switch (state[Slot]) {
+    case SLOT_COMPUTING:
+      if (runtime->WaitGemm(Slot) || runtime->GemmTime(Slot, &seconds)) {
+        return -1;
+      }
+      stat_gemms++;
+      stat_gemm_time += seconds;
+      // GEMM waited for the copy on device, so the copy is done too
+      if (runtime->CopyTime(Slot, &seconds)) {
+        return -1;
+      }
+      break;
+    case SLOT_COPYING:
+      if (runtime->WaitCopy(Slot) || runtime->CopyTime(Slot, &seconds)) {
+        return -1;
+      }
+      break;
+    default:
+      return 0;
+  }
+
+  stat_copies++;
+  stat_copy_time += seconds;
+  state[Slot] = SLOT_IDLE;
+  return 0;
+}
@@ -0,0 +1,112 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvsgemmqueue.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructor
+ *
+ * @param pRuntime GPU runtime
+ * @param Streams number of streams (at least 1)
+ * @param Depth maximum number of GEMMs in flight (at least Streams)
+ *
+ * */
+rvs::GemmQueue::GemmQueue(GemmQueueRuntime* pRuntime, int Streams, int Depth)
+: runtime(pRuntime), num_streams(std::max(Streams, 1)),
+  num_slots(std::max(Depth, num_streams)), next_slot(0), next_stream(0),
+  pending(0), busy(num_slots, false) {
+  reset_stats();
+}
+
+//! Clears launch and completion counters
+void rvs::GemmQueue::reset_stats() {
+  stat_submitted = 0;
+  stat_completed = 0;
+}
+
+/**
+ * @brief Launches GEMMs, waiting for the oldest one whenever the queue is
+ * full
+ *
+ * @param Count number of GEMMs to launch
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmQueue::submit(int Count) {
+  for (int i = 0; i < Count; i++) {
+    // the next slot in the ring holds the oldest GEMM in flight
+    if (retire(next_slot)) {
+      return -1;
+    }
+    if (runtime->QueueGemm(next_stream, next_slot)) {
+      return -1;
+    }
+    busy[next_slot] = true;
+    pending++;
+    stat_submitted++;
+
+    next_slot = (next_slot + 1) % num_slots;
+    next_stream = (next_stream + 1) % num_streams;
+  }
+  return 0;
+}
+
+/**
+ * @brief Waits for all GEMMs in flight
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmQueue::drain() {
+  int result = 0;
+  // oldest first
+  for (int i = 0; i < num_slots; i++) {
+    if (retire((next_slot + i) % num_slots)) {
+      result = -1;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Waits for GEMM of the slot, if any
+ *
+ * @param Slot slot to retire
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::GemmQueue::retire(int Slot) {
+  if (!busy[Slot]) {
+    return 0;
+  }
+  if (runtime->WaitQueued(Slot)) {
+    return -1;
+  }
+  busy[Slot] = false;
+  pending--;
+  stat_completed++;
+  return 0;
+}
@@ -0,0 +1,279 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvshistogram.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+//! number of sub-buckets in every power of two above the linear range
+const uint64_t half_count = 1ull << (RVS_HIST_SUB_BITS - 1);
+//! number of exactly counted values
+const uint64_t linear_count = 1ull << RVS_HIST_SUB_BITS;
+//! largest value which is not clamped
+const uint64_t max_value = (1ull << RVS_HIST_VALUE_BITS) - 1;
+
+//! Returns index of the most significant bit set in Value (Value > 0)
+int msb(uint64_t Value) {
+  return 63 - __builtin_clzll(Value);
+}
+
+}  // namespace
+
+//! Default constructor
+rvs::Histogram::Histogram()
+: counts(RVS_HIST_BUCKETS, 0),
+total(0),
+vmin(std::numeric_limits<uint64_t>::max()),
+vmax(0) {
+}
+
+/**
+ * @brief Returns index of bucket counting given value
+ *
+ * @param Value recorded value
+ * @return bucket index
+ *
+ * */
+size_t rvs::Histogram::bucket_index(uint64_t Value) {
+  if (Value < linear_count) {
+    return Value;
+  }
+  if (Value > max_value) {
+    Value = max_value;
+  }
+
+  // shift so that only RVS_HIST_SUB_BITS-1 bits below msb remain
+  int shift = msb(Value) - (RVS_HIST_SUB_BITS - 1);
+  uint64_t sub = (Value >> shift) - half_count;
+  return linear_count + (shift - 1) * half_count + sub;
+}
+
+/**
+ * @brief Returns smallest value counted in given bucket
+ *
+ * @param Index bucket index
+ * @return lower bound of bucket (inclusive)
+ *
+ * */
+uint64_t rvs::Histogram::bucket_low(size_t Index) {
+  if (Index < linear_count) {
+    return Index;
+  }
+
+  uint64_t j = Index - linear_count;
+  int shift = j / half_count + 1;
+  return (half_count + j % half_count) << shift;
+}
+
+/**
+ * @brief Returns largest value counted in given bucket
+ *
+ * @param Index bucket index
+ * @return upper bound of bucket (inclusive)
+ *
+ * */
+uint64_t rvs::Histogram::bucket_high(size_t Index) {
+  if (Index < linear_count) {
+    return Index;
+  }
+
+  int shift = (Index - linear_count) / half_count + 1;
+  return bucket_low(Index) + (1ull << shift) - 1;
+}
+
+/**
+ * @brief Records value
+ *
+ * @param Value value to record
+ * @param Count number of times value is recorded
+ *
+ * */
+void rvs::Histogram::record(uint64_t Value, uint64_t Count) {
+  if (Count == 0) {
+    return;
+  }
+  Value = std::min(Value, max_value);
+  counts[bucket_index(Value)] += Count;
+  total += Count;
+  vmin = std::min(vmin, Value);
+  vmax = std::max(vmax, Value);
+}
+
+/**
+ * @brief Adds all values recorded in another histogram
+ *
+ * Used to combine sampling intervals into totals and to combine both
+ * directions of bidirectional pair.
+ *
+ * @param Other histogram to add
+ *
+ * */
+void rvs::Histogram::merge(const Histogram& Other) {
+  if (Other.total == 0) {
+    return;
+  }
+  for (size_t i = 0; i < counts.size(); i++) {
+    counts[i] += Other.counts[i];
+  }
+  total += Other.total;
+  vmin = std::min(vmin, Other.vmin);
+  vmax = std::max(vmax, Other.vmax);
+}
+
+//! Removes all recorded values
+void rvs::Histogram::reset() {
+  std::fill(counts.begin(), counts.end(), 0);
+  total = 0;
+  vmin = std::numeric_limits<uint64_t>::max();
+  vmax = 0;
+}
+
+/**
+ * @brief Returns value at given percentile
+ *
+ * Result is the middle of the bucket holding requested rank, limited to
+ * smallest and largest recorded values.
+ *
+ * @param P percentile (0..100)
+ * @return value at percentile (0 if histogram is empty)
+ *
+ * */
+uint64_t rvs::Histogram::percentile(double P) const {
+  if (total == 0) {
+    return 0;
+  }
+  if (P >= 100) {
+    return vmax;
+  }
+
+  uint64_t rank = static_cast<uint64_t>(ceil(P / 100 * total));
+  rank = std::max(rank, static_cast<uint64_t>(1));
+
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < counts.size(); i++) {
+    cumulative += counts[i];
+    if (cumulative >= rank) {
+      uint64_t low = bucket_low(i);
+      uint64_t value = low + (bucket_high(i) - low) / 2;
+      return std::max(vmin, std::min(vmax, value));
+    }
+  }
+
+  return vmax;
+}
+
+//! Default constructor
+rvs::AtomicHistogram::AtomicHistogram()
+: vmin(std::numeric_limits<uint64_t>::max()),
+vmax(0) {
+  for (size_t i = 0; i < RVS_HIST_BUCKETS; i++) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Records value without taking any lock
+ *
+ * @param Value value to record
+ *
+ * */
+void rvs::AtomicHistogram::record(uint64_t Value) {
+  Value = std::min(Value, max_value);
+  counts[Histogram::bucket_index(Value)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+
+  uint64_t cur = vmin.load(std::memory_order_relaxed);
+  while (Value < cur &&
+         !vmin.compare_exchange_weak(cur, Value, std::memory_order_relaxed)) {
+  }
+  cur = vmax.load(std::memory_order_relaxed);
+  while (Value > cur &&
+         !vmax.compare_exchange_weak(cur, Value, std::memory_order_relaxed)) {
+  }
+}
+
+/**
+ * @brief Moves values recorded so far into histogram
+ *
+ * Recorder is left empty. Min/max are taken from the drained buckets when
+ * a concurrent record() has not updated them yet.
+ *
+ * @param pHist [out] histogram values are added to
+ *
+ * */
+void rvs::AtomicHistogram::drain(Histogram* pHist) {
+  size_t lowest = RVS_HIST_BUCKETS;
+  size_t highest = 0;
+  uint64_t drained = 0;
+
+  for (size_t i = 0; i < RVS_HIST_BUCKETS; i++) {
+    if (counts[i].load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    uint64_t c = counts[i].exchange(0, std::memory_order_relaxed);
+    if (c == 0) {
+      continue;
+    }
+    pHist->counts[i] += c;
+    drained += c;
+    lowest = std::min(lowest, i);
+    highest = i;
+  }
+
+  if (drained == 0) {
+    return;
+  }
+
+  uint64_t mn = vmin.exchange(std::numeric_limits<uint64_t>::max(),
+                              std::memory_order_relaxed);
+  uint64_t mx = vmax.exchange(0, std::memory_order_relaxed);
+  if (mn > Histogram::bucket_high(lowest)) {
+    mn = Histogram::bucket_low(lowest);
+  }
+  if (mx < Histogram::bucket_low(highest)) {
+    mx = Histogram::bucket_high(highest);
+  }
+
+  pHist->total += drained;
+  pHist->vmin = std::min(pHist->vmin, mn);
+  pHist->vmax = std::max(pHist->vmax, mx);
+}
+
+/**
+ * @brief Merges histograms of the same transfer size
+ *
+ * @param Src histograms to add
+ * @param pDst [in,out] histograms Src is added to
+ *
+ * */
+void rvs::merge(const HistogramMap& Src, HistogramMap* pDst) {
+  for (auto it = Src.begin(); it != Src.end(); ++it) {
+    (*pDst)[it->first].merge(it->second);
+  }
+}
@@ -0,0 +1,271 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvshostalloc.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+// encoding of huge page size in mmap() flags, missing in older headers
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+//! Constructor
+rvs::HostAllocator::HostAllocator(HostPinner* pPinner) : pinner(pPinner) {
+  reset_stats();
+}
+
+/**
+ * @brief Allocates host buffer and pins it if pinner is given
+ *
+ * @param Size size in bytes
+ * @param Page requested page size (regular page size or smaller - no huge
+ * pages)
+ * @param Peer device the buffer is pinned for (passed to pinner)
+ * @param pBuff [out] allocated buffer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HostAllocator::allocate(size_t Size, size_t Page, int Peer,
+                                 HostBuffer* pBuff) {
+  if (map(Size, Page, pBuff)) {
+    return -1;
+  }
+
+  if (pinner) {
+    auto start = std::chrono::steady_clock::now();
+    if (pinner->Pin(pBuff->ptr, pBuff->size, Peer, &pBuff->dev_ptr)) {
+      unmap(pBuff);
+      return -1;
+    }
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    pBuff->pinned = true;
+    pBuff->pin_time = elapsed.count();
+  }
+
+  std::lock_guard<std::mutex> lk(mtx);
+  stat_buffers++;
+  stat_bytes += pBuff->size;
+  if (stat_min_page == 0 || pBuff->page_size < stat_min_page) {
+    stat_min_page = pBuff->page_size;
+  }
+  if (pBuff->page_size < pBuff->page_req) {
+    stat_fallbacks++;
+  }
+  stat_pin_time += pBuff->pin_time;
+  if (pBuff->pin_time > stat_pin_max) {
+    stat_pin_max = pBuff->pin_time;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Unpins and unmaps buffer obtained through allocate()
+ *
+ * @param pBuff buffer to release
+ *
+ * */
+void rvs::HostAllocator::release(HostBuffer* pBuff) {
+  if (pBuff->pinned && pinner) {
+    pinner->Unpin(pBuff->ptr);
+  }
+  unmap(pBuff);
+}
+
+//! Resets statistics
+void rvs::HostAllocator::reset_stats() {
+  std::lock_guard<std::mutex> lk(mtx);
+  stat_buffers = 0;
+  stat_bytes = 0;
+  stat_min_page = 0;
+  stat_fallbacks = 0;
+  stat_pin_time = 0;
+  stat_pin_max = 0;
+}
+
+/**
+ * @brief Maps anonymous host memory backed by requested page size
+ *
+ * Explicit huge pages of the requested size are tried first, then 2 MiB
+ * explicit huge pages and finally regular pages with transparent huge pages
+ * requested.
+ *
+ * @param Size size in bytes
+ * @param Page requested page size
+ * @param pBuff [out] mapped buffer (not pinned)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HostAllocator::map(size_t Size, size_t Page, HostBuffer* pBuff) {
+  size_t base = base_page();
+  void* p;
+
+  pBuff->ptr = nullptr;
+  pBuff->size = Size;
+  pBuff->map_size = 0;
+  pBuff->page_req = Page > base ? Page : base;
+  pBuff->page_size = 0;
+  pBuff->transparent = false;
+  pBuff->dev_ptr = nullptr;
+  pBuff->pinned = false;
+  pBuff->pin_time = 0;
+  if (Size == 0) {
+    return -1;
+  }
+
+#if defined(MAP_HUGETLB)
+  std::vector<size_t> pages;
+  if (Page > base) {
+    pages.push_back(Page);
+  }
+  if (Page > RVS_HOSTALLOC_PAGE_2M) {
+    pages.push_back(RVS_HOSTALLOC_PAGE_2M);
+  }
+  for (auto page : pages) {
+    int shift = 0;
+    while ((static_cast<size_t>(1) << shift) < page) {
+      shift++;
+    }
+    size_t len = (Size + page - 1) / page * page;
+    p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+             (shift << MAP_HUGE_SHIFT), -1, 0);
+    if (p != MAP_FAILED) {
+      pBuff->ptr = p;
+      pBuff->map_size = len;
+      pBuff->page_size = page;
+      pBuff->dev_ptr = p;
+      return 0;
+    }
+  }
+#endif
+
+  size_t len = (Size + base - 1) / base * base;
+  p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return -1;
+  }
+#if defined(MADV_HUGEPAGE)
+  if (Page > base) {
+    madvise(p, len, MADV_HUGEPAGE);
+    pBuff->transparent = true;
+  }
+#endif
+  pBuff->ptr = p;
+  pBuff->map_size = len;
+  pBuff->page_size = base;
+  pBuff->dev_ptr = p;
+  return 0;
+}
+
+/**
+ * @brief Unmaps buffer obtained through map()
+ *
+ * @param pBuff buffer to unmap
+ *
+ * */
+void rvs::HostAllocator::unmap(HostBuffer* pBuff) {
+  if (pBuff->ptr) {
+    munmap(pBuff->ptr, pBuff->map_size);
+  }
+  pBuff->ptr = nullptr;
+  pBuff->dev_ptr = nullptr;
+  pBuff->map_size = 0;
+  pBuff->pinned = false;
+}
+
+//! Returns regular page size
+size_t rvs::HostAllocator::base_page() {
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * @brief Converts page size given as number with optional K, M or G suffix
+ * (e.g. "4K", "2M", "1G") into bytes
+ *
+ * @param Name page size
+ * @param pPage [out] page size in bytes
+ * @return 0 - if successfull, -1 if Name is not valid
+ *
+ * */
+int rvs::HostAllocator::parse_page(const std::string& Name, size_t* pPage) {
+  char* end;
+  unsigned long long value = strtoull(Name.c_str(), &end, 10);
+  if (end == Name.c_str() || value == 0) {
+    return -1;
+  }
+
+  std::string suffix(end);
+  if (suffix.size() > 1) {
+    return -1;
+  }
+  if (suffix.size() == 1) {
+    switch (toupper(suffix[0])) {
+      case 'K':
+        value *= 1024;
+        break;
+      case 'M':
+        value *= 1024 * 1024;
+        break;
+      case 'G':
+        value *= 1024 * 1024 * 1024;
+        break;
+      default:
+        return -1;
+    }
+  }
+
+  // page sizes are powers of 2
+  if (value & (value - 1)) {
+    return -1;
+  }
+  *pPage = static_cast<size_t>(value);
+  return 0;
+}
+
+/**
+ * @brief Returns page size in the form accepted by parse_page()
+ *
+ * @param Page page size in bytes
+ * @return page size (e.g. "2M")
+ *
+ * */
+std::string rvs::HostAllocator::page_name(size_t Page) {
+  const char* suffix[] = {"", "K", "M", "G"};
+  int ix = 0;
+  while (ix < 3 && Page >= 1024 && Page % 1024 == 0) {
+    Page /= 1024;
+    ix++;
+  }
+  return std::to_string(Page) + suffix[ix];
+}
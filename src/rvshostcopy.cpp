@@ -0,0 +1,301 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvshostcopy.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "include/rvsnuma.h"
+
+rvs::HostCopy::HostCopy() {
+  src_buff = nullptr;
+  dst_buff = nullptr;
+  buff_size = 0;
+  buff_page = 0;
+  num_threads = 0;
+  src_host.ptr = nullptr;
+  dst_host.ptr = nullptr;
+}
+
+rvs::HostCopy::~HostCopy() {
+  release();
+}
+
+/**
+ * @brief Allocates source and destination buffers on given NUMA nodes
+ *
+ * @param SrcCpus CPUs of source NUMA node (empty - any CPU)
+ * @param DstCpus CPUs of destination NUMA node (empty - any CPU)
+ * @param CopyCpus CPUs copy threads run on (empty - any CPU)
+ * @param Size buffer size in bytes
+ * @param Threads number of copy threads (0 - one per CPU in CopyCpus)
+ * @param HugePage 'true' if buffers are to be backed by huge pages
+ * @return 0 - if successfull, -1 otherwise
+ *
+ * */
+int rvs::HostCopy::initialize(const std::vector<int>& SrcCpus,
+                              const std::vector<int>& DstCpus,
+                              const std::vector<int>& CopyCpus,
+                              size_t Size, int Threads, bool HugePage) {
+  release();
+  if (Size == 0) {
+    return -1;
+  }
+
+  size_t page = HugePage ? RVS_HOSTCOPY_HUGEPAGE : 0;
+  if (rvs::HostAllocator::map(Size, page, &src_host) ||
+      rvs::HostAllocator::map(Size, page, &dst_host)) {
+    release();
+    return -1;
+  }
+  src_buff = static_cast<uint8_t*>(src_host.ptr);
+  dst_buff = static_cast<uint8_t*>(dst_host.ptr);
+  buff_size = Size;
+  buff_page = std::min(src_host.page_size, dst_host.page_size);
+
+  // pages are placed on the node of the CPU which touches them first
+  if (touch(src_buff, buff_size, 0x5a, SrcCpus) ||
+      touch(dst_buff, buff_size, 0, DstCpus)) {
+    release();
+    return -1;
+  }
+
+  copy_cpus = CopyCpus;
+  num_threads = Threads > 0 ? Threads : static_cast<int>(copy_cpus.size());
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Releases buffers
+ *
+ * */
+void rvs::HostCopy::release() {
+  rvs::HostAllocator::unmap(&src_host);
+  rvs::HostAllocator::unmap(&dst_host);
+  src_buff = nullptr;
+  dst_buff = nullptr;
+  buff_size = 0;
+  buff_page = 0;
+}
+
+/**
+ * @brief Copies source to destination buffer repeatedly
+ *
+ * Every thread copies its own slice of the buffer until Seconds elapse
+ * (at least once).
+ *
+ * @param Method one of RVS_HOSTCOPY_*
+ * @param Seconds how long to copy
+ * @param pBytes [out] total number of bytes copied
+ * @param pDuration [out] duration of copying in seconds
+ * @return 0 - if successfull, -1 otherwise
+ *
+ * */
+int rvs::HostCopy::run(int Method, double Seconds,
+                       uint64_t* pBytes, double* pDuration) {
+  if (src_buff == nullptr || pBytes == nullptr || pDuration == nullptr) {
+    return -1;
+  }
+
+  std::vector<std::thread> workers;
+  std::vector<uint64_t> bytes(num_threads, 0);
+  std::vector<double> duration(num_threads, 0);
+  std::atomic<int> ready(0);
+  std::atomic<bool> go(false);
+
+  // slices are cache line aligned, last one takes the remainder
+  size_t slice = (buff_size / num_threads) & ~static_cast<size_t>(63);
+
+  for (int t = 0; t < num_threads; t++) {
+    size_t offset = slice * t;
+    size_t len = (t == num_threads - 1) ? buff_size - offset : slice;
+    workers.emplace_back([&, t, offset, len]() {
+      if (!copy_cpus.empty()) {
+        rvs::NumaTopology::pin(
+          std::vector<int>(1, copy_cpus[t % copy_cpus.size()]));
+      }
+      ready++;
+      while (!go) {
+        std::this_thread::yield();
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      std::chrono::duration<double> elapsed;
+      do {
+        copy(Method, dst_buff + offset, src_buff + offset, len);
+        bytes[t] += len;
+        elapsed = std::chrono::steady_clock::now() - start;
+      } while (elapsed.count() < Seconds);
+      duration[t] = elapsed.count();
+    });
+  }
+
+  // start all threads at once
+  while (ready < num_threads) {
+    std::this_thread::yield();
+  }
+  go = true;
+
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  *pBytes = 0;
+  *pDuration = 0;
+  for (int t = 0; t < num_threads; t++) {
+    *pBytes += bytes[t];
+    *pDuration = std::max(*pDuration, duration[t]);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Copies memory using given method
+ *
+ * @param Method one of RVS_HOSTCOPY_*
+ * @param pDst destination
+ * @param pSrc source
+ * @param Size number of bytes
+ *
+ * */
+void rvs::HostCopy::copy(int Method, void* pDst, const void* pSrc,
+                         size_t Size) {
+  if (Method == RVS_HOSTCOPY_STREAM) {
+    copy_stream(pDst, pSrc, Size);
+  } else {
+    memcpy(pDst, pSrc, Size);
+  }
+}
+
+/**
+ * @brief Copies memory using non-temporal stores
+ *
+ * Falls back to memcpy() where streaming stores are not available.
+ *
+ * @param pDst destination
+ * @param pSrc source
+ * @param Size number of bytes
+ *
+ * */
+void rvs::HostCopy::copy_stream(void* pDst, const void* pSrc, size_t Size) {
+#if defined(__SSE2__)
+  uint8_t* dst = static_cast<uint8_t*>(pDst);
+  const uint8_t* src = static_cast<const uint8_t*>(pSrc);
+
+  // streaming stores need 16 byte aligned destination
+  size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+  head = std::min(head, Size);
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  Size -= head;
+
+  for (; Size >= 64; Size -= 64, dst += 64, src += 64) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+  }
+  for (; Size >= 16; Size -= 16, dst += 16, src += 16) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+  }
+  memcpy(dst, src, Size);
+
+  // make streaming stores visible to other threads
+  _mm_sfence();
+#else
+  memcpy(pDst, pSrc, Size);
+#endif
+}
+
+/**
+ * @brief Converts copy method name into RVS_HOSTCOPY_* value
+ *
+ * @param Name "memcpy" or "stream"
+ * @return method, -1 if Name is not valid
+ *
+ * */
+int rvs::HostCopy::parse_method(const std::string& Name) {
+  if (Name == "memcpy") {
+    return RVS_HOSTCOPY_MEMCPY;
+  }
+  if (Name == "stream") {
+    return RVS_HOSTCOPY_STREAM;
+  }
+  return -1;
+}
+
+/**
+ * @brief Returns name of copy method
+ *
+ * @param Method one of RVS_HOSTCOPY_*
+ * @return method name
+ *
+ * */
+const char* rvs::HostCopy::method_name(int Method) {
+  return Method == RVS_HOSTCOPY_STREAM ? "stream" : "memcpy";
+}
+
+/**
+ * @brief Writes to every page of buffer from a thread pinned to given CPUs
+ *
+ * @param pBuff buffer
+ * @param Size size in bytes
+ * @param Value value to write
+ * @param Cpus CPUs to run on (empty - any CPU)
+ * @return 0 - if successfull, -1 otherwise
+ *
+ * */
+int rvs::HostCopy::touch(void* pBuff, size_t Size, uint8_t Value,
+                         const std::vector<int>& Cpus) {
+  int sts = 0;
+  std::thread t([&]() {
+    if (!Cpus.empty() && rvs::NumaTopology::pin(Cpus)) {
+      sts = -1;
+      return;
+    }
+    memset(pBuff, Value, Size);
+  });
+  t.join();
+  return sts;
+}
@@ -38,6 +38,7 @@
 
 #include "include/rvs_util.h"
 #include "include/rvsloglp.h"
+#include "include/rvspingpong.h"
 
 extern void gpu_get_all_gpu_id(std::vector<uint16_t>* pgpus_id);
 // ptr to singletone instance
@@ -77,11 +78,13 @@ rvs::hsa* rvs::hsa::Get() {
 }
 
 //! Default constructor
-rvs::hsa::hsa() {
+rvs::hsa::hsa() : transfer_pool(this), host_page(0), host_pinner(this),
+                  host_alloc(&host_pinner) {
 }
 
-//! Default destructor
+//! Default destructor, releases cached transfer buffers and signals
 rvs::hsa::~hsa() {
+  transfer_pool.clear();
 }
 
 
@@ -342,9 +345,42 @@ void rvs::hsa::InitAgents() {
 
   std::sort(size_list.begin(), size_list.end());
 
+  InitTopology();
+
   PrintTopology();
 }
 
+/**
+ * @brief Fetch peer access and link information for all pairs of agents
+ *
+ * Functionality:
+ *
+ * Queries HSA once for every ordered pair of agents in agent_list and
+ * stores results in topology so that FindAgent(), GetPeerStatus() and
+ * GetLinkInfo() don't need to query HSA again.
+ *
+ * @return void
+ *
+ * */
+void rvs::hsa::InitTopology() {
+  std::vector<uint32_t> nodes;
+
+  RVSHSATRACE_
+  for (size_t i = 0; i < agent_list.size(); i++) {
+    nodes.push_back(agent_list[i].node);
+  }
+  topology.reset(nodes);
+
+  for (size_t i = 0; i < agent_list.size(); i++) {
+    for (size_t j = 0; j < agent_list.size(); j++) {
+      Topology::Pair& p = topology.pair(i, j);
+      p.peer = GetPeerStatusAgent(agent_list[i], agent_list[j]);
+      QueryLinkInfo(i, j, &p.distance, &p.path);
+      p.hops = p.path.size();
+    }
+  }
+}
+
 /**
  * @brief Process individual hsa_agent
  *
@@ -522,12 +558,8 @@ hsa_status_t rvs::hsa::ProcessMemPool(hsa_amd_memory_pool_t pool, void* data) {
  *
  * */
 int rvs::hsa::FindAgent(const uint32_t Node) {
-  for (size_t i = 0; i < agent_list.size(); i++) {
-    if (agent_list[i].node == Node)
-      return i;
-  }
-  RVSHSATRACE_
-  return -1;
+  // topology agents are in the same order as agent_list
+  return topology.index(Node);
 }
 
 /**
@@ -604,6 +636,14 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
   void* srcbuff = nullptr;
   void* dstbuff = nullptr;
 
+  // host side of host <-> GPU transfer backed by requested page size
+  if (host_page &&
+      (agent_list[SrcAgent].agent_device_type == "CPU") !=
+      (agent_list[DstAgent].agent_device_type == "CPU")) {
+    return AllocateHost(SrcAgent, DstAgent, Size,
+                        pSrcPool, SrcBuff, pDstPool, DstBuff);
+  }
+
   // iterate over src pools
   for (size_t i = 0; i < agent_list[SrcAgent].mem_pool_list.size(); i++) {
     RVSHSATRACE_
@@ -723,36 +763,270 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
 }
 
 /**
- * @brief Allocate buffers in source and destination memory pools
+ * @brief Allocate buffer in memory of an agent, accessible by other agents
+ *
+ * @param Agent agent index in agent_list vector, owner of the memory
+ * @param Peers agent indexes in agent_list vector to grant access to
+ * @param Size size of buffer
+ * @param pBuff [out] ptr to buffer
+ * @param pPool [out] memory pool the buffer is allocated in (optional)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::AllocateShared(int Agent, const std::vector<int>& Peers,
+                             size_t Size, void** pBuff,
+                             hsa_amd_memory_pool_t* pPool) {
+  hsa_status_t status;
+  void* buff = nullptr;
+
+  std::vector<hsa_agent_t> peer_agents;
+  for (auto ix : Peers) {
+    if (ix != Agent) {
+      peer_agents.push_back(agent_list[ix].agent);
+    }
+  }
+
+  for (size_t i = 0; i < agent_list[Agent].mem_pool_list.size(); i++) {
+    RVSHSATRACE_
+    if (Size > agent_list[Agent].max_size_list[i]) {
+      RVSHSATRACE_
+      continue;
+    }
+
+    if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
+                agent_list[Agent].mem_pool_list[i], Size, 0, &buff))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                   "hsa_amd_memory_pool_allocate()",
+                   status);
+      continue;
+    }
+
+    if (peer_agents.size() > 0 &&
+        HSA_STATUS_SUCCESS != (status = hsa_amd_agents_allow_access(
+                peer_agents.size(), peer_agents.data(), NULL, buff))) {
+      RVSHSATRACE_
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_agents_allow_access()",
+                status);
+      hsa_amd_memory_pool_free(buff);
+      continue;
+    }
+
+    *pBuff = buff;
+    if (pPool) {
+      *pPool = agent_list[Agent].mem_pool_list[i];
+    }
+    return 0;
+  }
+
+  RVSHSATRACE_
+  return -1;
+}
+
+/**
+ * @brief Allocate buffers for transfer between host and GPU with host
+ * buffer mapped with host_page pages and locked for the GPU agent
+ *
+ * @param SrcAgent source agent index in agent_list vector
+ * @param DstAgent destination agent index in agent_list vector
+ * @param Size size of data to transfer
+ * @param pSrcPool [out] ptr to source memory pool (for host buffer: first
+ * pool of CPU agent, buffer does not come from it)
+ * @param SrcBuff  [out] ptr to source buffer
+ * @param pDstPool [out] ptr to destination memory pool (see pSrcPool)
+ * @param DstBuff  [out] ptr to destination buffer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::AllocateHost(int SrcAgent, int DstAgent, size_t Size,
+                           hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
+                           hsa_amd_memory_pool_t* pDstPool, void** DstBuff) {
+  bool src_host = agent_list[SrcAgent].agent_device_type == "CPU";
+  int host = src_host ? SrcAgent : DstAgent;
+  int gpu = src_host ? DstAgent : SrcAgent;
+  hsa_amd_memory_pool_t gpu_pool;
+  void* gpubuff = nullptr;
+  HostBuffer hostbuff;
+
+  RVSHSATRACE_
+  if (agent_list[host].mem_pool_list.empty() ||
+      AllocateShared(gpu, std::vector<int>(), Size, &gpubuff, &gpu_pool)) {
+    return -1;
+  }
+
+  if (host_alloc.allocate(Size, host_page, gpu, &hostbuff)) {
+    RVSHSATRACE_
+    hsa_amd_memory_pool_free(gpubuff);
+    return -1;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(host_mtx);
+    host_buffers[hostbuff.dev_ptr] = hostbuff;
+  }
+
+  *pSrcPool = src_host ? agent_list[host].mem_pool_list[0] : gpu_pool;
+  *pDstPool = src_host ? gpu_pool : agent_list[host].mem_pool_list[0];
+  *SrcBuff = src_host ? hostbuff.dev_ptr : gpubuff;
+  *DstBuff = src_host ? gpubuff : hostbuff.dev_ptr;
+
+  return 0;
+}
+
+/**
+ * @brief Set page size of host buffers in host <-> GPU transfers
+ *
+ * Cached transfer buffers are released when the page size changes.
+ *
+ * @param Page page size in bytes, 0 - allocate from system memory pool
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::SetHostPage(size_t Page) {
+  if (Page != host_page) {
+    transfer_pool.clear();
+    host_page = Page;
+  }
+  host_alloc.reset_stats();
+  return 0;
+}
+
+/**
+ * @brief Lock host memory for access by one agent
+ *
+ * @param Ptr host address
+ * @param Size size in bytes
+ * @param Peer agent index in agent_list vector
+ * @param pDevPtr [out] address to be used by the agent
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaHostPinner::Pin(void* Ptr, size_t Size, int Peer,
+                            void** pDevPtr) {
+  hsa_status_t status;
+  hsa_agent_t agent = pHsa->agent_list[Peer].agent;
+
+  if (HSA_STATUS_SUCCESS !=
+      (status = hsa_amd_memory_lock(Ptr, Size, &agent, 1, pDevPtr))) {
+    rvs::hsa::print_hsa_status(__FILE__, __LINE__, __func__,
+                               "hsa_amd_memory_lock()", status);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Unlock host memory locked by Pin()
+ *
+ * @param Ptr host address
+ *
+ * */
+void rvs::HsaHostPinner::Unpin(void* Ptr) {
+  hsa_amd_memory_unlock(Ptr);
+}
+
+/**
+ * @brief Allocate buffers for transfer between two agents
+ *
+ * TransferAllocator implementation used by transfer_pool.
+ *
+ * @param SrcAgent source agent index in agent_list vector
+ * @param DstAgent destination agent index in agent_list vector
+ * @param Size size of each buffer
+ * @param pSrcBuff [out] ptr to source buffer
+ * @param pDstBuff [out] ptr to destination buffer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::AllocateBuffers(int SrcAgent, int DstAgent, size_t Size,
+                              void** pSrcBuff, void** pDstBuff) {
+  hsa_amd_memory_pool_t src_pool;
+  hsa_amd_memory_pool_t dst_pool;
+  return Allocate(SrcAgent, DstAgent, Size,
+                  &src_pool, pSrcBuff, &dst_pool, pDstBuff);
+}
+
+/**
+ * @brief Free buffer obtained through AllocateBuffers() or Allocate()
+ *
+ * @param Buff buffer to free
+ *
+ * */
+void rvs::hsa::FreeBuffer(void* Buff) {
+  {
+    std::lock_guard<std::mutex> lk(host_mtx);
+    auto it = host_buffers.find(Buff);
+    if (it != host_buffers.end()) {
+      host_alloc.release(&it->second);
+      host_buffers.erase(it);
+      return;
+    }
+  }
+  hsa_amd_memory_pool_free(Buff);
+}
+
+/**
+ * @brief Create signal used to wait on copy operation
+ *
+ * @param pSignal [out] signal handle
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::CreateSignal(uint64_t* pSignal) {
+  hsa_status_t status;
+  hsa_signal_t signal;
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_signal_create(1, 0, NULL, &signal))) {
+    print_hsa_status(__FILE__, __LINE__, __func__,
+              "hsa_signal_create()",
+              status);
+    return -1;
+  }
+  *pSignal = signal.handle;
+  return 0;
+}
+
+/**
+ * @brief Destroy signal obtained through CreateSignal()
+ *
+ * @param Signal signal handle
+ *
+ * */
+void rvs::hsa::DestroySignal(uint64_t Signal) {
+  hsa_signal_t signal;
+  signal.handle = Signal;
+  hsa_signal_destroy(signal);
+}
+
+/**
+ * @brief Transfer data between two NUMA nodes and measure transfer time
+ *
+ * Buffers and signals are taken from transfer_pool, so they are allocated
+ * and granted access only the first time a given transfer is made.
  *
  * @param SrcNode source NUMA node
  * @param DstNode destination NUMA node
  * @param Size size of data to transfer
  * @param bidirectional 'true' for bidirectional transfer
  * @param Duration [out] duration of transfer in seconds
+ * @param QueueDepth number of copies of Size bytes kept in flight in each
+ * direction (Duration then covers all of them)
  * @return 0 - if successfull, non-zero otherwise
  *
  * */
 int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
                               size_t Size, bool bidirectional,
-                              double* Duration) {
+                              double* Duration, int QueueDepth) {
   hsa_status_t status;
-  int sts;
 
   int32_t src_ix_fwd;
   int32_t dst_ix_fwd;
-  hsa_amd_memory_pool_t src_pool_fwd;
-  hsa_amd_memory_pool_t dst_pool_fwd;
-  void* src_ptr_fwd = nullptr;
-  void* dst_ptr_fwd = nullptr;
+  TransferPool::Entry* fwd;
   hsa_signal_t signal_fwd;
 
   int32_t src_ix_rev;
   int32_t dst_ix_rev;
-  hsa_amd_memory_pool_t src_pool_rev;
-  hsa_amd_memory_pool_t dst_pool_rev;
-  void* src_ptr_rev = nullptr;
-  void* dst_ptr_rev = nullptr;
+  TransferPool::Entry* rev = nullptr;
   hsa_signal_t signal_rev;
 
   RVSHSATRACE_
@@ -768,63 +1042,46 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
     return -1;
   }
 
-  // allocate buffers and grant permissions for forward transfer
-  sts = Allocate(src_ix_fwd, dst_ix_fwd, Size,
-           &src_pool_fwd, &src_ptr_fwd,
-           &dst_pool_fwd, &dst_ptr_fwd);
-  if (sts) {
-    RVSHSATRACE_
-    return -1;
-  }
-
-  // Create a signal to wait on copy operation
-  if (HSA_STATUS_SUCCESS !=
-     (status = hsa_signal_create(1, 0, NULL, &signal_fwd))) {
-    print_hsa_status(__FILE__, __LINE__, __func__,
-              "hsa_signal_create()",
-              status);
-      hsa_amd_memory_pool_free(src_ptr_fwd);
-      hsa_amd_memory_pool_free(dst_ptr_fwd);
+  // pipelined copies, one slot per copy in flight
+  if (QueueDepth > 1) {
+    HsaCopyEngine engine(this);
+    if (engine.initialize(src_ix_fwd, dst_ix_fwd, true, bidirectional,
+                          Size, QueueDepth)) {
       RVSHSATRACE_
       return -1;
+    }
+    CopyPipeline pipeline(&engine, engine.directions(), QueueDepth);
+    return pipeline.run(Size, QueueDepth, Duration);
   }
 
-  if (bidirectional) {
+  // get buffers with granted permissions and signal for forward transfer
+  fwd = transfer_pool.acquire(src_ix_fwd, dst_ix_fwd, Size);
+  if (fwd == nullptr) {
     RVSHSATRACE_
+    return -1;
+  }
+  signal_fwd.handle = fwd->signal;
+  signal_rev.handle = 0;
 
-    // allocate buffers and grant permissions for reverse transfer
-    sts = Allocate(src_ix_rev, dst_ix_rev, Size,
-            &src_pool_rev, &src_ptr_rev,
-            &dst_pool_rev, &dst_ptr_rev);
+  if (bidirectional) {
+    RVSHSATRACE_
 
-    if (sts) {
+    // get buffers with granted permissions and signal for reverse transfer
+    rev = transfer_pool.acquire(src_ix_rev, dst_ix_rev, Size);
+    if (rev == nullptr) {
       RVSHSATRACE_
-      hsa_amd_memory_pool_free(src_ptr_fwd);
-      hsa_amd_memory_pool_free(dst_ptr_fwd);
-      return -1;
-    }
-
-    // Create a signal to wait on for reverse copy operation
-    if (HSA_STATUS_SUCCESS !=
-       (status = hsa_signal_create(1, 0, NULL, &signal_rev))) {
-      print_hsa_status(__FILE__, __LINE__, __func__,
-              "hsa_signal_create()",
-              status);
-      hsa_amd_memory_pool_free(src_ptr_fwd);
-      hsa_amd_memory_pool_free(dst_ptr_fwd);
-      hsa_amd_memory_pool_free(src_ptr_rev);
-      hsa_amd_memory_pool_free(dst_ptr_rev);
-      hsa_signal_destroy(signal_fwd);
+      transfer_pool.release(fwd);
       return -1;
     }
+    signal_rev.handle = rev->signal;
   }
 
   // initiate forward transfer
   hsa_signal_store_relaxed(signal_fwd, 1);
   if (HSA_STATUS_SUCCESS !=
      (status = hsa_amd_memory_async_copy(
-                dst_ptr_fwd, agent_list[dst_ix_fwd].agent,
-                src_ptr_fwd, agent_list[src_ix_fwd].agent,
+                fwd->dst_buff, agent_list[dst_ix_fwd].agent,
+                fwd->src_buff, agent_list[src_ix_fwd].agent,
                 Size,
                 0, NULL, signal_fwd)))
     print_hsa_status(__FILE__, __LINE__, __func__,
@@ -835,8 +1092,8 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
     // initiate reverse transfer
     hsa_signal_store_relaxed(signal_rev, 1);
     if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_async_copy(
-        dst_ptr_rev, agent_list[dst_ix_rev].agent,
-        src_ptr_rev, agent_list[src_ix_rev].agent, Size,
+        rev->dst_buff, agent_list[dst_ix_rev].agent,
+        rev->src_buff, agent_list[src_ix_rev].agent, Size,
         0, NULL, signal_rev)))
       print_hsa_status(__FILE__, __LINE__, __func__,
               "hsa_amd_memory_async_copy()",
@@ -857,21 +1114,407 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
   // get transfer duration
   *Duration = GetCopyTime(bidirectional, signal_fwd, signal_rev)/1000000000;
 
-  hsa_amd_memory_pool_free(src_ptr_fwd);
-  hsa_amd_memory_pool_free(dst_ptr_fwd);
-  hsa_signal_destroy(signal_fwd);
+  // keep buffers and signals for the next transfer
+  transfer_pool.release(fwd);
+  transfer_pool.release(rev);
+  RVSHSATRACE_
 
-  if (bidirectional) {
+  return 0;
+}
+
+
+/**
+ * @brief Measure small message latency between two nodes
+ *
+ * Performs Rounds chained round trips (see rvs::PingPong). Buffers and
+ * signals come from the transfer pool, so they are allocated only on the
+ * first call for given nodes and size.
+ *
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Size message size in bytes
+ * @param Rounds number of chained round trips
+ * @param pOneWay [out] one-way latencies (nsec) are added here
+ * @param pRoundTrip [out] round trip latencies (nsec) are added here
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::SendPingPong(uint32_t SrcNode, uint32_t DstNode, size_t Size,
+                           int Rounds, Histogram* pOneWay,
+                           Histogram* pRoundTrip) {
+  RVSHSATRACE_
+
+  int32_t src_ix = FindAgent(SrcNode);
+  int32_t dst_ix = FindAgent(DstNode);
+  if (src_ix < 0 || dst_ix < 0) {
     RVSHSATRACE_
-    hsa_amd_memory_pool_free(src_ptr_rev);
-    hsa_amd_memory_pool_free(dst_ptr_rev);
-    hsa_signal_destroy(signal_rev);
+    return -1;
+  }
+
+  HsaCopyEngine engine(this);
+  if (engine.initialize(src_ix, dst_ix, true, true, Size, Rounds)) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  rvs::PingPong pingpong(&engine, Rounds);
+  return pingpong.run(Size, pOneWay, pRoundTrip);
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param pWrapper RVS HSA wrapper providing agents and transfer pool
+ *
+ * */
+rvs::HsaCopyEngine::HsaCopyEngine(hsa* pWrapper) : pHsa(pWrapper) {
+}
+
+//! Destructor, gives slot buffers and signals back to transfer pool
+rvs::HsaCopyEngine::~HsaCopyEngine() {
+  release();
+}
+
+/**
+ * @brief Acquire buffers and signals for all slots
+ *
+ * @param SrcAgent source agent index in agent_list vector
+ * @param DstAgent destination agent index in agent_list vector
+ * @param Fwd 'true' to enable copies from source to destination
+ * @param Rev 'true' to enable copies from destination to source
+ * @param Size size of each copy
+ * @param Depth number of slots per direction
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCopyEngine::initialize(int SrcAgent, int DstAgent,
+                                   bool Fwd, bool Rev,
+                                   size_t Size, int Depth) {
+  release();
+
+  if (Fwd) {
+    src_agent.push_back(SrcAgent);
+    dst_agent.push_back(DstAgent);
+  }
+  if (Rev) {
+    src_agent.push_back(DstAgent);
+    dst_agent.push_back(SrcAgent);
+  }
+
+  slots.resize(src_agent.size());
+  for (size_t d = 0; d < slots.size(); d++) {
+    for (int i = 0; i < Depth; i++) {
+      TransferPool::Entry* e =
+        pHsa->transfer_pool.acquire(src_agent[d], dst_agent[d], Size);
+      if (e == nullptr) {
+        RVSHSATRACE_
+        release();
+        return -1;
+      }
+      slots[d].push_back(e);
+    }
   }
-  RVSHSATRACE_
 
   return 0;
 }
 
+/**
+ * @brief Give slot buffers and signals back to transfer pool
+ *
+ * */
+void rvs::HsaCopyEngine::release() {
+  for (auto& dir : slots) {
+    for (auto e : dir) {
+      pHsa->transfer_pool.release(e);
+    }
+  }
+  slots.clear();
+  src_agent.clear();
+  dst_agent.clear();
+}
+
+/**
+ * @brief Initiate async copy in the given slot
+ *
+ * @param Dir copy direction
+ * @param Slot copy slot
+ * @param Size size of data to copy
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCopyEngine::Submit(int Dir, int Slot, size_t Size) {
+  hsa_status_t status;
+  TransferPool::Entry* e = slots[Dir][Slot];
+  hsa_signal_t signal;
+  signal.handle = e->signal;
+
+  hsa_signal_store_relaxed(signal, 1);
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_amd_memory_async_copy(
+                e->dst_buff, pHsa->agent_list[dst_agent[Dir]].agent,
+                e->src_buff, pHsa->agent_list[src_agent[Dir]].agent,
+                Size,
+                0, NULL, signal))) {
+    hsa::print_hsa_status(__FILE__, __LINE__, __func__,
+              "hsa_amd_memory_async_copy()",
+              status);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Initiate async copy which starts after another copy completes
+ *
+ * Dependency is passed to HSA as a signal, so host does not wait for it.
+ *
+ * @param Dir copy direction
+ * @param Slot copy slot
+ * @param Size size of data to copy
+ * @param DepDir direction of the copy to wait for
+ * @param DepSlot slot of the copy to wait for
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCopyEngine::SubmitAfter(int Dir, int Slot, size_t Size,
+                                    int DepDir, int DepSlot) {
+  hsa_status_t status;
+  TransferPool::Entry* e = slots[Dir][Slot];
+  hsa_signal_t signal;
+  signal.handle = e->signal;
+  hsa_signal_t dep;
+  dep.handle = slots[DepDir][DepSlot]->signal;
+
+  hsa_signal_store_relaxed(signal, 1);
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_amd_memory_async_copy(
+                e->dst_buff, pHsa->agent_list[dst_agent[Dir]].agent,
+                e->src_buff, pHsa->agent_list[src_agent[Dir]].agent,
+                Size,
+                1, &dep, signal))) {
+    hsa::print_hsa_status(__FILE__, __LINE__, __func__,
+              "hsa_amd_memory_async_copy()",
+              status);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Wait for copy in the given slot to complete
+ *
+ * @param Dir copy direction
+ * @param Slot copy slot
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCopyEngine::Wait(int Dir, int Slot) {
+  hsa_signal_t signal;
+  signal.handle = slots[Dir][Slot]->signal;
+
+  while (hsa_signal_wait_acquire(signal, HSA_SIGNAL_CONDITION_LT,
+         1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE)) {}
+  return 0;
+}
+
+/**
+ * @brief Fetch start and end time of completed copy
+ *
+ * @param Dir copy direction
+ * @param Slot copy slot
+ * @param pStart [out] start time in nanoseconds
+ * @param pEnd [out] end time in nanoseconds
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCopyEngine::CopyTime(int Dir, int Slot,
+                                 uint64_t* pStart, uint64_t* pEnd) {
+  hsa_status_t status;
+  hsa_signal_t signal;
+  signal.handle = slots[Dir][Slot]->signal;
+
+  hsa_amd_profiling_async_copy_time_t async_time {0};
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_amd_profiling_get_async_copy_time(signal, &async_time))) {
+    hsa::print_hsa_status(__FILE__, __LINE__, __func__,
+                   "hsa_amd_profiling_get_async_copy_time()",
+                   status);
+    return -1;
+  }
+  *pStart = async_time.start;
+  *pEnd = async_time.end;
+  return 0;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param pWrapper RVS HSA wrapper providing agents
+ *
+ * */
+rvs::HsaCollectiveEngine::HsaCollectiveEngine(hsa* pWrapper)
+: pHsa(pWrapper), buffer_size(0) {
+}
+
+//! Destructor, frees buffers and signals
+rvs::HsaCollectiveEngine::~HsaCollectiveEngine() {
+  release();
+}
+
+/**
+ * @brief Prepare buffers and signals for a collective schedule
+ *
+ * Buffers are reallocated only if ranks change or Size grows, signals
+ * are only added.
+ *
+ * @param Nodes NUMA nodes of ranks
+ * @param Size size of buffer of every rank
+ * @param Steps number of copies in the schedule
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCollectiveEngine::initialize(const std::vector<uint32_t>& Nodes,
+                                         size_t Size, size_t Steps) {
+  if (Nodes != nodes || Size > buffer_size) {
+    for (auto b : buffers) {
+      pHsa->FreeBuffer(b);
+    }
+    buffers.clear();
+    agents.clear();
+    nodes.clear();
+    buffer_size = 0;
+
+    for (auto node : Nodes) {
+      int ix = pHsa->FindAgent(node);
+      if (ix < 0) {
+        RVSHSATRACE_
+        return -1;
+      }
+      agents.push_back(ix);
+    }
+    for (auto ix : agents) {
+      void* buff = nullptr;
+      if (pHsa->AllocateShared(ix, agents, Size, &buff)) {
+        RVSHSATRACE_
+        release();
+        return -1;
+      }
+      buffers.push_back(buff);
+    }
+    nodes = Nodes;
+    buffer_size = Size;
+  }
+
+  while (signals.size() < Steps) {
+    uint64_t signal;
+    if (pHsa->CreateSignal(&signal)) {
+      RVSHSATRACE_
+      return -1;
+    }
+    signals.push_back(signal);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Free buffers and signals
+ *
+ * */
+void rvs::HsaCollectiveEngine::release() {
+  for (auto b : buffers) {
+    pHsa->FreeBuffer(b);
+  }
+  for (auto s : signals) {
+    pHsa->DestroySignal(s);
+  }
+  buffers.clear();
+  signals.clear();
+  agents.clear();
+  nodes.clear();
+  buffer_size = 0;
+}
+
+/**
+ * @brief Initiate async copy which starts after its dependencies complete
+ *
+ * @param Index index of copy in schedule
+ * @param Step copy to perform
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCollectiveEngine::Submit(size_t Index,
+                                     const CollectiveStep& Step) {
+  hsa_status_t status;
+  hsa_signal_t signal;
+  signal.handle = signals[Index];
+
+  std::vector<hsa_signal_t> deps(Step.deps.size());
+  for (size_t i = 0; i < Step.deps.size(); i++) {
+    deps[i].handle = signals[Step.deps[i]];
+  }
+
+  char* src = static_cast<char*>(buffers[Step.src]) + Step.offset;
+  char* dst = static_cast<char*>(buffers[Step.dst]) + Step.offset;
+
+  hsa_signal_store_relaxed(signal, 1);
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_amd_memory_async_copy(
+                dst, pHsa->agent_list[agents[Step.dst]].agent,
+                src, pHsa->agent_list[agents[Step.src]].agent,
+                Step.size,
+                deps.size(), deps.size() ? deps.data() : NULL, signal))) {
+    hsa::print_hsa_status(__FILE__, __LINE__, __func__,
+              "hsa_amd_memory_async_copy()",
+              status);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Wait for copy to complete
+ *
+ * @param Index index of copy in schedule
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCollectiveEngine::Wait(size_t Index) {
+  hsa_signal_t signal;
+  signal.handle = signals[Index];
+
+  while (hsa_signal_wait_acquire(signal, HSA_SIGNAL_CONDITION_LT,
+         1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE)) {}
+  return 0;
+}
+
+/**
+ * @brief Fetch start and end time of completed copy
+ *
+ * @param Index index of copy in schedule
+ * @param pStart [out] start time in nanoseconds
+ * @param pEnd [out] end time in nanoseconds
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::HsaCollectiveEngine::CopyTime(size_t Index,
+                                       uint64_t* pStart, uint64_t* pEnd) {
+  hsa_status_t status;
+  hsa_signal_t signal;
+  signal.handle = signals[Index];
+
+  hsa_amd_profiling_async_copy_time_t async_time {0};
+  if (HSA_STATUS_SUCCESS !=
+     (status = hsa_amd_profiling_get_async_copy_time(signal, &async_time))) {
+    hsa::print_hsa_status(__FILE__, __LINE__, __func__,
+                   "hsa_amd_profiling_get_async_copy_time()",
+                   status);
+    return -1;
+  }
+  *pStart = async_time.start;
+  *pEnd = async_time.end;
+  return 0;
+}
 
 /**
  * @brief Get peer status between Src and Dst nodes
@@ -882,20 +1525,16 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
  *
  * */
 int rvs::hsa::GetPeerStatus(uint32_t SrcNode, uint32_t DstNode) {
-  int32_t srcix;
-  int32_t dstix;
   std::string msg;
 
   RVSHSATRACE_
-  // given NUMA nodes, find agent indexes
-  srcix = FindAgent(SrcNode);
-  dstix = FindAgent(DstNode);
-  if (srcix < 0 || dstix < 0) {
+  const Topology::Pair* p = topology.at(SrcNode, DstNode);
+  if (p == nullptr) {
     RVSHSATRACE_
     return 0;
   }
 
-  int peer_status = GetPeerStatusAgent(agent_list[srcix], agent_list[dstix]);
+  int peer_status = p->peer;
 
   msg = "Src: " + std::to_string(SrcNode) + "  Dst: " + std::to_string(DstNode)
       + "  access: " + std::to_string(peer_status);
@@ -1000,19 +1639,32 @@ int rvs::hsa::GetPeerStatusAgent(const AgentInformation&  SrcAgent,
  * */
 int rvs::hsa::GetLinkInfo(uint32_t SrcNode, uint32_t DstNode,
                   uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr) {
-  int32_t srcix;
-  int32_t dstix;
-  hsa_status_t sts;
-
   RVSHSATRACE_
-  // given NUMA nodes, find agent indexes
-  srcix = FindAgent(SrcNode);
-  dstix = FindAgent(DstNode);
-  if (srcix < 0 || dstix < 0) {
+  const Topology::Pair* p = topology.at(SrcNode, DstNode);
+  if (p == nullptr) {
     RVSHSATRACE_
     return -1;
   }
 
+  *pDistance = p->distance;
+  *pInfoarr = p->path;
+  return 0;
+}
+
+/**
+ * @brief Query HSA for link information between Src and Dst agents
+ *
+ * @param srcix source agent index in agent_list
+ * @param dstix destination agent index in agent_list
+ * @param pDistance ptr to NUMA distance
+ * @param pInfoarr ptr to list of hop infos
+ * @return 0 - OK, non-zero otherwise
+ *
+ * */
+int rvs::hsa::QueryLinkInfo(int srcix, int dstix,
+                  uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr) {
+  hsa_status_t sts;
+
   RVSHSATRACE_
 
   *pDistance = NO_CONN;
@@ -0,0 +1,207 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvshsapool.h"
+
+#include <list>
+#include <mutex>
+
+/**
+ * @brief Constructor
+ *
+ * @param pAllocator provider of buffers and signals
+ * @param MaxBytes limit of bytes kept in idle entries
+ *
+ */
+rvs::TransferPool::TransferPool(TransferAllocator* pAllocator, size_t MaxBytes)
+: allocator(pAllocator),
+max_bytes(MaxBytes),
+total_bytes(0) {
+}
+
+//! Destructor, releases all entries
+rvs::TransferPool::~TransferPool() {
+  clear();
+}
+
+/**
+ * @brief Returns size class of the given transfer size
+ *
+ * @param Size transfer size in bytes
+ * @return Size rounded up to a power of two
+ *
+ */
+size_t rvs::TransferPool::size_class(size_t Size) {
+  size_t result = 1;
+  while (result < Size && result << 1) {
+    result <<= 1;
+  }
+  return result < Size ? Size : result;
+}
+
+/**
+ * @brief Gets idle entry suitable for the given transfer
+ *
+ * Allocates new entry if no idle one is found. Buffers are allocated with
+ * the size class size, or exactly Size bytes if that fails.
+ *
+ * @param SrcAgent source agent index
+ * @param DstAgent destination agent index
+ * @param Size transfer size in bytes
+ * @return entry to be given back through release(), nullptr on failure
+ *
+ */
+rvs::TransferPool::Entry* rvs::TransferPool::acquire(int SrcAgent,
+                                                     int DstAgent,
+                                                     size_t Size) {
+  size_t sclass = size_class(Size);
+
+  std::lock_guard<std::mutex> lk(pool_mutex);
+
+  for (auto it = pool.begin(); it != pool.end(); ++it) {
+    if (!it->in_use && it->src_agent == SrcAgent &&
+        it->dst_agent == DstAgent && it->size_class == sclass &&
+        it->size >= Size) {
+      it->in_use = true;
+      return &*it;
+    }
+  }
+
+  Entry e;
+  e.src_agent = SrcAgent;
+  e.dst_agent = DstAgent;
+  e.size_class = sclass;
+  e.size = sclass;
+  e.src_buff = nullptr;
+  e.dst_buff = nullptr;
+  e.in_use = true;
+
+  if (allocator->AllocateBuffers(SrcAgent, DstAgent, e.size,
+                                 &e.src_buff, &e.dst_buff)) {
+    // size class may not fit into memory pool, try exact size
+    if (sclass == Size) {
+      return nullptr;
+    }
+    e.size = Size;
+    if (allocator->AllocateBuffers(SrcAgent, DstAgent, e.size,
+                                   &e.src_buff, &e.dst_buff)) {
+      return nullptr;
+    }
+  }
+
+  if (allocator->CreateSignal(&e.signal)) {
+    allocator->FreeBuffer(e.src_buff);
+    allocator->FreeBuffer(e.dst_buff);
+    return nullptr;
+  }
+
+  total_bytes += 2 * e.size;
+  pool.push_back(e);
+  return &pool.back();
+}
+
+/**
+ * @brief Gives entry back to the pool
+ *
+ * Releases biggest idle entries if idle entries exceed the byte limit.
+ *
+ * @param pEntry entry obtained through acquire()
+ *
+ */
+void rvs::TransferPool::release(Entry* pEntry) {
+  if (pEntry == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(pool_mutex);
+  pEntry->in_use = false;
+  trim();
+}
+
+/**
+ * @brief Releases all entries
+ *
+ * Must not be called while transfers are in progress.
+ *
+ */
+void rvs::TransferPool::clear() {
+  std::lock_guard<std::mutex> lk(pool_mutex);
+  while (!pool.empty()) {
+    destroy(pool.begin());
+  }
+}
+
+//! Returns number of cached entries
+size_t rvs::TransferPool::entries() {
+  std::lock_guard<std::mutex> lk(pool_mutex);
+  return pool.size();
+}
+
+//! Returns number of bytes held in cached entries
+size_t rvs::TransferPool::cached_bytes() {
+  std::lock_guard<std::mutex> lk(pool_mutex);
+  return total_bytes;
+}
+
+/**
+ * @brief Releases buffers and signal of an entry and removes it
+ *
+ * Called with pool_mutex held.
+ *
+ * @param it entry to remove
+ *
+ */
+void rvs::TransferPool::destroy(std::list<Entry>::iterator it) {
+  allocator->FreeBuffer(it->src_buff);
+  allocator->FreeBuffer(it->dst_buff);
+  allocator->DestroySignal(it->signal);
+  total_bytes -= 2 * it->size;
+  pool.erase(it);
+}
+
+/**
+ * @brief Releases biggest idle entries until they fit into byte limit
+ *
+ * Called with pool_mutex held.
+ *
+ */
+void rvs::TransferPool::trim() {
+  size_t idle_bytes = 0;
+  for (auto it = pool.begin(); it != pool.end(); ++it) {
+    if (!it->in_use) {
+      idle_bytes += 2 * it->size;
+    }
+  }
+
+  while (idle_bytes > max_bytes) {
+    auto victim = pool.end();
+    for (auto it = pool.begin(); it != pool.end(); ++it) {
+      if (!it->in_use && (victim == pool.end() || it->size > victim->size)) {
+        victim = it;
+      }
+    }
+    idle_bytes -= 2 * victim->size;
+    destroy(victim);
+  }
+}
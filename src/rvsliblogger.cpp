@@ -26,7 +26,9 @@
 
 #include <unistd.h>
 #include <time.h>
+#include <zlib.h>
 #include <stdio.h>
+#include <cstdlib>
 #include <cstring>
 
 #include <iostream>
@@ -35,8 +37,13 @@
 #include <fstream>
 #include <string>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
 
 #include "include/rvstrace.h"
+#include "include/rvslogarena.h"
+#include "include/rvslogring.h"
 #include "include/rvslognode.h"
 #include "include/rvslognodestring.h"
 #include "include/rvslognodeint.h"
@@ -55,6 +62,39 @@ bool  rvs::logger::bStop(false);
 uint16_t rvs::logger::stop_flags(0u);
 bool rvs::logger::b_quiet(false);
 char rvs::logger::log_file[1024];
+std::ofstream rvs::logger::log_stream;
+std::deque<std::string> rvs::logger::log_queue;
+std::mutex  rvs::logger::queue_mutex;
+std::condition_variable rvs::logger::queue_cv;
+std::condition_variable rvs::logger::drained_cv;
+std::thread rvs::logger::writer_thread;
+bool  rvs::logger::writer_running(false);
+bool  rvs::logger::writer_stop(false);
+bool  rvs::logger::writer_busy(false);
+std::mutex  rvs::logger::writer_mutex;
+std::string rvs::logger::json_buf;
+bool  rvs::logger::buffered_m(false);
+bool  rvs::logger::ndjson_m(false);
+bool  rvs::logger::binary_m(false);
+rvs::LogBinaryWriter rvs::logger::bin_writer;
+std::thread rvs::logger::merge_thread;
+std::atomic<bool> rvs::logger::merge_running(false);
+std::atomic<int> rvs::logger::merge_producers(0);
+bool  rvs::logger::merge_stop(false);
+std::mutex  rvs::logger::merge_mutex;
+std::condition_variable rvs::logger::merge_cv;
+uint64_t rvs::logger::rotate_size_m(0);
+uint32_t rvs::logger::rotate_time_m(0);
+bool  rvs::logger::rotate_compress_m(true);
+uint64_t rvs::logger::segment_bytes(0);
+uint64_t rvs::logger::segment_rows(0);
+std::chrono::steady_clock::time_point rvs::logger::segment_start;
+int   rvs::logger::segment_index(0);
+std::thread rvs::logger::compress_thread;
+std::deque<std::string> rvs::logger::compress_queue;
+std::mutex  rvs::logger::compress_mutex;
+std::condition_variable rvs::logger::compress_cv;
+bool  rvs::logger::compress_stop(false);
 
 const char*  rvs::logger::loglevelname[] = {
   "NONE  ", "RESULT", "ERROR ", "INFO  ", "DEBUG ", "TRACE " };
@@ -79,6 +119,113 @@ bool rvs::logger::append() {
   return append_m;
 }
 
+/**
+ * @brief Set 'buffered' flag
+ *
+ * When set, messages logged through LogExt() are stored into per-thread
+ * ring buffers and output by a merge thread in timestamp order.
+ *
+ * @param flag new value
+ *
+ */
+void rvs::logger::buffered(const bool flag) {
+  buffered_m = flag;
+}
+
+/**
+ * @brief Get 'buffered' flag
+ *
+ * @return Current flag value
+ *
+ */
+bool rvs::logger::buffered() {
+  return buffered_m;
+}
+
+/**
+ * @brief Set 'ndjson' flag
+ *
+ * When set (along with 'json'), each JSON record is written to the log file
+ * as a single line instead of being an element of one JSON array. Such file
+ * can be appended to and read while RVS is still running.
+ *
+ * @param flag new value
+ *
+ */
+void rvs::logger::ndjson(const bool flag) {
+  ndjson_m = flag;
+}
+
+/**
+ * @brief Get 'ndjson' flag
+ *
+ * @return Current flag value
+ *
+ */
+bool rvs::logger::ndjson() {
+  return ndjson_m;
+}
+
+/**
+ * @brief Set 'binary' flag
+ *
+ * When set, the log file is written in compact binary form (see
+ * LogBinaryWriter). It holds text rows, or JSON records if JSON output is
+ * selected. Use rvslogconv (with "-j" for JSON) to get the log out of it.
+ *
+ * @param flag new value
+ *
+ */
+void rvs::logger::binary(const bool flag) {
+  binary_m = flag;
+}
+
+/**
+ * @brief Get 'binary' flag
+ *
+ * @return Current flag value
+ *
+ */
+bool rvs::logger::binary() {
+  return binary_m;
+}
+
+/**
+ * @brief Set log file size triggering rotation
+ *
+ * When current log file reaches the given size, it is closed as a
+ * complete segment, renamed to <log>.N and a new log file is started.
+ *
+ * @param bytes segment size in bytes (0 - no size limit)
+ *
+ */
+void rvs::logger::rotate_size(const uint64_t bytes) {
+  rotate_size_m = bytes;
+}
+
+/**
+ * @brief Set log file age triggering rotation
+ *
+ * @param secs segment age in seconds (0 - no time limit)
+ *
+ */
+void rvs::logger::rotate_time(const uint32_t secs) {
+  rotate_time_m = secs;
+}
+
+/**
+ * @brief Set 'compress' flag for rotated log segments
+ *
+ * When set (default), rotated segments are gzip compressed into
+ * <log>.N.gz by a background thread.
+ *
+ * @param flag new value
+ *
+ */
+void rvs::logger::rotate_compress(const bool flag) {
+  rotate_compress_m = flag;
+}
+
 void rvs::logger::set_log_file(const std::string& fname) {
     strncpy(log_file, fname.c_str(), sizeof(log_file));
 }
@@ -93,6 +240,16 @@ void rvs::logger::log_level(const int rLevel) {
   loglevel_m = rLevel;
 }
 
+/**
+ * @brief Get logging level
+ *
+ * @return Current logging level
+ *
+ */
+int rvs::logger::log_level() {
+  return loglevel_m;
+}
+
 /**
  * @brief Fetches times since system start
  *
@@ -204,16 +361,73 @@ int rvs::logger::LogExt(const char* Message, const int LogLevel,
     get_ticks(&secs, &usecs);
   }
 
+  // buffered mode: hand message over to merge thread without locking
+  // (registered as producer first, so that StopMerge() waits for the push
+  // before its final drain)
+  merge_producers.fetch_add(1);
+  if (merge_running.load()) {
+    DTRACE_
+    LogRing* ring = LogRingSet::local();
+    bool pushed;
+    while (!(pushed = ring->push(secs, usecs, LogLevel, Message))) {
+      // ring full, wake up merge thread and retry
+      if (!merge_running.load()) {
+        break;
+      }
+      merge_cv.notify_one();
+      std::this_thread::yield();
+    }
+    merge_producers.fetch_sub(1);
+    if (pushed) {
+      return 0;
+    }
+    return OutputRow(Message, LogLevel, secs, usecs);
+  }
+  merge_producers.fetch_sub(1);
+
   DTRACE_
+  return OutputRow(Message, LogLevel, secs, usecs);
+}
+
+/**
+ * @brief Formats log message as text log row
+ *
+ * @param pRow [out] row, message is appended to it
+ * @param Message Message to log
+ * @param LogLevel Logging level
+ * @param secs secconds from system start
+ * @param usecs microseconds in current second
+ *
+ */
+void rvs::logger::FormatRow(std::string* pRow, const char* Message,
+                            const int LogLevel, const uint32_t secs,
+                            const uint32_t usecs) {
   char  buff[64];
   snprintf(buff, sizeof(buff), "%6d.%-6d", secs, usecs);
 
-  std::string row("[");
-  row += loglevelname[LogLevel];
-  row +="] [";
-  row += buff;
-  row +="] ";
-  row += Message;
+  pRow->append("[");
+  pRow->append(loglevelname[LogLevel]);
+  pRow->append("] [");
+  pRow->append(buff);
+  pRow->append("] ");
+  pRow->append(Message);
+}
+
+/**
+ * @brief Formats log message and outputs it to cout and log file
+ *
+ * @param Message Message to log
+ * @param LogLevel Logging level
+ * @param secs secconds from system start
+ * @param usecs microseconds in current second
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::logger::OutputRow(const char* Message, const int LogLevel,
+                           const uint32_t secs, const uint32_t usecs) {
+  DTRACE_
+  std::string row;
+  FormatRow(&row, Message, LogLevel, secs, usecs);
 
   // if no quiet option given, output to cout
   if (!b_quiet) {
@@ -229,20 +443,33 @@ int rvs::logger::LogExt(const char* Message, const int LogLevel,
     return 0;
   }
 
-  DTRACE_
-  // send to file if requested
-  if (isfirstrecord_m) {
-    DTRACE_
-    isfirstrecord_m = false;
-  } else {
+  if (binary()) {
     DTRACE_
-    row = RVSENDL + row;
+    // lock log_mutex for the duration of this block
+    std::lock_guard<std::mutex> lk(log_mutex);
+    CheckRotate();
+    bin_writer.clear();
+    bin_writer.text(LogLevel, secs, usecs, Message);
+    ToFile(bin_writer.data());
+    return 0;
   }
-  DTRACE_
 
+  DTRACE_
   if (true) {
     // lock log_mutex for the duration of this block
     std::lock_guard<std::mutex> lk(log_mutex);
+    CheckRotate();
+
+    // send to file if requested
+    if (isfirstrecord_m) {
+      DTRACE_
+      isfirstrecord_m = false;
+    } else {
+      DTRACE_
+      row = RVSENDL + row;
+    }
+    DTRACE_
+
     ToFile(row);
   }
 
@@ -276,7 +503,10 @@ void* rvs::logger::LogRecordCreate(const char* Module, const char* Action,
     get_ticks(&sec, &usec);
   }
 
-  rvs::LogNodeRec* rec = new LogNodeRec(Action, LogLevel, sec, usec);
+  // record tree is built in an arena released by LogRecordFlush()
+  LogArena* arena = LogArena::acquire();
+  rvs::LogNodeRec* rec = new (arena) LogNodeRec(Action, LogLevel, sec, usec,
+                                                nullptr, arena);
   AddString(rec, "action", Action);
   AddString(rec, "module", Module);
   AddString(rec, "loglevelname", (LogLevel >= lognone && LogLevel < logtrace) ?
@@ -304,7 +534,7 @@ int   rvs::logger::LogRecordFlush(void* pLogRecord) {
   // no JSON loggin requested
   if (!to_json()) {
     DTRACE_
-    delete r;
+    LogNodeBase::Destroy(r);
     return 0;
   }
 
@@ -314,38 +544,57 @@ int   rvs::logger::LogRecordFlush(void* pLogRecord) {
     char buff[128];
     snprintf(buff, sizeof(buff), "unknown logging level: %d", r->LogLevel());
     Err(buff, "CLI");
-    delete r;
+    LogNodeBase::Destroy(r);
     return -1;
   }
 
   // if too high, ignore record
   if (level > loglevel_m) {
     DTRACE_
-    delete r;
+    LogNodeBase::Destroy(r);
     return 0;
   }
 
-  // do not pre-pend "," separator for the first row
-  std::string row;
-  if (append_m) {
+  // start new log file segment if current one is full
+  CheckRotate();
+
+  if (binary()) {
     DTRACE_
-    row = ",";
-  } else {
+    bin_writer.clear();
+    r->WriteBinary(&bin_writer);
+    ToFile(bin_writer.data());
+    LogNodeBase::Destroy(r);
+    return 0;
+  }
+
+  // (json_buf is reused between records, protected by log_mutex)
+  json_buf.clear();
+
+  if (ndjson()) {
     DTRACE_
-    if (!isfirstrecord_m) {
-      DTRACE_
-      row = ",";
-    }
+    // one record per line, no separators to keep track of
+    r->WriteJson(&json_buf, "", RVSJSONLINE);
+    json_buf += RVSENDL;
+    ToFile(json_buf);
+    LogNodeBase::Destroy(r);
+    return 0;
+  }
+
+  // do not pre-pend "," separator for the first row
+  // (when appending, init_log_file() clears isfirstrecord_m)
+  if (!isfirstrecord_m) {
+    DTRACE_
+    json_buf = ",";
   }
   DTRACE_
   // get JSON formatted log record
-  row += r->ToJson("  ");
+  r->WriteJson(&json_buf, "  ", 0);
 
   // send it to file
-  ToFile(row);
+  ToFile(json_buf);
 
   // dealloc memory
-  delete r;
+  LogNodeBase::Destroy(r);
 
   if (isfirstrecord_m) {
     DTRACE_
@@ -359,7 +608,9 @@ int   rvs::logger::LogRecordFlush(void* pLogRecord) {
 /**
  * @brief Output log record to file
  *
- * Sends out string representing record to a log file
+ * Queues string representing record for the background writer thread.
+ * If the writer is not running (log file not initialized or already
+ * terminated), the row is written to the log file directly.
  *
  * @param Row string representing log record
  * @return 0 - success, non-zero otherwise
@@ -371,6 +622,30 @@ int rvs::logger::ToFile(const std::string& Row) {
       return 0;
   }
 
+  {
+    // lock queue_mutex for the duration of this block
+    std::lock_guard<std::mutex> lk(queue_mutex);
+    if (writer_running) {
+      log_queue.push_back(Row);
+      queue_cv.notify_one();
+      segment_bytes += Row.size();
+      return 0;
+    }
+  }
+
+  return ToFileDirect(Row);
+}
+
+/**
+ * @brief Output log record to file bypassing the writer thread
+ *
+ * Opens log file in append mode, writes the row and closes the file.
+ *
+ * @param Row string representing log record
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::logger::ToFileDirect(const std::string& Row) {
   std::string logfile(log_file);
   if (logfile == "")
     return -1;
@@ -385,6 +660,404 @@ int rvs::logger::ToFile(const std::string& Row) {
   return 0;
 }
 
+/**
+ * @brief Opens log file and starts background writer thread
+ *
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::logger::StartWriter() {
+  static bool b_atexit = false;
+  // lock writer_mutex for the duration of this block
+  std::lock_guard<std::mutex> lk(writer_mutex);
+
+  if (writer_thread.joinable()) {
+    return 0;
+  }
+
+  std::string logfile(log_file);
+  log_stream.open(logfile, std::fstream::out | std::fstream::app);
+  if (log_stream.fail()) {
+    log_stream.close();
+    return -1;
+  }
+
+  // make sure pending rows are written out even if terminate() is not called
+  if (!b_atexit) {
+    b_atexit = true;
+    std::atexit(&rvs::logger::StopWriter);
+  }
+
+  {
+    std::lock_guard<std::mutex> lq(queue_mutex);
+    writer_stop = false;
+    writer_running = true;
+  }
+  writer_thread = std::thread(&rvs::logger::WriterThread);
+
+  return 0;
+}
+
+/**
+ * @brief Drains pending rows, stops writer thread and closes log file
+ *
+ */
+void rvs::logger::StopWriter() {
+  // lock writer_mutex for the duration of this block
+  std::lock_guard<std::mutex> lk(writer_mutex);
+
+  if (!writer_thread.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lq(queue_mutex);
+    writer_stop = true;
+  }
+  queue_cv.notify_one();
+
+  writer_thread.join();
+  log_stream.close();
+
+  // compress segments rotated so far
+  StopCompressor();
+}
+
+/**
+ * @brief Background writer thread function
+ *
+ * Takes all rows queued so far in one batch, writes them to the
+ * persistent log stream and flushes it. Exits when stop is requested and
+ * the queue is empty.
+ *
+ */
+void rvs::logger::WriterThread() {
+  std::deque<std::string> batch;
+  std::unique_lock<std::mutex> lk(queue_mutex);
+
+  while (true) {
+    queue_cv.wait(lk, []{ return !log_queue.empty() || writer_stop; });
+
+    if (log_queue.empty()) {
+      // stop requested and nothing left to write
+      writer_running = false;
+      drained_cv.notify_all();
+      break;
+    }
+
+    batch.swap(log_queue);
+    writer_busy = true;
+    lk.unlock();
+
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+      log_stream << *it;
+    }
+    log_stream.flush();
+    batch.clear();
+
+    lk.lock();
+    writer_busy = false;
+    if (log_queue.empty()) {
+      drained_cv.notify_all();
+    }
+  }
+}
+
+/**
+ * @brief Waits until all rows queued so far are written to the log file
+ *
+ */
+void rvs::logger::flush() {
+  std::unique_lock<std::mutex> lk(queue_mutex);
+  drained_cv.wait(lk, []{
+    return !writer_running || (log_queue.empty() && !writer_busy);
+  });
+}
+
+/**
+ * @brief Rotates log file if current segment reached its size or age limit
+ *
+ * Called with log_mutex held, just before a row or a record is written.
+ * Segment is rotated only if at least one row has been written into it.
+ * Log file is never rotated if the writer thread is not running.
+ *
+ */
+void rvs::logger::CheckRotate() {
+  if (rotate_size_m == 0 && rotate_time_m == 0) {
+    return;
+  }
+
+  uint64_t bytes;
+  {
+    std::lock_guard<std::mutex> lq(queue_mutex);
+    if (!writer_running) {
+      return;
+    }
+    bytes = segment_bytes;
+  }
+
+  if (segment_rows > 0) {
+    bool bexpired = rotate_size_m > 0 && bytes >= rotate_size_m;
+    if (!bexpired && rotate_time_m > 0) {
+      bexpired = std::chrono::steady_clock::now() - segment_start >=
+                 std::chrono::seconds(rotate_time_m);
+    }
+    if (bexpired) {
+      Rotate();
+    }
+  }
+
+  segment_rows++;
+}
+
+/**
+ * @brief Closes current log file segment and starts new one
+ *
+ * Called with log_mutex held so no other row can be queued meanwhile.
+ * Current segment is terminated the same way terminate() would do it,
+ * pending rows are drained, then the file is renamed to <log>.N and
+ * reopened. Renamed segment is handed over to the compression thread.
+ *
+ */
+void rvs::logger::Rotate() {
+  // terminate current segment
+  if (!(to_json() && ndjson()) && !binary()) {
+    std::string row(RVSENDL);
+    if (to_json()) {
+      row += "]";
+    }
+    ToFile(row);
+  }
+
+  // wait until the writer has written out the whole segment
+  flush();
+
+  std::string logfile(log_file);
+  std::string segment;
+  do {
+    segment = logfile + "." + std::to_string(++segment_index);
+  } while (access(segment.c_str(), F_OK) == 0 ||
+           access((segment + ".gz").c_str(), F_OK) == 0);
+
+  {
+    std::lock_guard<std::mutex> lq(queue_mutex);
+    log_stream.close();
+    if (rename(logfile.c_str(), segment.c_str())) {
+      segment.clear();
+    }
+    log_stream.open(logfile, std::fstream::out | std::fstream::app);
+    segment_bytes = 0;
+  }
+
+  if (segment.empty()) {
+    Err("could not rotate log file", "CLI");
+  } else if (rotate_compress_m) {
+    StartCompressor();
+    std::lock_guard<std::mutex> lc(compress_mutex);
+    compress_queue.push_back(segment);
+    compress_cv.notify_one();
+  }
+
+  segment_rows = 0;
+  segment_start = std::chrono::steady_clock::now();
+  isfirstrecord_m = true;
+
+  // start new segment, binary one gets its own header and string table
+  if (binary()) {
+    bin_writer.clear();
+    bin_writer.header();
+    ToFile(bin_writer.data());
+  } else if (to_json() && !ndjson()) {
+    ToFile("[");
+  }
+}
+
+/**
+ * @brief Compresses log file segment into <segment>.gz
+ *
+ * Uncompressed segment is removed on success.
+ *
+ * @param File log file segment
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::logger::Compress(const std::string& File) {
+  std::string gzfile = File + ".gz";
+
+  FILE* in = fopen(File.c_str(), "rb");
+  if (in == nullptr) {
+    return -1;
+  }
+
+  gzFile out = gzopen(gzfile.c_str(), "wb");
+  if (out == nullptr) {
+    fclose(in);
+    return -1;
+  }
+
+  char buff[65536];
+  bool berror = false;
+  size_t len;
+  while ((len = fread(buff, 1, sizeof(buff), in)) > 0) {
+    if (gzwrite(out, buff, static_cast<unsigned>(len)) !=
+        static_cast<int>(len)) {
+      berror = true;
+      break;
+    }
+  }
+  berror = berror || ferror(in);
+  fclose(in);
+  berror = gzclose(out) != Z_OK || berror;
+
+  if (berror) {
+    unlink(gzfile.c_str());
+    return -1;
+  }
+
+  unlink(File.c_str());
+  return 0;
+}
+
+/**
+ * @brief Starts compression thread if not already running
+ *
+ */
+void rvs::logger::StartCompressor() {
+  std::lock_guard<std::mutex> lk(compress_mutex);
+
+  if (compress_thread.joinable()) {
+    return;
+  }
+
+  compress_stop = false;
+  compress_thread = std::thread(&rvs::logger::CompressorThread);
+}
+
+/**
+ * @brief Compresses all pending segments and stops compression thread
+ *
+ */
+void rvs::logger::StopCompressor() {
+  {
+    std::lock_guard<std::mutex> lk(compress_mutex);
+    if (!compress_thread.joinable()) {
+      return;
+    }
+    compress_stop = true;
+  }
+  compress_cv.notify_one();
+
+  compress_thread.join();
+}
+
+/**
+ * @brief Background compression thread function
+ *
+ * Compresses rotated segments one by one. Exits when stop is requested
+ * and the queue is empty.
+ *
+ */
+void rvs::logger::CompressorThread() {
+  std::unique_lock<std::mutex> lk(compress_mutex);
+
+  while (true) {
+    compress_cv.wait(lk, []{ return !compress_queue.empty() || compress_stop; });
+
+    if (compress_queue.empty()) {
+      break;
+    }
+
+    std::string segment = compress_queue.front();
+    compress_queue.pop_front();
+    lk.unlock();
+
+    if (Compress(segment)) {
+      Err((std::string("could not compress log segment ") + segment).c_str(),
+          "CLI");
+    }
+
+    lk.lock();
+  }
+}
+
+/**
+ * @brief Starts merge thread consuming per-thread log rings
+ *
+ */
+void rvs::logger::StartMerge() {
+  std::lock_guard<std::mutex> lk(merge_mutex);
+
+  if (merge_thread.joinable()) {
+    return;
+  }
+
+  merge_stop = false;
+  merge_running.store(true, std::memory_order_release);
+  merge_thread = std::thread(&rvs::logger::MergeThread);
+}
+
+/**
+ * @brief Outputs all buffered messages and stops merge thread
+ *
+ */
+void rvs::logger::StopMerge() {
+  {
+    std::lock_guard<std::mutex> lk(merge_mutex);
+    if (!merge_thread.joinable()) {
+      return;
+    }
+    // new messages go directly to output from now on (sequentially
+    // consistent with merge_producers, see LogExt())
+    merge_running.store(false);
+    merge_stop = true;
+  }
+  merge_cv.notify_one();
+  merge_thread.join();
+
+  // producers which still saw merge thread running must finish their push
+  while (merge_producers.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  // pick up messages pushed while merge thread was exiting
+  std::vector<LogRingRecord> recs;
+  LogRingSet::drain(&recs);
+  for (auto it = recs.begin(); it != recs.end(); ++it) {
+    OutputRow(it->msg.c_str(), it->level, it->sec, it->usec);
+  }
+}
+
+/**
+ * @brief Merge thread function
+ *
+ * Periodically drains all per-thread rings and outputs messages in
+ * timestamp order. Exits after final drain once stop is requested.
+ *
+ */
+void rvs::logger::MergeThread() {
+  std::vector<LogRingRecord> recs;
+  std::unique_lock<std::mutex> lk(merge_mutex);
+
+  while (true) {
+    if (!merge_stop) {
+      merge_cv.wait_for(lk, std::chrono::milliseconds(5));
+    }
+    bool bstop = merge_stop;
+    lk.unlock();
+
+    recs.clear();
+    LogRingSet::drain(&recs);
+    for (auto it = recs.begin(); it != recs.end(); ++it) {
+      OutputRow(it->msg.c_str(), it->level, it->sec, it->usec);
+    }
+
+    lk.lock();
+    if (bstop) {
+      break;
+    }
+  }
+}
+
 /**
  * @brief Patch JSON log file
  *
@@ -422,7 +1095,8 @@ int rvs::logger::JsonPatchAppend(int* pSts) {
  *
  */
 void* rvs::logger::CreateNode(void* Parent, const char* Name) {
-  rvs::LogNode* p = new LogNode(Name, static_cast<rvs::LogNodeBase*>(Parent));
+  rvs::LogNodeBase* pp = static_cast<rvs::LogNodeBase*>(Parent);
+  rvs::LogNode* p = new (pp ? pp->Arena() : nullptr) LogNode(Name, pp);
   return p;
 }
 
@@ -438,7 +1112,7 @@ void* rvs::logger::CreateNode(void* Parent, const char* Name) {
  */
 void  rvs::logger::AddString(void* Parent, const char* Key, const char* Val) {
   rvs::LogNode* pp = static_cast<rvs::LogNode*>(Parent);
-  rvs::LogNodeString* p = new LogNodeString(Key, Val, pp);
+  rvs::LogNodeString* p = new (pp->Arena()) LogNodeString(Key, Val, pp);
   pp->Add(p);
 }
 
@@ -454,7 +1128,7 @@ void  rvs::logger::AddString(void* Parent, const char* Key, const char* Val) {
  */
 void  rvs::logger::AddInt(void* Parent, const char* Key, const int Val) {
   rvs::LogNode* pp = static_cast<rvs::LogNode*>(Parent);
-  rvs::LogNodeInt* p = new LogNodeInt(Key, Val, pp);
+  rvs::LogNodeInt* p = new (pp->Arena()) LogNodeInt(Key, Val, pp);
   pp->Add(p);
 }
 
@@ -483,9 +1157,20 @@ void  rvs::logger::AddNode(void* Parent, void* Child) {
  *
  */
 int rvs::logger::init_log_file() {
+  // make sure log file from previous initialization is closed
+  StopWriter();
+
   isfirstrecord_m = true;
   bStop = false;
   stop_flags = 0;
+  segment_bytes = 0;
+  segment_rows = 0;
+  segment_start = std::chrono::steady_clock::now();
+  segment_index = 0;
+
+  if (buffered()) {
+    StartMerge();
+  }
 
   std::string row;
   std::string logfile(log_file);
@@ -499,11 +1184,14 @@ int rvs::logger::init_log_file() {
     // have well formed JSON after appending
     int patch_status = -1;
 
-    if (to_json()) {
+    // (NDJSON records and binary sessions are simply appended)
+    if (to_json() && !ndjson() && !binary()) {
       int sts = JsonPatchAppend(&patch_status);
       if (sts) {
         return -1;
       }
+      // records follow the ones already in the file
+      isfirstrecord_m = false;
     }
   }  else {
     // logging but not appending - just truncate the file.
@@ -514,11 +1202,23 @@ int rvs::logger::init_log_file() {
     if (berror) {
       return -1;
     }
-    if (to_json()) {
+    if (to_json() && !ndjson() && !binary()) {
       row = "[";
     }
   }
 
+  // every binary session starts with header and empty string table
+  if (binary()) {
+    std::lock_guard<std::mutex> lk(log_mutex);
+    bin_writer.clear();
+    bin_writer.header();
+    row = bin_writer.data();
+  }
+
+  if (StartWriter()) {
+    return -1;
+  }
+
   // print to log file if requested
   ToFile(row);
 
@@ -528,23 +1228,34 @@ int rvs::logger::init_log_file() {
 /**
  * @brief Performs proper termination of log file contents
  *
+ * Writes out all pending rows, stops writer thread and closes log file.
+ *
  * @return 0 - success, non-zero otherwise
  *
  */
 int rvs::logger::terminate() {
+  // output messages still held in per-thread rings
+  StopMerge();
+
   // if no logg to file requested, just return
   std::string logfile(log_file);
   if (logfile == "")
     return 0;
 
-  std::string row(RVSENDL);
+  // NDJSON and binary files are complete after each record
+  if (!(to_json() && ndjson()) && !binary()) {
+    std::string row(RVSENDL);
 
-  if (to_json()) {
-    row += "]";
+    if (to_json()) {
+      row += "]";
+    }
+
+    // print to log file if requested
+    ToFile(row);
   }
 
-  // print to log file if requested
-  ToFile(row);
+  // flush pending rows and close log file
+  StopWriter();
 
   return 0;
 }
@@ -558,6 +1269,9 @@ int rvs::logger::terminate() {
  *
  */
 void rvs::logger::Stop(uint16_t flags) {
+  // output buffered messages first as merge thread needs cout_mutex
+  StopMerge();
+
   // lock cout_mutex for the duration of this block
   std::lock_guard<std::mutex> lk(cout_mutex);
 
@@ -0,0 +1,153 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvslinkmap.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Lists names of links used by a transfer
+ *
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Path hop by hop link information from Src to Dst
+ * @param pNames [out] link names, no duplicates
+ *
+ * */
+void rvs::LinkMap::path_links(uint32_t SrcNode, uint32_t DstNode,
+                              const std::vector<linkinfo_t>& Path,
+                              std::vector<std::string>* pNames) {
+  std::string src = std::to_string(SrcNode);
+  std::string dst = std::to_string(DstNode);
+
+  pNames->clear();
+  for (auto it = Path.begin(); it != Path.end(); ++it) {
+    if (it->etype == RVS_LINK_TYPE_XGMI) {
+      pNames->push_back(it->strtype + " " + src + "->" + dst);
+    } else if (it->etype == RVS_LINK_TYPE_PCIE) {
+      pNames->push_back(it->strtype + " " + src + " up");
+      pNames->push_back(it->strtype + " " + dst + " down");
+    } else {
+      pNames->push_back(it->strtype);
+    }
+  }
+
+  std::sort(pNames->begin(), pNames->end());
+  pNames->erase(std::unique(pNames->begin(), pNames->end()), pNames->end());
+}
+
+/**
+ * @brief Adds transfer
+ *
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Path hop by hop link information from Src to Dst
+ * @return transfer index
+ *
+ * */
+size_t rvs::LinkMap::add(uint32_t SrcNode, uint32_t DstNode,
+                         const std::vector<linkinfo_t>& Path) {
+  size_t ix = transfer_links.size();
+  transfer_links.push_back(std::vector<size_t>());
+  transfer_src.push_back(SrcNode);
+  transfer_dst.push_back(DstNode);
+  add_path(ix, SrcNode, DstNode, Path);
+  return ix;
+}
+
+/**
+ * @brief Adds links of another path to an existing transfer
+ *
+ * Used for bidirectional transfers, which load paths in both directions.
+ *
+ * @param Transfer transfer index
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Path hop by hop link information from Src to Dst
+ *
+ * */
+void rvs::LinkMap::add_path(size_t Transfer, uint32_t SrcNode,
+                            uint32_t DstNode,
+                            const std::vector<linkinfo_t>& Path) {
+  std::vector<std::string> names;
+  path_links(SrcNode, DstNode, Path, &names);
+
+  std::vector<size_t>& used = transfer_links[Transfer];
+  for (auto it = names.begin(); it != names.end(); ++it) {
+    auto found = link_index.find(*it);
+    size_t link;
+    if (found == link_index.end()) {
+      link = link_names.size();
+      link_index[*it] = link;
+      link_names.push_back(*it);
+      link_users.push_back(std::vector<size_t>());
+    } else {
+      link = found->second;
+    }
+    if (std::find(used.begin(), used.end(), link) != used.end()) {
+      continue;
+    }
+    used.push_back(link);
+    link_users[link].push_back(Transfer);
+  }
+  std::sort(used.begin(), used.end());
+}
+
+//! Removes all transfers and links
+void rvs::LinkMap::clear() {
+  link_index.clear();
+  link_names.clear();
+  transfer_links.clear();
+  transfer_src.clear();
+  transfer_dst.clear();
+  link_users.clear();
+}
+
+/**
+ * @brief Checks if two transfers share no link
+ *
+ * @param TransferA index of the first transfer
+ * @param TransferB index of the second transfer
+ * @return 'true' if transfers have no link in common
+ *
+ * */
+bool rvs::LinkMap::disjoint(size_t TransferA, size_t TransferB) const {
+  const std::vector<size_t>& a = transfer_links[TransferA];
+  const std::vector<size_t>& b = transfer_links[TransferB];
+  size_t i = 0;
+  size_t j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (a[i] == b[j]) {
+      return false;
+    }
+    if (a[i] < b[j]) {
+      i++;
+    } else {
+      j++;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,179 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvslinksched.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Returns smallest possible number of rounds
+ *
+ * @param Map transfers and their links
+ * @return largest number of transfers using one link, at least 1 if
+ * there are any transfers
+ *
+ * */
+size_t rvs::LinkScheduler::lower_bound(const LinkMap& Map) {
+  size_t bound = Map.size() > 0 ? 1 : 0;
+  for (size_t l = 0; l < Map.link_count(); l++) {
+    bound = std::max(bound, Map.users(l).size());
+  }
+  return bound;
+}
+
+/**
+ * @brief Places transfers into the first round where their links are free
+ *
+ * @param Map transfers and their links
+ * @param Order transfers in order of placement
+ * @param pRounds [out] transfer indexes of every round
+ * @return number of rounds
+ *
+ * */
+size_t rvs::LinkScheduler::first_fit(const LinkMap& Map,
+                                     const std::vector<size_t>& Order,
+                                     std::vector<std::vector<size_t>>* pRounds) {
+  // per round: links in use
+  std::vector<std::vector<bool>> busy;
+  pRounds->clear();
+  for (auto t : Order) {
+    const std::vector<size_t>& links = Map.links(t);
+    size_t r = 0;
+    if (links.empty()) {
+      // unknown path, might contend with anything
+      r = busy.size();
+    } else {
+      for (; r < busy.size(); r++) {
+        // round without link table holds a transfer with unknown path
+        bool free = !busy[r].empty();
+        for (auto l : links) {
+          if (!free || busy[r][l]) {
+            free = false;
+            break;
+          }
+        }
+        if (free) {
+          break;
+        }
+      }
+    }
+
+    if (r == busy.size()) {
+      // no link table for unknown path, so nothing else joins its round
+      busy.push_back(std::vector<bool>(links.empty() ? 0 : Map.link_count(),
+                                       false));
+      pRounds->push_back(std::vector<size_t>());
+    }
+    for (auto l : links) {
+      busy[r][l] = true;
+    }
+    (*pRounds)[r].push_back(t);
+  }
+
+  return pRounds->size();
+}
+
+/**
+ * @brief Groups transfers into rounds of link-disjoint transfers
+ *
+ * Greedy placement depends on order of transfers, so several orders are
+ * tried and the schedule with fewest rounds is kept:
+ * - transfers on most loaded links first,
+ * - transfers by distance of destination from source in node order, which
+ *   splits all-pairs transfers into perfect matchings (round robin),
+ * - RVS_LINKSCHED_SHUFFLES fixed pseudo-random orders.
+ *
+ * @param Map transfers and their links
+ * @param pRounds [out] transfer indexes of every round, in increasing
+ * order within a round
+ * @return number of rounds
+ *
+ * */
+size_t rvs::LinkScheduler::schedule(const LinkMap& Map,
+                                    std::vector<std::vector<size_t>>* pRounds) {
+  size_t n = Map.size();
+  size_t bound = lower_bound(Map);
+
+  // load of the most used link of every transfer
+  std::vector<size_t> load(n, 0);
+  std::vector<size_t> order;
+  for (size_t t = 0; t < n; t++) {
+    for (auto l : Map.links(t)) {
+      load[t] = std::max(load[t], Map.users(l).size());
+    }
+    order.push_back(t);
+  }
+
+  // most constrained transfers first, then those using more links
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (load[a] != load[b]) {
+      return load[a] > load[b];
+    }
+    return Map.links(a).size() > Map.links(b).size();
+  });
+  first_fit(Map, order, pRounds);
+
+  // position of every node in increasing node order
+  std::vector<uint32_t> nodes;
+  for (size_t t = 0; t < n; t++) {
+    nodes.push_back(Map.src(t));
+    nodes.push_back(Map.dst(t));
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  auto pos = [&](uint32_t Node) {
+    return std::lower_bound(nodes.begin(), nodes.end(), Node) - nodes.begin();
+  };
+
+  std::vector<std::vector<size_t>> rounds;
+  if (pRounds->size() > bound) {
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      size_t shift_a = (pos(Map.dst(a)) + nodes.size() - pos(Map.src(a)))
+                     % nodes.size();
+      size_t shift_b = (pos(Map.dst(b)) + nodes.size() - pos(Map.src(b)))
+                     % nodes.size();
+      return shift_a < shift_b;
+    });
+    if (first_fit(Map, order, &rounds) < pRounds->size()) {
+      pRounds->swap(rounds);
+    }
+  }
+
+  std::mt19937 gen(1);
+  for (int i = 0; i < RVS_LINKSCHED_SHUFFLES && pRounds->size() > bound;
+       i++) {
+    std::shuffle(order.begin(), order.end(), gen);
+    if (first_fit(Map, order, &rounds) < pRounds->size()) {
+      pRounds->swap(rounds);
+    }
+  }
+
+  for (auto& round : *pRounds) {
+    std::sort(round.begin(), round.end());
+  }
+
+  return pRounds->size();
+}
@@ -0,0 +1,210 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvslogarena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//! max number of free arenas cached per thread
+#define RVS_LOGARENA_CACHE 4
+
+std::atomic<uint64_t> rvs::LogArena::num_block_alloc(0);
+
+/**
+ * @brief Constructor
+ *
+ * @param BlockSize default size of arena block
+ *
+ */
+rvs::LogArena::LogArena(size_t BlockSize)
+:
+block_size(BlockSize),
+first(nullptr),
+current(nullptr),
+ptr(nullptr),
+end(nullptr) {
+}
+
+//! Destructor, releases all blocks
+rvs::LogArena::~LogArena() {
+  Block* b = first;
+  while (b) {
+    Block* n = b->next;
+    free(b);
+    b = n;
+  }
+}
+
+/**
+ * @brief Allocates memory from arena
+ *
+ * @param Size number of bytes
+ * @param Align required alignment (power of 2)
+ * @return pointer to allocated memory
+ *
+ */
+void* rvs::LogArena::allocate(size_t Size, size_t Align) {
+  uintptr_t p = (reinterpret_cast<uintptr_t>(ptr) + Align - 1) & ~(Align - 1);
+  if (ptr == nullptr || p + Size > reinterpret_cast<uintptr_t>(end)) {
+    if (!next_block(Size, Align)) {
+      throw std::bad_alloc();
+    }
+    p = (reinterpret_cast<uintptr_t>(ptr) + Align - 1) & ~(Align - 1);
+  }
+  ptr = reinterpret_cast<char*>(p + Size);
+  return reinterpret_cast<void*>(p);
+}
+
+/**
+ * @brief Moves to the next block big enough for the request
+ *
+ * Reuses block retained from previous reset() if possible, otherwise
+ * allocates new block and links it after the current one.
+ *
+ * @param Size number of bytes requested
+ * @param Align required alignment
+ * @return 'true' - success, 'false' if out of memory
+ *
+ */
+bool rvs::LogArena::next_block(size_t Size, size_t Align) {
+  size_t need = Size + Align;
+  Block* b = current ? current->next : first;
+
+  if (b == nullptr || b->size < need) {
+    size_t sz = need > block_size ? need : block_size;
+    Block* nb = static_cast<Block*>(malloc(sizeof(Block) + sz));
+    if (nb == nullptr) {
+      return false;
+    }
+    num_block_alloc++;
+    nb->size = sz;
+    nb->next = b;
+    if (current) {
+      current->next = nb;
+    } else {
+      first = nb;
+    }
+    b = nb;
+  }
+
+  current = b;
+  ptr = reinterpret_cast<char*>(b + 1);
+  end = ptr + b->size;
+  return true;
+}
+
+/**
+ * @brief Copies C string into arena
+ *
+ * @param Str string to copy
+ * @return pointer to copy
+ *
+ */
+const char* rvs::LogArena::copy(const char* Str) {
+  size_t len = strlen(Str) + 1;
+  char* p = static_cast<char*>(allocate(len, 1));
+  memcpy(p, Str, len);
+  return p;
+}
+
+/**
+ * @brief Releases everything allocated so far
+ *
+ * Blocks are retained for subsequent allocations.
+ *
+ */
+void rvs::LogArena::reset() {
+  current = nullptr;
+  ptr = nullptr;
+  end = nullptr;
+}
+
+//! Returns number of blocks owned by this arena
+size_t rvs::LogArena::blocks() const {
+  size_t cnt = 0;
+  for (Block* b = first; b; b = b->next) {
+    cnt++;
+  }
+  return cnt;
+}
+
+namespace {
+
+/**
+ * @brief Per-thread cache of free arenas
+ */
+struct ArenaCache {
+  ~ArenaCache() {
+    for (auto it = arenas.begin(); it != arenas.end(); ++it) {
+      delete *it;
+    }
+  }
+  std::vector<rvs::LogArena*> arenas;
+};
+
+ArenaCache& arena_cache() {
+  static thread_local ArenaCache cache;
+  return cache;
+}
+
+}  // namespace
+
+/**
+ * @brief Gets free arena from per-thread cache or creates new one
+ *
+ * @return pointer to arena
+ *
+ */
+rvs::LogArena* rvs::LogArena::acquire() {
+  ArenaCache& c = arena_cache();
+  if (c.arenas.empty()) {
+    return new LogArena();
+  }
+  LogArena* a = c.arenas.back();
+  c.arenas.pop_back();
+  return a;
+}
+
+/**
+ * @brief Resets arena and returns it to per-thread cache
+ *
+ * @param pArena arena previously obtained through acquire()
+ *
+ */
+void rvs::LogArena::release(LogArena* pArena) {
+  pArena->reset();
+  ArenaCache& c = arena_cache();
+  if (c.arenas.size() < RVS_LOGARENA_CACHE) {
+    c.arenas.push_back(pArena);
+  } else {
+    delete pArena;
+  }
+}
+
+//! Returns total number of arena blocks allocated so far
+uint64_t rvs::LogArena::block_allocations() {
+  return num_block_alloc.load();
+}
@@ -0,0 +1,615 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvslogbinary.h"
+
+#include <string.h>
+
+#include <sstream>
+#include <string>
+
+#include "include/rvsliblogger.h"
+#include "include/rvslognode.h"
+#include "include/rvslognodeint.h"
+#include "include/rvslognoderec.h"
+#include "include/rvslognodestring.h"
+
+//! Longest string considered for the string table
+#define RVSBIN_MAX_INTERN_LEN 64
+//! Max number of strings remembered as seen once
+#define RVSBIN_MAX_SEEN 65536
+//! Max number of digits in number stored as integer
+#define RVSBIN_MAX_DIGITS 19
+//! Max number of fractional digits in number stored as integer
+#define RVSBIN_MAX_FRAC 15
+
+//! Default constructor
+rvs::LogBinaryWriter::LogBinaryWriter() : last_sec(0) {
+}
+
+/**
+ * @brief Starts new session
+ *
+ * Clears string table and time base.
+ *
+ */
+void rvs::LogBinaryWriter::reset() {
+  strings.clear();
+  seen.clear();
+  last_sec = 0;
+}
+
+/**
+ * @brief Appends varint encoded value to output buffer
+ *
+ * @param pOut Output buffer
+ * @param Val value to encode
+ *
+ */
+void rvs::LogBinaryWriter::put_varint(std::string* pOut, uint64_t Val) {
+  while (Val >= 0x80) {
+    pOut->push_back(static_cast<char>((Val & 0x7f) | 0x80));
+    Val >>= 7;
+  }
+  pOut->push_back(static_cast<char>(Val));
+}
+
+/**
+ * @brief Appends timestamp (seconds as delta to previous element)
+ *
+ * @param Sec seconds from system start
+ * @param uSec microseconds in current second
+ *
+ */
+void rvs::LogBinaryWriter::put_time(const uint32_t Sec, const uint32_t uSec) {
+  int64_t delta = static_cast<int64_t>(Sec) - last_sec;
+  put_varint(&buf, (static_cast<uint64_t>(delta) << 1) ^ (delta >> 63));
+  put_varint(&buf, uSec);
+  last_sec = Sec;
+}
+
+/**
+ * @brief Appends decimal number ([-]digits[.digits]) as integer
+ *
+ * Digit counts are kept so that leading and trailing zeros are restored.
+ *
+ * @param Str string
+ * @param Len string length
+ * @return 'false' if string is not a number which can be stored this way
+ *
+ */
+bool rvs::LogBinaryWriter::put_number(const char* Str, size_t Len) {
+  size_t i = 0;
+  bool neg = false;
+  if (Len > 0 && Str[0] == '-') {
+    neg = true;
+    i++;
+  }
+
+  uint64_t mantissa = 0;
+  uint64_t int_digits = 0;
+  uint64_t frac_digits = 0;
+  bool dot = false;
+  for (; i < Len; i++) {
+    if (Str[i] == '.' && !dot) {
+      dot = true;
+      continue;
+    }
+    if (Str[i] < '0' || Str[i] > '9') {
+      return false;
+    }
+    mantissa = mantissa * 10 + (Str[i] - '0');
+    if (dot) {
+      frac_digits++;
+    } else {
+      int_digits++;
+    }
+  }
+  if (int_digits == 0 || (dot && frac_digits == 0) ||
+      int_digits + frac_digits > RVSBIN_MAX_DIGITS ||
+      frac_digits > RVSBIN_MAX_FRAC) {
+    return false;
+  }
+
+  uint64_t desc = (int_digits << 5) | (frac_digits << 1) | (neg ? 1 : 0);
+  put_varint(&buf, (desc << 2) | BinNumber);
+  put_varint(&buf, mantissa);
+  return true;
+}
+
+/**
+ * @brief Appends string
+ *
+ * Strings already in the table are stored as reference, numbers as
+ * integers. Other strings are stored inline and added to the table the
+ * second time they are seen (always if Intern is set).
+ *
+ * @param Str string
+ * @param Len string length
+ * @param Intern 'true' to add string to the table on first use
+ *
+ */
+void rvs::LogBinaryWriter::put_string(const char* Str, size_t Len,
+                                      bool Intern) {
+  std::string key(Str, Len);
+  auto it = strings.find(key);
+  if (it != strings.end()) {
+    put_varint(&buf, (static_cast<uint64_t>(it->second) << 2) | BinRef);
+    return;
+  }
+
+  if (!Intern && put_number(Str, Len)) {
+    return;
+  }
+
+  uint64_t kind = BinInline;
+  if (Intern) {
+    kind = BinDefine;
+  } else if (Len <= RVSBIN_MAX_INTERN_LEN) {
+    if (seen.erase(key)) {
+      kind = BinDefine;
+    } else if (seen.size() < RVSBIN_MAX_SEEN) {
+      seen.insert(key);
+    }
+  }
+  if (kind == BinDefine) {
+    uint32_t id = strings.size();
+    strings.insert(std::make_pair(key, id));
+  }
+
+  put_varint(&buf, (static_cast<uint64_t>(Len) << 2) | kind);
+  buf.append(Str, Len);
+}
+
+/**
+ * @brief Writes session header
+ *
+ */
+void rvs::LogBinaryWriter::header() {
+  reset();
+  buf.append(RVSBINMAGIC, RVSBINMAGICLEN);
+}
+
+/**
+ * @brief Writes text log row
+ *
+ * Message is split into tokens at every space.
+ *
+ * @param Level Logging level
+ * @param Sec seconds from system start
+ * @param uSec microseconds in current second
+ * @param Msg Message
+ *
+ */
+void rvs::LogBinaryWriter::text(const int Level, const uint32_t Sec,
+                                const uint32_t uSec, const char* Msg) {
+  buf.push_back(BinText);
+  put_varint(&buf, Level);
+  put_time(Sec, uSec);
+
+  uint64_t tokens = 1;
+  for (const char* p = Msg; *p; p++) {
+    if (*p == ' ') {
+      tokens++;
+    }
+  }
+  put_varint(&buf, tokens);
+
+  const char* start = Msg;
+  for (const char* p = Msg; ; p++) {
+    if (*p == ' ' || *p == '\0') {
+      put_string(start, p - start, false);
+      if (*p == '\0') {
+        break;
+      }
+      start = p + 1;
+    }
+  }
+}
+
+/**
+ * @brief Starts JSON record, has to be closed with end()
+ *
+ * @param Level Logging level
+ * @param Sec seconds from system start
+ * @param uSec microseconds in current second
+ *
+ */
+void rvs::LogBinaryWriter::record(const int Level, const uint32_t Sec,
+                                  const uint32_t uSec) {
+  buf.push_back(BinRecord);
+  put_varint(&buf, Level);
+  put_time(Sec, uSec);
+}
+
+/**
+ * @brief Starts list node, has to be closed with end()
+ *
+ * @param Name Node name
+ *
+ */
+void rvs::LogBinaryWriter::node(const char* Name) {
+  buf.push_back(BinNode);
+  put_string(Name, strlen(Name), true);
+}
+
+//! Closes record or list node
+void rvs::LogBinaryWriter::end() {
+  buf.push_back(BinEnd);
+}
+
+/**
+ * @brief Writes string node
+ *
+ * @param Key Node name
+ * @param Val Node value
+ *
+ */
+void rvs::LogBinaryWriter::add_string(const char* Key, const char* Val) {
+  buf.push_back(BinString);
+  put_string(Key, strlen(Key), true);
+  put_string(Val, strlen(Val), false);
+}
+
+/**
+ * @brief Writes integer node
+ *
+ * @param Key Node name
+ * @param Val Node value
+ *
+ */
+void rvs::LogBinaryWriter::add_int(const char* Key, const int Val) {
+  int64_t v = Val;
+  buf.push_back(BinInt);
+  put_string(Key, strlen(Key), true);
+  put_varint(&buf, (static_cast<uint64_t>(v) << 1) ^ (v >> 63));
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param Data binary log content
+ *
+ */
+rvs::LogBinaryReader::LogBinaryReader(const std::string& Data)
+: in(Data), pos(0), bad(false), last_sec(0) {
+}
+
+/**
+ * @brief Converts binary log into text log
+ *
+ * @param In binary log
+ * @param Out text log
+ * @param pCount [out] number of converted rows
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::LogBinaryReader::ToText(std::istream& In, std::ostream& Out,
+                                 int* pCount) {
+  std::stringstream ss;
+  ss << In.rdbuf();
+  std::string data = ss.str();
+  LogBinaryReader reader(data);
+  return reader.convert(false, Out, pCount);
+}
+
+/**
+ * @brief Converts binary log into JSON log
+ *
+ * @param In binary log
+ * @param Out JSON log
+ * @param pCount [out] number of converted records
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::LogBinaryReader::ToJson(std::istream& In, std::ostream& Out,
+                                 int* pCount) {
+  std::stringstream ss;
+  ss << In.rdbuf();
+  std::string data = ss.str();
+  LogBinaryReader reader(data);
+  return reader.convert(true, Out, pCount);
+}
+
+/**
+ * @brief Reads varint
+ *
+ * @param pVal [out] value
+ * @return 'false' if input ended
+ *
+ */
+bool rvs::LogBinaryReader::get_varint(uint64_t* pVal) {
+  uint64_t val = 0;
+  for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+    uint8_t b = static_cast<uint8_t>(in[pos++]);
+    val |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      *pVal = val;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Reads string stored by LogBinaryWriter::put_string()
+ *
+ * Sets 'bad' flag if input is malformed.
+ *
+ * @param pStr [out] string
+ * @return 'false' if input ended or is malformed
+ *
+ */
+bool rvs::LogBinaryReader::get_string(std::string* pStr) {
+  uint64_t v;
+  if (!get_varint(&v)) {
+    return false;
+  }
+
+  uint64_t arg = v >> 2;
+  switch (v & 3) {
+  case BinRef:
+    if (arg >= strings.size()) {
+      bad = true;
+      return false;
+    }
+    *pStr = strings[arg];
+    return true;
+
+  case BinNumber: {
+    uint64_t mantissa;
+    if (!get_varint(&mantissa)) {
+      return false;
+    }
+    uint64_t int_digits = arg >> 5;
+    uint64_t frac_digits = (arg >> 1) & 0xf;
+    uint64_t digits = int_digits + frac_digits;
+    if (digits > RVSBIN_MAX_DIGITS) {
+      bad = true;
+      return false;
+    }
+    char num[RVSBIN_MAX_DIGITS + 1];
+    for (uint64_t i = digits; i > 0; i--) {
+      num[i - 1] = '0' + mantissa % 10;
+      mantissa /= 10;
+    }
+    pStr->clear();
+    if (arg & 1) {
+      pStr->push_back('-');
+    }
+    pStr->append(num, int_digits);
+    if (frac_digits) {
+      pStr->push_back('.');
+      pStr->append(num + int_digits, frac_digits);
+    }
+    return true;
+  }
+
+  default:
+    if (arg > in.size() - pos) {
+      return false;
+    }
+    pStr->assign(in, pos, arg);
+    pos += arg;
+    if ((v & 3) == BinDefine) {
+      strings.push_back(*pStr);
+    }
+    return true;
+  }
+}
+
+/**
+ * @brief Reads timestamp
+ *
+ * @param pSec [out] seconds from system start
+ * @param pUSec [out] microseconds in current second
+ * @return 'false' if input ended
+ *
+ */
+bool rvs::LogBinaryReader::get_time(uint32_t* pSec, uint32_t* pUSec) {
+  uint64_t zz;
+  uint64_t usec;
+  if (!get_varint(&zz) || !get_varint(&usec)) {
+    return false;
+  }
+  int64_t delta = static_cast<int64_t>(zz >> 1) ^ -static_cast<int64_t>(zz & 1);
+  last_sec = static_cast<uint32_t>(last_sec + delta);
+  *pSec = last_sec;
+  *pUSec = static_cast<uint32_t>(usec);
+  return true;
+}
+
+/**
+ * @brief Reads child elements up to the closing BinEnd tag
+ *
+ * @param pParent node children are added to
+ * @return 0 - success, 1 - input ended, -1 - malformed input
+ *
+ */
+int rvs::LogBinaryReader::get_children(LogNode* pParent) {
+  std::string key;
+  std::string val;
+  uint64_t v;
+
+  while (pos < in.size()) {
+    uint8_t tag = static_cast<uint8_t>(in[pos++]);
+
+    switch (tag) {
+    case BinEnd:
+      return 0;
+
+    case BinNode: {
+      if (!get_string(&key)) {
+        return bad ? -1 : 1;
+      }
+      LogNode* node = new LogNode(key.c_str(), pParent);
+      pParent->Add(node);
+      int sts = get_children(node);
+      if (sts) {
+        return sts;
+      }
+      break;
+    }
+
+    case BinString:
+      if (!get_string(&key) || !get_string(&val)) {
+        return bad ? -1 : 1;
+      }
+      pParent->Add(new LogNodeString(key.c_str(), val.c_str(), pParent));
+      break;
+
+    case BinInt:
+      if (!get_string(&key) || !get_varint(&v)) {
+        return bad ? -1 : 1;
+      }
+      pParent->Add(new LogNodeInt(key.c_str(),
+        static_cast<int>(static_cast<int64_t>(v >> 1) ^
+                         -static_cast<int64_t>(v & 1)), pParent));
+      break;
+
+    default:
+      return -1;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief Converts binary log
+ *
+ * Text rows are written when converting to text, JSON records when
+ * converting to JSON. Conversion stops at incomplete trailing element.
+ *
+ * @param Json 'true' for JSON output, 'false' for text output
+ * @param Out output stream
+ * @param pCount [out] number of converted rows/records
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::LogBinaryReader::convert(bool Json, std::ostream& Out, int* pCount) {
+  std::string row;
+  std::string msg;
+  std::string token;
+  int count = 0;
+  // rows in current session, -1 before first session header
+  int session_rows = -1;
+  bool done = false;
+
+  if (Json) {
+    Out << "[";
+  }
+
+  while (!done && pos < in.size()) {
+    if (in.compare(pos, RVSBINMAGICLEN, RVSBINMAGIC) == 0) {
+      // empty text session still ends with a line break
+      if (!Json && session_rows == 0) {
+        Out << RVSENDL;
+      }
+      session_rows = 0;
+      strings.clear();
+      last_sec = 0;
+      pos += RVSBINMAGICLEN;
+      continue;
+    }
+
+    uint8_t tag = static_cast<uint8_t>(in[pos++]);
+    uint64_t level;
+    uint64_t tokens;
+    uint32_t sec;
+    uint32_t usec;
+
+    switch (tag) {
+    case BinText:
+      if (!get_varint(&level) || !get_time(&sec, &usec) ||
+          !get_varint(&tokens)) {
+        done = true;
+        break;
+      }
+      if (level > logtrace) {
+        return -1;
+      }
+      msg.clear();
+      for (uint64_t i = 0; i < tokens && !done; i++) {
+        if (!get_string(&token)) {
+          done = true;
+          break;
+        }
+        if (i > 0) {
+          msg.push_back(' ');
+        }
+        msg.append(token);
+      }
+      if (!done && !Json) {
+        row.clear();
+        logger::FormatRow(&row, msg.c_str(), level, sec, usec);
+        Out << row << RVSENDL;
+        count++;
+        session_rows++;
+      }
+      break;
+
+    case BinRecord: {
+      if (!get_varint(&level) || !get_time(&sec, &usec)) {
+        done = true;
+        break;
+      }
+      LogNodeRec rec("record", level, sec, usec);
+      int sts = get_children(&rec);
+      if (sts < 0) {
+        return -1;
+      }
+      if (sts > 0) {
+        done = true;
+        break;
+      }
+      if (Json) {
+        row.clear();
+        if (count > 0) {
+          row = ",";
+        }
+        rec.WriteJson(&row, "  ", 0);
+        Out << row;
+        count++;
+      }
+      break;
+    }
+
+    default:
+      return -1;
+    }
+  }
+
+  if (bad) {
+    return -1;
+  }
+
+  if (Json) {
+    Out << RVSENDL << "]";
+  } else if (session_rows == 0) {
+    Out << RVSENDL;
+  }
+
+  *pCount = count;
+  return Out.fail() ? -1 : 0;
+}
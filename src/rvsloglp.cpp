@@ -51,6 +51,7 @@ int   rvs::lp::Initialize(const T_MODULE_INIT* pMi) {
   mi.cbStop            = pMi->cbStop;
   mi.cbStopping        = pMi->cbStopping;
   mi.cbErr             = pMi->cbErr;
+  mi.cbLogLevel        = pMi->cbLogLevel;
 
   return 0;
 }
@@ -265,3 +266,15 @@ int rvs::lp::Err(const std::string &Message
       , const std::string &Module, const std::string &Action) {
   return (*mi.cbErr)(Message.c_str(), Module.c_str(), Action.c_str());
 }
+
+/**
+ * @brief Returns current logging level
+ *
+ * Used to skip formatting of messages which would be filtered out anyway.
+ *
+ * @return Logging level set in Launcher
+ *
+ */
+int rvs::lp::LogLevel() {
+  return (*mi.cbLogLevel)();
+}
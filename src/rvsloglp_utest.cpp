@@ -267,3 +267,15 @@ int rvs::lp::Err(const std::string &Message
       , const std::string &Module, const std::string &Action) {
   return rvs::logger::Err(Message.c_str(), Module.c_str(), Action.c_str());
 }
+
+/**
+ * @brief Returns current logging level
+ *
+ * Used to skip formatting of messages which would be filtered out anyway.
+ *
+ * @return Logging level set in Launcher
+ *
+ */
+int rvs::lp::LogLevel() {
+  return rvs::logger::log_level();
+}
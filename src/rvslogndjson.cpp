@@ -0,0 +1,133 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvslogndjson.h"
+
+#include <string>
+
+#include "include/rvslognodebase.h"
+
+/**
+ * @brief Converts NDJSON log into JSON array log
+ *
+ * Incomplete last line (log still being written) and empty lines are
+ * skipped.
+ *
+ * @param In NDJSON input
+ * @param Out JSON array output
+ * @param pCount [out] number of converted records
+ * @return 0 - success, non-zero otherwise
+ *
+ */
+int rvs::LogNdjson::ToArray(std::istream& In, std::ostream& Out,
+                            int* pCount) {
+  std::string line;
+  std::string row;
+  int count = 0;
+
+  Out << "[";
+  while (std::getline(In, line)) {
+    row.clear();
+    if (count > 0) {
+      row = ",";
+    }
+    if (!Reindent(line, "  ", &row)) {
+      continue;
+    }
+    Out << row;
+    count++;
+  }
+  Out << RVSENDL << "]";
+
+  *pCount = count;
+  return Out.fail() ? -1 : 0;
+}
+
+/**
+ * @brief Converts single line JSON record into multi-line one
+ *
+ * Layout is the same as produced by LogNodeBase::WriteJson().
+ *
+ * @param Line single line JSON record
+ * @param Lead String representing base indentation
+ * @param pOut Output buffer
+ * @return 'true' if Line holds complete record, 'false' otherwise
+ *
+ */
+bool rvs::LogNdjson::Reindent(const std::string& Line, const std::string& Lead,
+                              std::string* pOut) {
+  size_t end = Line.find_last_not_of(" \t\r");
+  if (end == std::string::npos || Line[end] != '}') {
+    return false;
+  }
+
+  auto newline = [&](int Depth) {
+    pOut->append(RVSENDL);
+    pOut->append(Lead);
+    for (int i = 0; i < Depth; i++) {
+      pOut->append(RVSINDENT);
+    }
+  };
+
+  int depth = 0;
+  bool in_string = false;
+  bool pending = true;
+  for (size_t i = Line.find_first_not_of(" \t"); i <= end; i++) {
+    char c = Line[i];
+    if (in_string) {
+      pOut->push_back(c);
+      if (c == '\\' && i < end) {
+        pOut->push_back(Line[++i]);
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+    if (c == '}') {
+      newline(--depth);
+      pOut->push_back(c);
+      pending = false;
+      continue;
+    }
+    if (pending) {
+      // drop blanks between separator and next element
+      if (c == ' ' || c == '\t') {
+        continue;
+      }
+      newline(depth);
+      pending = false;
+    }
+    pOut->push_back(c);
+    if (c == '"') {
+      in_string = true;
+    } else if (c == '{') {
+      depth++;
+      pending = true;
+    } else if (c == ',') {
+      pending = true;
+    }
+  }
+
+  return depth == 0 && !in_string;
+}
@@ -25,6 +25,7 @@
 #include <string>
 
 #include "include/rvslognode.h"
+#include "include/rvslogbinary.h"
 #include "include/rvstrace.h"
 
 using std::string;
@@ -34,11 +35,14 @@ using std::string;
  *
  * @param Name Node name
  * @param Parent Pointer to parent node
+ * @param pArena Arena to allocate from (defaults to parent's arena)
  *
  */
-rvs::LogNode::LogNode(const char* Name, const LogNodeBase* Parent)
+rvs::LogNode::LogNode(const char* Name, const LogNodeBase* Parent,
+                      LogArena* pArena)
 :
-LogNodeBase(Name, Parent) {
+LogNodeBase(Name, Parent, pArena),
+Child(LogArenaAllocator<LogNodeBase*>(arena)) {
   Type = eLN::List;
 }
 
@@ -60,28 +64,45 @@ void rvs::LogNode::Add(LogNodeBase* pChild) {
 }
 
 /**
- * @brief Provides JSON representation of Node
+ * @brief Appends JSON representation of Node to output buffer
  *
  * Traverses list of child nodes and converts them into proper string representation.
  * Also ensures proper indentation and line breaks for formatted output.
  *
- * @param Lead String of blanks " " representing current indentation
- * @return Node as JSON string
+ * @param pOut Output buffer JSON is appended to
+ * @param Lead String representing base indentation
+ * @param Depth Nesting level of this node
  *
  */
-std::string rvs::LogNode::ToJson(const std::string& Lead) {
+void rvs::LogNode::WriteJson(std::string* pOut, const std::string& Lead,
+                             const int Depth) {
   DTRACE_
-  string result(RVSENDL);
-  result += Lead + "\"" + Name + "\"" + " : {";
+  NewLine(pOut, Lead, Depth);
+  pOut->append("\"");
+  pOut->append(Name);
+  pOut->append("\" : {");
 
   int  size = Child.size();
   for (int i = 0; i < size; i++) {
-    result += Child[i]->ToJson(Lead + RVSINDENT);
+    Child[i]->WriteJson(pOut, Lead, Nested(Depth));
     if (i+ 1 < size) {
-      result += ",";
+      pOut->append(",");
     }
   }
-  result += RVSENDL + Lead + "}";
+  NewLine(pOut, Lead, Depth);
+  pOut->append("}");
+}
 
-  return result;
+/**
+ * @brief Appends binary representation of Node to binary log writer
+ *
+ * @param pOut Binary log writer
+ *
+ */
+void rvs::LogNode::WriteBinary(LogBinaryWriter* pOut) {
+  pOut->node(Name);
+  for (auto it = Child.begin(); it != Child.end(); ++it) {
+    (*it)->WriteBinary(pOut);
+  }
+  pOut->end();
 }
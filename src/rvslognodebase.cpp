@@ -22,6 +22,7 @@
  * SOFTWARE.
  *
  *******************************************************************************/
+#include <cstring>
 #include <string>
 
 #include "include/rvslognodebase.h"
@@ -29,16 +30,109 @@
 /**
  * @brief Constructor
  *
+ * Node is placed in the given arena, or in the arena of its parent if
+ * none is given. Nodes without arena own heap copies of their strings.
+ *
  * @param pName Node name
  * @param pParent Pointer to parent node
+ * @param pArena Arena to allocate strings from
  *
  */
-rvs::LogNodeBase::LogNodeBase(const char* pName, const LogNodeBase* pParent)
-: Name(pName),
+rvs::LogNodeBase::LogNodeBase(const char* pName, const LogNodeBase* pParent,
+                              LogArena* pArena)
+: arena(pArena ? pArena : (pParent ? pParent->arena : nullptr)),
+Name(nullptr),
 Parent(pParent),
 Type(eLN::Unknown) {
+  Name = CopyString(pName);
 }
 
 //! Destructor
 rvs::LogNodeBase::~LogNodeBase() {
+  FreeString(Name);
+}
+
+/**
+ * @brief Releases node and all its children
+ *
+ * Arena backed trees are released by returning the arena for reuse,
+ * heap trees are deleted.
+ *
+ * @param pNode root node of the tree
+ *
+ */
+void rvs::LogNodeBase::Destroy(LogNodeBase* pNode) {
+  if (pNode == nullptr) {
+    return;
+  }
+  if (pNode->arena) {
+    // all node memory lives in the arena, nothing else to free
+    LogArena::release(pNode->arena);
+  } else {
+    delete pNode;
+  }
+}
+
+/**
+ * @brief Makes copy of string owned by this node
+ *
+ * @param Str string to copy
+ * @return pointer to copy (in arena if node is arena backed)
+ *
+ */
+const char* rvs::LogNodeBase::CopyString(const char* Str) {
+  if (arena) {
+    return arena->copy(Str);
+  }
+  size_t len = strlen(Str) + 1;
+  char* p = new char[len];
+  memcpy(p, Str, len);
+  return p;
+}
+
+/**
+ * @brief Releases string previously obtained through CopyString()
+ *
+ * @param Str string to release
+ *
+ */
+void rvs::LogNodeBase::FreeString(const char* Str) {
+  if (!arena) {
+    delete[] Str;
+  }
+}
+
+/**
+ * @brief Provides JSON representation of Node
+ *
+ * @param Lead String of blanks " " representing current indentation
+ * @return Node as JSON string
+ *
+ */
+std::string rvs::LogNodeBase::ToJson(const std::string& Lead) {
+  std::string result;
+  WriteJson(&result, Lead, 0);
+  return result;
+}
+
+/**
+ * @brief Starts new line at the given indentation
+ *
+ * Does nothing in single line mode (negative Depth).
+ *
+ * @param pOut Output buffer
+ * @param Lead String representing base indentation
+ * @param Depth Nesting level, adds RVSINDENT per level to Lead
+ *
+ */
+void rvs::LogNodeBase::NewLine(std::string* pOut, const std::string& Lead,
+                               const int Depth) {
+  if (Depth < 0) {
+    return;
+  }
+  pOut->append(RVSENDL);
+  pOut->append(Lead);
+  for (int i = 0; i < Depth; i++) {
+    pOut->append(RVSINDENT);
+  }
 }
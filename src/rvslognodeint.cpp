@@ -22,9 +22,11 @@
  * SOFTWARE.
  *
  *******************************************************************************/
+#include <cstdio>
 #include <string>
 
 #include "include/rvslognodeint.h"
+#include "include/rvslogbinary.h"
 
 using std::string;
 
@@ -49,18 +51,31 @@ rvs::LogNodeInt::~LogNodeInt() {
 }
 
 /**
- * @brief Provides JSON representation of Node
+ * @brief Appends JSON representation of Node to output buffer
  *
- * Traverses list of child nodes and converts them into proper string representation.
- * Also ensures proper indentation and line breaks for formatted output.
- *
- * @param Lead String of blanks " " representing current indentation
- * @return Node as JSON string
+ * @param pOut Output buffer JSON is appended to
+ * @param Lead String representing base indentation
+ * @param Depth Nesting level of this node
  *
  */
-std::string rvs::LogNodeInt::ToJson(const std::string& Lead) {
-  string result(RVSENDL);
-  result += Lead + "\"" + Name + "\"" + " : " + std::to_string(Value);
+void rvs::LogNodeInt::WriteJson(std::string* pOut, const std::string& Lead,
+                                const int Depth) {
+  char  buff[16];
+  snprintf(buff, sizeof(buff), "%d", Value);
+
+  NewLine(pOut, Lead, Depth);
+  pOut->append("\"");
+  pOut->append(Name);
+  pOut->append("\" : ");
+  pOut->append(buff);
+}
 
-  return result;
+/**
+ * @brief Appends binary representation of Node to binary log writer
+ *
+ * @param pOut Binary log writer
+ *
+ */
+void rvs::LogNodeInt::WriteBinary(LogBinaryWriter* pOut) {
+  pOut->add_int(Name, Value);
 }
@@ -24,6 +24,7 @@
  *******************************************************************************/
 
 #include "include/rvslognoderec.h"
+#include "include/rvslogbinary.h"
 
 #include <string>
 #include "include/rvstrace.h"
@@ -36,12 +37,14 @@
  * @param Sec secconds since system start
  * @param uSec microseconds in current second
  * @param Parent Pointer to parent node
+ * @param pArena Arena to allocate from (defaults to parent's arena)
  *
  */
 rvs::LogNodeRec::LogNodeRec(const char* Name, int LoggingLevel,
-  const unsigned Sec, const unsigned uSec, const LogNodeBase* Parent)
+  const unsigned Sec, const unsigned uSec, const LogNodeBase* Parent,
+  LogArena* pArena)
 :
-LogNode(Name, Parent),
+LogNode(Name, Parent, pArena),
 Level(LoggingLevel),
 sec(Sec),
 usec(uSec) {
@@ -63,40 +66,57 @@ int rvs::LogNodeRec::LogLevel() {
 }
 
 /**
- * @brief Provides JSON representation of Node
+ * @brief Appends JSON representation of Node to output buffer
  *
  * Traverses list of child nodes and converts them into proper string representation.
  * Also ensures proper indentation and line breaks for formatted output.
  *
- * @param Lead String of blanks " " representing current indentation
- * @return Node as JSON string
+ * @param pOut Output buffer JSON is appended to
+ * @param Lead String representing base indentation
+ * @param Depth Nesting level of this node
  *
  */
-std::string rvs::LogNodeRec::ToJson(const std::string& Lead) {
+void rvs::LogNodeRec::WriteJson(std::string* pOut, const std::string& Lead,
+                                const int Depth) {
   DTRACE_
-  std::string result(RVSENDL);
-  result += Lead + "{";
+  char  buff[64];
 
-  result += RVSENDL;
-  result += Lead + RVSINDENT;
-  result += std::string("\"") + "loglevel" + "\"" + " : " +
-            std::to_string(Level) + ",";
+  NewLine(pOut, Lead, Depth);
+  pOut->append("{");
+
+  snprintf(buff, sizeof(buff), "%d", Level);
+  NewLine(pOut, Lead, Nested(Depth));
+  pOut->append("\"loglevel\" : ");
+  pOut->append(buff);
+  pOut->append(",");
 
-  char  buff[64];
   snprintf(buff, sizeof(buff), "%6d.%-6d", sec, usec);
-  result += RVSENDL;
-  result += Lead + RVSINDENT;
-  result += std::string("\"") + "time" + "\"" + " : " +
-            std::string("\"") + buff + std::string("\"")  + ",";
+  NewLine(pOut, Lead, Nested(Depth));
+  pOut->append("\"time\" : \"");
+  pOut->append(buff);
+  pOut->append("\",");
 
   int  size = Child.size();
   for (int i = 0; i < size; i++) {
-    result += Child[i]->ToJson(Lead + RVSINDENT);
+    Child[i]->WriteJson(pOut, Lead, Nested(Depth));
     if (i+ 1 < size) {
-      result += ",";
+      pOut->append(",");
     }
   }
-  result += RVSENDL + Lead + "}";
+  NewLine(pOut, Lead, Depth);
+  pOut->append("}");
+}
 
-  return result;
+/**
+ * @brief Appends binary representation of Record to binary log writer
+ *
+ * @param pOut Binary log writer
+ *
+ */
+void rvs::LogNodeRec::WriteBinary(LogBinaryWriter* pOut) {
+  pOut->record(Level, sec, usec);
+  for (auto it = Child.begin(); it != Child.end(); ++it) {
+    (*it)->WriteBinary(pOut);
+  }
+  pOut->end();
 }
@@ -25,6 +25,7 @@
 #include <string>
 
 #include "include/rvslognodestring.h"
+#include "include/rvslogbinary.h"
 
 using std::string;
 
@@ -40,27 +41,40 @@ rvs::LogNodeString::LogNodeString(const char* Name, const char* Val,
                                   const LogNodeBase* Parent)
 :
 LogNodeBase(Name, Parent),
-Value(Val) {
+Value(nullptr) {
   Type = eLN::String;
+  Value = CopyString(Val);
 }
 
 //! Destructor
 rvs::LogNodeString::~LogNodeString() {
+  FreeString(Value);
 }
 
 /**
- * @brief Provides JSON representation of Node
+ * @brief Appends JSON representation of Node to output buffer
  *
- * Traverses list of child nodes and converts them into proper string representation.
- * Also ensures proper indentation and line breaks for formatted output.
- *
- * @param Lead String of blanks " " representing current indentation
- * @return Node as JSON string
+ * @param pOut Output buffer JSON is appended to
+ * @param Lead String representing base indentation
+ * @param Depth Nesting level of this node
  *
  */
-std::string rvs::LogNodeString::ToJson(const std::string& Lead) {
-  string result(RVSENDL);
-  result += Lead + "\"" + Name + "\"" + " : " + "\"" + Value + "\"";
+void rvs::LogNodeString::WriteJson(std::string* pOut, const std::string& Lead,
+                                   const int Depth) {
+  NewLine(pOut, Lead, Depth);
+  pOut->append("\"");
+  pOut->append(Name);
+  pOut->append("\" : \"");
+  pOut->append(Value);
+  pOut->append("\"");
+}
 
-  return result;
+/**
+ * @brief Appends binary representation of Node to binary log writer
+ *
+ * @param pOut Binary log writer
+ *
+ */
+void rvs::LogNodeString::WriteBinary(LogBinaryWriter* pOut) {
+  pOut->add_string(Name, Value);
 }
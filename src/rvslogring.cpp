@@ -0,0 +1,250 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvslogring.h"
+
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+std::vector<std::shared_ptr<rvs::LogRing>> rvs::LogRingSet::rings;
+std::mutex rvs::LogRingSet::rings_mutex;
+
+/**
+ * @brief Constructor
+ *
+ * @param Capacity Max number of records held (rounded up to power of 2)
+ *
+ */
+rvs::LogRing::LogRing(size_t Capacity)
+:
+head(0),
+tail(0),
+bclosed(false) {
+  size_t cap = 1;
+  while (cap < Capacity) {
+    cap <<= 1;
+  }
+  slot.resize(cap);
+  mask = cap - 1;
+}
+
+/**
+ * @brief Appends record to the ring (producer side)
+ *
+ * @param Sec seconds from system start
+ * @param uSec microseconds in current second
+ * @param Level logging level
+ * @param Msg message text
+ * @return 'true' - success, 'false' if ring is full
+ *
+ */
+bool rvs::LogRing::push(uint32_t Sec, uint32_t uSec, int Level,
+                        const char* Msg) {
+  size_t h = head.load(std::memory_order_relaxed);
+  size_t t = tail.load(std::memory_order_acquire);
+  if (h - t > mask) {
+    return false;
+  }
+
+  LogRingRecord& r = slot[h & mask];
+  r.sec = Sec;
+  r.usec = uSec;
+  r.level = Level;
+  r.msg.assign(Msg);
+
+  head.store(h + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Takes oldest record from the ring (consumer side)
+ *
+ * Message buffer is swapped rather than copied so that the slot can reuse
+ * the previous buffer of *pRec.
+ *
+ * @param pRec [out] record
+ * @return 'true' - success, 'false' if ring is empty
+ *
+ */
+bool rvs::LogRing::pop(LogRingRecord* pRec) {
+  size_t t = tail.load(std::memory_order_relaxed);
+  size_t h = head.load(std::memory_order_acquire);
+  if (t == h) {
+    return false;
+  }
+
+  LogRingRecord& r = slot[t & mask];
+  pRec->sec = r.sec;
+  pRec->usec = r.usec;
+  pRec->level = r.level;
+  pRec->msg.swap(r.msg);
+
+  tail.store(t + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Returns timestamp of the oldest record (consumer side)
+ *
+ * @param pTs [out] timestamp in microseconds
+ * @return 'true' - success, 'false' if ring is empty
+ *
+ */
+bool rvs::LogRing::front_ts(uint64_t* pTs) const {
+  size_t t = tail.load(std::memory_order_relaxed);
+  size_t h = head.load(std::memory_order_acquire);
+  if (t == h) {
+    return false;
+  }
+
+  const LogRingRecord& r = slot[t & mask];
+  *pTs = static_cast<uint64_t>(r.sec) * 1000000 + r.usec;
+  return true;
+}
+
+//! Returns number of records currently in the ring
+size_t rvs::LogRing::size() const {
+  return head.load(std::memory_order_acquire) -
+         tail.load(std::memory_order_acquire);
+}
+
+//! Returns max number of records the ring can hold
+size_t rvs::LogRing::capacity() const {
+  return mask + 1;
+}
+
+//! Marks ring as no longer used by its producer
+void rvs::LogRing::close() {
+  bclosed.store(true, std::memory_order_release);
+}
+
+//! Returns 'true' if producer thread has exited
+bool rvs::LogRing::closed() const {
+  return bclosed.load(std::memory_order_acquire);
+}
+
+namespace {
+
+/**
+ * @brief Holds ring of the calling thread
+ *
+ * Closes the ring when thread exits so that consumer can release it once
+ * remaining records are drained.
+ *
+ */
+struct LocalRing {
+  ~LocalRing() {
+    if (ring) {
+      ring->close();
+    }
+  }
+  std::shared_ptr<rvs::LogRing> ring;
+};
+
+}  // namespace
+
+/**
+ * @brief Returns ring of the calling thread
+ *
+ * Ring is created and registered on first call from a given thread.
+ *
+ * @return pointer to ring
+ *
+ */
+rvs::LogRing* rvs::LogRingSet::local() {
+  static thread_local LocalRing lr;
+
+  if (!lr.ring) {
+    lr.ring = std::make_shared<LogRing>();
+    std::lock_guard<std::mutex> lk(rings_mutex);
+    rings.push_back(lr.ring);
+  }
+
+  return lr.ring.get();
+}
+
+/**
+ * @brief Drains all rings merging records in timestamp order
+ *
+ * Only records present at the time of the call are taken, so a busy
+ * producer cannot keep the consumer in here forever. Records within one
+ * ring are already ordered; records from different rings are merged
+ * by (sec, usec), ties are resolved by ring registration order.
+ *
+ * @param pOut [out] records are appended to this vector
+ * @return number of records appended
+ *
+ */
+size_t rvs::LogRingSet::drain(std::vector<LogRingRecord>* pOut) {
+  typedef std::pair<uint64_t, size_t> ts_ring;
+
+  std::lock_guard<std::mutex> lk(rings_mutex);
+
+  std::vector<size_t> left(rings.size());
+  std::priority_queue<ts_ring, std::vector<ts_ring>,
+                      std::greater<ts_ring>> heap;
+
+  for (size_t i = 0; i < rings.size(); i++) {
+    left[i] = rings[i]->size();
+    uint64_t ts;
+    if (left[i] > 0 && rings[i]->front_ts(&ts)) {
+      heap.push(ts_ring(ts, i));
+    }
+  }
+
+  size_t cnt = 0;
+  while (!heap.empty()) {
+    size_t i = heap.top().second;
+    heap.pop();
+
+    pOut->emplace_back();
+    rings[i]->pop(&pOut->back());
+    cnt++;
+
+    uint64_t ts;
+    if (--left[i] > 0 && rings[i]->front_ts(&ts)) {
+      heap.push(ts_ring(ts, i));
+    }
+  }
+
+  // release rings of exited threads
+  for (auto it = rings.begin(); it != rings.end();) {
+    if ((*it)->closed() && (*it)->size() == 0) {
+      it = rings.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return cnt;
+}
+
+//! Returns number of registered rings
+size_t rvs::LogRingSet::count() {
+  std::lock_guard<std::mutex> lk(rings_mutex);
+  return rings.size();
+}
@@ -0,0 +1,484 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvsmatgen.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define RVS_MATGEN_X86 1
+#include <immintrin.h>
+#endif
+
+//! Weyl increment applied to element index
+#define RVS_MATGEN_GOLDEN 0x9E3779B9u
+//! murmur3 finalizer multipliers
+#define RVS_MATGEN_MIX1 0x85EBCA6Bu
+#define RVS_MATGEN_MIX2 0xC2B2AE35u
+
+namespace {
+
+enum { TYPE_FLOAT, TYPE_DOUBLE, TYPE_HALF };
+
+//! Fills Count elements starting at index First of a 2^32 element block
+void fill_scalar(void* pData, int Type, uint32_t Key, uint32_t First,
+                 size_t Count, float FScale, double DScale) {
+  switch (Type) {
+    case TYPE_FLOAT: {
+      float* data = static_cast<float*>(pData);
+      for (size_t i = 0; i < Count; i++) {
+        uint32_t h = rvs::MatrixGen::hash(Key,
+                                          First + static_cast<uint32_t>(i));
+        data[i] = static_cast<float>(static_cast<int32_t>(h >> 8)) * FScale;
+      }
+      break;
+    }
+    case TYPE_DOUBLE: {
+      double* data = static_cast<double*>(pData);
+      for (size_t i = 0; i < Count; i++) {
+        uint32_t h = rvs::MatrixGen::hash(Key,
+                                          First + static_cast<uint32_t>(i));
+        data[i] = static_cast<double>(static_cast<int32_t>(h >> 1)) * DScale;
+      }
+      break;
+    }
+    default: {
+      uint16_t* data = static_cast<uint16_t*>(pData);
+      for (size_t i = 0; i < Count; i++) {
+        uint32_t h = rvs::MatrixGen::hash(Key,
+                                          First + static_cast<uint32_t>(i));
+        data[i] = rvs::MatrixGen::half_bits(h);
+      }
+      break;
+    }
+  }
+}
+
+#if defined(RVS_MATGEN_X86)
+
+__attribute__((target("avx2")))
+inline __m256i hash8(__m256i Key, uint32_t First) {
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(First)),
+                               lane);
+  x = _mm256_add_epi32(_mm256_mullo_epi32(x,
+        _mm256_set1_epi32(static_cast<int32_t>(RVS_MATGEN_GOLDEN))), Key);
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  x = _mm256_mullo_epi32(x,
+        _mm256_set1_epi32(static_cast<int32_t>(RVS_MATGEN_MIX1)));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+  x = _mm256_mullo_epi32(x,
+        _mm256_set1_epi32(static_cast<int32_t>(RVS_MATGEN_MIX2)));
+  return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+}
+
+__attribute__((target("avx2,f16c")))
+void fill_avx2(void* pData, int Type, uint32_t Key, uint32_t First,
+               size_t Count, float FScale, double DScale) {
+  const __m256i key = _mm256_set1_epi32(static_cast<int32_t>(Key));
+  size_t vec = Count & ~static_cast<size_t>(7);
+  size_t i;
+
+  switch (Type) {
+    case TYPE_FLOAT: {
+      float* data = static_cast<float*>(pData);
+      const __m256 fs = _mm256_set1_ps(FScale);
+      for (i = 0; i < vec; i += 8) {
+        __m256i h = hash8(key, First + static_cast<uint32_t>(i));
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(
+          _mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), fs));
+      }
+      break;
+    }
+    case TYPE_DOUBLE: {
+      double* data = static_cast<double*>(pData);
+      const __m256d ds = _mm256_set1_pd(DScale);
+      for (i = 0; i < vec; i += 8) {
+        __m256i h = _mm256_srli_epi32(
+          hash8(key, First + static_cast<uint32_t>(i)), 1);
+        _mm256_storeu_pd(data + i, _mm256_mul_pd(
+          _mm256_cvtepi32_pd(_mm256_castsi256_si128(h)), ds));
+        _mm256_storeu_pd(data + i + 4, _mm256_mul_pd(
+          _mm256_cvtepi32_pd(_mm256_extracti128_si256(h, 1)), ds));
+      }
+      break;
+    }
+    default: {
+      uint16_t* data = static_cast<uint16_t*>(pData);
+      const __m256 hs = _mm256_set1_ps(1.0f / 2048);
+      for (i = 0; i < vec; i += 8) {
+        __m256i h = hash8(key, First + static_cast<uint32_t>(i));
+        __m256 f = _mm256_mul_ps(
+          _mm256_cvtepi32_ps(_mm256_srli_epi32(h, 21)), hs);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),
+                         _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+      }
+      break;
+    }
+  }
+
+  if (vec < Count) {
+    size_t size = Type == TYPE_FLOAT ? sizeof(float) :
+                  Type == TYPE_DOUBLE ? sizeof(double) : sizeof(uint16_t);
+    fill_scalar(static_cast<char*>(pData) + vec * size, Type, Key,
+                First + static_cast<uint32_t>(vec), Count - vec,
+                FScale, DScale);
+  }
+}
+
+// GCC 12 AVX-512 headers report their own _mm512_undefined_*() temporaries
+// as uninitialized once inlined here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+inline __m512i hash16(__m512i Key, uint32_t First) {
+  const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15);
+  __m512i x = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int32_t>(First)),
+                               lane);
+  x = _mm512_add_epi32(_mm512_mullo_epi32(x,
+        _mm512_set1_epi32(static_cast<int32_t>(RVS_MATGEN_GOLDEN))), Key);
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+  x = _mm512_mullo_epi32(x,
+        _mm512_set1_epi32(static_cast<int32_t>(RVS_MATGEN_MIX1)));
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 13));
+  x = _mm512_mullo_epi32(x,
+        _mm512_set1_epi32(static_cast<int32_t>(RVS_MATGEN_MIX2)));
+  return _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+}
+
+__attribute__((target("avx512f")))
+void fill_avx512(void* pData, int Type, uint32_t Key, uint32_t First,
+                 size_t Count, float FScale, double DScale) {
+  const __m512i key = _mm512_set1_epi32(static_cast<int32_t>(Key));
+  size_t vec = Count & ~static_cast<size_t>(15);
+  size_t i;
+
+  switch (Type) {
+    case TYPE_FLOAT: {
+      float* data = static_cast<float*>(pData);
+      const __m512 fs = _mm512_set1_ps(FScale);
+      for (i = 0; i < vec; i += 16) {
+        __m512i h = hash16(key, First + static_cast<uint32_t>(i));
+        _mm512_storeu_ps(data + i, _mm512_mul_ps(
+          _mm512_cvtepi32_ps(_mm512_srli_epi32(h, 8)), fs));
+      }
+      break;
+    }
+    case TYPE_DOUBLE: {
+      double* data = static_cast<double*>(pData);
+      const __m512d ds = _mm512_set1_pd(DScale);
+      for (i = 0; i < vec; i += 16) {
+        __m512i h = _mm512_srli_epi32(
+          hash16(key, First + static_cast<uint32_t>(i)), 1);
+        _mm512_storeu_pd(data + i, _mm512_mul_pd(
+          _mm512_cvtepi32_pd(_mm512_castsi512_si256(h)), ds));
+        _mm512_storeu_pd(data + i + 8, _mm512_mul_pd(
+          _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(h, 1)), ds));
+      }
+      break;
+    }
+    default: {
+      uint16_t* data = static_cast<uint16_t*>(pData);
+      const __m512 hs = _mm512_set1_ps(1.0f / 2048);
+      for (i = 0; i < vec; i += 16) {
+        __m512i h = hash16(key, First + static_cast<uint32_t>(i));
+        __m512 f = _mm512_mul_ps(
+          _mm512_cvtepi32_ps(_mm512_srli_epi32(h, 21)), hs);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i),
+                            _mm512_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+      }
+      break;
+    }
+  }
+
+  if (vec < Count) {
+    size_t size = Type == TYPE_FLOAT ? sizeof(float) :
+                  Type == TYPE_DOUBLE ? sizeof(double) : sizeof(uint16_t);
+    fill_scalar(static_cast<char*>(pData) + vec * size, Type, Key,
+                First + static_cast<uint32_t>(vec), Count - vec,
+                FScale, DScale);
+  }
+}
+
+#pragma GCC diagnostic pop
+
+#endif  // RVS_MATGEN_X86
+
+}  // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @param Seed seed shared by all streams
+ * @param Threads maximum number of threads (0 - one per CPU)
+ *
+ * */
+rvs::MatrixGen::MatrixGen(uint64_t Seed, int Threads)
+: seed(Seed), scale(1.0) {
+  set_threads(Threads);
+  simd_level = simd_supported();
+}
+
+/**
+ * @brief Sets maximum number of threads
+ *
+ * @param Threads maximum number of threads (0 - one per CPU)
+ *
+ * */
+void rvs::MatrixGen::set_threads(int Threads) {
+  if (Threads <= 0) {
+    Threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  num_threads = std::max(Threads, 1);
+}
+
+/**
+ * @brief Selects SIMD path, mostly for testing
+ *
+ * @param Level one of RVS_MATGEN_*, limited to what the CPU supports
+ * (negative - best supported)
+ *
+ * */
+void rvs::MatrixGen::set_simd(int Level) {
+  int supported = simd_supported();
+  simd_level = Level < 0 ? supported : std::min(Level, supported);
+}
+
+/**
+ * @brief Fills float matrix with values uniform in [0, scale)
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Stream selects independent sequence (e.g. one per matrix)
+ *
+ * */
+void rvs::MatrixGen::generate(float* pData, size_t Count,
+                              uint32_t Stream) const {
+  run(pData, Count, Stream, TYPE_FLOAT);
+}
+
+/**
+ * @brief Fills double matrix with values uniform in [0, scale)
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Stream selects independent sequence (e.g. one per matrix)
+ *
+ * */
+void rvs::MatrixGen::generate(double* pData, size_t Count,
+                              uint32_t Stream) const {
+  run(pData, Count, Stream, TYPE_DOUBLE);
+}
+
+/**
+ * @brief Fills IEEE binary16 matrix with values in [0, 1)
+ *
+ * @param pData matrix (raw half precision bits)
+ * @param Count number of elements
+ * @param Stream selects independent sequence (e.g. one per matrix)
+ *
+ * */
+void rvs::MatrixGen::generate_half(uint16_t* pData, size_t Count,
+                                   uint32_t Stream) const {
+  run(pData, Count, Stream, TYPE_HALF);
+}
+
+/**
+ * @brief Splits matrix into chunks and fills them in parallel
+ *
+ * Chunks are multiples of 64 elements so that only the last one has a
+ * scalar tail.
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Stream selects independent sequence
+ * @param Type element type
+ *
+ * */
+template <typename T>
+void rvs::MatrixGen::run(T* pData, size_t Count, uint32_t Stream,
+                         int Type) const {
+  size_t chunks = (Count + RVS_MATGEN_MIN_CHUNK - 1) / RVS_MATGEN_MIN_CHUNK;
+  size_t threads = std::max(std::min(chunks,
+                                     static_cast<size_t>(num_threads)),
+                            static_cast<size_t>(1));
+  size_t chunk = ((Count + threads - 1) / threads + 63) &
+                 ~static_cast<size_t>(63);
+
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++) {
+    size_t first = t * chunk;
+    if (first >= Count) {
+      break;
+    }
+    size_t count = std::min(chunk, Count - first);
+    workers.push_back(std::thread(&MatrixGen::fill, this, pData + first, Type,
+                                  first, count, Stream));
+  }
+  fill(pData, Type, 0, std::min(chunk, Count), Stream);
+
+  for (auto& w : workers) {
+    w.join();
+  }
+}
+
+/**
+ * @brief Fills a range of elements
+ *
+ * Range is split on 2^32 element boundaries, each block has its own key.
+ *
+ * @param pData first element of the range
+ * @param Type element type
+ * @param First index of first element within the matrix
+ * @param Count number of elements
+ * @param Stream selects independent sequence
+ *
+ * */
+void rvs::MatrixGen::fill(void* pData, int Type, uint64_t First, size_t Count,
+                          uint32_t Stream) const {
+  const float fscale = static_cast<float>(scale / 16777216.0);
+  const double dscale = scale / 2147483648.0;
+  size_t size = Type == TYPE_FLOAT ? sizeof(float) :
+                Type == TYPE_DOUBLE ? sizeof(double) : sizeof(uint16_t);
+  char* data = static_cast<char*>(pData);
+
+  while (Count > 0) {
+    uint32_t block = static_cast<uint32_t>(First >> 32);
+    uint32_t lo = static_cast<uint32_t>(First);
+    size_t count = std::min(static_cast<uint64_t>(Count),
+                            (static_cast<uint64_t>(1) << 32) - lo);
+    uint32_t k = key(seed, Stream, block);
+
+    switch (simd_level) {
+#if defined(RVS_MATGEN_X86)
+      case RVS_MATGEN_AVX512:
+        fill_avx512(data, Type, k, lo, count, fscale, dscale);
+        break;
+      case RVS_MATGEN_AVX2:
+        fill_avx2(data, Type, k, lo, count, fscale, dscale);
+        break;
+#endif
+      default:
+        fill_scalar(data, Type, k, lo, count, fscale, dscale);
+        break;
+    }
+
+    data += count * size;
+    First += count;
+    Count -= count;
+  }
+}
+
+/**
+ * @brief Hashes element index (murmur3 finalizer of a Weyl sequence)
+ *
+ * @param Key block key, see key()
+ * @param Index element index within the block
+ * @return 32 random bits
+ *
+ * */
+uint32_t rvs::MatrixGen::hash(uint32_t Key, uint32_t Index) {
+  uint32_t x = Index * RVS_MATGEN_GOLDEN + Key;
+  x ^= x >> 16;
+  x *= RVS_MATGEN_MIX1;
+  x ^= x >> 13;
+  x *= RVS_MATGEN_MIX2;
+  x ^= x >> 16;
+  return x;
+}
+
+/**
+ * @brief Derives key of a 2^32 element block (splitmix64)
+ *
+ * @param Seed generator seed
+ * @param Stream sequence number
+ * @param Block upper 32 bits of element index
+ * @return block key
+ *
+ * */
+uint32_t rvs::MatrixGen::key(uint64_t Seed, uint32_t Stream, uint32_t Block) {
+  uint64_t z = Seed + 0x9E3779B97F4A7C15ull *
+               (((static_cast<uint64_t>(Stream) << 32) | Block) + 1);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z ^= z >> 31;
+  return static_cast<uint32_t>(z);
+}
+
+/**
+ * @brief Converts hash to IEEE binary16 bits of (Hash >> 21) / 2048
+ *
+ * @param Hash value returned by hash()
+ * @return half precision bits
+ *
+ * */
+uint16_t rvs::MatrixGen::half_bits(uint32_t Hash) {
+  uint32_t k = Hash >> 21;
+  if (k == 0) {
+    return 0;
+  }
+  int e = 31 - __builtin_clz(k);
+  return static_cast<uint16_t>(((e + 4) << 10) | ((k << (10 - e)) & 0x3FF));
+}
+
+/**
+ * @brief Returns widest SIMD path supported by the CPU
+ *
+ * @return one of RVS_MATGEN_*
+ *
+ * */
+int rvs::MatrixGen::simd_supported() {
+#if defined(RVS_MATGEN_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return RVS_MATGEN_AVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) {
+    return RVS_MATGEN_AVX2;
+  }
+#endif
+  return RVS_MATGEN_SCALAR;
+}
+
+/**
+ * @brief Returns name of SIMD path
+ *
+ * @param Level one of RVS_MATGEN_*
+ * @return SIMD path name
+ *
+ * */
+const char* rvs::MatrixGen::simd_name(int Level) {
+  switch (Level) {
+    case RVS_MATGEN_AVX512:
+      return "avx512";
+    case RVS_MATGEN_AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
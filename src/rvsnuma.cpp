@@ -0,0 +1,408 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvsnuma.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! names of placements, indexed by RVS_NUMA_PLACEMENT_*
+const char* const kPlacementNames[] = {"all", "local", "remote"};
+
+/**
+ * @brief Lists numbers following Prefix in names of directory entries
+ *
+ * @param Dir directory path
+ * @param Prefix name prefix (e.g. "node")
+ * @return numbers in increasing order, empty if Dir can't be read
+ *
+ * */
+std::vector<int> list_numbered(const std::string& Dir,
+                               const std::string& Prefix) {
+  std::vector<int> result;
+  DIR* dirp = opendir(Dir.c_str());
+  if (dirp == nullptr) {
+    return result;
+  }
+  struct dirent* dir;
+  while ((dir = readdir(dirp)) != nullptr) {
+    std::string name(dir->d_name);
+    if (name.size() <= Prefix.size() ||
+        name.compare(0, Prefix.size(), Prefix)) {
+      continue;
+    }
+    std::string num = name.substr(Prefix.size());
+    if (num.find_first_not_of("0123456789") != std::string::npos) {
+      continue;
+    }
+    result.push_back(atoi(num.c_str()));
+  }
+  closedir(dirp);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+/**
+ * @brief Reads NUMA and KFD topology
+ *
+ * @param SysRoot sysfs mount point
+ * @return 0 - if successfull, -1 if no NUMA node was found
+ *
+ * */
+int rvs::NumaTopology::load(const std::string& SysRoot) {
+  clear();
+
+  std::string node_dir = SysRoot + "/devices/system/node";
+  numa_nodes = list_numbered(node_dir, "node");
+  for (auto n : numa_nodes) {
+    std::string dir = node_dir + "/node" + std::to_string(n);
+    std::ifstream f_cpus(dir + "/cpulist");
+    std::string list;
+    std::getline(f_cpus, list);
+    parse_cpulist(list, &node_cpus[n]);
+
+    std::ifstream f_dist(dir + "/distance");
+    int d;
+    while (f_dist >> d) {
+      node_distance[n].push_back(d);
+    }
+  }
+
+  std::string kfd_dir = SysRoot + "/class/kfd/kfd/topology/nodes";
+  size_t cpu_agents = 0;
+  for (auto k : list_numbered(kfd_dir, "")) {
+    std::ifstream f_prop(kfd_dir + "/" + std::to_string(k) + "/properties");
+    std::string prop_name;
+    uint64_t prop_val;
+    uint64_t cpu_cores = 0;
+    uint64_t simd = 0;
+    uint64_t location = 0;
+    uint64_t domain = 0;
+    while (f_prop >> prop_name >> prop_val) {
+      if (prop_name == "cpu_cores_count") {
+        cpu_cores = prop_val;
+      } else if (prop_name == "simd_count") {
+        simd = prop_val;
+      } else if (prop_name == "location_id") {
+        location = prop_val;
+      } else if (prop_name == "domain") {
+        domain = prop_val;
+      }
+    }
+
+    if (simd == 0) {
+      // CPU agents follow NUMA node order
+      if (cpu_cores > 0 && cpu_agents < numa_nodes.size()) {
+        kfd_node_numa[k] = numa_nodes[cpu_agents];
+      }
+      cpu_agents++;
+      continue;
+    }
+
+    char bdf[32];
+    snprintf(bdf, sizeof(bdf), "%04x:%02x:%02x.%x",
+             static_cast<unsigned>(domain),
+             static_cast<unsigned>((location >> 8) & 0xff),
+             static_cast<unsigned>((location >> 3) & 0x1f),
+             static_cast<unsigned>(location & 0x7));
+    std::ifstream f_numa(SysRoot + "/bus/pci/devices/" + bdf + "/numa_node");
+    int numa = -1;
+    if (f_numa >> numa && numa >= 0) {
+      kfd_node_numa[k] = numa;
+    }
+  }
+
+  return numa_nodes.empty() ? -1 : 0;
+}
+
+//! Removes all nodes
+void rvs::NumaTopology::clear() {
+  numa_nodes.clear();
+  node_cpus.clear();
+  node_distance.clear();
+  kfd_node_numa.clear();
+}
+
+/**
+ * @brief Returns CPUs of a NUMA node
+ *
+ * @param NumaNode NUMA node
+ * @return CPU numbers, empty if node is not known
+ *
+ * */
+const std::vector<int>& rvs::NumaTopology::cpus(int NumaNode) const {
+  static const std::vector<int> none;
+  auto it = node_cpus.find(NumaNode);
+  return it == node_cpus.end() ? none : it->second;
+}
+
+/**
+ * @brief Returns NUMA distance between two nodes
+ *
+ * @param From NUMA node
+ * @param To NUMA node
+ * @return distance as reported by the kernel, -1 if not known
+ *
+ * */
+int rvs::NumaTopology::distance(int From, int To) const {
+  auto it = node_distance.find(From);
+  if (it == node_distance.end()) {
+    return -1;
+  }
+  // distance row has one entry per node, in node order
+  auto pos = std::lower_bound(numa_nodes.begin(), numa_nodes.end(), To);
+  if (pos == numa_nodes.end() || *pos != To) {
+    return -1;
+  }
+  size_t ix = pos - numa_nodes.begin();
+  return ix < it->second.size() ? it->second[ix] : -1;
+}
+
+/**
+ * @brief Returns NUMA node of a KFD (HSA) agent
+ *
+ * @param KfdNode KFD node of CPU or GPU agent
+ * @return NUMA node, -1 if not known
+ *
+ * */
+int rvs::NumaTopology::kfd_numa(uint32_t KfdNode) const {
+  auto it = kfd_node_numa.find(KfdNode);
+  return it == kfd_node_numa.end() ? -1 : it->second;
+}
+
+/**
+ * @brief Returns nearest NUMA node other than the given one
+ *
+ * @param NumaNode NUMA node
+ * @return nearest other node (lowest number on equal distance), -1 if
+ * there is no other node
+ *
+ * */
+int rvs::NumaTopology::nearest_remote(int NumaNode) const {
+  int best = -1;
+  int best_dist = 0;
+  for (auto n : numa_nodes) {
+    if (n == NumaNode) {
+      continue;
+    }
+    int d = distance(NumaNode, n);
+    if (d < 0) {
+      d = INT32_MAX;
+    }
+    if (best < 0 || d < best_dist) {
+      best = n;
+      best_dist = d;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Selects CPU agents whose memory holds host buffers for a GPU
+ *
+ * @param Placement one of RVS_NUMA_PLACEMENT_*
+ * @param GpuNode KFD node of the GPU
+ * @param CpuNodes KFD nodes of all CPU agents
+ * @param pSelected [out] KFD nodes of selected CPU agents
+ * @return 0 - if successfull, 1 if placement could not be honoured (NUMA
+ * node of GPU or CPU agents not known, or no remote node) and all CPU
+ * agents were selected instead
+ *
+ * */
+int rvs::NumaTopology::select(int Placement, uint32_t GpuNode,
+                              const std::vector<uint32_t>& CpuNodes,
+                              std::vector<uint32_t>* pSelected) const {
+  pSelected->clear();
+  if (Placement == RVS_NUMA_PLACEMENT_ALL) {
+    *pSelected = CpuNodes;
+    return 0;
+  }
+
+  int gpu_numa = kfd_numa(GpuNode);
+  int want = -1;
+  if (gpu_numa >= 0) {
+    want = Placement == RVS_NUMA_PLACEMENT_LOCAL ? gpu_numa
+                                                 : nearest_remote(gpu_numa);
+  }
+  if (want >= 0) {
+    for (auto cpu : CpuNodes) {
+      if (kfd_numa(cpu) == want) {
+        pSelected->push_back(cpu);
+      }
+    }
+  }
+
+  if (pSelected->empty()) {
+    *pSelected = CpuNodes;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Restricts calling thread to the given CPUs
+ *
+ * @param Cpus CPU numbers
+ * @return 0 - if successfull, non-zero otherwise (affinity is unchanged)
+ *
+ * */
+int rvs::NumaTopology::pin(const std::vector<int>& Cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  bool bany = false;
+  for (auto cpu : Cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+      bany = true;
+    }
+  }
+  if (!bany) {
+    return -1;
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) ? -1 : 0;
+}
+
+/**
+ * @brief Constructor, pins calling thread to the given CPUs
+ *
+ * @param Cpus CPU numbers (empty - thread is not pinned)
+ *
+ * */
+rvs::CpuPinGuard::CpuPinGuard(const std::vector<int>& Cpus) : bpinned(false) {
+  if (Cpus.empty()) {
+    return;
+  }
+  if (pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved)) {
+    return;
+  }
+  bpinned = NumaTopology::pin(Cpus) == 0;
+}
+
+//! Destructor, restores affinity the thread had before pinning
+rvs::CpuPinGuard::~CpuPinGuard() {
+  if (bpinned) {
+    pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+  }
+}
+
+/**
+ * @brief Parses kernel CPU list format (e.g. "0-3,8,10-11")
+ *
+ * @param List CPU list
+ * @param pCpus [out] CPU numbers in order given
+ * @return 0 - if successfull, -1 if List is malformed
+ *
+ * */
+int rvs::NumaTopology::parse_cpulist(const std::string& List,
+                                     std::vector<int>* pCpus) {
+  pCpus->clear();
+  std::stringstream ss(List);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace),
+                range.end());
+    if (range.empty()) {
+      continue;
+    }
+    int first, last;
+    char dash;
+    std::stringstream rs(range);
+    if (!(rs >> first)) {
+      return -1;
+    }
+    last = first;
+    if (rs >> dash) {
+      if (dash != '-' || !(rs >> last) || last < first) {
+        return -1;
+      }
+    }
+    if (rs >> dash) {
+      return -1;
+    }
+    for (int cpu = first; cpu <= last; cpu++) {
+      pCpus->push_back(cpu);
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Converts placement name to value
+ *
+ * @param Name "all", "local" or "remote"
+ * @return one of RVS_NUMA_PLACEMENT_*, -1 if name is not known
+ *
+ * */
+int rvs::NumaTopology::parse_placement(const std::string& Name) {
+  for (int i = RVS_NUMA_PLACEMENT_ALL; i <= RVS_NUMA_PLACEMENT_REMOTE; i++) {
+    if (Name == kPlacementNames[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Converts placement value to name
+ *
+ * @param Placement one of RVS_NUMA_PLACEMENT_*
+ * @return placement name, "unknown" if not valid
+ *
+ * */
+const char* rvs::NumaTopology::placement_name(int Placement) {
+  if (Placement < RVS_NUMA_PLACEMENT_ALL ||
+      Placement > RVS_NUMA_PLACEMENT_REMOTE) {
+    return "unknown";
+  }
+  return kPlacementNames[Placement];
+}
+
+/**
+ * @brief Describes placement of host memory relative to a GPU
+ *
+ * @param HostNuma NUMA node of host memory
+ * @param GpuNuma NUMA node of GPU
+ * @return "local", "remote" or "unknown" (either node not known)
+ *
+ * */
+const char* rvs::NumaTopology::relation(int HostNuma, int GpuNuma) {
+  if (HostNuma < 0 || GpuNuma < 0) {
+    return "unknown";
+  }
+  return HostNuma == GpuNuma ? "local" : "remote";
+}
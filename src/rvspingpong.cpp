@@ -0,0 +1,122 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvspingpong.h"
+
+#include <vector>
+
+/**
+ * @brief Constructor
+ *
+ * @param pEngine copy engine with Rounds slots in both directions
+ * @param Rounds number of chained round trips per measurement
+ *
+ * */
+rvs::PingPong::PingPong(CopyEngine* pEngine, int Rounds)
+: engine(pEngine),
+chain(Rounds > 0 ? Rounds : 1) {
+}
+
+/**
+ * @brief Fills list of default message sizes (powers of two, 4B - 64KB)
+ *
+ * @param pSizes [out] message sizes in bytes
+ *
+ * */
+void rvs::PingPong::default_sizes(std::vector<uint32_t>* pSizes) {
+  pSizes->clear();
+  for (uint32_t s = RVS_PINGPONG_MIN_SIZE; s <= RVS_PINGPONG_MAX_SIZE; s *= 2) {
+    pSizes->push_back(s);
+  }
+}
+
+/**
+ * @brief Measures one chain of round trips
+ *
+ * @param Size message size in bytes
+ * @param pOneWay [out] one-way latencies (nsec) of both directions are
+ * added here
+ * @param pRoundTrip [out] round trip latencies (nsec) are added here
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::PingPong::run(size_t Size, Histogram* pOneWay, Histogram* pRoundTrip) {
+  int sts = 0;
+  int last_dir = -1;
+  int last_slot = -1;
+
+  for (int k = 0; k < chain; k++) {
+    // ping: first one starts right away, others after previous pong
+    if (k == 0) {
+      sts = engine->Submit(0, k, Size);
+    } else {
+      sts = engine->SubmitAfter(0, k, Size, 1, k - 1);
+    }
+    if (sts) {
+      break;
+    }
+    last_dir = 0;
+    last_slot = k;
+
+    // pong after ping
+    sts = engine->SubmitAfter(1, k, Size, 0, k);
+    if (sts) {
+      break;
+    }
+    last_dir = 1;
+    last_slot = k;
+  }
+
+  // copies complete in chain order, waiting for the last one is enough
+  if (last_dir >= 0 && engine->Wait(last_dir, last_slot)) {
+    return -1;
+  }
+  if (sts) {
+    return sts;
+  }
+
+  std::vector<uint64_t> oneway;
+  std::vector<uint64_t> roundtrip;
+  for (int k = 0; k < chain; k++) {
+    uint64_t ping_start, ping_end;
+    uint64_t pong_start, pong_end;
+    if (engine->CopyTime(0, k, &ping_start, &ping_end) ||
+        engine->CopyTime(1, k, &pong_start, &pong_end)) {
+      return -1;
+    }
+    oneway.push_back(ping_end > ping_start ? ping_end - ping_start : 0);
+    oneway.push_back(pong_end > pong_start ? pong_end - pong_start : 0);
+    roundtrip.push_back(pong_end > ping_start ? pong_end - ping_start : 0);
+  }
+
+  // record only complete measurements
+  for (auto v : oneway) {
+    pOneWay->record(v);
+  }
+  for (auto v : roundtrip) {
+    pRoundTrip->record(v);
+  }
+
+  return 0;
+}
@@ -0,0 +1,262 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvssizesweep.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+
+//! two-sided 95% Student's t quantiles for 1..30 degrees of freedom
+const double t95[] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+bool size_less(const rvs::SizeSweep::Point& p, size_t Size) {
+  return p.size < Size;
+}
+
+}  // namespace
+
+//! Default constructor
+rvs::SizeSweep::SizeSweep()
+: tolerance(RVS_SWEEP_TOLERANCE),
+min_samples(RVS_SWEEP_MIN_SAMPLES),
+max_samples(RVS_SWEEP_MAX_SAMPLES),
+max_points(RVS_SWEEP_MAX_POINTS),
+finished(true) {
+}
+
+/**
+ * @brief Returns half-width of 95% confidence interval of mean duration
+ *
+ * @return half-width in seconds (largest double if less than two samples)
+ *
+ */
+double rvs::SizeSweep::Point::ci() const {
+  if (samples < 2) {
+    return std::numeric_limits<double>::max();
+  }
+  double stddev = sqrt(m2 / (samples - 1));
+  return t_quantile(samples - 1) * stddev / sqrt(samples);
+}
+
+/**
+ * @brief Returns two-sided 95% quantile of Student's t distribution
+ *
+ * @param Df degrees of freedom
+ * @return quantile (tabulated up to 30, approximated above)
+ *
+ */
+double rvs::SizeSweep::t_quantile(uint32_t Df) {
+  const uint32_t n = sizeof(t95) / sizeof(t95[0]);
+  if (Df == 0) {
+    return std::numeric_limits<double>::max();
+  }
+  if (Df <= n) {
+    return t95[Df - 1];
+  }
+  // approaches normal quantile as 1/Df
+  return 1.960 + (t95[n - 1] - 1.960) * n / Df;
+}
+
+//! Creates point without samples
+rvs::SizeSweep::Point rvs::SizeSweep::make_point(size_t Size) {
+  Point p;
+  p.size = Size;
+  p.samples = 0;
+  p.mean = 0;
+  p.m2 = 0;
+  p.settled = false;
+  p.converged = false;
+  return p;
+}
+
+/**
+ * @brief Starts new sweep
+ *
+ * Sweep starts with the smallest and the largest size and sizes in between
+ * which are at least RVS_SWEEP_SEED_RATIO times apart.
+ *
+ * @param Sizes configured transfer sizes
+ * @param Tolerance relative half-width of confidence interval (e.g. 0.05)
+ * @param MinSamples minimum number of samples per size
+ * @param MaxSamples maximum number of samples per size (size is given up
+ * on when reached)
+ * @param MaxPoints maximum number of sizes to measure
+ *
+ */
+void rvs::SizeSweep::initialize(const std::vector<uint32_t>& Sizes,
+                                double Tolerance, uint32_t MinSamples,
+                                uint32_t MaxSamples, uint32_t MaxPoints) {
+  tolerance = Tolerance;
+  min_samples = std::max(MinSamples, 2u);
+  max_samples = std::max(MaxSamples, min_samples);
+  max_points = MaxPoints;
+  pts.clear();
+
+  std::vector<uint32_t> sorted(Sizes);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  sorted.erase(std::remove(sorted.begin(), sorted.end(), 0u), sorted.end());
+
+  for (size_t i = 0; i < sorted.size(); i++) {
+    bool last = i + 1 == sorted.size();
+    if (pts.empty() || last ||
+        sorted[i] >= pts.back().size * RVS_SWEEP_SEED_RATIO) {
+      pts.push_back(make_point(sorted[i]));
+    }
+  }
+
+  finished = pts.empty();
+}
+
+/**
+ * @brief Get sizes which need more samples
+ *
+ * When all sizes have settled, refines the sweep before returning.
+ *
+ * @param pSizes [out] sizes to measure next (one sample each)
+ * @return 'false' if sweep is done, 'true' otherwise
+ *
+ */
+bool rvs::SizeSweep::pending(std::vector<size_t>* pSizes) {
+  pSizes->clear();
+  if (finished) {
+    return false;
+  }
+
+  for (int pass = 0; pass < 2; pass++) {
+    for (auto it = pts.begin(); it != pts.end(); ++it) {
+      if (!it->settled) {
+        pSizes->push_back(it->size);
+      }
+    }
+    if (pSizes->size() > 0) {
+      return true;
+    }
+    if (!refine()) {
+      break;
+    }
+  }
+
+  finished = true;
+  return false;
+}
+
+/**
+ * @brief Records one measurement
+ *
+ * @param Size transfer size (as returned by pending())
+ * @param Duration transfer duration in seconds
+ *
+ */
+void rvs::SizeSweep::add(size_t Size, double Duration) {
+  auto it = std::lower_bound(pts.begin(), pts.end(), Size, size_less);
+  if (it == pts.end() || it->size != Size || it->settled) {
+    return;
+  }
+
+  it->samples++;
+  double delta = Duration - it->mean;
+  it->mean += delta / it->samples;
+  it->m2 += delta * (Duration - it->mean);
+
+  settle(&*it);
+}
+
+//! Marks point settled if converged or out of samples
+void rvs::SizeSweep::settle(Point* pPoint) {
+  if (pPoint->samples >= min_samples &&
+      pPoint->ci() <= tolerance * pPoint->mean) {
+    pPoint->converged = true;
+    pPoint->settled = true;
+  } else if (pPoint->samples >= max_samples) {
+    pPoint->settled = true;
+  }
+}
+
+/**
+ * @brief Inserts new sizes where bandwidth changes the most
+ *
+ * @return 'true' if any size has been added
+ *
+ */
+bool rvs::SizeSweep::refine() {
+  if (pts.size() < 2 || pts.size() >= max_points) {
+    return false;
+  }
+
+  double peak = 0;
+  for (auto it = pts.begin(); it != pts.end(); ++it) {
+    peak = std::max(peak, it->bandwidth());
+  }
+  // steps smaller than measurement error are not worth refining
+  double step = std::max(RVS_SWEEP_REFINE_STEP, 2 * tolerance) * peak;
+
+  // (bandwidth step, new size) for every gap worth refining
+  std::vector<std::pair<double, size_t>> gaps;
+  for (size_t i = 0; i + 1 < pts.size(); i++) {
+    size_t lo = pts[i].size;
+    size_t hi = pts[i + 1].size;
+    double diff = fabs(pts[i + 1].bandwidth() - pts[i].bandwidth());
+    if (diff <= step || hi < lo * RVS_SWEEP_MIN_RATIO) {
+      continue;
+    }
+    size_t mid = static_cast<size_t>(sqrt(static_cast<double>(lo) * hi));
+    size_t aligned = (mid + RVS_SWEEP_ALIGN / 2) / RVS_SWEEP_ALIGN
+                   * RVS_SWEEP_ALIGN;
+    if (aligned > lo && aligned < hi) {
+      mid = aligned;
+    }
+    if (mid > lo && mid < hi) {
+      gaps.push_back(std::make_pair(diff, mid));
+    }
+  }
+
+  // biggest steps first
+  std::sort(gaps.begin(), gaps.end(),
+            [](const std::pair<double, size_t>& a,
+               const std::pair<double, size_t>& b) {
+              return a.first > b.first;
+            });
+  size_t room = max_points - pts.size();
+  if (gaps.size() > room) {
+    gaps.resize(room);
+  }
+
+  for (auto it = gaps.begin(); it != gaps.end(); ++it) {
+    auto pos = std::lower_bound(pts.begin(), pts.end(), it->second,
+                                size_less);
+    pts.insert(pos, make_point(it->second));
+  }
+
+  return gaps.size() > 0;
+}
@@ -0,0 +1,210 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvstopology.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+const uint32_t rvs::Topology::NO_CONN;
+
+//! Default constructor
+rvs::Topology::Topology() {
+}
+
+/**
+ * @brief Sets list of agents and resets all connections
+ *
+ * All pairs are set to "no access, no connection" state.
+ *
+ * @param Nodes NUMA node of every agent (in agent index order)
+ *
+ */
+void rvs::Topology::reset(const std::vector<uint32_t>& Nodes) {
+  Pair empty;
+  empty.peer = 0;
+  empty.distance = NO_CONN;
+  empty.hops = 0;
+
+  nodes = Nodes;
+  node_index.clear();
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (nodes[i] >= node_index.size()) {
+      node_index.resize(nodes[i] + 1, -1);
+    }
+    node_index[nodes[i]] = static_cast<int>(i);
+  }
+  matrix.assign(nodes.size() * nodes.size(), empty);
+}
+
+//! Removes all agents
+void rvs::Topology::clear() {
+  nodes.clear();
+  node_index.clear();
+  matrix.clear();
+}
+
+/**
+ * @brief Find agent index for NUMA node
+ * @param Node NUMA node
+ * @return agent index, -1 if there is no agent for this node
+ *
+ */
+int rvs::Topology::index(uint32_t Node) const {
+  if (Node >= node_index.size()) {
+    return -1;
+  }
+  return node_index[Node];
+}
+
+/**
+ * @brief Get connection between two NUMA nodes
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @return ptr to connection, nullptr if either node is unknown
+ *
+ */
+rvs::Topology::Pair* rvs::Topology::at(uint32_t SrcNode, uint32_t DstNode) {
+  int srcix = index(SrcNode);
+  int dstix = index(DstNode);
+  if (srcix < 0 || dstix < 0) {
+    return nullptr;
+  }
+  return &pair(srcix, dstix);
+}
+
+//! Const version of at()
+const rvs::Topology::Pair* rvs::Topology::at(uint32_t SrcNode,
+                                             uint32_t DstNode) const {
+  return const_cast<Topology*>(this)->at(SrcNode, DstNode);
+}
+
+/**
+ * @brief Writes topology in text form
+ *
+ * Format is line oriented:
+ *
+ *     RVSTOPOLOGY 1
+ *     agents <N> <node_0> ... <node_N-1>
+ *     pair <src> <dst> <peer> <distance> <hops> [<type> <distance> <name>]...
+ *
+ * with one "pair" line per ordered pair of agents and one type/distance/name
+ * triplet per hop.
+ *
+ * @param Out output stream
+ *
+ */
+void rvs::Topology::serialize(std::ostream& Out) const {
+  Out << RVS_TOPOLOGY_MAGIC << "\n";
+  Out << "agents " << nodes.size();
+  for (size_t i = 0; i < nodes.size(); i++) {
+    Out << " " << nodes[i];
+  }
+  Out << "\n";
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (size_t j = 0; j < nodes.size(); j++) {
+      const Pair& p = matrix[i * nodes.size() + j];
+      Out << "pair " << nodes[i] << " " << nodes[j] << " " << p.peer << " "
+          << p.distance << " " << p.hops;
+      for (auto it = p.path.begin(); it != p.path.end(); ++it) {
+        Out << " " << it->etype << " " << it->distance << " "
+            << (it->strtype.empty() ? "-" : it->strtype);
+      }
+      Out << "\n";
+    }
+  }
+}
+
+/**
+ * @brief Reads topology written by serialize()
+ *
+ * Pairs not present in the input are left in "no connection" state.
+ *
+ * @param In input stream
+ * @return 0 - OK, -1 if input is malformed (topology is cleared)
+ *
+ */
+int rvs::Topology::deserialize(std::istream& In) {
+  std::string line;
+  std::string tag;
+
+  clear();
+  if (!std::getline(In, line) || line != RVS_TOPOLOGY_MAGIC) {
+    return -1;
+  }
+
+  size_t count;
+  if (!std::getline(In, line)) {
+    return -1;
+  }
+  std::istringstream hdr(line);
+  if (!(hdr >> tag >> count) || tag != "agents" ||
+      count > RVS_TOPOLOGY_MAX_NODE) {
+    return -1;
+  }
+  std::vector<uint32_t> agents(count);
+  for (size_t i = 0; i < count; i++) {
+    // node is used as index into lookup table so keep it bounded
+    if (!(hdr >> agents[i]) || agents[i] >= RVS_TOPOLOGY_MAX_NODE) {
+      return -1;
+    }
+  }
+  reset(agents);
+
+  while (std::getline(In, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream ss(line);
+    uint32_t src;
+    uint32_t dst;
+    Pair p;
+    if (!(ss >> tag >> src >> dst >> p.peer >> p.distance >> p.hops) ||
+        tag != "pair") {
+      clear();
+      return -1;
+    }
+    Pair* pp = at(src, dst);
+    if (pp == nullptr) {
+      clear();
+      return -1;
+    }
+    for (uint32_t h = 0; h < p.hops; h++) {
+      linkinfo_t li;
+      if (!(ss >> li.etype >> li.distance >> li.strtype)) {
+        clear();
+        return -1;
+      }
+      if (li.strtype == "-") {
+        li.strtype.clear();
+      }
+      p.path.push_back(li);
+    }
+    *pp = p;
+  }
+
+  return 0;
+}